@@ -556,6 +556,18 @@
 #define CH_DBG_STATISTICS                   FALSE
 #endif
 
+/**
+ * @brief   Debug option, ISRs time accounting.
+ * @details If enabled the time spent in ISRs is measured and it is not
+ *          accounted to the interrupted threads.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_DBG_STATISTICS.
+ */
+#if !defined(CH_DBG_STATISTICS_ISR)
+#define CH_DBG_STATISTICS_ISR               FALSE
+#endif
+
 /**
  * @brief   Debug option, system state check.
  * @details If enabled the correct call protocol for system APIs is checked
@@ -635,6 +647,19 @@
 #define CH_DBG_FILL_THREADS                 FALSE
 #endif
 
+/**
+ * @brief   Debug option, stacks watermark.
+ * @details If enabled then the idle thread incrementally scans the filled
+ *          stacks of the registered threads, the unused stack space is
+ *          returned by @p chRegGetStackUnusedX().
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_DBG_FILL_THREADS and @p CH_CFG_USE_REGISTRY.
+ */
+#if !defined(CH_DBG_STACK_WATERMARK)
+#define CH_DBG_STACK_WATERMARK              FALSE
+#endif
+
 /**
  * @brief   Debug option, threads profiling.
  * @details If enabled then a field is added to the @p thread_t structure that
@@ -648,6 +673,39 @@
 #define CH_DBG_THREADS_PROFILING            FALSE
 #endif
 
+/**
+ * @brief   Debug option, sampling profiler.
+ * @details If enabled then program counter samples can be collected in a
+ *          per-core buffer and fetched using @p chProfRead().
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_DBG_PROFILER)
+#define CH_DBG_PROFILER                     FALSE
+#endif
+
+/**
+ * @brief   Profiler buffer entries.
+ * @note    The value must be a power of two.
+ * @note    The profiler buffer is only allocated if @p CH_DBG_PROFILER is
+ *          enabled.
+ */
+#if !defined(CH_DBG_PROFILER_BUFFER_SIZE)
+#define CH_DBG_PROFILER_BUFFER_SIZE         256
+#endif
+
+/**
+ * @brief   Debug option, synchronization objects profiling.
+ * @details If enabled then mutexes and semaphores collect acquisitions,
+ *          contention, wait and hold times statistics.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_TM.
+ */
+#if !defined(CH_DBG_SYNC_PROFILING)
+#define CH_DBG_SYNC_PROFILING               FALSE
+#endif
+
 /** @} */
 
 /*===========================================================================*/
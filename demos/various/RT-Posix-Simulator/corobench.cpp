@@ -0,0 +1,148 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "hal.h"
+#include "shell.h"
+#include "chprintf.h"
+#include "chcoroutines.hpp"
+
+using namespace chibios_rt;
+
+/*
+ * Coroutines benchmark, hundreds of state machines are run by a single
+ * executor in the shell thread. In the first phase tokens are passed
+ * around a ring of machines using coroutine mailboxes, in the second phase
+ * all the machines sleep repeatedly on virtual timers.
+ */
+#define COROBENCH_MACHINES  256
+#define COROBENCH_TOKENS    4
+#define COROBENCH_LAPS      200
+#define COROBENCH_SLEEPS    100
+#define COROBENCH_FRAME     192
+
+/* Stack assumed for an equivalent state machine thread.*/
+#define COROBENCH_STACK     256
+
+typedef CoroutineExecutor<COROBENCH_FRAME, COROBENCH_MACHINES> bench_executor_t;
+typedef CoroutineMailbox<unsigned, COROBENCH_TOKENS> bench_mailbox_t;
+
+struct bench_objects {
+  bench_executor_t      exec;
+  bench_mailbox_t       mbx[COROBENCH_MACHINES];
+  unsigned              transitions;
+};
+
+/* Objects are constructed by the command, constructors using the kernel
+   cannot run before chSysInit().*/
+alignas(bench_objects) static uint8_t bench_buf[sizeof (bench_objects)];
+
+static CoroutineTask ring_machine(BaseCoroutineExecutor &exec,
+                                  bench_objects *bp, unsigned id) {
+  bench_mailbox_t *next = &bp->mbx[(id + 1U) % COROBENCH_MACHINES];
+  unsigned i;
+
+  (void)exec;
+  for (i = 0U; i < COROBENCH_TOKENS * COROBENCH_LAPS; i++) {
+    unsigned token = co_await bp->mbx[id].fetch();
+
+    (void) next->post(token + 1U);
+    bp->transitions++;
+  }
+}
+
+static CoroutineTask sleep_machine(BaseCoroutineExecutor &exec,
+                                   bench_objects *bp) {
+  unsigned i;
+
+  (void)exec;
+  for (i = 0U; i < COROBENCH_SLEEPS; i++) {
+    co_await Coroutine::sleep(TIME_MS2I(1));
+    bp->transitions++;
+  }
+}
+
+static bool bench_phase(BaseSequentialStream *chp, bench_objects *bp,
+                        const char *name, bool ring) {
+  systime_t start;
+  sysinterval_t elapsed;
+  unsigned i;
+
+  bp->transitions = 0U;
+  for (i = 0U; i < COROBENCH_MACHINES; i++) {
+    bool spawned;
+
+    if (ring) {
+      spawned = bp->exec.spawn(ring_machine(bp->exec, bp, i));
+    }
+    else {
+      spawned = bp->exec.spawn(sleep_machine(bp->exec, bp));
+    }
+    if (!spawned) {
+      chprintf(chp, "%s: frame of %u bytes required" SHELL_NEWLINE_STR,
+               name, (unsigned)bp->exec.getMaxFrameSizeX());
+      /* Spawned machines never terminate, the objects are abandoned.*/
+      return false;
+    }
+  }
+  if (ring) {
+    for (i = 0U; i < COROBENCH_TOKENS; i++) {
+      (void) bp->mbx[0].post(0U);
+    }
+  }
+
+  start = chVTGetSystemTimeX();
+  bp->exec.run();
+  elapsed = chTimeDiffX(start, chVTGetSystemTimeX());
+
+  chprintf(chp, "%s: %u transitions, %u ms", name, bp->transitions,
+           (unsigned)TIME_I2MS(elapsed));
+  if (elapsed > (sysinterval_t)0) {
+    chprintf(chp, ", %u transitions/S",
+             (unsigned)(((uint64_t)bp->transitions * CH_CFG_ST_FREQUENCY) /
+                        elapsed));
+  }
+  chprintf(chp, SHELL_NEWLINE_STR);
+
+  return true;
+}
+
+extern "C" void cmd_corobench(BaseSequentialStream *chp,
+                              int argc, char *argv[]) {
+  bench_objects *bp;
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: corobench" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  bp = new (bench_buf) bench_objects;
+  chprintf(chp, "%u machines in one thread" SHELL_NEWLINE_STR,
+           COROBENCH_MACHINES);
+  if (!bench_phase(chp, bp, "mailbox ring", true) ||
+      !bench_phase(chp, bp, "sleep       ", false)) {
+    return;
+  }
+
+  chprintf(chp, "frames:  %u x %u bytes, largest %u bytes" SHELL_NEWLINE_STR,
+           COROBENCH_MACHINES, (unsigned)bench_executor_t::BLOCK_SIZE,
+           (unsigned)bp->exec.getMaxFrameSizeX());
+  chprintf(chp, "threads: %u x %u bytes" SHELL_NEWLINE_STR,
+           COROBENCH_MACHINES,
+           (unsigned)THD_WORKING_AREA_SIZE(COROBENCH_STACK));
+  bp->~bench_objects();
+}
@@ -18,10 +18,16 @@
 #include "hal.h"
 #include "shell.h"
 #include "chprintf.h"
+#include "nullstreams.h"
+#include "memstreams.h"
+#include "dlog.h"
+#include "hal_blk_queue.h"
+#include "blkfile.h"
 
 #define SHELL_WA_SIZE       THD_WORKING_AREA_SIZE(4096)
 #define CONSOLE_WA_SIZE     THD_WORKING_AREA_SIZE(4096)
 #define TEST_WA_SIZE        THD_WORKING_AREA_SIZE(4096)
+#define DISP_WA_SIZE        THD_WORKING_AREA_SIZE(1024)
 
 #define cputs(msg) chMsgSend(cdtp, (msg_t)msg)
 
@@ -29,7 +35,200 @@ static thread_t *cdtp;
 static thread_t *shelltp1;
 static thread_t *shelltp2;
 
+/*
+ * Block requests queue benchmark, some streams of single block writes are
+ * interleaved as it would happen with concurrent writer threads.
+ */
+#define BENCH_STREAMS       4
+#define BENCH_BLOCKS        256
+#define BENCH_MERGE_BLOCKS  16
+
+static FileBlockDevice FBD1;
+static BRQDriver BRQ1;
+static uint8_t bench_data[BENCH_STREAMS][BENCH_BLOCKS * FBD_BLOCK_SIZE];
+static uint8_t bench_merge_buffer[BENCH_MERGE_BLOCKS * FBD_BLOCK_SIZE];
+static brq_request_t bench_requests[BENCH_STREAMS * BENCH_BLOCKS];
+
+static const BRQConfig bench_unmerged_cfg = {
+  (BaseBlockDevice *)&FBD1,
+  FBD_BLOCK_SIZE,
+  0,
+  0,
+  NULL,
+  0
+};
+
+static const BRQConfig bench_merged_cfg = {
+  (BaseBlockDevice *)&FBD1,
+  FBD_BLOCK_SIZE,
+  BENCH_MERGE_BLOCKS,
+  TIME_MS2I(100),
+  bench_merge_buffer,
+  BENCH_MERGE_BLOCKS
+};
+
+static THD_FUNCTION(dispatcher_thread, arg) {
+
+  while (brqDispatchTimeout((BRQDriver *)arg, TIME_INFINITE) != MSG_RESET) {
+  }
+}
+
+static void bench_run(BaseSequentialStream *chp, const char *name,
+                      const BRQConfig *cfg) {
+  thread_t *tp;
+  systime_t start;
+  sysinterval_t elapsed;
+  unsigned i, n, errors;
+
+  brqStart(&BRQ1, cfg);
+  tp = chThdCreateFromHeap(NULL, DISP_WA_SIZE, "blkqueue",
+                           NORMALPRIO, dispatcher_thread, &BRQ1);
+
+  start = chVTGetSystemTimeX();
+  n = 0;
+  for (i = 0; i < BENCH_BLOCKS; i++) {
+    unsigned s;
+
+    for (s = 0; s < BENCH_STREAMS; s++) {
+      brqRequestObjectInit(&bench_requests[n], BRQ_OP_WRITE,
+                           (s * BENCH_BLOCKS * 2) + i,
+                           &bench_data[s][i * FBD_BLOCK_SIZE], 1,
+                           NULL, NULL);
+      brqSubmit(&BRQ1, &bench_requests[n]);
+      n++;
+    }
+  }
+  errors = 0;
+  for (i = 0; i < n; i++) {
+    if (brqWaitTimeout(&BRQ1, &bench_requests[i], TIME_INFINITE) != MSG_OK) {
+      errors++;
+    }
+  }
+  elapsed = chTimeDiffX(start, chVTGetSystemTimeX());
+
+  chprintf(chp, "%s: %u requests, %u transfers, %u errors, %u ms",
+           name, (unsigned)brqGetRequestsX(&BRQ1),
+           (unsigned)brqGetTransfersX(&BRQ1), errors,
+           (unsigned)TIME_I2MS(elapsed));
+  if (elapsed > (sysinterval_t)0) {
+    chprintf(chp, ", %u IOPS",
+             (unsigned)(((uint64_t)n * CH_CFG_ST_FREQUENCY) / elapsed));
+  }
+  chprintf(chp, SHELL_NEWLINE_STR);
+
+  brqStop(&BRQ1);
+  chThdWait(tp);
+}
+
+static void cmd_blkbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: blkbench" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  if (fbdStart(&FBD1, "blkbench.img",
+               BENCH_STREAMS * BENCH_BLOCKS * 2) != HAL_SUCCESS) {
+    chprintf(chp, "Cannot create blkbench.img" SHELL_NEWLINE_STR);
+    return;
+  }
+  (void)blkConnect(&FBD1);
+
+  bench_run(chp, "unmerged", &bench_unmerged_cfg);
+  bench_run(chp, "merged  ", &bench_merged_cfg);
+
+  (void)blkDisconnect(&FBD1);
+  fbdStop(&FBD1);
+}
+
+#define LOGBENCH_BATCHES    32
+#define LOGBENCH_CALLS      4096
+
+/* Each batch must fit the log ring, a message with three arguments takes
+   five words.*/
+#if DLOG_BUFFER_SIZE < (LOGBENCH_CALLS * 5)
+#error "DLOG_BUFFER_SIZE too small for LOGBENCH_CALLS"
+#endif
+
+static NullStream bench_null;
+static uint8_t bench_log[1024];
+
+/* Average realtime counter cycles per call.*/
+static rttime_t logbench_cycles(const time_measurement_t *tmp) {
+
+  return tmp->cumulative / (rttime_t)(LOGBENCH_BATCHES * LOGBENCH_CALLS);
+}
+
+static void cmd_logbench(BaseSequentialStream *chp, int argc, char *argv[]) {
+  BaseSequentialStream *nsp = (BaseSequentialStream *)&bench_null;
+  time_measurement_t tm_printf, tm_dlog;
+  dlog_stream_t dls;
+  MemoryStream ms;
+  unsigned b, i;
+  FILE *f;
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: logbench" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  nullObjectInit(&bench_null);
+  dlogObjectInit(&dls, nsp);
+  (void) dlogDrain(&dls);
+  chTMObjectInit(&tm_printf);
+  chTMObjectInit(&tm_dlog);
+
+  /* Batches fit the log ring, the drain is not measured.*/
+  for (b = 0; b < LOGBENCH_BATCHES; b++) {
+    chTMStartMeasurementX(&tm_printf);
+    for (i = 0; i < LOGBENCH_CALLS; i++) {
+      chprintf(nsp, "sample %u: value=%d state=%s" SHELL_NEWLINE_STR,
+               i, -(int)i, "ok");
+    }
+    chTMStopMeasurementX(&tm_printf);
+
+    chTMStartMeasurementX(&tm_dlog);
+    for (i = 0; i < LOGBENCH_CALLS; i++) {
+      dlogX("sample %u: value=%d state=%s", i, -(int)i, "ok");
+    }
+    chTMStopMeasurementX(&tm_dlog);
+    (void) dlogDrain(&dls);
+  }
+
+  chprintf(chp, "chprintf(): %u cycles per call" SHELL_NEWLINE_STR,
+           (unsigned)logbench_cycles(&tm_printf));
+  chprintf(chp, "dlogX():    %u cycles per call, %u lost" SHELL_NEWLINE_STR,
+           (unsigned)logbench_cycles(&tm_dlog), (unsigned)dls.lost);
+
+  /* Results also logged in a stream for chdlog.py.*/
+  msObjectInit(&ms, bench_log, sizeof (bench_log), 0);
+  dlogObjectInit(&dls, (BaseSequentialStream *)&ms);
+  dlogStart(&dls);
+  dlogX("logbench: %u calls", LOGBENCH_BATCHES * LOGBENCH_CALLS);
+  dlogX("logbench: %s %u cycles per call", "chprintf()",
+        (unsigned)logbench_cycles(&tm_printf));
+  dlogX("logbench: %s %u cycles per call", "dlogX()",
+        (unsigned)logbench_cycles(&tm_dlog));
+  (void) dlogDrain(&dls);
+  f = fopen("logbench.dlog", "wb");
+  if (f != NULL) {
+    (void) fwrite(bench_log, 1, ms.eos, f);
+    (void) fclose(f);
+    chprintf(chp, "Log written in logbench.dlog" SHELL_NEWLINE_STR);
+  }
+}
+
+/* C++ benchmarks, in corobench.cpp and queuebench.cpp.*/
+void cmd_corobench(BaseSequentialStream *chp, int argc, char *argv[]);
+void cmd_queuebench(BaseSequentialStream *chp, int argc, char *argv[]);
+
 static const ShellCommand commands[] = {
+  {"blkbench", cmd_blkbench},
+  {"logbench", cmd_logbench},
+  {"corobench", cmd_corobench},
+  {"queuebench", cmd_queuebench},
   {NULL, NULL}
 };
 
@@ -169,6 +368,12 @@ int main(void) {
   sdStart(&SD1, NULL);
   sdStart(&SD2, NULL);
 
+  /*
+   * Block device and requests queue objects used by the shell benchmark.
+   */
+  fbdObjectInit(&FBD1);
+  brqObjectInit(&BRQ1);
+
   /*
    * Shell manager initialization.
    */
@@ -0,0 +1,161 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ch.h"
+#include "hal.h"
+#include "shell.h"
+#include "chprintf.h"
+#include "ch.hpp"
+
+using namespace chibios_rt;
+
+/*
+ * Queues benchmark, the kernel mailbox wrapper is compared with the
+ * lock-free typed queues. In the first phase a single thread posts and
+ * fetches without waiting, in the second phase a producer thread feeds
+ * the shell thread with blocking operations.
+ */
+#define QUEUEBENCH_SIZE     64
+#define QUEUEBENCH_MESSAGES 1000000
+#define QUEUEBENCH_WA_SIZE  THD_WORKING_AREA_SIZE(1024)
+
+typedef Mailbox<msg_t, QUEUEBENCH_SIZE> bench_mailbox_t;
+typedef SPSCQueue<msg_t, QUEUEBENCH_SIZE, true> bench_spsc_t;
+typedef MPMCQueue<msg_t, QUEUEBENCH_SIZE, true> bench_mpmc_t;
+
+struct bench_queues {
+  bench_mailbox_t       mbx;
+  bench_spsc_t          spsc;
+  bench_mpmc_t          mpmc;
+};
+
+/* Objects are constructed by the command, constructors using the kernel
+   cannot run before chSysInit().*/
+alignas(bench_queues) static uint8_t bench_buf[sizeof (bench_queues)];
+
+/* Uniform interface over the compared queues.*/
+static bool bench_try_post(bench_mailbox_t &q, msg_t msg) {
+
+  return q.post(msg, TIME_IMMEDIATE) == MSG_OK;
+}
+
+static bool bench_try_fetch(bench_mailbox_t &q, msg_t *msgp) {
+
+  return q.fetch(msgp, TIME_IMMEDIATE) == MSG_OK;
+}
+
+template <class Q>
+static bool bench_try_post(Q &q, msg_t msg) {
+
+  return q.tryPost(msg);
+}
+
+template <class Q>
+static bool bench_try_fetch(Q &q, msg_t *msgp) {
+
+  return q.tryFetch(msgp);
+}
+
+template <class Q>
+static THD_FUNCTION(bench_producer, arg) {
+  Q *qp = (Q *)arg;
+  msg_t i;
+
+  for (i = 0; i < QUEUEBENCH_MESSAGES; i++) {
+    (void) qp->post(i, TIME_INFINITE);
+  }
+}
+
+static void bench_print(BaseSequentialStream *chp, const char *name,
+                        unsigned n, sysinterval_t elapsed, unsigned errors) {
+
+  chprintf(chp, "%s: %u ms", name, (unsigned)TIME_I2MS(elapsed));
+  if (elapsed > (sysinterval_t)0) {
+    chprintf(chp, ", %u msgs/S",
+             (unsigned)(((uint64_t)n * CH_CFG_ST_FREQUENCY) / elapsed));
+  }
+  chprintf(chp, ", %u errors" SHELL_NEWLINE_STR, errors);
+}
+
+template <class Q>
+static void bench_single(BaseSequentialStream *chp, const char *name, Q &q) {
+  systime_t start;
+  unsigned i, errors = 0U;
+
+  start = chVTGetSystemTimeX();
+  for (i = 0U; i < QUEUEBENCH_MESSAGES; i++) {
+    msg_t msg;
+
+    if (!bench_try_post(q, (msg_t)i) ||
+        !bench_try_fetch(q, &msg) || (msg != (msg_t)i)) {
+      errors++;
+    }
+  }
+  bench_print(chp, name, QUEUEBENCH_MESSAGES,
+              chTimeDiffX(start, chVTGetSystemTimeX()), errors);
+}
+
+template <class Q>
+static void bench_threads(BaseSequentialStream *chp, const char *name, Q &q) {
+  thread_t *tp;
+  systime_t start;
+  unsigned errors = 0U;
+  msg_t i;
+
+  /* Same priority, the producer runs until the queue is full.*/
+  tp = chThdCreateFromHeap(NULL, QUEUEBENCH_WA_SIZE, "producer",
+                           chThdGetPriorityX(), bench_producer<Q>, &q);
+  if (tp == NULL) {
+    chprintf(chp, "out of memory" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  start = chVTGetSystemTimeX();
+  for (i = 0; i < QUEUEBENCH_MESSAGES; i++) {
+    msg_t msg;
+
+    if ((q.fetch(&msg, TIME_INFINITE) != MSG_OK) || (msg != i)) {
+      errors++;
+    }
+  }
+  bench_print(chp, name, QUEUEBENCH_MESSAGES,
+              chTimeDiffX(start, chVTGetSystemTimeX()), errors);
+  chThdWait(tp);
+}
+
+extern "C" void cmd_queuebench(BaseSequentialStream *chp,
+                               int argc, char *argv[]) {
+  bench_queues *bp;
+
+  (void)argv;
+  if (argc > 0) {
+    chprintf(chp, "Usage: queuebench" SHELL_NEWLINE_STR);
+    return;
+  }
+
+  bp = new (bench_buf) bench_queues;
+  chprintf(chp, "%u messages, single thread" SHELL_NEWLINE_STR,
+           QUEUEBENCH_MESSAGES);
+  bench_single(chp, "Mailbox  ", bp->mbx);
+  bench_single(chp, "SPSCQueue", bp->spsc);
+  bench_single(chp, "MPMCQueue", bp->mpmc);
+  chprintf(chp, "%u messages, producer thread" SHELL_NEWLINE_STR,
+           QUEUEBENCH_MESSAGES);
+  bench_threads(chp, "Mailbox  ", bp->mbx);
+  bench_threads(chp, "SPSCQueue", bp->spsc);
+  bench_threads(chp, "MPMCQueue", bp->mpmc);
+  bp->~bench_queues();
+}
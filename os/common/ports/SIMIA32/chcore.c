@@ -28,6 +28,12 @@
 #if defined(WIN32)
 #include <windows.h>
 #else
+#if !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+#include <string.h>
+#include <signal.h>
+#include <ucontext.h>
 #include <sys/time.h>
 #endif
 
@@ -57,6 +63,13 @@
 bool port_isr_context_flag;
 syssts_t port_irq_sts;
 
+#if (PORT_SIM_VIRTUAL_TIME == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Virtual time in nanoseconds.
+ */
+uint64_t port_sim_time;
+#endif
+
 /*===========================================================================*/
 /* Module local types.                                                       */
 /*===========================================================================*/
@@ -69,6 +82,29 @@ syssts_t port_irq_sts;
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (defined(__CHIBIOS_RT__) && (CH_DBG_PROFILER == TRUE) &&               \
+     (PORT_SUPPORTS_PROFILER == TRUE)) || defined(__DOXYGEN__)
+/**
+ * @brief   Profiler signal handler.
+ * @details The interrupted program counter is fetched from the signal
+ *          context.
+ */
+static void port_prof_handler(int sig, siginfo_t *sip, void *ctx) {
+  ucontext_t *ucp = (ucontext_t *)ctx;
+
+  (void)sig;
+  (void)sip;
+
+#if defined(__APPLE__)
+  chProfSampleX((void *)ucp->uc_mcontext->__ss.__eip);
+#elif defined(__x86_64__)
+  chProfSampleX((void *)ucp->uc_mcontext.gregs[REG_RIP]);
+#else
+  chProfSampleX((void *)ucp->uc_mcontext.gregs[REG_EIP]);
+#endif
+}
+#endif
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -127,7 +163,10 @@ void _port_thread_start(msg_t (*pf)(void *), void *p) {
  * @return              The realtime counter value.
  */
 rtcnt_t port_rt_get_counter_value(void) {
-#if defined(WIN32)
+#if PORT_SIM_VIRTUAL_TIME == TRUE
+
+  return (rtcnt_t)(port_sim_time / 1000U);
+#elif defined(WIN32)
   LARGE_INTEGER n;
 
   QueryPerformanceCounter(&n);
@@ -141,4 +180,47 @@ rtcnt_t port_rt_get_counter_value(void) {
 #endif
 }
 
+#if (defined(__CHIBIOS_RT__) && (CH_DBG_PROFILER == TRUE) &&               \
+     (PORT_SUPPORTS_PROFILER == TRUE)) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts the profiler sampling source.
+ *
+ * @param[in] frequency requested sampling frequency in Hz
+ * @return              The effective sampling frequency, the period is
+ *                      rounded to microseconds.
+ */
+uint32_t port_prof_start(uint32_t frequency) {
+  struct sigaction sa;
+  struct itimerval it;
+  uint32_t period = 1000000U / frequency;
+
+  if (period == 0U) {
+    period = 1U;
+  }
+
+  memset(&sa, 0, sizeof (sa));
+  sa.sa_sigaction = port_prof_handler;
+  sa.sa_flags     = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&sa.sa_mask);
+  (void) sigaction(SIGPROF, &sa, NULL);
+
+  it.it_interval.tv_sec  = (time_t)(period / 1000000U);
+  it.it_interval.tv_usec = (suseconds_t)(period % 1000000U);
+  it.it_value            = it.it_interval;
+  (void) setitimer(ITIMER_PROF, &it, NULL);
+
+  return 1000000U / period;
+}
+
+/**
+ * @brief   Stops the profiler sampling source.
+ */
+void port_prof_stop(void) {
+  struct itimerval it;
+
+  memset(&it, 0, sizeof (it));
+  (void) setitimer(ITIMER_PROF, &it, NULL);
+}
+#endif
+
 /** @} */
@@ -41,6 +41,19 @@
  */
 #define PORT_SUPPORTS_RT                TRUE
 
+/**
+ * @brief   This port supports a profiler sampling source.
+ * @details Samples are taken by a @p SIGPROF handler, the timer counts the
+ *          host CPU time so the time spent sleeping while idle is not
+ *          sampled.
+ * @note    Not supported on Windows.
+ */
+#if !defined(WIN32) || defined(__DOXYGEN__)
+#define PORT_SUPPORTS_PROFILER          TRUE
+#else
+#define PORT_SUPPORTS_PROFILER          FALSE
+#endif
+
 /**
  * @brief   Natural alignment constant.
  * @note    It is the minimum alignment for pointer-size variables.
@@ -113,6 +126,32 @@
 #define PORT_INT_REQUIRED_STACK         16384
 #endif
 
+/**
+ * @brief   Deterministic virtual time mode.
+ * @details In this mode the simulated time does not follow the host clock,
+ *          it advances by a fixed cost for each kernel lock and interrupts
+ *          check, while idle it jumps to the next timer event. Time
+ *          measurements become reproducible run to run.
+ * @note    Only supported by the Posix simulator.
+ */
+#if !defined(PORT_SIM_VIRTUAL_TIME) || defined(__DOXYGEN__)
+#define PORT_SIM_VIRTUAL_TIME           FALSE
+#endif
+
+/**
+ * @brief   Virtual time cost of a kernel lock in nanoseconds.
+ */
+#if !defined(PORT_SIM_LOCK_COST) || defined(__DOXYGEN__)
+#define PORT_SIM_LOCK_COST              100
+#endif
+
+/**
+ * @brief   Virtual time cost of an interrupts check in nanoseconds.
+ */
+#if !defined(PORT_SIM_CHECK_COST) || defined(__DOXYGEN__)
+#define PORT_SIM_CHECK_COST             20
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -189,6 +228,17 @@ struct port_context {
 #define AALIGN(p, mask, mod)                                                \
   p = (void *)((((uint32_t)(p) - (uint32_t)(mod)) & ~(uint32_t)(mask)) + (uint32_t)(mod)) \
 
+/**
+ * @brief   Advances the virtual time.
+ *
+ * @param[in] ns        time increment in nanoseconds
+ */
+#if (PORT_SIM_VIRTUAL_TIME == TRUE) || defined(__DOXYGEN__)
+#define port_sim_advance(ns) (port_sim_time += (uint64_t)(ns))
+#else
+#define port_sim_advance(ns)
+#endif
+
 /**
  * @brief   Platform dependent part of the @p chThdCreateI() API.
  * @details This code usually setup the context switching frame represented
@@ -293,6 +343,9 @@ struct port_context {
 
 extern bool port_isr_context_flag;
 extern syssts_t port_irq_sts;
+#if PORT_SIM_VIRTUAL_TIME == TRUE
+extern uint64_t port_sim_time;
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -304,6 +357,11 @@ extern "C" {
   /*lint -restore*/
   rtcnt_t port_rt_get_counter_value(void);
   void _sim_check_for_interrupts(void);
+  void _sim_wait_for_interrupts(void);
+#if PORT_SUPPORTS_PROFILER == TRUE
+  uint32_t port_prof_start(uint32_t frequency);
+  void port_prof_stop(void);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -372,6 +430,7 @@ static inline bool port_is_isr_context(void) {
 static inline void port_lock(void) {
 
   port_irq_sts = (syssts_t)1;
+  port_sim_advance(PORT_SIM_LOCK_COST);
 }
 
 /**
@@ -391,6 +450,7 @@ static inline void port_unlock(void) {
 static inline void port_lock_from_isr(void) {
 
   port_irq_sts = (syssts_t)1;
+  port_sim_advance(PORT_SIM_LOCK_COST);
 }
 
 /**
@@ -433,11 +493,11 @@ static inline void port_enable(void) {
  *          The simplest implementation is an empty function or macro but this
  *          would not take advantage of architecture-specific power saving
  *          modes.
- * @note    Implemented as an inlined @p WFI instruction.
+ * @note    The simulator sleeps until an interrupt source is ready.
  */
 static inline void port_wait_for_interrupt(void) {
 
-  _sim_check_for_interrupts();
+  _sim_wait_for_interrupts();
 }
 
 #endif /* !defined(_FROM_ASM_) */
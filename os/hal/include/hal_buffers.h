@@ -81,6 +81,12 @@ struct io_buffers_queue {
    * @brief   Queue suspended state flag.
    */
   bool                  suspended;
+  /**
+   * @brief   Current buffer borrowed by the application flag.
+   * @note    A borrowed buffer is accessed outside the critical zone so
+   *          it cannot be flushed.
+   */
+  bool                  borrowed;
   /**
    * @brief   Active buffers counter.
    */
@@ -121,6 +127,25 @@ struct io_buffers_queue {
    * @brief   Boundary for R/W sequential access.
    */
   uint8_t               *top;
+  /**
+   * @brief   Coalescing threshold for partially filled buffers.
+   * @details Partially filled output buffers are not posted by
+   *          @p obqTryFlushI() until they contain at least this number
+   *          of bytes or until the coalescing latency expired.
+   * @note    Zero disables coalescing, this field is not used by input
+   *          queues.
+   */
+  size_t                cthreshold;
+  /**
+   * @brief   Coalescing maximum latency.
+   * @note    This field is not used by input queues.
+   */
+  sysinterval_t         clatency;
+  /**
+   * @brief   System time of the current buffer acquisition.
+   * @note    This field is not used by input queues.
+   */
+  systime_t             ctime;
   /**
    * @brief   Data notification callback.
    */
@@ -318,6 +343,9 @@ extern "C" {
   msg_t ibqGetTimeout(input_buffers_queue_t *ibqp, sysinterval_t timeout);
   size_t ibqReadTimeout(input_buffers_queue_t *ibqp, uint8_t *bp,
                         size_t n, sysinterval_t timeout);
+  msg_t ibqBorrowBufferTimeout(input_buffers_queue_t *ibqp, uint8_t **bpp,
+                               size_t *np, sysinterval_t timeout);
+  void ibqReturnBuffer(input_buffers_queue_t *ibqp, size_t n);
   void obqObjectInit(output_buffers_queue_t *obqp, bool suspended, uint8_t *bp,
                      size_t size, size_t n, bqnotify_t onfy, void *link);
   void obqResetI(output_buffers_queue_t *obqp);
@@ -334,8 +362,13 @@ extern "C" {
                       sysinterval_t timeout);
   size_t obqWriteTimeout(output_buffers_queue_t *obqp, const uint8_t *bp,
                          size_t n, sysinterval_t timeout);
+  msg_t obqBorrowBufferTimeout(output_buffers_queue_t *obqp, uint8_t **bpp,
+                               size_t *np, sysinterval_t timeout);
+  void obqReturnBuffer(output_buffers_queue_t *obqp, size_t n);
   bool obqTryFlushI(output_buffers_queue_t *obqp);
   void obqFlush(output_buffers_queue_t *obqp);
+  void obqSetCoalescing(output_buffers_queue_t *obqp, size_t threshold,
+                        sysinterval_t latency);
 #ifdef __cplusplus
 }
 #endif
@@ -111,6 +111,19 @@ typedef struct {
    *          present, USB descriptors must be changed accordingly.
    */
   usbep_t                   int_in;
+  /**
+   * @brief   Output coalescing threshold.
+   * @details Partially filled output buffers are not transmitted on SOF
+   *          until they contain at least this number of bytes or until
+   *          @p flush_latency expired.
+   * @note    If set to zero then coalescing is disabled and partial
+   *          buffers are transmitted on the first available SOF.
+   */
+  size_t                    flush_threshold;
+  /**
+   * @brief   Output coalescing maximum latency.
+   */
+  sysinterval_t             flush_latency;
 } SerialUSBConfig;
 
 /**
@@ -166,6 +179,85 @@ struct SerialUSBDriver {
 /* Driver macros.                                                            */
 /*===========================================================================*/
 
+/**
+ * @name    Zero-copy API
+ * @{
+ */
+/**
+ * @brief   Borrows the data of the current receive packet buffer.
+ * @details The received data can be accessed in place, without copies,
+ *          until it is returned using @p sduReturnReceiveBuffer().
+ * @note    This function bypasses the channel interface, it must not be
+ *          mixed with channel reads while a buffer is borrowed.
+ *
+ * @param[in] sdup      pointer to a @p SerialUSBDriver object
+ * @param[out] bpp      pointer to a variable receiving the data pointer
+ * @param[out] np       pointer to a variable receiving the data size
+ * @param[in] t         the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a buffer has been borrowed.
+ * @retval MSG_TIMEOUT  if the specified time expired.
+ * @retval MSG_RESET    if the driver has been stopped or suspended.
+ *
+ * @api
+ */
+#define sduBorrowReceiveBufferTimeout(sdup, bpp, np, t)                     \
+  ibqBorrowBufferTimeout(&(sdup)->ibqueue, bpp, np, t)
+
+/**
+ * @brief   Returns a borrowed receive packet buffer.
+ *
+ * @param[in] sdup      pointer to a @p SerialUSBDriver object
+ * @param[in] n         number of consumed bytes
+ *
+ * @api
+ */
+#define sduReturnReceiveBuffer(sdup, n)                                     \
+  ibqReturnBuffer(&(sdup)->ibqueue, n)
+
+/**
+ * @brief   Borrows the free space of the current transmit packet buffer.
+ * @details The space can be filled in place, without copies, then the
+ *          written data is committed using @p sduReturnTransmitBuffer().
+ * @note    This function bypasses the channel interface, it must not be
+ *          mixed with channel writes while a buffer is borrowed.
+ *
+ * @param[in] sdup      pointer to a @p SerialUSBDriver object
+ * @param[out] bpp      pointer to a variable receiving the space pointer
+ * @param[out] np       pointer to a variable receiving the space size
+ * @param[in] t         the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a buffer has been borrowed.
+ * @retval MSG_TIMEOUT  if the specified time expired.
+ * @retval MSG_RESET    if the driver has been stopped or suspended.
+ *
+ * @api
+ */
+#define sduBorrowTransmitBufferTimeout(sdup, bpp, np, t)                    \
+  obqBorrowBufferTimeout(&(sdup)->obqueue, bpp, np, t)
+
+/**
+ * @brief   Returns a borrowed transmit packet buffer.
+ * @details A completely filled buffer is transmitted immediately, partially
+ *          filled buffers are transmitted on SOF or by an explicit flush.
+ *
+ * @param[in] sdup      pointer to a @p SerialUSBDriver object
+ * @param[in] n         number of written bytes
+ *
+ * @api
+ */
+#define sduReturnTransmitBuffer(sdup, n)                                    \
+  obqReturnBuffer(&(sdup)->obqueue, n)
+/** @} */
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
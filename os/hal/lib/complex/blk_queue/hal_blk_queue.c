@@ -0,0 +1,633 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_blk_queue.c
+ * @brief   Block device requests queue code.
+ * @details This module queues asynchronous read and write requests toward
+ *          a @p BaseBlockDevice. Pending requests are served by a
+ *          dispatcher thread in ascending blocks order and adjacent
+ *          requests are merged in multi-block transfers.
+ *
+ * @addtogroup HAL_BLK_QUEUE
+ * @{
+ */
+
+#include <string.h>
+
+#include "hal.h"
+#include "hal_blk_queue.h"
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Set of requests served by a single device transfer.
+ */
+typedef struct {
+  /**
+   * @brief   First request in blocks order.
+   */
+  brq_request_t             *first;
+  /**
+   * @brief   Last request in blocks order.
+   */
+  brq_request_t             *last;
+  /**
+   * @brief   First block of the transfer.
+   */
+  uint32_t                  startblk;
+  /**
+   * @brief   Number of blocks of the transfer.
+   */
+  uint32_t                  n;
+  /**
+   * @brief   Transfer performed through the merge buffer.
+   */
+  bool                      copy;
+} brq_batch_t;
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Checks if two requests must be served in arrival order.
+ *
+ * @param[in] r1p       pointer to the first request
+ * @param[in] r2p       pointer to the second request
+ * @return              The ordering constraint.
+ * @retval false        if the requests can be reordered.
+ * @retval true         if the requests overlap and at least one of them is
+ *                      a write.
+ *
+ * @notapi
+ */
+static bool brq_conflicts(const brq_request_t *r1p, const brq_request_t *r2p) {
+
+  if ((r1p->op == BRQ_OP_READ) && (r2p->op == BRQ_OP_READ)) {
+    return false;
+  }
+
+  return (r1p->startblk < r2p->startblk + r2p->n) &&
+         (r2p->startblk < r1p->startblk + r1p->n);
+}
+
+/**
+ * @brief   Checks if a pending request can be served ahead of older ones.
+ *
+ * @param[in] brqp      pointer to the @p BRQDriver object
+ * @param[in] reqp      pointer to the pending request
+ * @return              The request eligibility.
+ *
+ * @notapi
+ */
+static bool brq_is_eligible(BRQDriver *brqp, const brq_request_t *reqp) {
+  const brq_request_t *p;
+
+  for (p = brqp->head; p != reqp; p = p->next) {
+    if (brq_conflicts(p, reqp)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief   Removes a request from the pending list.
+ *
+ * @param[in] brqp      pointer to the @p BRQDriver object
+ * @param[in] reqp      pointer to the pending request
+ *
+ * @notapi
+ */
+static void brq_unlink(BRQDriver *brqp, brq_request_t *reqp) {
+  brq_request_t *prevp = NULL, *p = brqp->head;
+
+  while (p != reqp) {
+    prevp = p;
+    p = p->next;
+  }
+
+  if (prevp == NULL) {
+    brqp->head = reqp->next;
+  }
+  else {
+    prevp->next = reqp->next;
+  }
+  if (brqp->tail == reqp) {
+    brqp->tail = prevp;
+  }
+  reqp->next = NULL;
+  reqp->state = BRQ_REQ_ACTIVE;
+}
+
+/**
+ * @brief   Selects the next request to be served.
+ * @details The oldest request is selected if it exceeded its deadline else
+ *          the eligible request with the lowest start block after the
+ *          current position, wrapping around to the lowest start block
+ *          when there are none.
+ *
+ * @param[in] brqp      pointer to the @p BRQDriver object
+ * @return              The selected request.
+ *
+ * @notapi
+ */
+static brq_request_t *brq_select(BRQDriver *brqp) {
+  brq_request_t *p, *nextp = NULL, *lowestp = NULL;
+
+  /* The oldest request is always eligible.*/
+  p = brqp->head;
+  if (osalTimeDiffX(p->time, osalOsGetSystemTimeX()) >=
+      brqp->config->deadline) {
+    return p;
+  }
+
+  while (p != NULL) {
+    if (brq_is_eligible(brqp, p)) {
+      if ((p->startblk >= brqp->position) &&
+          ((nextp == NULL) || (p->startblk < nextp->startblk))) {
+        nextp = p;
+      }
+      if ((lowestp == NULL) || (p->startblk < lowestp->startblk)) {
+        lowestp = p;
+      }
+    }
+    p = p->next;
+  }
+
+  return nextp != NULL ? nextp : lowestp;
+}
+
+/**
+ * @brief   Merges adjacent pending requests into a batch.
+ *
+ * @param[in] brqp      pointer to the @p BRQDriver object
+ * @param[in,out] bp    pointer to the batch
+ *
+ * @notapi
+ */
+static void brq_merge(BRQDriver *brqp, brq_batch_t *bp) {
+  const BRQConfig *config = brqp->config;
+  brq_request_t *p;
+  uint32_t n;
+  bool copy, merged;
+
+  if (config->max_blocks == 0U) {
+    return;
+  }
+
+  do {
+    merged = false;
+    for (p = brqp->head; p != NULL; p = p->next) {
+      if ((p->op != bp->first->op) || !brq_is_eligible(brqp, p)) {
+        continue;
+      }
+
+      n = bp->n + p->n;
+      if (n > config->max_blocks) {
+        continue;
+      }
+
+      /* Zero-copy is possible only if the buffers are contiguous too.*/
+      copy = bp->copy;
+      if (p->startblk == bp->startblk + bp->n) {
+        copy = copy || (p->buffer != bp->last->buffer +
+                                     (bp->last->n * config->blk_size));
+      }
+      else if (p->startblk + p->n == bp->startblk) {
+        copy = copy || (p->buffer + (p->n * config->blk_size) !=
+                        bp->first->buffer);
+      }
+      else {
+        continue;
+      }
+      if (copy && ((config->buffer == NULL) || (n > config->buffer_blocks))) {
+        continue;
+      }
+
+      brq_unlink(brqp, p);
+      if (p->startblk > bp->startblk) {
+        bp->last->next = p;
+        bp->last = p;
+      }
+      else {
+        p->next = bp->first;
+        bp->first = p;
+        bp->startblk = p->startblk;
+      }
+      bp->n = n;
+      bp->copy = copy;
+      merged = true;
+      break;
+    }
+  } while (merged);
+}
+
+/**
+ * @brief   Performs the device transfer of a batch.
+ *
+ * @param[in] brqp      pointer to the @p BRQDriver object
+ * @param[in] bp        pointer to the batch
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @notapi
+ */
+static bool brq_transfer(BRQDriver *brqp, const brq_batch_t *bp) {
+  const BRQConfig *config = brqp->config;
+  brq_request_t *p;
+  uint8_t *buf;
+  bool err;
+
+  if (!bp->copy) {
+    if (bp->first->op == BRQ_OP_READ) {
+      return blkRead(config->blkp, bp->startblk, bp->first->buffer, bp->n);
+    }
+    return blkWrite(config->blkp, bp->startblk, bp->first->buffer, bp->n);
+  }
+
+  if (bp->first->op == BRQ_OP_READ) {
+    err = blkRead(config->blkp, bp->startblk, config->buffer, bp->n);
+    if (!err) {
+      buf = config->buffer;
+      for (p = bp->first; p != NULL; p = p->next) {
+        memcpy(p->buffer, buf, p->n * config->blk_size);
+        buf += p->n * config->blk_size;
+      }
+    }
+    return err;
+  }
+
+  buf = config->buffer;
+  for (p = bp->first; p != NULL; p = p->next) {
+    memcpy(buf, p->buffer, p->n * config->blk_size);
+    buf += p->n * config->blk_size;
+  }
+  return blkWrite(config->blkp, bp->startblk, config->buffer, bp->n);
+}
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] brqp     pointer to the @p BRQDriver object
+ *
+ * @init
+ */
+void brqObjectInit(BRQDriver *brqp) {
+
+  osalDbgCheck(brqp != NULL);
+
+  brqp->state      = BRQ_STOP;
+  brqp->config     = NULL;
+  brqp->head       = NULL;
+  brqp->tail       = NULL;
+  brqp->dispatcher = NULL;
+  osalEventObjectInit(&brqp->event);
+}
+
+/**
+ * @brief   Configures and activates a block requests queue.
+ *
+ * @param[in] brqp      pointer to the @p BRQDriver object
+ * @param[in] config    pointer to the configuration
+ *
+ * @api
+ */
+void brqStart(BRQDriver *brqp, const BRQConfig *config) {
+
+  osalDbgCheck((brqp != NULL) && (config != NULL) &&
+               (config->blkp != NULL) && (config->blk_size > 0U));
+  osalDbgAssert((brqp->state == BRQ_STOP) || (brqp->state == BRQ_READY),
+                "invalid state");
+
+  osalSysLock();
+  osalDbgAssert(brqp->head == NULL, "requests pending");
+  brqp->config     = config;
+  brqp->position   = 0U;
+  brqp->nrequests  = 0U;
+  brqp->ntransfers = 0U;
+  brqp->state      = BRQ_READY;
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Deactivates a block requests queue.
+ * @details Pending requests are completed with @p MSG_RESET without
+ *          invoking their callbacks, a transfer already in progress is
+ *          completed normally.
+ *
+ * @param[in] brqp      pointer to the @p BRQDriver object
+ *
+ * @api
+ */
+void brqStop(BRQDriver *brqp) {
+  brq_request_t *p;
+
+  osalDbgCheck(brqp != NULL);
+  osalDbgAssert((brqp->state == BRQ_STOP) || (brqp->state == BRQ_READY),
+                "invalid state");
+
+  osalSysLock();
+  while (brqp->head != NULL) {
+    p = brqp->head;
+    brqp->head = p->next;
+    p->next   = NULL;
+    p->state  = BRQ_REQ_IDLE;
+    p->result = MSG_RESET;
+    osalThreadResumeI(&p->thread, MSG_RESET);
+  }
+  brqp->tail  = NULL;
+  brqp->state = BRQ_STOP;
+  osalThreadResumeI(&brqp->dispatcher, MSG_RESET);
+  osalOsRescheduleS();
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Initializes a request object.
+ *
+ * @param[out] reqp     pointer to the @p brq_request_t object
+ * @param[in] op        requested operation
+ * @param[in] startblk  first block to be transferred
+ * @param[in] buffer    pointer to the data buffer
+ * @param[in] n         number of blocks to be transferred
+ * @param[in] callback  completion callback or @p NULL
+ * @param[in] arg       callback argument
+ *
+ * @init
+ */
+void brqRequestObjectInit(brq_request_t *reqp, brqop_t op,
+                          uint32_t startblk, uint8_t *buffer, uint32_t n,
+                          brqcallback_t callback, void *arg) {
+
+  osalDbgCheck((reqp != NULL) && (buffer != NULL) && (n > 0U));
+
+  reqp->next     = NULL;
+  reqp->state    = BRQ_REQ_IDLE;
+  reqp->op       = op;
+  reqp->startblk = startblk;
+  reqp->n        = n;
+  reqp->buffer   = buffer;
+  reqp->callback = callback;
+  reqp->arg      = arg;
+  reqp->result   = MSG_OK;
+  reqp->thread   = NULL;
+}
+
+/**
+ * @brief   Queues a request.
+ *
+ * @param[in] brqp      pointer to the @p BRQDriver object
+ * @param[in] reqp      pointer to the request, it must not be already
+ *                      queued
+ *
+ * @iclass
+ */
+void brqSubmitI(BRQDriver *brqp, brq_request_t *reqp) {
+
+  osalDbgCheckClassI();
+  osalDbgCheck((brqp != NULL) && (reqp != NULL));
+  osalDbgAssert(brqp->state == BRQ_READY, "invalid state");
+  osalDbgAssert(reqp->state == BRQ_REQ_IDLE, "already queued");
+
+  reqp->next  = NULL;
+  reqp->state = BRQ_REQ_PENDING;
+  reqp->time  = osalOsGetSystemTimeX();
+  if (brqp->tail == NULL) {
+    brqp->head = reqp;
+  }
+  else {
+    brqp->tail->next = reqp;
+  }
+  brqp->tail = reqp;
+
+  osalThreadResumeI(&brqp->dispatcher, MSG_OK);
+}
+
+/**
+ * @brief   Queues a request.
+ *
+ * @param[in] brqp      pointer to the @p BRQDriver object
+ * @param[in] reqp      pointer to the request, it must not be already
+ *                      queued
+ *
+ * @api
+ */
+void brqSubmit(BRQDriver *brqp, brq_request_t *reqp) {
+
+  osalSysLock();
+  brqSubmitI(brqp, reqp);
+  osalOsRescheduleS();
+  osalSysUnlock();
+}
+
+/**
+ * @brief   Waits for a request completion.
+ * @note    Only one thread can wait on a request.
+ *
+ * @param[in] brqp      pointer to the @p BRQDriver object
+ * @param[in] reqp      pointer to the request
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the transfer succeeded.
+ * @retval MSG_RESET    if the transfer failed or the driver has been
+ *                      stopped.
+ * @retval MSG_TIMEOUT  if the request did not complete within the
+ *                      specified time.
+ *
+ * @api
+ */
+msg_t brqWaitTimeout(BRQDriver *brqp, brq_request_t *reqp,
+                     sysinterval_t timeout) {
+  msg_t msg;
+
+  osalDbgCheck((brqp != NULL) && (reqp != NULL));
+
+  osalSysLock();
+  if (reqp->state != BRQ_REQ_IDLE) {
+    msg = osalThreadSuspendTimeoutS(&reqp->thread, timeout);
+  }
+  else {
+    msg = reqp->result;
+  }
+  osalSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Reads one or more blocks through the queue.
+ * @note    The function waits for the request completion.
+ *
+ * @param[in] brqp      pointer to the @p BRQDriver object
+ * @param[in] startblk  first block to read
+ * @param[out] buffer   pointer to the read buffer
+ * @param[in] n         number of blocks to read
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool brqRead(BRQDriver *brqp, uint32_t startblk,
+             uint8_t *buffer, uint32_t n) {
+  brq_request_t req;
+
+  brqRequestObjectInit(&req, BRQ_OP_READ, startblk, buffer, n, NULL, NULL);
+  brqSubmit(brqp, &req);
+
+  return brqWaitTimeout(brqp, &req, TIME_INFINITE) == MSG_OK ?
+         HAL_SUCCESS : HAL_FAILED;
+}
+
+/**
+ * @brief   Writes one or more blocks through the queue.
+ * @note    The function waits for the request completion.
+ *
+ * @param[in] brqp      pointer to the @p BRQDriver object
+ * @param[in] startblk  first block to write
+ * @param[in] buffer    pointer to the write buffer
+ * @param[in] n         number of blocks to write
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool brqWrite(BRQDriver *brqp, uint32_t startblk,
+              const uint8_t *buffer, uint32_t n) {
+  brq_request_t req;
+
+  brqRequestObjectInit(&req, BRQ_OP_WRITE, startblk, (uint8_t *)buffer, n,
+                       NULL, NULL);
+  brqSubmit(brqp, &req);
+
+  return brqWaitTimeout(brqp, &req, TIME_INFINITE) == MSG_OK ?
+         HAL_SUCCESS : HAL_FAILED;
+}
+
+/**
+ * @brief   Serves pending requests with a single device transfer.
+ * @details The function waits for pending requests, selects the next
+ *          request to be served, merges adjacent requests with it and
+ *          performs the transfer. Completed requests callbacks are invoked
+ *          then waiting threads are resumed.
+ * @note    This function is meant to be called in a loop by a single
+ *          dispatcher thread, requests submitted by higher priority
+ *          threads are more likely to be merged.
+ *
+ * @param[in] brqp      pointer to the @p BRQDriver object
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a transfer has been performed.
+ * @retval MSG_RESET    if the driver is stopped or has been stopped while
+ *                      waiting.
+ * @retval MSG_TIMEOUT  if no request has been submitted within the
+ *                      specified time.
+ *
+ * @api
+ */
+msg_t brqDispatchTimeout(BRQDriver *brqp, sysinterval_t timeout) {
+  brq_batch_t batch;
+  brq_request_t *p, *nextp;
+  uint32_t nrequests;
+  bool err;
+  msg_t msg;
+
+  osalDbgCheck(brqp != NULL);
+
+  osalSysLock();
+  if (brqp->state != BRQ_READY) {
+    osalSysUnlock();
+    return MSG_RESET;
+  }
+  if (brqp->head == NULL) {
+    msg = osalThreadSuspendTimeoutS(&brqp->dispatcher, timeout);
+    if (msg != MSG_OK) {
+      osalSysUnlock();
+      return msg;
+    }
+  }
+
+  p = brq_select(brqp);
+  brq_unlink(brqp, p);
+  batch.first    = p;
+  batch.last     = p;
+  batch.startblk = p->startblk;
+  batch.n        = p->n;
+  batch.copy     = false;
+  brq_merge(brqp, &batch);
+  osalSysUnlock();
+
+  err = brq_transfer(brqp, &batch);
+  msg = err ? MSG_RESET : MSG_OK;
+  brqp->position = batch.startblk + batch.n;
+
+  /* Completing the served requests.*/
+  nrequests = 0U;
+  p = batch.first;
+  while (p != NULL) {
+    nextp = p->next;
+    p->next   = NULL;
+    p->result = msg;
+    if (p->callback != NULL) {
+      p->callback(brqp, p);
+    }
+    osalSysLock();
+    p->state = BRQ_REQ_IDLE;
+    osalThreadResumeI(&p->thread, msg);
+    osalSysUnlock();
+    nrequests++;
+    p = nextp;
+  }
+
+  osalSysLock();
+  brqp->nrequests += nrequests;
+  brqp->ntransfers++;
+  osalEventBroadcastFlagsI(&brqp->event, err ? BRQ_TRANSFER_ERROR :
+                                               BRQ_TRANSFER_COMPLETE);
+  osalOsRescheduleS();
+  osalSysUnlock();
+
+  return MSG_OK;
+}
+
+/** @} */
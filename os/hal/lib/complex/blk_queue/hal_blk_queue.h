@@ -0,0 +1,296 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    hal_blk_queue.h
+ * @brief   Block device requests queue header.
+ *
+ * @addtogroup HAL_BLK_QUEUE
+ * @{
+ */
+
+#ifndef HAL_BLK_QUEUE_H
+#define HAL_BLK_QUEUE_H
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @name    Event flags
+ * @{
+ */
+#define BRQ_TRANSFER_COMPLETE               (eventflags_t)1
+#define BRQ_TRANSFER_ERROR                  (eventflags_t)2
+/** @} */
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Driver state machine possible states.
+ */
+typedef enum {
+  BRQ_UNINIT = 0,                   /**< Not initialized.                   */
+  BRQ_STOP = 1,                     /**< Stopped.                           */
+  BRQ_READY = 2                     /**< Ready.                             */
+} brqstate_t;
+
+/**
+ * @brief   Type of a request operation.
+ */
+typedef enum {
+  BRQ_OP_READ = 0,                  /**< Blocks read.                       */
+  BRQ_OP_WRITE = 1                  /**< Blocks write.                      */
+} brqop_t;
+
+/**
+ * @brief   Type of a request state.
+ */
+typedef enum {
+  BRQ_REQ_IDLE = 0,                 /**< Not queued or completed.           */
+  BRQ_REQ_PENDING = 1,              /**< Queued, waiting for dispatch.      */
+  BRQ_REQ_ACTIVE = 2                /**< Transfer in progress.              */
+} brqreqstate_t;
+
+/**
+ * @brief   Type of a structure representing a block requests queue driver.
+ */
+typedef struct BRQDriver BRQDriver;
+
+/**
+ * @brief   Type of a block request.
+ */
+typedef struct brq_request brq_request_t;
+
+/**
+ * @brief   Request completion callback type.
+ *
+ * @param[in] brqp      pointer to the @p BRQDriver object
+ * @param[in] reqp      pointer to the completed request
+ */
+typedef void (*brqcallback_t)(BRQDriver *brqp, brq_request_t *reqp);
+
+/**
+ * @brief   Structure representing a block request.
+ * @note    Request objects are owned by the caller and must not be
+ *          modified or reused while queued.
+ */
+struct brq_request {
+  /**
+   * @brief   Next request in the pending list.
+   */
+  brq_request_t             *next;
+  /**
+   * @brief   Request state.
+   */
+  brqreqstate_t             state;
+  /**
+   * @brief   Requested operation.
+   */
+  brqop_t                   op;
+  /**
+   * @brief   First block of the transfer.
+   */
+  uint32_t                  startblk;
+  /**
+   * @brief   Number of blocks to be transferred.
+   */
+  uint32_t                  n;
+  /**
+   * @brief   Data buffer.
+   */
+  uint8_t                   *buffer;
+  /**
+   * @brief   Completion callback or @p NULL.
+   * @note    The callback is invoked from the dispatcher thread context.
+   */
+  brqcallback_t             callback;
+  /**
+   * @brief   Callback argument, not used by the driver.
+   */
+  void                      *arg;
+  /**
+   * @brief   Submission time.
+   */
+  systime_t                 time;
+  /**
+   * @brief   Transfer result.
+   * @note    @p MSG_OK if the transfer succeeded, @p MSG_RESET if the
+   *          transfer failed or the driver has been stopped.
+   */
+  msg_t                     result;
+  /**
+   * @brief   Thread waiting for completion.
+   */
+  thread_reference_t        thread;
+};
+
+/**
+ * @brief   Driver configuration structure.
+ */
+typedef struct {
+  /**
+   * @brief   Underlying block device.
+   * @note    The device is supposed to be already connected.
+   */
+  BaseBlockDevice           *blkp;
+  /**
+   * @brief   Block size of the underlying device.
+   */
+  uint32_t                  blk_size;
+  /**
+   * @brief   Maximum number of blocks in a merged transfer.
+   * @note    Zero disables merging, requests are transferred one by one.
+   */
+  uint32_t                  max_blocks;
+  /**
+   * @brief   Maximum age of a pending request.
+   * @details Requests are served in ascending blocks order starting from
+   *          the position of the previous transfer (C-LOOK), a request
+   *          waiting for longer than this interval is served first.
+   * @note    Zero makes the queue serve requests in arrival order.
+   */
+  sysinterval_t             deadline;
+  /**
+   * @brief   Merge buffer or @p NULL.
+   * @details The buffer allows to merge adjacent requests whose buffers
+   *          are not contiguous in memory, without it only requests with
+   *          contiguous buffers can be merged.
+   */
+  uint8_t                   *buffer;
+  /**
+   * @brief   Merge buffer size in blocks.
+   */
+  uint32_t                  buffer_blocks;
+} BRQConfig;
+
+/**
+ * @brief   Structure representing a block requests queue driver.
+ */
+struct BRQDriver {
+  /**
+   * @brief   Driver state.
+   */
+  brqstate_t                state;
+  /**
+   * @brief   Current configuration data.
+   */
+  const BRQConfig           *config;
+  /**
+   * @brief   Pending requests in arrival order.
+   */
+  brq_request_t             *head;
+  /**
+   * @brief   Last pending request.
+   */
+  brq_request_t             *tail;
+  /**
+   * @brief   Block following the last transferred one.
+   */
+  uint32_t                  position;
+  /**
+   * @brief   Dispatcher thread waiting for requests.
+   */
+  thread_reference_t        dispatcher;
+  /**
+   * @brief   Completion events source.
+   */
+  event_source_t            event;
+  /**
+   * @brief   Number of completed requests.
+   */
+  uint32_t                  nrequests;
+  /**
+   * @brief   Number of transfers performed on the block device.
+   */
+  uint32_t                  ntransfers;
+};
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the completion events source.
+ *
+ * @param[in] brqp      pointer to the @p BRQDriver object
+ * @return              A pointer to the @p event_source_t object.
+ *
+ * @xclass
+ */
+#define brqGetEventSourceX(brqp) (&(brqp)->event)
+
+/**
+ * @brief   Returns the number of completed requests.
+ *
+ * @param[in] brqp      pointer to the @p BRQDriver object
+ * @return              The number of requests.
+ *
+ * @xclass
+ */
+#define brqGetRequestsX(brqp) ((brqp)->nrequests)
+
+/**
+ * @brief   Returns the number of transfers performed on the device.
+ * @note    The difference from @p brqGetRequestsX() is the number of
+ *          transfers saved by merging.
+ *
+ * @param[in] brqp      pointer to the @p BRQDriver object
+ * @return              The number of transfers.
+ *
+ * @xclass
+ */
+#define brqGetTransfersX(brqp) ((brqp)->ntransfers)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void brqObjectInit(BRQDriver *brqp);
+  void brqStart(BRQDriver *brqp, const BRQConfig *config);
+  void brqStop(BRQDriver *brqp);
+  void brqRequestObjectInit(brq_request_t *reqp, brqop_t op,
+                            uint32_t startblk, uint8_t *buffer, uint32_t n,
+                            brqcallback_t callback, void *arg);
+  void brqSubmitI(BRQDriver *brqp, brq_request_t *reqp);
+  void brqSubmit(BRQDriver *brqp, brq_request_t *reqp);
+  msg_t brqWaitTimeout(BRQDriver *brqp, brq_request_t *reqp,
+                       sysinterval_t timeout);
+  bool brqRead(BRQDriver *brqp, uint32_t startblk,
+               uint8_t *buffer, uint32_t n);
+  bool brqWrite(BRQDriver *brqp, uint32_t startblk,
+                const uint8_t *buffer, uint32_t n);
+  msg_t brqDispatchTimeout(BRQDriver *brqp, sysinterval_t timeout);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HAL_BLK_QUEUE_H */
+
+/** @} */
@@ -0,0 +1,9 @@
+# List of all the block requests queue files.
+BRQSRC := $(CHIBIOS)/os/hal/lib/complex/blk_queue/hal_blk_queue.c
+
+# Required include directories
+BRQINC := $(CHIBIOS)/os/hal/lib/complex/blk_queue
+
+# Shared variables
+ALLCSRC += $(BRQSRC)
+ALLINC  += $(BRQINC)
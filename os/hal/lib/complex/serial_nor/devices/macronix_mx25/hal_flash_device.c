@@ -663,4 +663,51 @@ flash_error_t snor_device_read_sfdp(SNORDriver *devp, flash_offset_t offset,
   return FLASH_NO_ERROR;
 }
 
+/**
+ * @brief   Suspends an erase operation in progress.
+ * @note    The function returns when the device is able to accept read
+ *          commands, the erase could also have been completed.
+ *
+ * @param[in] devp      pointer to a @p SNORDriver instance
+ */
+flash_error_t snor_device_suspend_erase(SNORDriver *devp) {
+  uint8_t sts[2];
+
+  /* Program/erase suspend command.*/
+#if MX25_BUS_MODE == MX25_BUS_MODE_SPI
+  bus_cmd(devp->config->busp, MX25_CMD_SPI_PE_SUSPEND);
+#else
+  bus_cmd(devp->config->busp, MX25_CMD_OPI_PE_SUSPEND);
+#endif
+
+  /* Waiting for the WIP bit to be cleared.*/
+  do {
+#if MX25_BUS_MODE == MX25_BUS_MODE_SPI
+    bus_cmd_receive(devp->config->busp, MX25_CMD_SPI_RDSR, 1U, sts);
+#else
+    bus_cmd_addr_dummy_receive(devp->config->busp, MX25_CMD_OPI_RDSR,
+                               0U, 4U, 2U, sts);   /*Note: always 4 dummies.*/
+#endif
+  } while ((sts[0] & 1U) != 0U);
+
+  return FLASH_NO_ERROR;
+}
+
+/**
+ * @brief   Resumes a suspended erase operation.
+ * @note    The command is ignored by the device if nothing is suspended.
+ *
+ * @param[in] devp      pointer to a @p SNORDriver instance
+ */
+flash_error_t snor_device_resume_erase(SNORDriver *devp) {
+
+#if MX25_BUS_MODE == MX25_BUS_MODE_SPI
+  bus_cmd(devp->config->busp, MX25_CMD_SPI_PE_RESUME);
+#else
+  bus_cmd(devp->config->busp, MX25_CMD_OPI_PE_RESUME);
+#endif
+
+  return FLASH_NO_ERROR;
+}
+
 /** @} */
@@ -531,6 +531,30 @@ flash_error_t snor_device_read_sfdp(SNORDriver *devp, flash_offset_t offset,
   return FLASH_NO_ERROR;
 }
 
+flash_error_t snor_device_suspend_erase(SNORDriver *devp) {
+  uint8_t sts;
+
+  /* Program/erase suspend command.*/
+  bus_cmd(devp->config->busp, N25Q_CMD_PROGRAM_ERASE_SUSPEND);
+
+  /* Waiting for the P/E controller to become ready, the erase is either
+     suspended or already completed.*/
+  do {
+    bus_cmd_receive(devp->config->busp, N25Q_CMD_READ_FLAG_STATUS_REGISTER,
+                    1, &sts);
+  } while ((sts & N25Q_FLAGS_PROGRAM_ERASE) == 0U);
+
+  return FLASH_NO_ERROR;
+}
+
+flash_error_t snor_device_resume_erase(SNORDriver *devp) {
+
+  /* Program/erase resume command, ignored if nothing is suspended.*/
+  bus_cmd(devp->config->busp, N25Q_CMD_PROGRAM_ERASE_RESUME);
+
+  return FLASH_NO_ERROR;
+}
+
 #if (SNOR_BUS_DRIVER == SNOR_BUS_DRIVER_WSPI) || defined(__DOXYGEN__)
 void snor_activate_xip(SNORDriver *devp) {
   static const uint8_t flash_status_xip[1] = {
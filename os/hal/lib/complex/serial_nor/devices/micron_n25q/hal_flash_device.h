@@ -34,6 +34,7 @@
  * @{
  */
 #define SNOR_DEVICE_SUPPORTS_XIP            TRUE
+#define SNOR_DEVICE_SUPPORTS_ERASE_SUSPEND  TRUE
 /** @} */
 
 /**
@@ -322,6 +323,8 @@ extern "C" {
   flash_error_t snor_device_query_erase(SNORDriver *devp, uint32_t *msec);
   flash_error_t snor_device_read_sfdp(SNORDriver *devp, flash_offset_t offset,
                                       size_t n, uint8_t *rp);
+  flash_error_t snor_device_suspend_erase(SNORDriver *devp);
+  flash_error_t snor_device_resume_erase(SNORDriver *devp);
 #if (SNOR_BUS_DRIVER == SNOR_BUS_DRIVER_WSPI) &&                            \
     (SNOR_DEVICE_SUPPORTS_XIP == TRUE)
   void snor_activate_xip(SNORDriver *devp);
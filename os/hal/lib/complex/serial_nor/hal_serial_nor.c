@@ -22,6 +22,8 @@
  * @{
  */
 
+#include <string.h>
+
 #include "hal.h"
 #include "hal_serial_nor.h"
 
@@ -29,6 +31,16 @@
 /* Driver local definitions.                                                 */
 /*===========================================================================*/
 
+#if (SNOR_BUS_DRIVER == SNOR_BUS_DRIVER_WSPI) || defined(__DOXYGEN__)
+#if (WSPI_SUPPORTS_MEMMAP == TRUE) || defined(__DOXYGEN__)
+#define snor_is_mapped(devp) ((devp)->mapped != NULL)
+#endif
+#endif
+
+#if !defined(snor_is_mapped)
+#define snor_is_mapped(devp) false
+#endif
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -66,6 +78,176 @@ static const struct SNORDriverVMT snor_vmt = {
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+#if (SNOR_USE_CACHE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Invalidates the cache lines overlapping a flash area.
+ *
+ * @param[in] devp      pointer to the @p SNORDriver object
+ * @param[in] offset    flash offset of the area
+ * @param[in] n         size of the area
+ */
+static void snor_cache_invalidate(SNORDriver *devp,
+                                  flash_offset_t offset,
+                                  size_t n) {
+  unsigned i;
+
+  for (i = 0U; i < (unsigned)SNOR_CACHE_LINES; i++) {
+    snor_cache_line_t *lp = &devp->cache.lines[i];
+
+    if ((lp->offset != SNOR_CACHE_INVALID) &&
+        ((size_t)lp->offset < ((size_t)offset + n)) &&
+        (((size_t)lp->offset + (size_t)SNOR_CACHE_LINE_SIZE) >
+         (size_t)offset)) {
+      lp->offset = SNOR_CACHE_INVALID;
+    }
+  }
+}
+
+/**
+ * @brief   Returns the cache line containing a flash offset.
+ * @details If the line is not cached then the least recently used line is
+ *          filled from the device.
+ *
+ * @param[in] devp      pointer to the @p SNORDriver object
+ * @param[in] offset    flash offset aligned to a line boundary
+ * @param[out] lpp      pointer to a variable receiving the line pointer
+ * @return              An error code.
+ */
+static flash_error_t snor_cache_get_line(SNORDriver *devp,
+                                         flash_offset_t offset,
+                                         snor_cache_line_t **lpp) {
+  snor_cache_line_t *lp, *victim;
+  unsigned i;
+
+  /* Searching for the line, the victim for replacement is determined
+     in the same pass, unused lines are preferred.*/
+  victim = &devp->cache.lines[0];
+  for (i = 0U; i < (unsigned)SNOR_CACHE_LINES; i++) {
+    lp = &devp->cache.lines[i];
+
+    if (lp->offset == offset) {
+      devp->cache.hits++;
+      lp->stamp = ++devp->cache.clock;
+      *lpp = lp;
+      return FLASH_NO_ERROR;
+    }
+
+    if ((victim->offset != SNOR_CACHE_INVALID) &&
+        ((lp->offset == SNOR_CACHE_INVALID) ||
+         ((int32_t)(lp->stamp - victim->stamp) < 0))) {
+      victim = lp;
+    }
+  }
+
+  /* Cache miss, filling the victim line.*/
+  devp->cache.misses++;
+  victim->offset = SNOR_CACHE_INVALID;
+  flash_error_t err = snor_device_read(devp, offset,
+                                       (size_t)SNOR_CACHE_LINE_SIZE,
+                                       victim->data);
+  if (err != FLASH_NO_ERROR) {
+    return err;
+  }
+  victim->offset = offset;
+  victim->stamp  = ++devp->cache.clock;
+  *lpp = victim;
+
+  return FLASH_NO_ERROR;
+}
+
+/**
+ * @brief   Reads data through the cache.
+ *
+ * @param[in] devp      pointer to the @p SNORDriver object
+ * @param[in] offset    flash offset
+ * @param[in] n         number of bytes to be read
+ * @param[out] rp       pointer to the data buffer
+ * @return              An error code.
+ */
+static flash_error_t snor_cache_read(SNORDriver *devp, flash_offset_t offset,
+                                     size_t n, uint8_t *rp) {
+
+  while (n > 0U) {
+    snor_cache_line_t *lp;
+    flash_offset_t base;
+    size_t chunk;
+    flash_error_t err;
+
+    /* Line containing the current offset and size of the data to be
+       copied from it.*/
+    base  = offset & ~((flash_offset_t)SNOR_CACHE_LINE_SIZE - 1U);
+    chunk = (size_t)SNOR_CACHE_LINE_SIZE - (size_t)(offset - base);
+    if (chunk > n) {
+      chunk = n;
+    }
+
+    err = snor_cache_get_line(devp, base, &lp);
+    if (err != FLASH_NO_ERROR) {
+      return err;
+    }
+
+    memcpy(rp, &lp->data[offset - base], chunk);
+    offset += (flash_offset_t)chunk;
+    rp     += chunk;
+    n      -= chunk;
+  }
+
+  return FLASH_NO_ERROR;
+}
+#endif /* SNOR_USE_CACHE == TRUE */
+
+#if (SNOR_USE_ERASE_SUSPEND == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Reads data while an erase operation is in progress.
+ * @details The erase is suspended for the duration of the read operation
+ *          then resumed.
+ *
+ * @param[in] devp      pointer to the @p SNORDriver object
+ * @param[in] offset    flash offset
+ * @param[in] n         number of bytes to be read
+ * @param[out] rp       pointer to the data buffer
+ * @return              An error code.
+ */
+static flash_error_t snor_read_suspended(SNORDriver *devp,
+                                         flash_offset_t offset,
+                                         size_t n, uint8_t *rp) {
+  flash_error_t err;
+
+  /* The area being erased cannot be read.*/
+  if (((snor_descriptor.attributes & FLASH_ATTR_SUSPEND_ERASE_CAPABLE) == 0U) ||
+      (((size_t)offset < ((size_t)devp->erase_offset +
+                          (size_t)devp->erase_size)) &&
+       (((size_t)offset + n) > (size_t)devp->erase_offset))) {
+    return FLASH_BUSY_ERASING;
+  }
+
+  /* Bus acquired.*/
+  bus_acquire(devp->config->busp, devp->config->buscfg);
+
+  /* Suspending the erase, the device could also have completed it in the
+     meanwhile, the resume command is ignored in that case.*/
+  err = snor_device_suspend_erase(devp);
+  if (err == FLASH_NO_ERROR) {
+
+    /* Actual read implementation.*/
+#if SNOR_USE_CACHE == TRUE
+    err = snor_cache_read(devp, offset, n, rp);
+#else
+    err = snor_device_read(devp, offset, n, rp);
+#endif
+
+    /* Erase resumed, the driver remains in FLASH_ERASE state until the
+       completion is detected by snor_query_erase().*/
+    (void) snor_device_resume_erase(devp);
+  }
+
+  /* Bus released.*/
+  bus_release(devp->config->busp);
+
+  return err;
+}
+#endif /* SNOR_USE_ERASE_SUSPEND == TRUE */
+
 /**
  * @brief   Returns a pointer to the device descriptor.
  *
@@ -94,9 +276,24 @@ static flash_error_t snor_read(void *instance, flash_offset_t offset,
                 "invalid state");
 
   if (devp->state == FLASH_ERASE) {
+#if SNOR_USE_ERASE_SUSPEND == TRUE
+    return snor_read_suspended(devp, offset, n, rp);
+#else
     return FLASH_BUSY_ERASING;
+#endif
   }
 
+#if SNOR_BUS_DRIVER == SNOR_BUS_DRIVER_WSPI
+#if WSPI_SUPPORTS_MEMMAP == TRUE
+  /* In memory mapped mode the data is simply copied from the memory
+     space, commands cannot be sent to the device.*/
+  if (snor_is_mapped(devp)) {
+    memcpy(rp, devp->mapped + offset, n);
+    return FLASH_NO_ERROR;
+  }
+#endif
+#endif
+
   /* Bus acquired.*/
   bus_acquire(devp->config->busp, devp->config->buscfg);
 
@@ -104,7 +301,11 @@ static flash_error_t snor_read(void *instance, flash_offset_t offset,
   devp->state = FLASH_READ;
 
   /* Actual read implementation.*/
+#if SNOR_USE_CACHE == TRUE
+  err = snor_cache_read(devp, offset, n, rp);
+#else
   err = snor_device_read(devp, offset, n, rp);
+#endif
 
   /* Ready state again.*/
   devp->state = FLASH_READY;
@@ -125,6 +326,7 @@ static flash_error_t snor_program(void *instance, flash_offset_t offset,
                                      (size_t)snor_descriptor.sectors_size);
   osalDbgAssert((devp->state == FLASH_READY) || (devp->state == FLASH_ERASE),
                 "invalid state");
+  osalDbgAssert(!snor_is_mapped(devp), "memory mapped");
 
   if (devp->state == FLASH_ERASE) {
     return FLASH_BUSY_ERASING;
@@ -136,6 +338,11 @@ static flash_error_t snor_program(void *instance, flash_offset_t offset,
   /* FLASH_PGM state while the operation is performed.*/
   devp->state = FLASH_PGM;
 
+#if SNOR_USE_CACHE == TRUE
+  /* Cached data is going to be stale.*/
+  snor_cache_invalidate(devp, offset, n);
+#endif
+
   /* Actual program implementation.*/
   err = snor_device_program(devp, offset, n, pp);
 
@@ -155,6 +362,7 @@ static flash_error_t snor_start_erase_all(void *instance) {
   osalDbgCheck(instance != NULL);
   osalDbgAssert((devp->state == FLASH_READY) || (devp->state == FLASH_ERASE),
                 "invalid state");
+  osalDbgAssert(!snor_is_mapped(devp), "memory mapped");
 
   if (devp->state == FLASH_ERASE) {
     return FLASH_BUSY_ERASING;
@@ -166,6 +374,18 @@ static flash_error_t snor_start_erase_all(void *instance) {
   /* FLASH_ERASE state while the operation is performed.*/
   devp->state = FLASH_ERASE;
 
+#if SNOR_USE_CACHE == TRUE
+  /* Cached data is going to be stale.*/
+  snorCacheInvalidate(devp);
+#endif
+
+#if SNOR_USE_ERASE_SUSPEND == TRUE
+  /* Area being erased.*/
+  devp->erase_offset = (flash_offset_t)0;
+  devp->erase_size   = (uint32_t)snor_descriptor.sectors_count *
+                       snor_descriptor.sectors_size;
+#endif
+
   /* Actual erase implementation.*/
   err = snor_device_start_erase_all(devp);
 
@@ -187,6 +407,7 @@ static flash_error_t snor_start_erase_sector(void *instance,
   osalDbgCheck(sector < snor_descriptor.sectors_count);
   osalDbgAssert((devp->state == FLASH_READY) || (devp->state == FLASH_ERASE),
                 "invalid state");
+  osalDbgAssert(!snor_is_mapped(devp), "memory mapped");
 
   if (devp->state == FLASH_ERASE) {
     return FLASH_BUSY_ERASING;
@@ -198,6 +419,18 @@ static flash_error_t snor_start_erase_sector(void *instance,
   /* FLASH_ERASE state while the operation is performed.*/
   devp->state = FLASH_ERASE;
 
+#if SNOR_USE_CACHE == TRUE
+  /* Cached data is going to be stale.*/
+  snor_cache_invalidate(devp, flashGetSectorOffset((BaseFlash *)devp, sector),
+                        (size_t)flashGetSectorSize((BaseFlash *)devp, sector));
+#endif
+
+#if SNOR_USE_ERASE_SUSPEND == TRUE
+  /* Area being erased.*/
+  devp->erase_offset = flashGetSectorOffset((BaseFlash *)devp, sector);
+  devp->erase_size   = flashGetSectorSize((BaseFlash *)devp, sector);
+#endif
+
   /* Actual erase implementation.*/
   err = snor_device_start_erase_sector(devp, sector);
 
@@ -647,6 +880,15 @@ void snorObjectInit(SNORDriver *devp) {
   devp->vmt         = &snor_vmt;
   devp->state       = FLASH_STOP;
   devp->config      = NULL;
+#if SNOR_BUS_DRIVER == SNOR_BUS_DRIVER_WSPI
+#if WSPI_SUPPORTS_MEMMAP == TRUE
+  devp->mapped      = NULL;
+#endif
+#endif
+#if SNOR_USE_CACHE == TRUE
+  snorCacheInvalidate(devp);
+  snorCacheResetStats(devp);
+#endif
 }
 
 /**
@@ -672,6 +914,11 @@ void snorStart(SNORDriver *devp, const SNORConfig *config) {
     /* Device identification and initialization.*/
     snor_device_init(devp);
 
+#if SNOR_USE_CACHE == TRUE
+    /* The device could have been modified while stopped.*/
+    snorCacheInvalidate(devp);
+#endif
+
     /* Driver in ready state.*/
     devp->state = FLASH_READY;
 
@@ -711,6 +958,44 @@ void snorStop(SNORDriver *devp) {
   }
 }
 
+#if (SNOR_USE_CACHE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Invalidates the whole read cache.
+ * @note    The cache is automatically invalidated by the driver program and
+ *          erase operations, this function is only required if the flash
+ *          content is modified by other means.
+ *
+ * @param[in] devp      pointer to the @p SNORDriver object
+ *
+ * @api
+ */
+void snorCacheInvalidate(SNORDriver *devp) {
+  unsigned i;
+
+  osalDbgCheck(devp != NULL);
+
+  for (i = 0U; i < (unsigned)SNOR_CACHE_LINES; i++) {
+    devp->cache.lines[i].offset = SNOR_CACHE_INVALID;
+    devp->cache.lines[i].stamp  = 0U;
+  }
+}
+
+/**
+ * @brief   Resets the read cache statistics.
+ *
+ * @param[in] devp      pointer to the @p SNORDriver object
+ *
+ * @api
+ */
+void snorCacheResetStats(SNORDriver *devp) {
+
+  osalDbgCheck(devp != NULL);
+
+  devp->cache.hits   = 0U;
+  devp->cache.misses = 0U;
+}
+#endif /* SNOR_USE_CACHE == TRUE */
+
 #if (SNOR_BUS_DRIVER == SNOR_BUS_DRIVER_WSPI) || defined(__DOXYGEN__)
 #if (WSPI_SUPPORTS_MEMMAP == TRUE) || defined(__DOXYGEN__)
 /**
@@ -718,6 +1003,9 @@ void snorStop(SNORDriver *devp) {
  * @details The memory mapping mode is only available when the WSPI mode
  *          is selected and the underlying WSPI controller supports the
  *          feature.
+ * @note    While in memory mapped mode the driver read operations are
+ *          served directly from the memory space, program and erase
+ *          operations are not allowed.
  *
  * @param[in] devp      pointer to the @p SNORDriver object
  * @param[out] addrp    pointer to the memory start address of the mapped
@@ -736,7 +1024,10 @@ void snorMemoryMap(SNORDriver *devp, uint8_t **addrp) {
 #endif
 
   /* Starting WSPI memory mapped mode.*/
-  wspiMapFlash(devp->config->busp, &snor_memmap_read, addrp);
+  wspiMapFlash(devp->config->busp, &snor_memmap_read, &devp->mapped);
+  if (addrp != NULL) {
+    *addrp = devp->mapped;
+  }
 
   /* Bus release.*/
   bus_release(devp->config->busp);
@@ -756,6 +1047,7 @@ void snorMemoryUnmap(SNORDriver *devp) {
 
   /* Stopping WSPI memory mapped mode.*/
   wspiUnmapFlash(devp->config->busp);
+  devp->mapped = NULL;
 
 #if SNOR_DEVICE_SUPPORTS_XIP == TRUE
   snor_reset_xip(devp);
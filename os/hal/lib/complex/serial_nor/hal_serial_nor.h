@@ -65,6 +65,47 @@
 #if !defined(SNOR_SHARED_BUS) || defined(__DOXYGEN__)
 #define SNOR_SHARED_BUS                     TRUE
 #endif
+
+/**
+ * @brief   Read cache switch.
+ * @details If set to @p TRUE the driver keeps recently read data in a
+ *          LRU cache, cached lines are invalidated by program and erase
+ *          operations.
+ */
+#if !defined(SNOR_USE_CACHE) || defined(__DOXYGEN__)
+#define SNOR_USE_CACHE                      FALSE
+#endif
+
+/**
+ * @brief   Number of read cache lines.
+ */
+#if !defined(SNOR_CACHE_LINES) || defined(__DOXYGEN__)
+#define SNOR_CACHE_LINES                    8
+#endif
+
+/**
+ * @brief   Size of read cache lines.
+ * @note    It must be a power of two not greater than the device sectors
+ *          size.
+ */
+#if !defined(SNOR_CACHE_LINE_SIZE) || defined(__DOXYGEN__)
+#define SNOR_CACHE_LINE_SIZE                256
+#endif
+
+/**
+ * @brief   Erase suspend switch.
+ * @details If set to @p TRUE then read operations issued while an erase
+ *          is in progress suspend the erase, perform the read and resume
+ *          the erase instead of failing with @p FLASH_BUSY_ERASING.
+ * @note    Requires device support, the feature is only used if the
+ *          device descriptor has the @p FLASH_ATTR_SUSPEND_ERASE_CAPABLE
+ *          attribute.
+ * @note    Reads of the area being erased still fail with
+ *          @p FLASH_BUSY_ERASING.
+ */
+#if !defined(SNOR_USE_ERASE_SUSPEND) || defined(__DOXYGEN__)
+#define SNOR_USE_ERASE_SUSPEND              FALSE
+#endif
 /** @} */
 
 /*===========================================================================*/
@@ -81,6 +122,19 @@
 #error "invalid SNOR_BUS_DRIVER setting"
 #endif
 
+#if SNOR_USE_CACHE == TRUE
+#if SNOR_CACHE_LINES < 1
+#error "invalid SNOR_CACHE_LINES value"
+#endif
+
+/*lint -save -e9027 [10.1] It is meant to be this way, not an error.*/
+#if (SNOR_CACHE_LINE_SIZE < 16) ||                                          \
+    ((SNOR_CACHE_LINE_SIZE & (SNOR_CACHE_LINE_SIZE - 1)) != 0)
+/*lint -restore*/
+#error "SNOR_CACHE_LINE_SIZE must be a power of two greater or equal to 16"
+#endif
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -93,6 +147,49 @@ typedef struct {
   const BUSConfig           *buscfg;
 } SNORConfig;
 
+#if (SNOR_USE_CACHE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a read cache line.
+ */
+typedef struct {
+  /**
+   * @brief   Flash offset of the cached data.
+   * @note    It is @p SNOR_CACHE_INVALID if the line is not used.
+   */
+  flash_offset_t            offset;
+  /**
+   * @brief   Last access stamp, used for LRU replacement.
+   */
+  uint32_t                  stamp;
+  /**
+   * @brief   Cached data.
+   */
+  uint8_t                   data[SNOR_CACHE_LINE_SIZE];
+} snor_cache_line_t;
+
+/**
+ * @brief   Type of a read cache.
+ */
+typedef struct {
+  /**
+   * @brief   Access stamps counter.
+   */
+  uint32_t                  clock;
+  /**
+   * @brief   Number of cache hits.
+   */
+  uint32_t                  hits;
+  /**
+   * @brief   Number of cache misses.
+   */
+  uint32_t                  misses;
+  /**
+   * @brief   Cache lines.
+   */
+  snor_cache_line_t         lines[SNOR_CACHE_LINES];
+} snor_cache_t;
+#endif
+
 /**
  * @brief   @p SNORDriver specific methods.
  */
@@ -138,12 +235,63 @@ typedef struct {
    * @brief   Device ID and unique ID.
    */
   uint8_t                       device_id[20];
+#if (SNOR_BUS_DRIVER == SNOR_BUS_DRIVER_WSPI) || defined(__DOXYGEN__)
+#if (WSPI_SUPPORTS_MEMMAP == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Memory mapped flash address or @p NULL.
+   */
+  uint8_t                       *mapped;
+#endif
+#endif
+#if (SNOR_USE_CACHE == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Read cache.
+   */
+  snor_cache_t                  cache;
+#endif
+#if (SNOR_USE_ERASE_SUSPEND == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Offset of the area being erased.
+   */
+  flash_offset_t                erase_offset;
+  /**
+   * @brief   Size of the area being erased.
+   */
+  uint32_t                      erase_size;
+#endif
 } SNORDriver;
 
 /*===========================================================================*/
 /* Driver macros.                                                            */
 /*===========================================================================*/
 
+#if (SNOR_USE_CACHE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Offset marking an unused cache line.
+ */
+#define SNOR_CACHE_INVALID                  ((flash_offset_t)-1)
+
+/**
+ * @brief   Returns the number of read cache hits.
+ *
+ * @param[in] devp      pointer to the @p SNORDriver object
+ * @return              The number of hits since last reset.
+ *
+ * @xclass
+ */
+#define snorCacheGetHitsX(devp) ((devp)->cache.hits)
+
+/**
+ * @brief   Returns the number of read cache misses.
+ *
+ * @param[in] devp      pointer to the @p SNORDriver object
+ * @return              The number of misses since last reset.
+ *
+ * @xclass
+ */
+#define snorCacheGetMissesX(devp) ((devp)->cache.misses)
+#endif
+
 #if SNOR_SHARED_BUS == FALSE
 #define bus_acquire(busp, config)
 #define bus_release(busp)
@@ -191,6 +339,10 @@ extern "C" {
   void snorObjectInit(SNORDriver *devp);
   void snorStart(SNORDriver *devp, const SNORConfig *config);
   void snorStop(SNORDriver *devp);
+#if (SNOR_USE_CACHE == TRUE) || defined(__DOXYGEN__)
+  void snorCacheInvalidate(SNORDriver *devp);
+  void snorCacheResetStats(SNORDriver *devp);
+#endif
 #if (SNOR_BUS_DRIVER == SNOR_BUS_DRIVER_WSPI) || defined(__DOXYGEN__)
 #if (WSPI_SUPPORTS_MEMMAP == TRUE) || defined(__DOXYGEN__)
   void snorMemoryMap(SNORDriver *devp, uint8_t ** addrp);
@@ -204,6 +356,11 @@ extern "C" {
 /* Device-specific implementations.*/
 #include "hal_flash_device.h"
 
+#if (SNOR_USE_ERASE_SUSPEND == TRUE) &&                                     \
+    (SNOR_DEVICE_SUPPORTS_ERASE_SUSPEND == FALSE)
+#error "SNOR_USE_ERASE_SUSPEND requires device support"
+#endif
+
 #endif /* HAL_SERIAL_NOR_H */
 
 /** @} */
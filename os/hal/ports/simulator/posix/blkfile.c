@@ -0,0 +1,209 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/posix/blkfile.c
+ * @brief   Posix simulator file-backed block device code.
+ * @details Each read or write operation is performed with a single
+ *          @p pread() or @p pwrite() call on the backing file.
+ *
+ * @addtogroup POSIX_BLKFILE
+ * @{
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "hal.h"
+#include "blkfile.h"
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+static bool _is_inserted(void *instance) {
+
+  return ((FileBlockDevice *)instance)->fd >= 0;
+}
+
+static bool _is_protected(void *instance) {
+
+  (void)instance;
+
+  return false;
+}
+
+static bool _connect(void *instance) {
+  FileBlockDevice *fbdp = (FileBlockDevice *)instance;
+
+  if (fbdp->fd < 0) {
+    return HAL_FAILED;
+  }
+  fbdp->state = BLK_READY;
+  return HAL_SUCCESS;
+}
+
+static bool _disconnect(void *instance) {
+  FileBlockDevice *fbdp = (FileBlockDevice *)instance;
+
+  if (fbdp->fd >= 0) {
+    fbdp->state = BLK_ACTIVE;
+  }
+  return HAL_SUCCESS;
+}
+
+static bool _read(void *instance, uint32_t startblk,
+                  uint8_t *buffer, uint32_t n) {
+  FileBlockDevice *fbdp = (FileBlockDevice *)instance;
+  size_t size = (size_t)n * FBD_BLOCK_SIZE;
+
+  if ((fbdp->state != BLK_READY) || (startblk + n > fbdp->blk_num)) {
+    return HAL_FAILED;
+  }
+
+  fbdp->transfers++;
+  if (pread(fbdp->fd, buffer, size,
+            (off_t)startblk * FBD_BLOCK_SIZE) != (ssize_t)size) {
+    return HAL_FAILED;
+  }
+  return HAL_SUCCESS;
+}
+
+static bool _write(void *instance, uint32_t startblk,
+                   const uint8_t *buffer, uint32_t n) {
+  FileBlockDevice *fbdp = (FileBlockDevice *)instance;
+  size_t size = (size_t)n * FBD_BLOCK_SIZE;
+
+  if ((fbdp->state != BLK_READY) || (startblk + n > fbdp->blk_num)) {
+    return HAL_FAILED;
+  }
+
+  fbdp->transfers++;
+  if (pwrite(fbdp->fd, buffer, size,
+             (off_t)startblk * FBD_BLOCK_SIZE) != (ssize_t)size) {
+    return HAL_FAILED;
+  }
+  return HAL_SUCCESS;
+}
+
+static bool _sync(void *instance) {
+  FileBlockDevice *fbdp = (FileBlockDevice *)instance;
+
+  if (fbdp->state != BLK_READY) {
+    return HAL_FAILED;
+  }
+  return fsync(fbdp->fd) == 0 ? HAL_SUCCESS : HAL_FAILED;
+}
+
+static bool _get_info(void *instance, BlockDeviceInfo *bdip) {
+  FileBlockDevice *fbdp = (FileBlockDevice *)instance;
+
+  if (fbdp->state != BLK_READY) {
+    return HAL_FAILED;
+  }
+  bdip->blk_size = FBD_BLOCK_SIZE;
+  bdip->blk_num  = fbdp->blk_num;
+  return HAL_SUCCESS;
+}
+
+static const struct BaseBlockDeviceVMT vmt = {
+  (size_t)0,
+  _is_inserted, _is_protected,
+  _connect, _disconnect,
+  _read, _write, _sync,
+  _get_info
+};
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes an instance.
+ *
+ * @param[out] fbdp     pointer to the @p FileBlockDevice object
+ *
+ * @init
+ */
+void fbdObjectInit(FileBlockDevice *fbdp) {
+
+  fbdp->vmt       = &vmt;
+  fbdp->state     = BLK_STOP;
+  fbdp->fd        = -1;
+  fbdp->blk_num   = 0U;
+  fbdp->transfers = 0U;
+}
+
+/**
+ * @brief   Opens the backing file, it is created if not existing.
+ *
+ * @param[in] fbdp      pointer to the @p FileBlockDevice object
+ * @param[in] path      path of the backing file
+ * @param[in] blk_num   number of blocks of the device
+ * @return              The operation status.
+ * @retval HAL_SUCCESS  operation succeeded.
+ * @retval HAL_FAILED   operation failed.
+ *
+ * @api
+ */
+bool fbdStart(FileBlockDevice *fbdp, const char *path, uint32_t blk_num) {
+
+  osalDbgAssert(fbdp->state == BLK_STOP, "invalid state");
+
+  fbdp->fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (fbdp->fd < 0) {
+    return HAL_FAILED;
+  }
+  if (ftruncate(fbdp->fd, (off_t)blk_num * FBD_BLOCK_SIZE) != 0) {
+    close(fbdp->fd);
+    fbdp->fd = -1;
+    return HAL_FAILED;
+  }
+  fbdp->blk_num   = blk_num;
+  fbdp->transfers = 0U;
+  fbdp->state     = BLK_ACTIVE;
+  return HAL_SUCCESS;
+}
+
+/**
+ * @brief   Closes the backing file.
+ *
+ * @param[in] fbdp      pointer to the @p FileBlockDevice object
+ *
+ * @api
+ */
+void fbdStop(FileBlockDevice *fbdp) {
+
+  if (fbdp->fd >= 0) {
+    close(fbdp->fd);
+    fbdp->fd = -1;
+  }
+  fbdp->state = BLK_STOP;
+}
+
+/** @} */
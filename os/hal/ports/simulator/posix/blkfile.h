@@ -0,0 +1,102 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/posix/blkfile.h
+ * @brief   Posix simulator file-backed block device header.
+ *
+ * @addtogroup POSIX_BLKFILE
+ * @{
+ */
+
+#ifndef BLKFILE_H
+#define BLKFILE_H
+
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Block size of the simulated device.
+ */
+#define FBD_BLOCK_SIZE                      512U
+
+/*===========================================================================*/
+/* Driver pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   @p FileBlockDevice specific data.
+ */
+#define _file_block_device_data                                             \
+  _base_block_device_data                                                   \
+  /* Backing file descriptor.*/                                             \
+  int                   fd;                                                 \
+  /* Number of blocks of the device.*/                                      \
+  uint32_t              blk_num;                                            \
+  /* Number of read or write transfers performed.*/                         \
+  uint32_t              transfers;
+
+/**
+ * @extends BaseBlockDevice
+ *
+ * @brief   Block device backed by a host file.
+ */
+typedef struct {
+  /** @brief Virtual Methods Table.*/
+  const struct BaseBlockDeviceVMT *vmt;
+  _file_block_device_data
+} FileBlockDevice;
+
+/*===========================================================================*/
+/* Driver macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the number of transfers performed on the device.
+ *
+ * @param[in] fbdp      pointer to the @p FileBlockDevice object
+ * @return              The number of transfers.
+ *
+ * @xclass
+ */
+#define fbdGetTransfersX(fbdp) ((fbdp)->transfers)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void fbdObjectInit(FileBlockDevice *fbdp);
+  bool fbdStart(FileBlockDevice *fbdp, const char *path, uint32_t blk_num);
+  void fbdStop(FileBlockDevice *fbdp);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BLKFILE_H */
+
+/** @} */
@@ -24,10 +24,18 @@
 
 #include <stdio.h>
 #include <stdlib.h>
-#include <sys/time.h>
+#include <poll.h>
 
 #include "hal.h"
 
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+#if !HAL_USE_SERIAL
+#define SD_LLD_POLL_FDS                     0
+#endif
+
 /*===========================================================================*/
 /* Driver exported variables.                                                */
 /*===========================================================================*/
@@ -36,13 +44,82 @@
 /* Driver local variables and types.                                         */
 /*===========================================================================*/
 
-static struct timeval nextcnt;
-static struct timeval tick = {0UL, 1000000UL / OSAL_ST_FREQUENCY};
-
 /*===========================================================================*/
 /* Driver local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Serves the pending interrupt sources.
+ *
+ * @return              The interrupt status.
+ * @retval false        if no interrupt has been served.
+ * @retval true         if at least one interrupt has been served.
+ */
+static bool serve_interrupts(void) {
+  bool int_occurred = false;
+
+#if HAL_USE_SERIAL
+  if (sd_lld_interrupt_pending()) {
+    int_occurred = true;
+  }
+#endif
+
+#if OSAL_ST_MODE != OSAL_ST_MODE_NONE
+  if (st_lld_interrupt_pending()) {
+    int_occurred = true;
+  }
+#endif
+
+  return int_occurred;
+}
+
+/**
+ * @brief   Sleeps until an interrupt source becomes ready.
+ */
+static void wait_interrupts(void) {
+  struct pollfd pfds[1 + SD_LLD_POLL_FDS];
+  nfds_t n = 0;
+  int timeout = -1;
+
+#if (OSAL_ST_MODE != OSAL_ST_MODE_NONE) && (PORT_SIM_VIRTUAL_TIME == TRUE)
+  /* The virtual time jumps to the next timer event, the sockets are just
+     checked.*/
+  if (st_lld_skip_to_next_event()) {
+    timeout = 0;
+  }
+#elif OSAL_ST_MODE != OSAL_ST_MODE_NONE
+  /* Without a timer descriptor the time is polled every millisecond.*/
+  pfds[n].fd     = st_lld_get_fd();
+  pfds[n].events = POLLIN;
+  if (pfds[n].fd < 0) {
+    timeout = 1;
+  }
+  n++;
+#endif
+
+#if HAL_USE_SERIAL
+  n += (nfds_t)sd_lld_get_poll_fds(&pfds[n]);
+#endif
+
+  /* Nothing to wait for, poll() would block forever.*/
+  if (n == 0) {
+    return;
+  }
+
+  (void)poll(pfds, n, timeout);
+}
+
+/**
+ * @brief   Performs a preemption if required after interrupts.
+ */
+static void check_preemption(void) {
+
+  __dbg_check_lock();
+  if (chSchIsPreemptionRequired())
+    chSchDoPreemption();
+  __dbg_check_unlock();
+}
+
 /*===========================================================================*/
 /* Driver interrupt handlers.                                                */
 /*===========================================================================*/
@@ -61,43 +138,33 @@ void hal_lld_init(void) {
 #else
   puts("ChibiOS/RT simulator (Linux)\n");
 #endif
-  gettimeofday(&nextcnt, NULL);
-  timeradd(&nextcnt, &tick, &nextcnt);
 }
 
 /**
  * @brief   Interrupt simulation.
  */
 void _sim_check_for_interrupts(void) {
-  struct timeval tv;
-  bool int_occurred = false;
 
-#if HAL_USE_SERIAL
-  if (sd_lld_interrupt_pending()) {
-    int_occurred = true;
+  port_sim_advance(PORT_SIM_CHECK_COST);
+  if (serve_interrupts()) {
+    check_preemption();
   }
-#endif
-
-  gettimeofday(&tv, NULL);
-  if (timercmp(&tv, &nextcnt, >=)) {
-    int_occurred = true;
-    timeradd(&nextcnt, &tick, &nextcnt);
-
-    CH_IRQ_PROLOGUE();
-
-    chSysLockFromISR();
-    chSysTimerHandlerI();
-    chSysUnlockFromISR();
+}
 
-    CH_IRQ_EPILOGUE();
-  }
+/**
+ * @brief   Interrupt simulation while idle.
+ * @details The host thread sleeps until an interrupt source becomes ready
+ *          instead of spinning.
+ */
+void _sim_wait_for_interrupts(void) {
 
-  if (int_occurred) {
-    __dbg_check_lock();
-    if (chSchIsPreemptionRequired())
-      chSchDoPreemption();
-    __dbg_check_unlock();
+  if (!serve_interrupts()) {
+    wait_interrupts();
+    if (!serve_interrupts()) {
+      return;
+    }
   }
+  check_preemption();
 }
 
 /** @} */
@@ -293,6 +293,30 @@ bool sd_lld_interrupt_pending(void) {
   return b;
 }
 
+/**
+ * @brief   Returns the sockets to be watched while the simulator is idle.
+ *
+ * @param[out] pfds     array of at least @p SD_LLD_POLL_FDS elements
+ * @return              The number of filled elements.
+ */
+unsigned sd_lld_get_poll_fds(struct pollfd *pfds) {
+  unsigned n = 0;
+
+#if USE_SIM_SERIAL1
+  pfds[n].fd     = SD1.com_data != -1 ? SD1.com_data : SD1.com_listen;
+  pfds[n].events = POLLIN;
+  n++;
+#endif
+
+#if USE_SIM_SERIAL2
+  pfds[n].fd     = SD2.com_data != -1 ? SD2.com_data : SD2.com_listen;
+  pfds[n].events = POLLIN;
+  n++;
+#endif
+
+  return n;
+}
+
 #endif /* HAL_USE_SERIAL */
 
 /** @} */
@@ -27,6 +27,16 @@
 
 #if HAL_USE_SERIAL || defined(__DOXYGEN__)
 
+/*===========================================================================*/
+/* Driver constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Maximum number of descriptors returned by
+ *          @p sd_lld_get_poll_fds().
+ */
+#define SD_LLD_POLL_FDS                     2
+
 /*===========================================================================*/
 /* Driver pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -132,6 +142,7 @@ extern "C" {
   void sd_lld_start(SerialDriver *sdp, const SerialConfig *config);
   void sd_lld_stop(SerialDriver *sdp);
   bool sd_lld_interrupt_pending(void);
+  unsigned sd_lld_get_poll_fds(struct pollfd *pfds);
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,404 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    simulator/posix/hal_st_lld.c
+ * @brief   Posix simulator ST subsystem low level driver source.
+ * @details The system time is derived from the host monotonic clock, on
+ *          Linux a @p timerfd is armed on the next tick or alarm so that
+ *          the simulator can sleep on it while idle. In virtual time mode
+ *          the port virtual clock is used instead.
+ *
+ * @addtogroup ST
+ * @{
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/timerfd.h>
+#endif
+
+#include "hal.h"
+
+#if (OSAL_ST_MODE != OSAL_ST_MODE_NONE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Driver local definitions.                                                 */
+/*===========================================================================*/
+
+#define NS_PER_S                            1000000000ULL
+
+/**
+ * @brief   Timer file descriptors usage.
+ */
+#if defined(__linux__) && (PORT_SIM_VIRTUAL_TIME == FALSE)
+#define ST_USE_TIMERFD                      TRUE
+#else
+#define ST_USE_TIMERFD                      FALSE
+#endif
+
+/*===========================================================================*/
+/* Driver exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver local variables and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Timer file descriptor.
+ */
+static int st_fd = -1;
+
+/**
+ * @brief   Host monotonic time at initialization.
+ */
+static uint64_t st_start;
+
+#if (OSAL_ST_MODE == OSAL_ST_MODE_PERIODIC) || defined(__DOXYGEN__)
+/**
+ * @brief   Number of ticks served.
+ */
+static uint64_t st_ticks;
+#endif
+
+#if (OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING) || defined(__DOXYGEN__)
+/**
+ * @brief   Alarm time, not truncated to the counter width.
+ */
+static uint64_t st_alarm;
+
+/**
+ * @brief   Alarm status.
+ */
+static bool st_alarm_active;
+#endif
+
+/*===========================================================================*/
+/* Driver local functions.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Returns the host monotonic time in nanoseconds.
+ */
+static uint64_t st_get_host_time(void) {
+#if PORT_SIM_VIRTUAL_TIME == TRUE
+
+  return port_sim_time;
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * NS_PER_S) + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief   Returns the number of ticks elapsed since initialization.
+ */
+static uint64_t st_get_ticks(void) {
+  uint64_t ns = st_get_host_time() - st_start;
+
+  return ((ns / NS_PER_S) * OSAL_ST_FREQUENCY) +
+         (((ns % NS_PER_S) * OSAL_ST_FREQUENCY) / NS_PER_S);
+}
+
+/**
+ * @brief   Converts a number of ticks in host time, rounding up.
+ */
+static uint64_t st_ticks2ns(uint64_t ticks) {
+
+  return ((ticks / OSAL_ST_FREQUENCY) * NS_PER_S) +
+         ((((ticks % OSAL_ST_FREQUENCY) * NS_PER_S) +
+           OSAL_ST_FREQUENCY - 1U) / OSAL_ST_FREQUENCY);
+}
+
+/**
+ * @brief   Arms the timer file descriptor.
+ *
+ * @param[in] ticks     expiration time in ticks since initialization
+ * @param[in] period    period in ticks or zero for a one-shot expiration
+ */
+static void st_arm(uint64_t ticks, uint64_t period) {
+#if ST_USE_TIMERFD == TRUE
+  struct itimerspec its;
+  uint64_t ns;
+
+  ns = st_start + st_ticks2ns(ticks);
+  its.it_value.tv_sec  = (time_t)(ns / NS_PER_S);
+  its.it_value.tv_nsec = (long)(ns % NS_PER_S);
+  ns = st_ticks2ns(period);
+  its.it_interval.tv_sec  = (time_t)(ns / NS_PER_S);
+  its.it_interval.tv_nsec = (long)(ns % NS_PER_S);
+  timerfd_settime(st_fd, TFD_TIMER_ABSTIME, &its, NULL);
+#else
+  (void)ticks;
+  (void)period;
+#endif
+}
+
+#if (OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING) || defined(__DOXYGEN__)
+/**
+ * @brief   Disarms the timer file descriptor.
+ */
+static void st_disarm(void) {
+#if ST_USE_TIMERFD == TRUE
+  struct itimerspec its = {{0, 0}, {0, 0}};
+
+  timerfd_settime(st_fd, 0, &its, NULL);
+#endif
+}
+#endif
+
+/**
+ * @brief   Consumes the pending timer file descriptor expirations.
+ */
+static void st_drain(void) {
+  uint64_t n;
+
+  if (st_fd >= 0) {
+    while (read(st_fd, &n, sizeof (n)) > 0) {
+    }
+  }
+}
+
+/**
+ * @brief   Serves a timer interrupt.
+ */
+static void st_serve_interrupt(void) {
+
+  OSAL_IRQ_PROLOGUE();
+
+  osalSysLockFromISR();
+  osalOsTimerHandlerI();
+  osalSysUnlockFromISR();
+
+  OSAL_IRQ_EPILOGUE();
+}
+
+/*===========================================================================*/
+/* Driver interrupt handlers.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Driver exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Low level ST driver initialization.
+ *
+ * @notapi
+ */
+void st_lld_init(void) {
+
+#if ST_USE_TIMERFD == TRUE
+  st_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  if (st_fd == -1) {
+    printf("ST: Error creating timer (%d)\n", errno);
+    exit(1);
+  }
+#endif
+  st_start = st_get_host_time();
+
+#if OSAL_ST_MODE == OSAL_ST_MODE_PERIODIC
+  st_ticks = 0U;
+  st_arm(1U, 1U);
+#else
+  st_alarm_active = false;
+#endif
+}
+
+/**
+ * @brief   Interrupt simulation.
+ * @details Serves the timer interrupt if the next tick or the alarm time
+ *          has been reached.
+ *
+ * @return              The interrupt status.
+ * @retval false        if no interrupt has been served.
+ * @retval true         if the timer interrupt has been served.
+ *
+ * @notapi
+ */
+bool st_lld_interrupt_pending(void) {
+  uint64_t now = st_get_ticks();
+
+#if OSAL_ST_MODE == OSAL_ST_MODE_PERIODIC
+  if (now <= st_ticks) {
+    return false;
+  }
+
+  st_drain();
+  while (st_ticks < now) {
+    st_ticks++;
+    st_serve_interrupt();
+  }
+  return true;
+#else
+  if (!st_alarm_active || (now < st_alarm)) {
+    return false;
+  }
+
+  /* Like a compare register the alarm matches again after a counter
+     wrap, unless changed by the handler.*/
+  st_drain();
+#if OSAL_ST_RESOLUTION < 64
+  st_alarm += (uint64_t)1 << OSAL_ST_RESOLUTION;
+  st_arm(st_alarm, 0U);
+#else
+  st_alarm_active = false;
+  st_disarm();
+#endif
+  st_serve_interrupt();
+  return true;
+#endif
+}
+
+/**
+ * @brief   Returns the timer file descriptor.
+ * @details The descriptor becomes readable when the timer interrupt
+ *          is due.
+ *
+ * @return              The file descriptor, -1 if the host does not
+ *                      support timer descriptors.
+ *
+ * @notapi
+ */
+int st_lld_get_fd(void) {
+
+  return st_fd;
+}
+
+#if (PORT_SIM_VIRTUAL_TIME == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Advances the virtual time to the next timer event.
+ *
+ * @return              The timer event status.
+ * @retval false        if there is no timer event scheduled.
+ * @retval true         if the virtual time has been advanced.
+ *
+ * @notapi
+ */
+bool st_lld_skip_to_next_event(void) {
+  uint64_t ns;
+
+#if OSAL_ST_MODE == OSAL_ST_MODE_PERIODIC
+  ns = st_start + st_ticks2ns(st_ticks + 1U);
+#else
+  if (!st_alarm_active) {
+    return false;
+  }
+  ns = st_start + st_ticks2ns(st_alarm);
+#endif
+  if (port_sim_time < ns) {
+    port_sim_time = ns;
+  }
+  return true;
+}
+#endif /* PORT_SIM_VIRTUAL_TIME == TRUE */
+
+/**
+ * @brief   Returns the time counter value.
+ *
+ * @return              The counter value.
+ *
+ * @notapi
+ */
+systime_t st_lld_get_counter(void) {
+
+  return (systime_t)st_get_ticks();
+}
+
+#if (OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts the alarm.
+ * @note    Makes sure that no spurious alarms are triggered after
+ *          this call.
+ *
+ * @param[in] time      the time to be set for the first alarm
+ *
+ * @notapi
+ */
+void st_lld_start_alarm(systime_t time) {
+
+  st_alarm_active = true;
+  st_lld_set_alarm(time);
+}
+
+/**
+ * @brief   Stops the alarm interrupt.
+ *
+ * @notapi
+ */
+void st_lld_stop_alarm(void) {
+
+  st_alarm_active = false;
+  st_disarm();
+}
+
+/**
+ * @brief   Sets the alarm time.
+ *
+ * @param[in] time      the time to be set for the next alarm
+ *
+ * @notapi
+ */
+void st_lld_set_alarm(systime_t time) {
+  uint64_t now = st_get_ticks();
+
+  /* The alarm matches when the counter reaches the specified value, it
+     could be after a counter wrap.*/
+  st_alarm = now + (uint64_t)(systime_t)(time - (systime_t)now);
+  st_arm(st_alarm, 0U);
+}
+
+/**
+ * @brief   Returns the current alarm time.
+ *
+ * @return              The currently set alarm time.
+ *
+ * @notapi
+ */
+systime_t st_lld_get_alarm(void) {
+
+  return (systime_t)st_alarm;
+}
+
+/**
+ * @brief   Determines if the alarm is active.
+ *
+ * @return              The alarm status.
+ * @retval false        if the alarm is not active.
+ * @retval true         is the alarm is active
+ *
+ * @notapi
+ */
+bool st_lld_is_alarm_active(void) {
+
+  return st_alarm_active;
+}
+#endif /* OSAL_ST_MODE == OSAL_ST_MODE_FREERUNNING */
+
+#endif /* OSAL_ST_MODE != OSAL_ST_MODE_NONE */
+
+/** @} */
@@ -1,9 +1,10 @@
 # List of all the Posix platform files.
 PLATFORMSRC = ${CHIBIOS}/os/hal/ports/simulator/posix/hal_lld.c \
               ${CHIBIOS}/os/hal/ports/simulator/posix/hal_serial_lld.c \
+              ${CHIBIOS}/os/hal/ports/simulator/posix/blkfile.c \
               ${CHIBIOS}/os/hal/ports/simulator/console.c \
               ${CHIBIOS}/os/hal/ports/simulator/hal_pal_lld.c \
-              ${CHIBIOS}/os/hal/ports/simulator/hal_st_lld.c
+              ${CHIBIOS}/os/hal/ports/simulator/posix/hal_st_lld.c
 
 # Required include directories
 PLATFORMINC = ${CHIBIOS}/os/hal/ports/simulator/posix \
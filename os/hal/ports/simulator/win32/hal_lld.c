@@ -107,4 +107,12 @@ void _sim_check_for_interrupts(void) {
   }
 }
 
+/**
+ * @brief   Interrupt simulation while idle.
+ */
+void _sim_wait_for_interrupts(void) {
+
+  _sim_check_for_interrupts();
+}
+
 /** @} */
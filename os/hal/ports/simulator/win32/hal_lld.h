@@ -45,6 +45,10 @@
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if PORT_SIM_VIRTUAL_TIME == TRUE
+#error "virtual time mode not supported by the Win32 simulator"
+#endif
+
 /*===========================================================================*/
 /* Driver data structures and types.                                         */
 /*===========================================================================*/
@@ -58,6 +62,7 @@ extern "C" {
 #endif
   void hal_lld_init(void);
   void _sim_check_for_interrupts(void);
+  void _sim_wait_for_interrupts(void);
 #ifdef __cplusplus
 }
 #endif
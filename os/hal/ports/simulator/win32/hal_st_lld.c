@@ -15,8 +15,8 @@
 */
 
 /**
- * @file    hal_st_lld.c
- * @brief   PLATFORM ST subsystem low level driver source.
+ * @file    simulator/win32/hal_st_lld.c
+ * @brief   Win32 simulator ST subsystem low level driver source.
  *
  * @addtogroup ST
  * @{
@@ -15,8 +15,8 @@
 */
 
 /**
- * @file    hal_st_lld.h
- * @brief   PLATFORM ST subsystem low level driver header.
+ * @file    simulator/win32/hal_st_lld.h
+ * @brief   Win32 simulator ST subsystem low level driver header.
  * @details This header is designed to be include-able without having to
  *          include other files from the HAL.
  *
@@ -80,6 +80,7 @@ void ibqObjectInit(input_buffers_queue_t *ibqp, bool suspended, uint8_t *bp,
 
   osalThreadQueueObjectInit(&ibqp->waiting);
   ibqp->suspended = suspended;
+  ibqp->borrowed  = false;
   ibqp->bcounter  = 0;
   ibqp->brdptr    = bp;
   ibqp->bwrptr    = bp;
@@ -113,6 +114,7 @@ void ibqResetI(input_buffers_queue_t *ibqp) {
   ibqp->bwrptr    = ibqp->buffers;
   ibqp->ptr       = NULL;
   ibqp->top       = NULL;
+  ibqp->borrowed  = false;
   osalThreadDequeueAllI(&ibqp->waiting, MSG_RESET);
 }
 
@@ -416,6 +418,91 @@ size_t ibqReadTimeout(input_buffers_queue_t *ibqp, uint8_t *bp,
   }
 }
 
+/**
+ * @brief   Borrows the data of the current input buffer.
+ * @details The function returns a pointer to the unread data of the current
+ *          buffer, acquiring a new filled buffer if necessary. The data can
+ *          be accessed in place, without copies, until it is returned to
+ *          the queue using @p ibqReturnBuffer().
+ * @note    Only one buffer can be borrowed at time and the queue must not
+ *          be read using other functions while a buffer is borrowed.
+ *
+ * @param[in] ibqp      pointer to the @p input_buffers_queue_t object
+ * @param[out] bpp      pointer to a variable receiving the data pointer
+ * @param[out] np       pointer to a variable receiving the data size
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a buffer has been borrowed.
+ * @retval MSG_TIMEOUT  if the specified time expired.
+ * @retval MSG_RESET    if the queue has been reset or has been put in
+ *                      suspended state.
+ *
+ * @api
+ */
+msg_t ibqBorrowBufferTimeout(input_buffers_queue_t *ibqp, uint8_t **bpp,
+                             size_t *np, sysinterval_t timeout) {
+
+  osalDbgCheck((bpp != NULL) && (np != NULL));
+
+  osalSysLock();
+
+  osalDbgAssert(!ibqp->borrowed, "already borrowed");
+
+  /* This condition indicates that a new buffer must be acquired.*/
+  if (ibqp->ptr == NULL) {
+    msg_t msg;
+
+    msg = ibqGetFullBufferTimeoutS(ibqp, timeout);
+    if (msg != MSG_OK) {
+      osalSysUnlock();
+      return msg;
+    }
+  }
+
+  /* Unread data in the current buffer.*/
+  *bpp = ibqp->ptr;
+  *np  = (size_t)ibqp->top - (size_t)ibqp->ptr;
+  ibqp->borrowed = true;
+
+  osalSysUnlock();
+  return MSG_OK;
+}
+
+/**
+ * @brief   Returns a borrowed input buffer to the queue.
+ * @details The specified amount of data is marked as consumed, if the
+ *          whole buffer has been consumed then it is released in the queue.
+ * @note    If the queue has been reset while the buffer was borrowed then
+ *          the function does nothing.
+ *
+ * @param[in] ibqp      pointer to the @p input_buffers_queue_t object
+ * @param[in] n         number of consumed bytes
+ *
+ * @api
+ */
+void ibqReturnBuffer(input_buffers_queue_t *ibqp, size_t n) {
+
+  osalSysLock();
+
+  if (ibqp->borrowed) {
+    osalDbgCheck(n <= ((size_t)ibqp->top - (size_t)ibqp->ptr));
+
+    ibqp->borrowed = false;
+    ibqp->ptr += n;
+
+    /* Has the current data buffer been finished? if so then release it.*/
+    if (ibqp->ptr >= ibqp->top) {
+      ibqReleaseEmptyBufferS(ibqp);
+    }
+  }
+
+  osalSysUnlock();
+}
+
 /**
  * @brief   Initializes an output buffers queue object.
  *
@@ -436,6 +523,7 @@ void obqObjectInit(output_buffers_queue_t *obqp, bool suspended, uint8_t *bp,
 
   osalThreadQueueObjectInit(&obqp->waiting);
   obqp->suspended = suspended;
+  obqp->borrowed  = false;
   obqp->bcounter  = n;
   obqp->brdptr    = bp;
   obqp->bwrptr    = bp;
@@ -445,6 +533,9 @@ void obqObjectInit(output_buffers_queue_t *obqp, bool suspended, uint8_t *bp,
   obqp->buffers   = bp;
   obqp->ptr       = NULL;
   obqp->top       = NULL;
+  obqp->cthreshold = (size_t)0;
+  obqp->clatency  = (sysinterval_t)0;
+  obqp->ctime     = (systime_t)0;
   obqp->notify    = onfy;
   obqp->link      = link;
 }
@@ -469,6 +560,7 @@ void obqResetI(output_buffers_queue_t *obqp) {
   obqp->bwrptr    = obqp->buffers;
   obqp->ptr       = NULL;
   obqp->top       = NULL;
+  obqp->borrowed  = false;
   osalThreadDequeueAllI(&obqp->waiting, MSG_RESET);
 }
 
@@ -595,6 +687,9 @@ msg_t obqGetEmptyBufferTimeoutS(output_buffers_queue_t *obqp,
   obqp->ptr = obqp->bwrptr + sizeof (size_t);
   obqp->top = obqp->bwrptr + obqp->bsize;
 
+  /* Start of the coalescing time window.*/
+  obqp->ctime = osalOsGetSystemTimeX();
+
   return MSG_OK;
 }
 
@@ -779,11 +874,103 @@ size_t obqWriteTimeout(output_buffers_queue_t *obqp, const uint8_t *bp,
   }
 }
 
+/**
+ * @brief   Borrows the free space of the current output buffer.
+ * @details The function returns a pointer to the free space of the current
+ *          buffer, acquiring a new empty buffer if necessary. The space can
+ *          be filled in place, without copies, then the written data is
+ *          committed to the queue using @p obqReturnBuffer().
+ * @note    Only one buffer can be borrowed at time and the queue must not
+ *          be written using other functions while a buffer is borrowed.
+ * @note    A borrowed buffer is never flushed by @p obqTryFlushI().
+ *
+ * @param[in] obqp      pointer to the @p output_buffers_queue_t object
+ * @param[out] bpp      pointer to a variable receiving the space pointer
+ * @param[out] np       pointer to a variable receiving the space size
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a buffer has been borrowed.
+ * @retval MSG_TIMEOUT  if the specified time expired.
+ * @retval MSG_RESET    if the queue has been reset or has been put in
+ *                      suspended state.
+ *
+ * @api
+ */
+msg_t obqBorrowBufferTimeout(output_buffers_queue_t *obqp, uint8_t **bpp,
+                             size_t *np, sysinterval_t timeout) {
+
+  osalDbgCheck((bpp != NULL) && (np != NULL));
+
+  osalSysLock();
+
+  osalDbgAssert(!obqp->borrowed, "already borrowed");
+
+  /* This condition indicates that a new buffer must be acquired.*/
+  if (obqp->ptr == NULL) {
+    msg_t msg;
+
+    msg = obqGetEmptyBufferTimeoutS(obqp, timeout);
+    if (msg != MSG_OK) {
+      osalSysUnlock();
+      return msg;
+    }
+  }
+
+  /* Free space in the current buffer.*/
+  *bpp = obqp->ptr;
+  *np  = (size_t)obqp->top - (size_t)obqp->ptr;
+  obqp->borrowed = true;
+
+  osalSysUnlock();
+  return MSG_OK;
+}
+
+/**
+ * @brief   Returns a borrowed output buffer to the queue.
+ * @details The specified amount of data is committed to the buffer, if the
+ *          buffer has been completely filled then it is posted in the queue.
+ *          A partially filled buffer is posted by the normal flush
+ *          mechanisms.
+ * @note    If the queue has been reset while the buffer was borrowed then
+ *          the written data is discarded.
+ *
+ * @param[in] obqp      pointer to the @p output_buffers_queue_t object
+ * @param[in] n         number of written bytes
+ *
+ * @api
+ */
+void obqReturnBuffer(output_buffers_queue_t *obqp, size_t n) {
+
+  osalSysLock();
+
+  if (obqp->borrowed) {
+    osalDbgCheck(n <= ((size_t)obqp->top - (size_t)obqp->ptr));
+
+    obqp->borrowed = false;
+    obqp->ptr += n;
+
+    /* If the current buffer has been fully written then it is posted as
+       full in the queue.*/
+    if (obqp->ptr >= obqp->top) {
+      obqPostFullBufferS(obqp, obqp->bsize - sizeof (size_t));
+    }
+  }
+
+  osalSysUnlock();
+}
+
 /**
  * @brief   Flushes the current, partially filled, buffer to the queue.
  * @note    The notification callback is not invoked because the function
  *          is meant to be called from ISR context. An operation status is
  *          returned instead.
+ * @note    If coalescing is enabled then the buffer is posted only if it
+ *          contains at least the configured threshold of bytes or if the
+ *          configured maximum latency expired since its acquisition.
  *
  * @param[in] obqp      pointer to the @p output_buffers_queue_t object
  * @return              The operation status.
@@ -798,11 +985,19 @@ bool obqTryFlushI(output_buffers_queue_t *obqp) {
 
   /* If queue is empty and there is a buffer partially filled and
      it is not being written.*/
-  if (obqIsEmptyI(obqp) && (obqp->ptr != NULL)) {
+  if (obqIsEmptyI(obqp) && (obqp->ptr != NULL) && !obqp->borrowed) {
     size_t size = (size_t)obqp->ptr - ((size_t)obqp->bwrptr + sizeof (size_t));
 
     if (size > 0U) {
 
+      /* Coalescing policy, small buffers are held back until the threshold
+         is reached or the maximum latency expired.*/
+      if ((size < obqp->cthreshold) &&
+          (osalTimeDiffX(obqp->ctime, osalOsGetSystemTimeX()) <
+           obqp->clatency)) {
+        return false;
+      }
+
       /* Writing size field in the buffer.*/
       *((size_t *)obqp->bwrptr) = size;
 
@@ -824,6 +1019,7 @@ bool obqTryFlushI(output_buffers_queue_t *obqp) {
 
 /**
  * @brief   Flushes the current, partially filled, buffer to the queue.
+ * @note    The coalescing policy does not apply to explicit flushes.
  *
  * @param[in] obqp      pointer to the @p output_buffers_queue_t object
  *
@@ -834,7 +1030,7 @@ void obqFlush(output_buffers_queue_t *obqp) {
   osalSysLock();
 
   /* If there is a buffer partially filled and not being written.*/
-  if (obqp->ptr != NULL) {
+  if ((obqp->ptr != NULL) && !obqp->borrowed) {
     size_t size = ((size_t)obqp->ptr - (size_t)obqp->bwrptr) - sizeof (size_t);
 
     if (size > 0U) {
@@ -844,4 +1040,35 @@ void obqFlush(output_buffers_queue_t *obqp) {
 
   osalSysUnlock();
 }
+
+/**
+ * @brief   Sets the coalescing policy of an output buffers queue.
+ * @details Partially filled buffers flushed using @p obqTryFlushI() are
+ *          held back until they contain at least @p threshold bytes or
+ *          until @p latency expired since the buffer has been acquired,
+ *          this reduces the number of small transfers performed by
+ *          chatty writers.
+ * @note    Completely filled buffers and explicit flushes using
+ *          @p obqFlush() are not affected.
+ *
+ * @param[in] obqp      pointer to the @p output_buffers_queue_t object
+ * @param[in] threshold minimum size of flushed buffers, zero disables
+ *                      coalescing
+ * @param[in] latency   maximum time a partially filled buffer can be held
+ *                      back, @p TIME_INFINITE means that partial buffers
+ *                      are only flushed explicitly or when the threshold
+ *                      is reached
+ *
+ * @api
+ */
+void obqSetCoalescing(output_buffers_queue_t *obqp, size_t threshold,
+                      sysinterval_t latency) {
+
+  osalDbgCheck(threshold <= (obqp->bsize - sizeof (size_t)));
+
+  osalSysLock();
+  obqp->cthreshold = threshold;
+  obqp->clatency   = latency;
+  osalSysUnlock();
+}
 /** @} */
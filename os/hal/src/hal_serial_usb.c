@@ -256,6 +256,10 @@ void sduStart(SerialUSBDriver *sdup, const SerialUSBConfig *config) {
   sdup->config = config;
   sdup->state = SDU_READY;
   osalSysUnlock();
+
+  /* Output coalescing policy.*/
+  obqSetCoalescing(&sdup->obqueue, config->flush_threshold,
+                   config->flush_latency);
 }
 
 /**
@@ -415,7 +419,8 @@ void sduSOFHookI(SerialUSBDriver *sdup) {
   }
 
   /* Checking if there only a buffer partially filled, if so then it is
-     enforced in the queue and transmitted.*/
+     enforced in the queue and transmitted, small buffers can be held back
+     by the coalescing policy.*/
   if (obqTryFlushI(&sdup->obqueue)) {
     size_t n;
     uint8_t *buf = obqGetFullBufferI(&sdup->obqueue, &n);
@@ -183,6 +183,19 @@
 #include "chconf.h"
 #include "chlicense.h"
 
+/**
+ * @brief   Bitmap scheduler.
+ * @details If enabled then ready threads and threads with an armed timeout
+ *          are tracked using bitmaps, the next thread is selected using a
+ *          find-first-set operation and the timer handler only processes
+ *          threads with an armed timeout when the earliest one expires.
+ * @note    Up to 64 threads are supported in this mode.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_BITMAP_SCHEDULER) || defined(__DOXYGEN__)
+#define CH_CFG_USE_BITMAP_SCHEDULER         FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -329,9 +342,15 @@
 #error "at least one thread must be defined"
 #endif
 
+#if CH_CFG_USE_BITMAP_SCHEDULER == TRUE
+#if CH_CFG_MAX_THREADS > 64
+#error "CH_CFG_MAX_THREADS cannot exceed 64 with the bitmap scheduler"
+#endif
+#else
 #if CH_CFG_MAX_THREADS > 16
 #error "ChibiOS/NIL is not recommended for thread-intensive applications,"  \
-       "consider ChibiOS/RT instead"
+       "consider ChibiOS/RT instead or enable CH_CFG_USE_BITMAP_SCHEDULER"
+#endif
 #endif
 
 #if (CH_CFG_ST_RESOLUTION != 16) && (CH_CFG_ST_RESOLUTION != 32)
@@ -446,6 +465,17 @@ typedef uint16_t sysinterval_t;
 typedef uint32_t time_conv_t;
 #endif
 
+#if (CH_CFG_USE_BITMAP_SCHEDULER == TRUE) || defined(__DOXYGEN__)
+#if (CH_CFG_MAX_THREADS <= 32) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a threads bitmap, one bit for each priority slot.
+ */
+typedef uint32_t nil_bitmap_t;
+#else
+typedef uint64_t nil_bitmap_t;
+#endif
+#endif
+
 /**
  * @brief   Type of a structure representing the system.
  */
@@ -530,8 +560,14 @@ struct nil_thread {
     eventmask_t         ewmask;     /**< @brief Enabled events mask.        */
 #endif
   } u1;
+#if (CH_CFG_USE_BITMAP_SCHEDULER == TRUE) || defined(__DOXYGEN__)
+  systime_t             wakeup;     /**< @brief Timeout time, valid if the
+                                                thread is in the timeouts
+                                                bitmap.                     */
+#else
   volatile sysinterval_t timeout;   /**< @brief Timeout counter, zero
                                                 if disabled.                */
+#endif
 #if (CH_CFG_USE_EVENTS == TRUE) || defined(__DOXYGEN__)
   eventmask_t           epmask;     /**< @brief Pending events mask.        */
 #endif
@@ -577,6 +613,25 @@ struct nil_os_instance {
    */
   systime_t             nexttime;
 #endif
+#if (CH_CFG_USE_BITMAP_SCHEDULER == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Ready threads bitmap.
+   * @note    The idle thread is not part of the bitmap, it is always ready.
+   */
+  nil_bitmap_t          readymap;
+  /**
+   * @brief   Bitmap of threads waiting with a timeout.
+   */
+  nil_bitmap_t          timermap;
+#if (CH_CFG_ST_TIMEDELTA == 0) || defined(__DOXYGEN__)
+  /**
+   * @brief   Earliest timeout time, valid if @p timermap is not zero.
+   * @note    The value can be earlier than the actual earliest timeout if
+   *          threads have been awakened before their timeout.
+   */
+  systime_t             deadline;
+#endif
+#endif
 #if (CH_DBG_SYSTEM_STATE_CHECK == TRUE) || defined(__DOXYGEN__)
   /**
    * @brief   ISR nesting level.
@@ -1235,7 +1290,7 @@ struct nil_os_instance {
  *
  * @iclass
  */
-#define chThdQueueIsEmptyI(tqp) ((bool)(tqp->cnt >= (cnt_t)0))
+#define chThdQueueIsEmptyI(tqp) ((bool)((tqp)->cnt >= (cnt_t)0))
 
 /**
  * @brief   Current system time.
@@ -31,6 +31,14 @@
 /* Module local definitions.                                                 */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_BITMAP_SCHEDULER == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Bitmap mask of a thread.
+ */
+#define NIL_THD_MASK(tp)                                                    \
+  ((nil_bitmap_t)1 << (unsigned)((tp) - &nil.threads[0]))
+#endif
+
 /*===========================================================================*/
 /* Module exported variables.                                                */
 /*===========================================================================*/
@@ -48,6 +56,72 @@ os_instance_t nil;
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_BITMAP_SCHEDULER == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the index of the lowest bit set in a bitmap.
+ * @note    The bitmap must not be zero.
+ *
+ * @param[in] map       the bitmap
+ * @return              The index of the lowest bit set.
+ */
+static inline unsigned nil_bitmap_ffs(nil_bitmap_t map) {
+
+#if defined(__GNUC__)
+#if CH_CFG_MAX_THREADS <= 32
+  return (unsigned)__builtin_ctzl((unsigned long)map);
+#else
+  return (unsigned)__builtin_ctzll((unsigned long long)map);
+#endif
+#else
+  unsigned i = 0U;
+
+  while ((map & (nil_bitmap_t)1) == (nil_bitmap_t)0) {
+    map >>= 1;
+    i++;
+  }
+
+  return i;
+#endif
+}
+
+/**
+ * @brief   Returns the highest priority ready thread.
+ *
+ * @return              Pointer to the thread, the idle thread if there are
+ *                      no other ready threads.
+ */
+static inline thread_t *nil_highest_ready(void) {
+
+  if (nil.readymap == (nil_bitmap_t)0) {
+    return &nil.threads[CH_CFG_MAX_THREADS];
+  }
+
+  return &nil.threads[nil_bitmap_ffs(nil.readymap)];
+}
+
+/**
+ * @brief   Wakes up a thread whose timeout expired.
+ *
+ * @param[in] tp        pointer to the thread
+ */
+static void nil_timeout_expired(thread_t *tp) {
+
+  chDbgAssert(!NIL_THD_IS_READY(tp), "is ready");
+
+  /* Timeout on thread queues requires a special handling because the
+     counter must be incremented.*/
+  if (NIL_THD_IS_WTQUEUE(tp)) {
+    tp->u1.tqp->cnt++;
+  }
+  else {
+    if (NIL_THD_IS_SUSPENDED(tp)) {
+      *tp->u1.trp = NULL;
+    }
+  }
+  (void) chSchReadyI(tp, MSG_TIMEOUT);
+}
+#endif /* CH_CFG_USE_BITMAP_SCHEDULER == TRUE */
+
 /*===========================================================================*/
 /* Module interrupt handlers.                                                */
 /*===========================================================================*/
@@ -356,6 +430,89 @@ void chSysTimerHandlerI(void) {
 
   chDbgCheckClassI();
 
+#if CH_CFG_USE_BITMAP_SCHEDULER == TRUE
+#if CH_CFG_ST_TIMEDELTA == 0
+  systime_t now = ++nil.systime;
+
+  /* Nothing to do until the earliest timeout.*/
+  if ((nil.timermap != (nil_bitmap_t)0) && (now == nil.deadline)) {
+    nil_bitmap_t map = nil.timermap;
+    sysinterval_t next = (sysinterval_t)0;
+
+    /* Only threads with an armed timeout are visited, there is no ordered
+       timeouts list so all of them are scanned in order to find the next
+       deadline.*/
+    do {
+      thread_t *tp = &nil.threads[nil_bitmap_ffs(map)];
+
+      map &= map - (nil_bitmap_t)1;
+
+      /* The thread could have been awakened while the lock was released.*/
+      if ((nil.timermap & NIL_THD_MASK(tp)) != (nil_bitmap_t)0) {
+        if (tp->wakeup == now) {
+          nil_timeout_expired(tp);
+        }
+        else {
+          sysinterval_t timeout = chTimeDiffX(now, tp->wakeup);
+
+          if (timeout <= (sysinterval_t)(next - (sysinterval_t)1)) {
+            next = timeout;
+          }
+        }
+      }
+
+      /* Lock released in order to give a preemption chance on those
+         architectures supporting IRQ preemption.*/
+      chSysUnlockFromISR();
+      chSysLockFromISR();
+    } while (map != (nil_bitmap_t)0);
+
+    nil.deadline = chTimeAddX(now, next);
+  }
+#else
+  nil_bitmap_t map = nil.timermap;
+  sysinterval_t next = (sysinterval_t)0;
+  sysinterval_t elapsed = chTimeDiffX(nil.lasttime, nil.nexttime);
+
+  chDbgAssert(nil.nexttime == port_timer_get_alarm(), "time mismatch");
+
+  /* Only threads with an armed timeout are visited.*/
+  while (map != (nil_bitmap_t)0) {
+    thread_t *tp = &nil.threads[nil_bitmap_ffs(map)];
+
+    map &= map - (nil_bitmap_t)1;
+
+    /* The thread could have been awakened while the lock was released.*/
+    if ((nil.timermap & NIL_THD_MASK(tp)) != (nil_bitmap_t)0) {
+      if (chTimeDiffX(nil.lasttime, tp->wakeup) <= elapsed) {
+        nil_timeout_expired(tp);
+      }
+      else {
+        sysinterval_t timeout = chTimeDiffX(nil.nexttime, tp->wakeup);
+
+        if (timeout <= (sysinterval_t)(next - (sysinterval_t)1)) {
+          next = timeout;
+        }
+      }
+    }
+
+    /* Lock released in order to give a preemption chance on those
+       architectures supporting IRQ preemption.*/
+    chSysUnlockFromISR();
+    chSysLockFromISR();
+  }
+
+  nil.lasttime = nil.nexttime;
+  if (next > (sysinterval_t)0) {
+    nil.nexttime = chTimeAddX(nil.nexttime, next);
+    port_timer_set_alarm(nil.nexttime);
+  }
+  else {
+    /* No tick event needed.*/
+    port_timer_stop_alarm();
+  }
+#endif
+#else /* CH_CFG_USE_BITMAP_SCHEDULER == FALSE */
 #if CH_CFG_ST_TIMEDELTA == 0
   thread_t *tp = &nil.threads[0];
   nil.systime++;
@@ -446,6 +603,7 @@ void chSysTimerHandlerI(void) {
     port_timer_stop_alarm();
   }
 #endif
+#endif /* CH_CFG_USE_BITMAP_SCHEDULER == FALSE */
 }
 
 /**
@@ -587,7 +745,12 @@ thread_t *chSchReadyI(thread_t *tp, msg_t msg) {
 
   tp->u1.msg = msg;
   tp->state = NIL_STATE_READY;
+#if CH_CFG_USE_BITMAP_SCHEDULER == TRUE
+  nil.readymap |= NIL_THD_MASK(tp);
+  nil.timermap &= ~NIL_THD_MASK(tp);
+#else
   tp->timeout = (sysinterval_t)0;
+#endif
   if (tp < nil.next) {
     nil.next = tp;
   }
@@ -670,6 +833,9 @@ msg_t chSchGoSleepTimeoutS(tstate_t newstate, sysinterval_t timeout) {
 
   /* Storing the wait object for the current thread.*/
   otp->state = newstate;
+#if CH_CFG_USE_BITMAP_SCHEDULER == TRUE
+  nil.readymap &= ~NIL_THD_MASK(otp);
+#endif
 
 #if CH_CFG_ST_TIMEDELTA > 0
   if (timeout != TIME_INFINITE) {
@@ -699,7 +865,26 @@ msg_t chSchGoSleepTimeoutS(tstate_t newstate, sysinterval_t timeout) {
     }
 
     /* Timeout settings.*/
+#if CH_CFG_USE_BITMAP_SCHEDULER == TRUE
+    otp->wakeup = abstime;
+    nil.timermap |= NIL_THD_MASK(otp);
+#else
     otp->timeout = abstime - nil.lasttime;
+#endif
+  }
+#elif CH_CFG_USE_BITMAP_SCHEDULER == TRUE
+  if (timeout != TIME_INFINITE) {
+    systime_t abstime = chTimeAddX(nil.systime, timeout);
+
+    /* Updating the earliest timeout.*/
+    if ((nil.timermap == (nil_bitmap_t)0) ||
+        (timeout < chTimeDiffX(nil.systime, nil.deadline))) {
+      nil.deadline = abstime;
+    }
+
+    /* Timeout settings.*/
+    otp->wakeup = abstime;
+    nil.timermap |= NIL_THD_MASK(otp);
   }
 #else
 
@@ -707,6 +892,16 @@ msg_t chSchGoSleepTimeoutS(tstate_t newstate, sysinterval_t timeout) {
   otp->timeout = timeout;
 #endif
 
+#if CH_CFG_USE_BITMAP_SCHEDULER == TRUE
+  /* Highest priority ready thread from the bitmap.*/
+  ntp = nil_highest_ready();
+  nil.current = nil.next = ntp;
+  if (ntp == &nil.threads[CH_CFG_MAX_THREADS]) {
+    CH_CFG_IDLE_ENTER_HOOK();
+  }
+  port_switch(ntp, otp);
+  return nil.current->u1.msg;
+#else
   /* Scanning the whole threads array.*/
   ntp = nil.threads;
   while (true) {
@@ -725,6 +920,7 @@ msg_t chSchGoSleepTimeoutS(tstate_t newstate, sysinterval_t timeout) {
     chDbgAssert(ntp <= &nil.threads[CH_CFG_MAX_THREADS],
                 "pointer out of range");
   }
+#endif
 }
 
 /**
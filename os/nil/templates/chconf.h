@@ -51,6 +51,17 @@
 #define CH_CFG_MAX_THREADS                  4
 #endif
 
+/**
+ * @brief   Bitmap scheduler.
+ * @details If enabled then the next ready thread is found using a bitmap
+ *          and the timer handler only processes expiring timeouts, up to
+ *          64 threads are supported in this mode.
+ * @note    The legacy mode supports up to 16 threads and is more compact.
+ */
+#if !defined(CH_CFG_USE_BITMAP_SCHEDULER)
+#define CH_CFG_USE_BITMAP_SCHEDULER         FALSE
+#endif
+
 /**
  * @brief   Auto starts threads when @p chSysInit() is invoked.
  */
@@ -206,6 +217,19 @@
 #define CH_CFG_MEMCORE_SIZE                 0
 #endif
 
+/**
+ * @brief   Memory regions APIs.
+ * @details If enabled then additional memory regions with attributes can
+ *          be registered, blocks can be placed in the regions directly or
+ *          through placement hints by the core allocator, heaps and pools.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMCORE.
+ */
+#if !defined(CH_CFG_USE_MEMCORE_REGIONS)
+#define CH_CFG_USE_MEMCORE_REGIONS          FALSE
+#endif
+
 /**
  * @brief   Heap Allocator APIs.
  * @details If enabled then the memory heap allocator APIs are included
@@ -228,6 +252,17 @@
 #define CH_CFG_USE_MEMPOOLS                 TRUE
 #endif
 
+/**
+ * @brief   Memory Arenas Allocator APIs.
+ * @details If enabled then the memory arenas allocator APIs are included
+ *          in the kernel.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_ARENAS)
+#define CH_CFG_USE_ARENAS                   FALSE
+#endif
+
 /**
  * @brief  Objects FIFOs APIs.
  * @details If enabled then the objects FIFOs APIs are included
@@ -312,6 +347,16 @@
 #define CH_CFG_FACTORY_MAX_NAMES_LENGTH     8
 #endif
 
+/**
+ * @brief   Size of the names hash index of each factory list.
+ * @details If greater than zero then lookups by name use a hash table
+ *          instead of scanning the objects list.
+ * @note    The value must be zero or a power of two.
+ */
+#if !defined(CH_CFG_FACTORY_HASH_SIZE)
+#define CH_CFG_FACTORY_HASH_SIZE            0
+#endif
+
 /**
  * @brief   Enables the registry of generic objects.
  */
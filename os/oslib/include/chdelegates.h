@@ -38,6 +38,17 @@
 /* Module constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @name    Delegate future states
+ * @{
+ */
+#define CH_DELEGATE_FUTURE_IDLE             0U
+#define CH_DELEGATE_FUTURE_PENDING          1U
+#define CH_DELEGATE_FUTURE_RUNNING          2U
+#define CH_DELEGATE_FUTURE_DONE             3U
+#define CH_DELEGATE_FUTURE_CALLBACK         4U
+/** @} */
+
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -84,10 +95,111 @@ typedef msg_t (*delegate_fn3_t)(msg_t p1, msg_t p2, msg_t p3);
  */
 typedef msg_t (*delegate_fn4_t)(msg_t p1, msg_t p2, msg_t p3, msg_t p4);
 
+/**
+ * @brief   Type of a delegate function with any number of parameters.
+ */
+typedef union {
+  delegate_fn0_t        fn0;
+  delegate_fn1_t        fn1;
+  delegate_fn2_t        fn2;
+  delegate_fn3_t        fn3;
+  delegate_fn4_t        fn4;
+} delegate_func_t;
+
+/**
+ * @brief   Type of a delegate future object.
+ */
+typedef struct ch_delegate_future delegate_future_t;
+
+/**
+ * @brief   Type of a delegate completion callback.
+ * @note    The callback is invoked by the dispatcher thread after the
+ *          function returned, the result is already available in the
+ *          future object. The callback can post the same future again
+ *          in order to chain another call, the future is completed and
+ *          waiting threads are resumed after the last call of the chain.
+ */
+typedef void (*delegate_callback_t)(delegate_future_t *fp);
+
+/**
+ * @brief   Structure representing an asynchronous delegate call.
+ */
+struct ch_delegate_future {
+  /**
+   * @brief   Next call in the queue.
+   */
+  delegate_future_t     *next;
+  /**
+   * @brief   Function to be called.
+   */
+  delegate_func_t       func;
+  /**
+   * @brief   Number of parameters.
+   */
+  unsigned              argsn;
+  /**
+   * @brief   Call parameters.
+   */
+  msg_t                 args[4];
+  /**
+   * @brief   Call state.
+   */
+  volatile unsigned     state;
+  /**
+   * @brief   Function return value.
+   */
+  msg_t                 result;
+  /**
+   * @brief   Thread waiting for the call completion.
+   */
+  thread_reference_t    waiter;
+  /**
+   * @brief   Completion callback or @p NULL.
+   */
+  delegate_callback_t   callback;
+};
+
+/**
+ * @brief   Structure representing a queue of asynchronous delegate calls.
+ */
+typedef struct {
+  /**
+   * @brief   First call in the queue.
+   */
+  delegate_future_t     *head;
+  /**
+   * @brief   Last call in the queue.
+   */
+  delegate_future_t     *tail;
+  /**
+   * @brief   Dispatcher thread waiting for calls.
+   */
+  thread_reference_t    dispatcher;
+} delegates_queue_t;
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
 
+/**
+ * @brief   Data part of a static delegates queue initializer.
+ * @details This macro should be used when statically initializing a
+ *          delegates queue that is part of a bigger structure.
+ *
+ * @param[in] name      the name of the delegates queue variable
+ */
+#define __DELEGATES_QUEUE_DATA(name) {NULL, NULL, NULL}
+
+/**
+ * @brief   Static delegates queue initializer.
+ * @details Statically initialized delegates queues require no explicit
+ *          initialization using @p chDelegateQueueObjectInit().
+ *
+ * @param[in] name      the name of the delegates queue variable
+ */
+#define DELEGATES_QUEUE_DECL(name)                                          \
+  delegates_queue_t name = __DELEGATES_QUEUE_DATA(name)
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -103,6 +215,19 @@ extern "C" {
   void chDelegateDispatch(void);
   msg_t chDelegateDispatchTimeout(sysinterval_t timeout);
   msg_t chDelegateCallVeneer(thread_t *tp, delegate_veneer_t veneer, ...);
+  void chDelegateQueueObjectInit(delegates_queue_t *dqp);
+  void chDelegateFutureObjectInit(delegate_future_t *fp,
+                                  delegate_callback_t callback);
+  msg_t chDelegatePostI(delegates_queue_t *dqp, delegate_future_t *fp,
+                        delegate_func_t func, unsigned argsn,
+                        const msg_t *argsp);
+  msg_t chDelegatePost(delegates_queue_t *dqp, delegate_future_t *fp,
+                       delegate_func_t func, unsigned argsn,
+                       const msg_t *argsp);
+  msg_t chDelegateFutureWaitTimeout(delegate_future_t *fp,
+                                    sysinterval_t timeout);
+  unsigned chDelegateDispatchQueueTimeout(delegates_queue_t *dqp,
+                                          sysinterval_t timeout);
 #ifdef __cplusplus
 }
 #endif
@@ -201,6 +326,213 @@ static inline msg_t chDelegateCallDirect4(thread_t *tp, delegate_fn4_t func,
   return chDelegateCallVeneer(tp, __ch_delegate_fn4, func, p1, p2, p3, p4);
 }
 
+/**
+ * @brief   Asynchronous call to a function with no parameters.
+ * @details The call is queued and the function returns immediately, the
+ *          outcome is retrieved using the future object.
+ *
+ * @param[in] dqp       pointer to the delegates queue
+ * @param[in] fp        pointer to the future object
+ * @param[in] func      pointer to the function to be called
+ * @return              The operation status.
+ * @retval MSG_OK       if the call has been queued.
+ * @retval MSG_RESET    if the future object is busy with another call,
+ *                      the call has not been queued.
+ *
+ * @api
+ */
+static inline msg_t chDelegateCallAsync0(delegates_queue_t *dqp,
+                                         delegate_future_t *fp,
+                                         delegate_fn0_t func) {
+  delegate_func_t f;
+
+  f.fn0 = func;
+  return chDelegatePost(dqp, fp, f, 0U, NULL);
+}
+
+/**
+ * @brief   Asynchronous call to a function with one parameter.
+ * @details The call is queued and the function returns immediately, the
+ *          outcome is retrieved using the future object.
+ *
+ * @param[in] dqp       pointer to the delegates queue
+ * @param[in] fp        pointer to the future object
+ * @param[in] func      pointer to the function to be called
+ * @param[in] p1        parameter 1 passed as a @p msg_t
+ * @return              The operation status.
+ * @retval MSG_OK       if the call has been queued.
+ * @retval MSG_RESET    if the future object is busy with another call,
+ *                      the call has not been queued.
+ *
+ * @api
+ */
+static inline msg_t chDelegateCallAsync1(delegates_queue_t *dqp,
+                                         delegate_future_t *fp,
+                                         delegate_fn1_t func,
+                                         msg_t p1) {
+  delegate_func_t f;
+  msg_t args[1];
+
+  f.fn1   = func;
+  args[0] = p1;
+  return chDelegatePost(dqp, fp, f, 1U, args);
+}
+
+/**
+ * @brief   Asynchronous call to a function with two parameters.
+ * @details The call is queued and the function returns immediately, the
+ *          outcome is retrieved using the future object.
+ *
+ * @param[in] dqp       pointer to the delegates queue
+ * @param[in] fp        pointer to the future object
+ * @param[in] func      pointer to the function to be called
+ * @param[in] p1        parameter 1 passed as a @p msg_t
+ * @param[in] p2        parameter 2 passed as a @p msg_t
+ * @return              The operation status.
+ * @retval MSG_OK       if the call has been queued.
+ * @retval MSG_RESET    if the future object is busy with another call,
+ *                      the call has not been queued.
+ *
+ * @api
+ */
+static inline msg_t chDelegateCallAsync2(delegates_queue_t *dqp,
+                                         delegate_future_t *fp,
+                                         delegate_fn2_t func,
+                                         msg_t p1, msg_t p2) {
+  delegate_func_t f;
+  msg_t args[2];
+
+  f.fn2   = func;
+  args[0] = p1;
+  args[1] = p2;
+  return chDelegatePost(dqp, fp, f, 2U, args);
+}
+
+/**
+ * @brief   Asynchronous call to a function with three parameters.
+ * @details The call is queued and the function returns immediately, the
+ *          outcome is retrieved using the future object.
+ *
+ * @param[in] dqp       pointer to the delegates queue
+ * @param[in] fp        pointer to the future object
+ * @param[in] func      pointer to the function to be called
+ * @param[in] p1        parameter 1 passed as a @p msg_t
+ * @param[in] p2        parameter 2 passed as a @p msg_t
+ * @param[in] p3        parameter 3 passed as a @p msg_t
+ * @return              The operation status.
+ * @retval MSG_OK       if the call has been queued.
+ * @retval MSG_RESET    if the future object is busy with another call,
+ *                      the call has not been queued.
+ *
+ * @api
+ */
+static inline msg_t chDelegateCallAsync3(delegates_queue_t *dqp,
+                                         delegate_future_t *fp,
+                                         delegate_fn3_t func,
+                                         msg_t p1, msg_t p2, msg_t p3) {
+  delegate_func_t f;
+  msg_t args[3];
+
+  f.fn3   = func;
+  args[0] = p1;
+  args[1] = p2;
+  args[2] = p3;
+  return chDelegatePost(dqp, fp, f, 3U, args);
+}
+
+/**
+ * @brief   Asynchronous call to a function with four parameters.
+ * @details The call is queued and the function returns immediately, the
+ *          outcome is retrieved using the future object.
+ *
+ * @param[in] dqp       pointer to the delegates queue
+ * @param[in] fp        pointer to the future object
+ * @param[in] func      pointer to the function to be called
+ * @param[in] p1        parameter 1 passed as a @p msg_t
+ * @param[in] p2        parameter 2 passed as a @p msg_t
+ * @param[in] p3        parameter 3 passed as a @p msg_t
+ * @param[in] p4        parameter 4 passed as a @p msg_t
+ * @return              The operation status.
+ * @retval MSG_OK       if the call has been queued.
+ * @retval MSG_RESET    if the future object is busy with another call,
+ *                      the call has not been queued.
+ *
+ * @api
+ */
+static inline msg_t chDelegateCallAsync4(delegates_queue_t *dqp,
+                                         delegate_future_t *fp,
+                                         delegate_fn4_t func,
+                                         msg_t p1, msg_t p2, msg_t p3,
+                                         msg_t p4) {
+  delegate_func_t f;
+  msg_t args[4];
+
+  f.fn4   = func;
+  args[0] = p1;
+  args[1] = p2;
+  args[2] = p3;
+  args[3] = p4;
+  return chDelegatePost(dqp, fp, f, 4U, args);
+}
+
+/**
+ * @brief   Returns @p true if the call has been completed.
+ * @note    This function can be used to poll a future without blocking.
+ *
+ * @param[in] fp        pointer to the future object
+ * @return              The completion state.
+ *
+ * @xclass
+ */
+static inline bool chDelegateFutureIsDoneX(delegate_future_t *fp) {
+
+  return (bool)(fp->state == CH_DELEGATE_FUTURE_DONE);
+}
+
+/**
+ * @brief   Returns the return value of a completed call.
+ * @pre     The call must have been completed.
+ *
+ * @param[in] fp        pointer to the future object
+ * @return              The function return value as a @p msg_t.
+ *
+ * @xclass
+ */
+static inline msg_t chDelegateFutureGetResultX(delegate_future_t *fp) {
+
+  return fp->result;
+}
+
+/**
+ * @brief   Waits for the completion of a call.
+ *
+ * @param[in] fp        pointer to the future object
+ * @return              The function return value as a @p msg_t.
+ *
+ * @api
+ */
+static inline msg_t chDelegateFutureWait(delegate_future_t *fp) {
+
+  (void) chDelegateFutureWaitTimeout(fp, TIME_INFINITE);
+
+  return fp->result;
+}
+
+/**
+ * @brief   Asynchronous calls dispatching.
+ * @details The function awaits for queued calls and executes all of them,
+ *          then it returns.
+ *
+ * @param[in] dqp       pointer to the delegates queue
+ * @return              The number of executed calls.
+ *
+ * @api
+ */
+static inline unsigned chDelegateDispatchQueue(delegates_queue_t *dqp) {
+
+  return chDelegateDispatchQueueTimeout(dqp, TIME_INFINITE);
+}
+
 #endif /* CH_CFG_USE_DELEGATES == TRUE */
 
 #endif /* CHDELEGATES_H */
@@ -47,6 +47,17 @@
 #define CH_CFG_FACTORY_MAX_NAMES_LENGTH     8
 #endif
 
+/**
+ * @brief   Size of the names hash index of each factory list.
+ * @details If greater than zero then the objects of each factory list are
+ *          also linked in a hash table indexed by name, lookups by name do
+ *          not need to scan the whole list.
+ * @note    The value must be zero or a power of two.
+ */
+#if !defined(CH_CFG_FACTORY_HASH_SIZE) || defined(__DOXYGEN__)
+#define CH_CFG_FACTORY_HASH_SIZE            0
+#endif
+
 /**
  * @brief   Enables the registry of generic objects.
  */
@@ -143,6 +154,11 @@
 #error "invalid CH_CFG_FACTORY_MAX_NAMES_LENGTH value"
 #endif
 
+#if (CH_CFG_FACTORY_HASH_SIZE < 0) ||                                       \
+    ((CH_CFG_FACTORY_HASH_SIZE & (CH_CFG_FACTORY_HASH_SIZE - 1)) != 0)
+#error "CH_CFG_FACTORY_HASH_SIZE must be zero or a power of two"
+#endif
+
 #if (CH_CFG_USE_MUTEXES == FALSE) && (CH_CFG_USE_SEMAPHORES == FALSE)
 #error "CH_CFG_USE_FACTORY requires CH_CFG_USE_MUTEXES and/or CH_CFG_USE_SEMAPHORES"
 #endif
@@ -171,6 +187,12 @@ typedef struct ch_dyn_element {
    * @brief   Next dynamic object in the list.
    */
   struct ch_dyn_element *next;
+#if (CH_CFG_FACTORY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+  /**
+   * @brief   Next dynamic object in the hash chain.
+   */
+  struct ch_dyn_element *hash_next;
+#endif
   /**
    * @brief   Number of references to this object.
    */
@@ -187,6 +209,12 @@ typedef struct ch_dyn_element {
  */
 typedef struct ch_dyn_list {
     dyn_element_t       *next;
+#if (CH_CFG_FACTORY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+    /**
+     * @brief   Hash chains headers.
+     */
+    dyn_element_t       *hash[CH_CFG_FACTORY_HASH_SIZE];
+#endif
 } dyn_list_t;
 
 #if (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE) || defined(__DOXYGEN__)
@@ -230,6 +230,7 @@
 #include "chmemcore.h"
 #include "chmemheaps.h"
 #include "chmempools.h"
+#include "chmemarenas.h"
 #include "chobjfifos.h"
 #include "chpipes.h"
 #include "chobjcaches.h"
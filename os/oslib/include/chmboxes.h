@@ -62,6 +62,22 @@ typedef struct {
   threads_queue_t       qr;             /**< @brief Queued readers.         */
 } mailbox_t;
 
+/**
+ * @brief   Structure representing a single producer single consumer
+ *          mailbox object.
+ */
+typedef struct {
+  volatile msg_t        *buffer;        /**< @brief Pointer to the mailbox
+                                                    buffer.                 */
+  size_t                mask;           /**< @brief Buffer size minus one.  */
+  volatile size_t       wridx;          /**< @brief Write index, free
+                                                    running.                */
+  volatile size_t       rdidx;          /**< @brief Read index, free
+                                                    running.                */
+  thread_reference_t    writer;         /**< @brief Waiting producer.       */
+  thread_reference_t    reader;         /**< @brief Waiting consumer.       */
+} spsc_mailbox_t;
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
@@ -98,6 +114,38 @@ typedef struct {
 #define MAILBOX_DECL(name, buffer, size)                                    \
   mailbox_t name = __MAILBOX_DATA(name, buffer, size)
 
+/**
+ * @brief   Data part of a static SPSC mailbox initializer.
+ * @details This macro should be used when statically initializing a
+ *          SPSC mailbox that is part of a bigger structure.
+ *
+ * @param[in] name      the name of the SPSC mailbox variable
+ * @param[in] buffer    pointer to the mailbox buffer array of @p msg_t
+ * @param[in] size      number of @p msg_t elements in the buffer array,
+ *                      it must be a power of two
+ */
+#define __SPSC_MAILBOX_DATA(name, buffer, size) {                           \
+  (msg_t *)(buffer),                                                        \
+  (size_t)(size) - (size_t)1,                                               \
+  (size_t)0,                                                                \
+  (size_t)0,                                                                \
+  NULL,                                                                     \
+  NULL                                                                      \
+}
+
+/**
+ * @brief   Static SPSC mailbox initializer.
+ * @details Statically initialized SPSC mailboxes require no explicit
+ *          initialization using @p chSpscMBObjectInit().
+ *
+ * @param[in] name      the name of the SPSC mailbox variable
+ * @param[in] buffer    pointer to the mailbox buffer array of @p msg_t
+ * @param[in] size      number of @p msg_t elements in the buffer array,
+ *                      it must be a power of two
+ */
+#define SPSC_MAILBOX_DECL(name, buffer, size)                               \
+  spsc_mailbox_t name = __SPSC_MAILBOX_DATA(name, buffer, size)
+
 /*===========================================================================*/
 /* External declarations.                                                    */
 /*===========================================================================*/
@@ -117,6 +165,23 @@ extern "C" {
   msg_t chMBFetchTimeout(mailbox_t *mbp, msg_t *msgp, sysinterval_t timeout);
   msg_t chMBFetchTimeoutS(mailbox_t *mbp, msg_t *msgp, sysinterval_t timeout);
   msg_t chMBFetchI(mailbox_t *mbp, msg_t *msgp);
+  size_t chMBPostBatchTimeout(mailbox_t *mbp, const msg_t *msgs, size_t n,
+                              sysinterval_t timeout);
+  size_t chMBPostBatchTimeoutS(mailbox_t *mbp, const msg_t *msgs, size_t n,
+                               sysinterval_t timeout);
+  size_t chMBPostBatchI(mailbox_t *mbp, const msg_t *msgs, size_t n);
+  size_t chMBFetchBatchTimeout(mailbox_t *mbp, msg_t *msgs, size_t n,
+                               sysinterval_t timeout);
+  size_t chMBFetchBatchTimeoutS(mailbox_t *mbp, msg_t *msgs, size_t n,
+                                sysinterval_t timeout);
+  size_t chMBFetchBatchI(mailbox_t *mbp, msg_t *msgs, size_t n);
+  void chSpscMBObjectInit(spsc_mailbox_t *smbp, msg_t *buf, size_t n);
+  msg_t chSpscMBPostTimeout(spsc_mailbox_t *smbp, msg_t msg,
+                            sysinterval_t timeout);
+  msg_t chSpscMBPostI(spsc_mailbox_t *smbp, msg_t msg);
+  msg_t chSpscMBFetchTimeout(spsc_mailbox_t *smbp, msg_t *msgp,
+                             sysinterval_t timeout);
+  msg_t chSpscMBFetchI(spsc_mailbox_t *smbp, msg_t *msgp);
 #ifdef __cplusplus
 }
 #endif
@@ -202,6 +267,34 @@ static inline void chMBResumeX(mailbox_t *mbp) {
   mbp->reset = false;
 }
 
+/**
+ * @brief   Returns the SPSC mailbox buffer size as number of messages.
+ *
+ * @param[in] smbp      the pointer to an initialized @p spsc_mailbox_t object
+ * @return              The size of the mailbox.
+ *
+ * @xclass
+ */
+static inline size_t chSpscMBGetSizeX(const spsc_mailbox_t *smbp) {
+
+  return smbp->mask + (size_t)1;
+}
+
+/**
+ * @brief   Returns the number of used message slots into a SPSC mailbox.
+ * @note    The value is only a snapshot if called outside the producer or
+ *          consumer context.
+ *
+ * @param[in] smbp      the pointer to an initialized @p spsc_mailbox_t object
+ * @return              The number of queued messages.
+ *
+ * @xclass
+ */
+static inline size_t chSpscMBGetUsedCountX(const spsc_mailbox_t *smbp) {
+
+  return smbp->wridx - smbp->rdidx;
+}
+
 #endif /* CH_CFG_USE_MAILBOXES == TRUE */
 
 #endif /* CHMBOXES_H */
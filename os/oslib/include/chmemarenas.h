@@ -0,0 +1,213 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    oslib/include/chmemarenas.h
+ * @brief   Memory Arenas macros and structures.
+ *
+ * @addtogroup oslib_memarenas
+ * @{
+ */
+
+#ifndef CHMEMARENAS_H
+#define CHMEMARENAS_H
+
+#if !defined(CH_CFG_USE_ARENAS) || defined(__DOXYGEN__)
+#define CH_CFG_USE_ARENAS                   FALSE
+#endif
+
+#if (CH_CFG_USE_ARENAS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of an arena allocation mark.
+ */
+typedef uint8_t *arena_mark_t;
+
+/**
+ * @brief   Structure representing a memory arena.
+ */
+typedef struct {
+  /**
+   * @brief   Arena buffer base.
+   */
+  uint8_t                   *base;
+  /**
+   * @brief   Next free address.
+   */
+  uint8_t                   *next;
+  /**
+   * @brief   Arena buffer end.
+   */
+  uint8_t                   *top;
+  /**
+   * @brief   Heap block containing the arena buffer or @p NULL.
+   */
+  void                      *block;
+  /**
+   * @brief   Maximum used size.
+   */
+  size_t                    peak;
+  /**
+   * @brief   Number of successful allocations.
+   */
+  uint32_t                  allocations;
+  /**
+   * @brief   Number of failed allocations.
+   */
+  uint32_t                  failures;
+} memory_arena_t;
+
+/**
+ * @brief   Type of an arena status.
+ */
+typedef struct {
+  /**
+   * @brief   Arena size.
+   */
+  size_t                    size;
+  /**
+   * @brief   Currently used size.
+   */
+  size_t                    used;
+  /**
+   * @brief   Maximum used size.
+   */
+  size_t                    peak;
+  /**
+   * @brief   Number of successful allocations.
+   */
+  uint32_t                  allocations;
+  /**
+   * @brief   Number of failed allocations.
+   */
+  uint32_t                  failures;
+} arena_status_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void chArenaObjectInit(memory_arena_t *ap, void *buf, size_t size);
+#if CH_CFG_USE_MEMCORE == TRUE
+  bool chArenaObjectInitFromCore(memory_arena_t *ap, size_t size);
+#endif
+#if CH_CFG_USE_HEAP == TRUE
+  bool chArenaObjectInitFromHeap(memory_arena_t *ap,
+                                 memory_heap_t *heapp,
+                                 size_t size);
+  void chArenaDispose(memory_arena_t *ap);
+#endif
+  void *chArenaAllocAligned(memory_arena_t *ap, size_t size, unsigned align);
+  void chArenaGetStatus(const memory_arena_t *ap, arena_status_t *asp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+/**
+ * @brief   Allocates a block from an arena.
+ * @details The allocated block is guaranteed to be properly aligned for a
+ *          pointer data type.
+ *
+ * @param[in] ap        pointer to a @p memory_arena_t structure
+ * @param[in] size      the size of the block to be allocated
+ * @return              A pointer to the allocated block.
+ * @retval NULL         if the arena is exhausted.
+ *
+ * @api
+ */
+static inline void *chArenaAlloc(memory_arena_t *ap, size_t size) {
+
+  return chArenaAllocAligned(ap, size, PORT_NATURAL_ALIGN);
+}
+
+/**
+ * @brief   Returns a mark of the current arena position.
+ * @details All the blocks allocated after taking the mark can be released
+ *          at once using @p chArenaRelease(), marks can be nested.
+ *
+ * @param[in] ap        pointer to a @p memory_arena_t structure
+ * @return              The arena mark.
+ *
+ * @api
+ */
+static inline arena_mark_t chArenaGetMark(const memory_arena_t *ap) {
+
+  return ap->next;
+}
+
+/**
+ * @brief   Releases all the blocks allocated after a mark.
+ * @note    Marks taken after @p mark become invalid.
+ *
+ * @param[in] ap        pointer to a @p memory_arena_t structure
+ * @param[in] mark      a mark previously returned by @p chArenaGetMark()
+ *
+ * @api
+ */
+static inline void chArenaRelease(memory_arena_t *ap, arena_mark_t mark) {
+
+  chDbgCheck((mark >= ap->base) && (mark <= ap->next));
+
+  ap->next = mark;
+}
+
+/**
+ * @brief   Releases all the blocks allocated from an arena.
+ *
+ * @param[in] ap        pointer to a @p memory_arena_t structure
+ *
+ * @api
+ */
+static inline void chArenaReset(memory_arena_t *ap) {
+
+  ap->next = ap->base;
+}
+
+#endif /* CH_CFG_USE_ARENAS == TRUE */
+
+#endif /* CHMEMARENAS_H */
+
+/** @} */
@@ -34,6 +34,41 @@
 /* Module constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @name    Memory region attributes
+ * @{
+ */
+/**
+ * @brief   Fast memory, zero wait states RAM like TCM or CCM.
+ */
+#define CH_MEM_ATTR_FAST                    (1U << 0)
+/**
+ * @brief   Memory reachable by the DMA controllers.
+ */
+#define CH_MEM_ATTR_DMA                     (1U << 1)
+/**
+ * @brief   Memory not cached by the data cache.
+ */
+#define CH_MEM_ATTR_NOCACHE                 (1U << 2)
+/** @} */
+
+/**
+ * @name    Memory placement hints
+ * @{
+ */
+/**
+ * @brief   Allocation from the default core memory.
+ */
+#define CH_MEM_HINT_DEFAULT                 0U
+/**
+ * @brief   Falls back on the default core memory.
+ * @details If no region with the required attributes can satisfy the
+ *          request then the block is allocated from the default core
+ *          memory, without this flag the allocation fails.
+ */
+#define CH_MEM_HINT_FALLBACK                (1U << 31)
+/** @} */
+
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -53,6 +88,18 @@
 #define CH_CFG_MEMCORE_SIZE                 0
 #endif
 
+/**
+ * @brief   Memory regions APIs.
+ * @details If enabled then additional memory regions with attributes can
+ *          be registered, blocks can be placed in the regions directly or
+ *          through placement hints by the core allocator, heaps and pools.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_MEMCORE_REGIONS) || defined(__DOXYGEN__)
+#define CH_CFG_USE_MEMCORE_REGIONS          FALSE
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -89,6 +136,47 @@ typedef struct {
   uint8_t *topmem;
 } memcore_t;
 
+/**
+ * @brief   Type of memory attributes and placement hints.
+ */
+typedef uint32_t memattr_t;
+
+#if (CH_CFG_USE_MEMCORE_REGIONS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Type of a memory region.
+ */
+typedef struct memregion memregion_t;
+
+/**
+ * @brief   Structure representing a memory region.
+ * @details A region is an additional memory bank managed like the core
+ *          memory, blocks are allocated from the lowest address upward and
+ *          are never freed.
+ */
+struct memregion {
+  /**
+   * @brief   Next region in the regions list.
+   */
+  memregion_t               *next;
+  /**
+   * @brief   Region name.
+   */
+  const char                *name;
+  /**
+   * @brief   Region attributes.
+   */
+  memattr_t                 attributes;
+  /**
+   * @brief   Region start address.
+   */
+  uint8_t                   *start;
+  /**
+   * @brief   Region free memory.
+   */
+  memcore_t                 core;
+};
+#endif /* CH_CFG_USE_MEMCORE_REGIONS == TRUE */
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
@@ -126,6 +214,22 @@ extern "C" {
   void *chCoreAllocFromBase(size_t size, unsigned align, size_t offset);
   void *chCoreAllocFromTop(size_t size, unsigned align, size_t offset);
   size_t chCoreGetStatusX(void);
+#if CH_CFG_USE_MEMCORE_REGIONS == TRUE
+  void chCoreRegionObjectInit(memregion_t *rp, const char *name,
+                              void *buf, size_t size, memattr_t attributes);
+  void chCoreRegionAdd(memregion_t *rp);
+  void chCoreRegionRemove(memregion_t *rp);
+  memregion_t *chCoreRegionFind(const char *name);
+  void *chCoreAllocFromRegionI(memregion_t *rp, size_t size,
+                               unsigned align, size_t offset);
+  void *chCoreAllocFromRegion(memregion_t *rp, size_t size,
+                              unsigned align, size_t offset);
+  void *chCoreAllocWithHintI(size_t size, unsigned align, size_t offset,
+                             memattr_t hint);
+  void *chCoreAllocWithHint(size_t size, unsigned align, size_t offset,
+                            memattr_t hint);
+  size_t chCoreGetRegionStatusX(const memregion_t *rp, size_t *totalp);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -96,6 +96,10 @@ union heap_header {
 struct memory_heap {
   memgetfunc2_t         provider;   /**< @brief Memory blocks provider for
                                                 this heap.                  */
+#if (CH_CFG_USE_MEMCORE_REGIONS == TRUE) || defined(__DOXYGEN__)
+  memattr_t             hint;       /**< @brief Placement hint used when
+                                                there is no provider.       */
+#endif
   heap_header_t         header;     /**< @brief Free blocks list header.    */
 #if (CH_CFG_USE_MUTEXES == TRUE) || defined(__DOXYGEN__)
   mutex_t               mtx;        /**< @brief Heap access mutex.          */
@@ -124,6 +128,9 @@ extern "C" {
 #endif
   void __heap_init(void);
   void chHeapObjectInit(memory_heap_t *heapp, void *buf, size_t size);
+#if CH_CFG_USE_MEMCORE_REGIONS == TRUE
+  void chHeapObjectInitWithHint(memory_heap_t *heapp, memattr_t hint);
+#endif
   void *chHeapAllocAligned(memory_heap_t *heapp, size_t size, unsigned align);
   void chHeapFree(void *p);
   size_t chHeapStatus(memory_heap_t *heapp, size_t *totalp, size_t *largestp);
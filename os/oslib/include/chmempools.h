@@ -68,6 +68,11 @@ typedef struct {
   unsigned              align;          /**< @brief Required alignment.     */
   memgetfunc_t          provider;       /**< @brief Memory blocks provider
                                                     for this pool.          */
+#if (CH_CFG_USE_MEMCORE_REGIONS == TRUE) || defined(__DOXYGEN__)
+  memattr_t             hint;           /**< @brief Placement hint used
+                                                    when there is no
+                                                    provider.               */
+#endif
 } memory_pool_t;
 
 #if (CH_CFG_USE_SEMAPHORES == TRUE) || defined(__DOXYGEN__)
@@ -95,8 +100,13 @@ typedef struct {
  * @param[in] align     required memory alignment
  * @param[in] provider  memory provider function for the memory pool
  */
+#if (CH_CFG_USE_MEMCORE_REGIONS == TRUE) || defined(__DOXYGEN__)
+#define __MEMORYPOOL_DATA(name, size, align, provider)                      \
+  {NULL, size, align, provider, CH_MEM_HINT_DEFAULT}
+#else
 #define __MEMORYPOOL_DATA(name, size, align, provider)                      \
   {NULL, size, align, provider}
+#endif
 
 /**
  * @brief   Static memory pool initializer.
@@ -149,6 +159,10 @@ extern "C" {
 #endif
   void chPoolObjectInitAligned(memory_pool_t *mp, size_t size,
                                unsigned align, memgetfunc_t provider);
+#if CH_CFG_USE_MEMCORE_REGIONS == TRUE
+  void chPoolObjectInitAlignedWithHint(memory_pool_t *mp, size_t size,
+                                       unsigned align, memattr_t hint);
+#endif
   void chPoolLoadArray(memory_pool_t *mp, void *p, size_t n);
   void *chPoolAllocI(memory_pool_t *mp);
   void *chPoolAlloc(memory_pool_t *mp);
@@ -193,6 +207,26 @@ static inline void chPoolObjectInit(memory_pool_t *mp,
   chPoolObjectInitAligned(mp, size, PORT_NATURAL_ALIGN, provider);
 }
 
+#if (CH_CFG_USE_MEMCORE_REGIONS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes an empty memory pool placed in memory regions.
+ *
+ * @param[out] mp       pointer to a @p memory_pool_t structure
+ * @param[in] size      the size of the objects contained in this memory pool,
+ *                      the minimum accepted size is the size of a pointer to
+ *                      void.
+ * @param[in] hint      placement hint, see @p chCoreAllocWithHint()
+ *
+ * @init
+ */
+static inline void chPoolObjectInitWithHint(memory_pool_t *mp,
+                                            size_t size,
+                                            memattr_t hint) {
+
+  chPoolObjectInitAlignedWithHint(mp, size, PORT_NATURAL_ALIGN, hint);
+}
+#endif
+
 /**
  * @brief   Adds an object to a memory pool.
  * @pre     The memory pool must be already been initialized.
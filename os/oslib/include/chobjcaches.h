@@ -50,10 +50,44 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Maximum number of objects written by a single flush.
+ * @note    Objects are collected in a stack array of this size and sorted
+ *          before being written.
+ */
+#if !defined(OC_FLUSH_BATCH) || defined(__DOXYGEN__)
+#define OC_FLUSH_BATCH                      8
+#endif
+
+/**
+ * @brief   Maximum number of objects examined by a flush within a single
+ *          critical section.
+ */
+#if !defined(OC_FLUSH_SCAN) || defined(__DOXYGEN__)
+#define OC_FLUSH_SCAN                       16
+#endif
+
+/**
+ * @brief   Shard selection function.
+ * @details The default function uses the upper bits of a mixed hash
+ *          so that the selection is not correlated with the lower bits
+ *          used by the hash tables of the shards and contiguous keys are
+ *          spread among the shards.
+ */
+#if !defined(OC_SHARD_FUNCTION) || defined(__DOXYGEN__)
+#define OC_SHARD_FUNCTION(ocsp, group, key)                                 \
+  ((unsigned)(oc_shard_mix((uint32_t)(group) + (uint32_t)(key)) >> 24) &   \
+   ((unsigned)(ocsp)->shardn - 1U))
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if OC_FLUSH_BATCH < 1
+#error "invalid OC_FLUSH_BATCH value"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -233,6 +267,23 @@ struct ch_objects_cache {
   oc_writef_t           writef;
 };
 
+/**
+ * @brief   Structure representing a set of cache shards.
+ * @details Objects are distributed among independent caches using
+ *          @p OC_SHARD_FUNCTION, each shard has its own hash table, LRU
+ *          list and semaphores.
+ */
+typedef struct {
+  /**
+   * @brief   Number of shards.
+   */
+  ucnt_t                shardn;
+  /**
+   * @brief   Pointer to the shards array.
+   */
+  objects_cache_t       *shards;
+} objects_cache_shards_t;
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
@@ -263,6 +314,19 @@ extern "C" {
   bool chCacheWriteObject(objects_cache_t *ocp,
                           oc_object_t *objp,
                           bool async);
+  unsigned chCacheFlush(objects_cache_t *ocp);
+  unsigned chCacheReadAhead(objects_cache_t *ocp,
+                            uint32_t group,
+                            uint32_t key,
+                            unsigned n);
+  void chCacheShardsObjectInit(objects_cache_shards_t *ocsp,
+                               ucnt_t shardn,
+                               objects_cache_t *shards);
+  unsigned chCacheShardsFlush(objects_cache_shards_t *ocsp);
+  unsigned chCacheShardsReadAhead(objects_cache_shards_t *ocsp,
+                                  uint32_t group,
+                                  uint32_t key,
+                                  unsigned n);
 #ifdef __cplusplus
 }
 #endif
@@ -297,6 +361,42 @@ static inline void chCacheReleaseObject(objects_cache_t *ocp,
   chSysUnlock();
 }
 
+/**
+ * @brief   Mixes the bits of a shard selection value.
+ *
+ * @param[in] x         value to be mixed
+ * @return              The mixed value.
+ *
+ * @notapi
+ */
+static inline uint32_t oc_shard_mix(uint32_t x) {
+
+  x *= 0x9E3779B1U;
+  x ^= x >> 16;
+  x *= 0x85EBCA6BU;
+
+  return x;
+}
+
+/**
+ * @brief   Returns the shard responsible for an object.
+ * @note    All operations on the object must be performed on the returned
+ *          cache.
+ *
+ * @param[in] ocsp      pointer to the @p objects_cache_shards_t structure
+ * @param[in] group     object group identifier
+ * @param[in] key       object identifier within the group
+ * @return              The pointer to the shard cache.
+ *
+ * @xclass
+ */
+static inline objects_cache_t *chCacheGetShardX(objects_cache_shards_t *ocsp,
+                                                uint32_t group,
+                                                uint32_t key) {
+
+  return &ocsp->shards[OC_SHARD_FUNCTION(ocsp, group, key)];
+}
+
 #endif /* CH_CFG_USE_OBJ_CACHES == TRUE */
 
 #endif /* CHOBJCACHES_H */
@@ -36,6 +36,15 @@
  *          - <b>Receive</b>: An object is received from the mailbox,
  *            can be blocking.
  *          .
+ *          Multicast objects FIFOs deliver each object by reference to
+ *          all the subscribers, each subscriber has its own mailbox. The
+ *          object is returned to the pool when the last subscriber
+ *          releases it:
+ *          - <b>Publish</b>: An object is posted in the mailboxes of all
+ *            the subscribers, it is guaranteed to be non-blocking.
+ *          - <b>Release</b>: A subscriber releases a received object, it
+ *            is guaranteed to be non-blocking.
+ *          .
  *
  * @addtogroup oslib_objects_fifos
  * @{
@@ -88,6 +97,59 @@ typedef struct ch_objects_fifo {
   mailbox_t                 mbx;
 } objects_fifo_t;
 
+/**
+ * @brief   Type of a multicast objects FIFO subscriber.
+ */
+typedef struct ch_objects_subscriber objects_subscriber_t;
+
+/**
+ * @brief   Structure representing a multicast objects FIFO subscriber.
+ */
+struct ch_objects_subscriber {
+  /**
+   * @brief   Next subscriber of the same FIFO.
+   */
+  objects_subscriber_t      *next;
+  /**
+   * @brief   Mailbox of the received objects.
+   */
+  mailbox_t                 mbx;
+  /**
+   * @brief   Objects not delivered because the mailbox was full.
+   */
+  ucnt_t                    dropped;
+};
+
+/**
+ * @brief   Type of a multicast objects FIFO.
+ */
+typedef struct ch_objects_multicast {
+  /**
+   * @brief   Pool of the free objects.
+   */
+  guarded_memory_pool_t     free;
+  /**
+   * @brief   Objects buffer.
+   */
+  uint8_t                   *objbuf;
+  /**
+   * @brief   Size of objects.
+   */
+  size_t                    objsize;
+  /**
+   * @brief   Number of objects.
+   */
+  size_t                    objn;
+  /**
+   * @brief   References counters, one for each object.
+   */
+  ucnt_t                    *refs;
+  /**
+   * @brief   List of the subscribers.
+   */
+  objects_subscriber_t      *subscribers;
+} objects_multicast_t;
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
@@ -99,7 +161,20 @@ typedef struct ch_objects_fifo {
 #ifdef __cplusplus
 extern "C" {
 #endif
-
+  void chFifoMulticastObjectInitAligned(objects_multicast_t *omp,
+                                        size_t objsize, size_t objn,
+                                        unsigned objalign, void *objbuf,
+                                        ucnt_t *refbuf);
+  void chFifoSubscriberObjectInit(objects_subscriber_t *osp,
+                                  msg_t *msgbuf, size_t n);
+  void chFifoSubscribe(objects_multicast_t *omp, objects_subscriber_t *osp);
+  void chFifoUnsubscribe(objects_multicast_t *omp, objects_subscriber_t *osp);
+  unsigned chFifoPublishObjectI(objects_multicast_t *omp, void *objp);
+  unsigned chFifoPublishObjectS(objects_multicast_t *omp, void *objp);
+  unsigned chFifoPublishObject(objects_multicast_t *omp, void *objp);
+  void chFifoReleaseObjectI(objects_multicast_t *omp, void *objp);
+  void chFifoReleaseObjectS(objects_multicast_t *omp, void *objp);
+  void chFifoReleaseObject(objects_multicast_t *omp, void *objp);
 #ifdef __cplusplus
 }
 #endif
@@ -423,6 +498,155 @@ static inline msg_t chFifoReceiveObjectTimeout(objects_fifo_t *ofp,
   return chMBFetchTimeout(&ofp->mbx, (msg_t *)objpp, timeout);
 }
 
+/**
+ * @brief   Initializes a multicast FIFO object.
+ * @pre     The messages size must be a multiple of the alignment
+ *          requirement.
+ *
+ * @param[out] omp      pointer to a @p objects_multicast_t structure
+ * @param[in] objsize   size of objects
+ * @param[in] objn      number of objects available
+ * @param[in] objbuf    pointer to the buffer of objects, it must be able
+ *                      to hold @p objn objects of @p objsize size
+ * @param[in] refbuf    pointer to the buffer of references counters, it
+ *                      must be able to hold @p objn counters
+ *
+ * @init
+ */
+static inline void chFifoMulticastObjectInit(objects_multicast_t *omp,
+                                             size_t objsize, size_t objn,
+                                             void *objbuf, ucnt_t *refbuf) {
+
+  chFifoMulticastObjectInitAligned(omp, objsize, objn,
+                                   PORT_NATURAL_ALIGN,
+                                   objbuf, refbuf);
+}
+
+/**
+ * @brief   Allocates a free object from a multicast FIFO.
+ *
+ * @param[in] omp       pointer to a @p objects_multicast_t structure
+ * @return              The pointer to the allocated object.
+ * @retval NULL         if an object is not immediately available.
+ *
+ * @iclass
+ */
+static inline void *chFifoMulticastTakeObjectI(objects_multicast_t *omp) {
+
+  return chGuardedPoolAllocI(&omp->free);
+}
+
+/**
+ * @brief   Allocates a free object from a multicast FIFO.
+ *
+ * @param[in] omp       pointer to a @p objects_multicast_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The pointer to the allocated object.
+ * @retval NULL         if an object is not available within the specified
+ *                      timeout.
+ *
+ * @sclass
+ */
+static inline void *chFifoMulticastTakeObjectTimeoutS(objects_multicast_t *omp,
+                                                      sysinterval_t timeout) {
+
+  return chGuardedPoolAllocTimeoutS(&omp->free, timeout);
+}
+
+/**
+ * @brief   Allocates a free object from a multicast FIFO.
+ *
+ * @param[in] omp       pointer to a @p objects_multicast_t structure
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The pointer to the allocated object.
+ * @retval NULL         if an object is not available within the specified
+ *                      timeout.
+ *
+ * @api
+ */
+static inline void *chFifoMulticastTakeObjectTimeout(objects_multicast_t *omp,
+                                                     sysinterval_t timeout) {
+
+  return chGuardedPoolAllocTimeout(&omp->free, timeout);
+}
+
+/**
+ * @brief   Fetches an object on a subscriber.
+ * @note    The object must be released using @p chFifoReleaseObject()
+ *          after use, it must not be modified.
+ *
+ * @param[in] osp       pointer to a @p objects_subscriber_t structure
+ * @param[in] objpp     pointer to the fetched object reference
+ * @return              The operation status.
+ * @retval MSG_OK       if an object has been correctly fetched.
+ * @retval MSG_TIMEOUT  if the FIFO is empty and a message cannot be fetched.
+ *
+ * @iclass
+ */
+static inline msg_t chFifoSubscriberReceiveObjectI(objects_subscriber_t *osp,
+                                                   void **objpp) {
+
+  return chMBFetchI(&osp->mbx, (msg_t *)objpp);
+}
+
+/**
+ * @brief   Fetches an object on a subscriber.
+ * @note    The object must be released using @p chFifoReleaseObject()
+ *          after use, it must not be modified.
+ *
+ * @param[in] osp       pointer to a @p objects_subscriber_t structure
+ * @param[in] objpp     pointer to the fetched object reference
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if an object has been correctly fetched.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @sclass
+ */
+static inline msg_t chFifoSubscriberReceiveObjectTimeoutS(objects_subscriber_t *osp,
+                                                          void **objpp,
+                                                          sysinterval_t timeout) {
+
+  return chMBFetchTimeoutS(&osp->mbx, (msg_t *)objpp, timeout);
+}
+
+/**
+ * @brief   Fetches an object on a subscriber.
+ * @note    The object must be released using @p chFifoReleaseObject()
+ *          after use, it must not be modified.
+ *
+ * @param[in] osp       pointer to a @p objects_subscriber_t structure
+ * @param[in] objpp     pointer to the fetched object reference
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if an object has been correctly fetched.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+static inline msg_t chFifoSubscriberReceiveObjectTimeout(objects_subscriber_t *osp,
+                                                         void **objpp,
+                                                         sysinterval_t timeout) {
+
+  return chMBFetchTimeout(&osp->mbx, (msg_t *)objpp, timeout);
+}
+
 #endif /* CH_CFG_USE_OBJ_FIFOS == TRUE */
 
 #endif /* CHOBJFIFOS_H */
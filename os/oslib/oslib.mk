@@ -26,12 +26,18 @@ endif
 ifneq ($(findstring CH_CFG_USE_MEMPOOLS TRUE,$(CHLIBCONF)),)
 LIBSRC += $(CHIBIOS)/os/oslib/src/chmempools.c
 endif
+ifneq ($(findstring CH_CFG_USE_ARENAS TRUE,$(CHLIBCONF)),)
+LIBSRC += $(CHIBIOS)/os/oslib/src/chmemarenas.c
+endif
 ifneq ($(findstring CH_CFG_USE_PIPES TRUE,$(CHLIBCONF)),)
 LIBSRC += $(CHIBIOS)/os/oslib/src/chpipes.c
 endif
 ifneq ($(findstring CH_CFG_USE_OBJ_CACHES TRUE,$(CHLIBCONF)),)
 LIBSRC += $(CHIBIOS)/os/oslib/src/chobjcaches.c
 endif
+ifneq ($(findstring CH_CFG_USE_OBJ_FIFOS TRUE,$(CHLIBCONF)),)
+LIBSRC += $(CHIBIOS)/os/oslib/src/chobjfifos.c
+endif
 ifneq ($(findstring CH_CFG_USE_DELEGATES TRUE,$(CHLIBCONF)),)
 LIBSRC += $(CHIBIOS)/os/oslib/src/chdelegates.c
 endif
@@ -43,8 +49,10 @@ LIBSRC := $(CHIBIOS)/os/oslib/src/chmboxes.c \
           $(CHIBIOS)/os/oslib/src/chmemcore.c \
           $(CHIBIOS)/os/oslib/src/chmemheaps.c \
           $(CHIBIOS)/os/oslib/src/chmempools.c \
+          $(CHIBIOS)/os/oslib/src/chmemarenas.c \
           $(CHIBIOS)/os/oslib/src/chpipes.c \
           $(CHIBIOS)/os/oslib/src/chobjcaches.c \
+          $(CHIBIOS)/os/oslib/src/chobjfifos.c \
           $(CHIBIOS)/os/oslib/src/chdelegates.c \
           $(CHIBIOS)/os/oslib/src/chfactory.c
 endif
@@ -27,6 +27,11 @@
  *          encapsulating a library not designed for threading into a
  *          delegate thread. Other threads have access to the library without
  *          having to worry about mutual exclusion.
+ *          <h2>Asynchronous calls</h2>
+ *          Calls can also be posted on a delegates queue without waiting,
+ *          the caller gets a future object that can be polled, waited or
+ *          chained using a completion callback. The dispatcher thread
+ *          executes all the queued calls on each wakeup.
  * @pre     In order to use the pipes APIs the @p CH_CFG_USE_DELEGATES
  *          option must be enabled in @p chconf.h.
  * @note    Compatible with RT and NIL.
@@ -73,6 +78,22 @@ typedef struct {
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+static msg_t delegate_call(const delegate_future_t *fp) {
+
+  switch (fp->argsn) {
+  case 0U:
+    return fp->func.fn0();
+  case 1U:
+    return fp->func.fn1(fp->args[0]);
+  case 2U:
+    return fp->func.fn2(fp->args[0], fp->args[1]);
+  case 3U:
+    return fp->func.fn3(fp->args[0], fp->args[1], fp->args[2]);
+  default:
+    return fp->func.fn4(fp->args[0], fp->args[1], fp->args[2], fp->args[3]);
+  }
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -234,6 +255,262 @@ msg_t chDelegateDispatchTimeout(sysinterval_t timeout) {
   return MSG_OK;
 }
 
+/**
+ * @brief   Initializes a delegates queue object.
+ *
+ * @param[out] dqp      pointer to a @p delegates_queue_t object
+ *
+ * @init
+ */
+void chDelegateQueueObjectInit(delegates_queue_t *dqp) {
+
+  chDbgCheck(dqp != NULL);
+
+  dqp->head       = NULL;
+  dqp->tail       = NULL;
+  dqp->dispatcher = NULL;
+}
+
+/**
+ * @brief   Initializes a delegate future object.
+ *
+ * @param[out] fp       pointer to a @p delegate_future_t object
+ * @param[in] callback  completion callback or @p NULL
+ *
+ * @init
+ */
+void chDelegateFutureObjectInit(delegate_future_t *fp,
+                                delegate_callback_t callback) {
+
+  chDbgCheck(fp != NULL);
+
+  fp->next     = NULL;
+  fp->argsn    = 0U;
+  fp->state    = CH_DELEGATE_FUTURE_IDLE;
+  fp->result   = MSG_RESET;
+  fp->waiter   = NULL;
+  fp->callback = callback;
+}
+
+/**
+ * @brief   Posts a call on a delegates queue.
+ * @details The call is written in the future object only if the future
+ *          is not busy with another call, use the @p chDelegateCallAsyncN()
+ *          functions instead of calling this function directly.
+ * @note    A future can be posted again after the completion of the
+ *          previous call or from its completion callback.
+ *
+ * @param[in] dqp       pointer to the delegates queue
+ * @param[in] fp        pointer to the future object
+ * @param[in] func      function to be called
+ * @param[in] argsn     number of parameters, from zero to four
+ * @param[in] argsp     pointer to the parameters array, can be @p NULL if
+ *                      @p argsn is zero
+ * @return              The operation status.
+ * @retval MSG_OK       if the call has been queued.
+ * @retval MSG_RESET    if the future object is busy with another call,
+ *                      the call has not been queued.
+ *
+ * @iclass
+ */
+msg_t chDelegatePostI(delegates_queue_t *dqp, delegate_future_t *fp,
+                      delegate_func_t func, unsigned argsn,
+                      const msg_t *argsp) {
+  unsigned i;
+
+  chDbgCheckClassI();
+  chDbgCheck((dqp != NULL) && (fp != NULL) && (func.fn0 != NULL) &&
+             (argsn <= 4U) && ((argsn == 0U) || (argsp != NULL)));
+
+  /* The future is accessed by the dispatcher while the call is pending or
+     running, it can only be rewritten when idle, completed or when its
+     completion callback chains another call.*/
+  if ((fp->state != CH_DELEGATE_FUTURE_IDLE) &&
+      (fp->state != CH_DELEGATE_FUTURE_DONE) &&
+      (fp->state != CH_DELEGATE_FUTURE_CALLBACK)) {
+    return MSG_RESET;
+  }
+
+  fp->func  = func;
+  fp->argsn = argsn;
+  for (i = 0U; i < argsn; i++) {
+    fp->args[i] = argsp[i];
+  }
+
+  fp->next  = NULL;
+  fp->state = CH_DELEGATE_FUTURE_PENDING;
+  if (dqp->tail == NULL) {
+    dqp->head = fp;
+  }
+  else {
+    dqp->tail->next = fp;
+  }
+  dqp->tail = fp;
+
+  /* Waking up the dispatcher, no effect if it is already running.*/
+  chThdResumeI(&dqp->dispatcher, MSG_OK);
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Posts a call on a delegates queue.
+ * @details The call is written in the future object only if the future
+ *          is not busy with another call, use the @p chDelegateCallAsyncN()
+ *          functions instead of calling this function directly.
+ * @note    A future can be posted again after the completion of the
+ *          previous call or from its completion callback.
+ *
+ * @param[in] dqp       pointer to the delegates queue
+ * @param[in] fp        pointer to the future object
+ * @param[in] func      function to be called
+ * @param[in] argsn     number of parameters, from zero to four
+ * @param[in] argsp     pointer to the parameters array, can be @p NULL if
+ *                      @p argsn is zero
+ * @return              The operation status.
+ * @retval MSG_OK       if the call has been queued.
+ * @retval MSG_RESET    if the future object is busy with another call,
+ *                      the call has not been queued.
+ *
+ * @api
+ */
+msg_t chDelegatePost(delegates_queue_t *dqp, delegate_future_t *fp,
+                     delegate_func_t func, unsigned argsn,
+                     const msg_t *argsp) {
+  msg_t msg;
+
+  chSysLock();
+  msg = chDelegatePostI(dqp, fp, func, argsn, argsp);
+  if (msg == MSG_OK) {
+    chSchRescheduleS();
+  }
+  chSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Waits for the completion of a call with timeout.
+ *
+ * @param[in] fp        pointer to the future object
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if the call has been completed, the return value
+ *                      is available using @p chDelegateFutureGetResultX().
+ * @retval MSG_TIMEOUT  if the call has not been completed within the
+ *                      specified timeout.
+ *
+ * @api
+ */
+msg_t chDelegateFutureWaitTimeout(delegate_future_t *fp,
+                                  sysinterval_t timeout) {
+  msg_t msg;
+
+  chDbgCheck(fp != NULL);
+
+  chSysLock();
+  chDbgAssert(fp->state != CH_DELEGATE_FUTURE_IDLE, "not posted");
+  if (fp->state == CH_DELEGATE_FUTURE_DONE) {
+    msg = MSG_OK;
+  }
+  else {
+    msg = chThdSuspendTimeoutS(&fp->waiter, timeout);
+  }
+  chSysUnlock();
+
+  return msg;
+}
+
+/**
+ * @brief   Asynchronous calls dispatching with timeout.
+ * @details The function awaits for queued calls then executes all the
+ *          calls found in the queue, calls posted during the execution
+ *          are served by the next invocation. For each call the
+ *          completion callback is invoked then the waiting thread, if
+ *          any, is resumed.
+ * @note    There must be a single dispatcher thread for each queue.
+ *
+ * @param[in] dqp       pointer to the delegates queue
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of executed calls, zero in case of
+ *                      timeout.
+ *
+ * @api
+ */
+unsigned chDelegateDispatchQueueTimeout(delegates_queue_t *dqp,
+                                        sysinterval_t timeout) {
+  delegate_future_t *fp, *next;
+  delegate_callback_t callback;
+  msg_t result;
+  unsigned n = 0U;
+
+  chDbgCheck(dqp != NULL);
+
+  chSysLock();
+  if (dqp->head == NULL) {
+    if (chThdSuspendTimeoutS(&dqp->dispatcher, timeout) != MSG_OK) {
+      chSysUnlock();
+      return 0U;
+    }
+  }
+
+  /* Taking all the queued calls at once.*/
+  fp = dqp->head;
+  dqp->head = NULL;
+  dqp->tail = NULL;
+  for (next = fp; next != NULL; next = next->next) {
+    next->state = CH_DELEGATE_FUTURE_RUNNING;
+  }
+  chSysUnlock();
+
+  while (fp != NULL) {
+    /* The link is fetched before the call, after completion the future
+       could be posted again.*/
+    next     = fp->next;
+    callback = fp->callback;
+    result   = delegate_call(fp);
+
+    /* The future is not completed while the callback runs, the callback
+       is able to post the same future again in order to chain another
+       call.*/
+    chSysLock();
+    fp->result = result;
+    if (callback == NULL) {
+      fp->state = CH_DELEGATE_FUTURE_DONE;
+      chThdResumeS(&fp->waiter, MSG_OK);
+    }
+    else {
+      fp->state = CH_DELEGATE_FUTURE_CALLBACK;
+    }
+    chSysUnlock();
+
+    if (callback != NULL) {
+      callback(fp);
+
+      /* The call is completed unless it has been chained.*/
+      chSysLock();
+      if (fp->state == CH_DELEGATE_FUTURE_CALLBACK) {
+        fp->state = CH_DELEGATE_FUTURE_DONE;
+        chThdResumeS(&fp->waiter, MSG_OK);
+      }
+      chSysUnlock();
+    }
+
+    fp = next;
+    n++;
+  }
+
+  return n;
+}
+
 #endif /* CH_CFG_USE_DELEGATES == TRUE */
 
 /** @} */
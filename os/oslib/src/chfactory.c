@@ -95,12 +95,57 @@ static void copy_name(const char *sp, char *dp) {
   } while ((c != (char)0) && (i > 0U));
 }
 
+#if CH_CFG_FACTORY_HASH_SIZE > 0
+/* FNV-1a hash of the significant part of a name.*/
+static dyn_element_t **dyn_hash_chain(const char *name, dyn_list_t *dlp) {
+  uint32_t h = 2166136261U;
+  unsigned i = 0U;
+
+  while ((i < (unsigned)CH_CFG_FACTORY_MAX_NAMES_LENGTH) &&
+         (name[i] != (char)0)) {
+    h = (h ^ (uint32_t)(uint8_t)name[i]) * 16777619U;
+    i++;
+  }
+
+  return &dlp->hash[h & ((uint32_t)CH_CFG_FACTORY_HASH_SIZE - 1U)];
+}
+#endif
+
 static inline void dyn_list_init(dyn_list_t *dlp) {
+#if CH_CFG_FACTORY_HASH_SIZE > 0
+  unsigned i;
+
+  for (i = 0U; i < (unsigned)CH_CFG_FACTORY_HASH_SIZE; i++) {
+    dlp->hash[i] = NULL;
+  }
+#endif
 
   dlp->next = (dyn_element_t *)dlp;
 }
 
+static void dyn_list_insert(dyn_element_t *element, dyn_list_t *dlp) {
+#if CH_CFG_FACTORY_HASH_SIZE > 0
+  dyn_element_t **chainp = dyn_hash_chain(element->name, dlp);
+
+  element->hash_next = *chainp;
+  *chainp = element;
+#endif
+
+  element->next = dlp->next;
+  dlp->next = element;
+}
+
 static dyn_element_t *dyn_list_find(const char *name, dyn_list_t *dlp) {
+#if CH_CFG_FACTORY_HASH_SIZE > 0
+  dyn_element_t *p = *dyn_hash_chain(name, dlp);
+
+  while (p != NULL) {
+    if (strncmp(p->name, name, CH_CFG_FACTORY_MAX_NAMES_LENGTH) == 0) {
+      return p;
+    }
+    p = p->hash_next;
+  }
+#else
   dyn_element_t *p = dlp->next;
 
   while (p != (dyn_element_t *)dlp) {
@@ -109,6 +154,7 @@ static dyn_element_t *dyn_list_find(const char *name, dyn_list_t *dlp) {
     }
     p = p->next;
   }
+#endif
 
   return NULL;
 }
@@ -117,6 +163,21 @@ static dyn_element_t *dyn_list_unlink(dyn_element_t *element,
                                       dyn_list_t *dlp) {
   dyn_element_t *prev = (dyn_element_t *)dlp;
 
+#if CH_CFG_FACTORY_HASH_SIZE > 0
+  {
+    dyn_element_t **chainp = dyn_hash_chain(element->name, dlp);
+
+    /* Removing from the hash chain first, chains are short.*/
+    while (*chainp != NULL) {
+      if (*chainp == element) {
+        *chainp = element->hash_next;
+        break;
+      }
+      chainp = &(*chainp)->hash_next;
+    }
+  }
+#endif
+
   /* Scanning the list.*/
   while (prev->next != (dyn_element_t *)dlp) {
     if (prev->next == element) {
@@ -156,10 +217,9 @@ static dyn_element_t *dyn_create_object_heap(const char *name,
   /* Initializing object list element.*/
   copy_name(name, dep->name);
   dep->refs = (ucnt_t)1;
-  dep->next = dlp->next;
 
   /* Updating factory list.*/
-  dlp->next = dep;
+  dyn_list_insert(dep, dlp);
 
   return dep;
 }
@@ -201,10 +261,9 @@ static dyn_element_t *dyn_create_object_pool(const char *name,
   /* Initializing object list element.*/
   copy_name(name, dep->name);
   dep->refs = (ucnt_t)1;
-  dep->next = dlp->next;
 
   /* Updating factory list.*/
-  dlp->next = (dyn_element_t *)dep;
+  dyn_list_insert(dep, dlp);
 
   return dep;
 }
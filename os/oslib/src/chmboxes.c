@@ -34,6 +34,12 @@
  *          - <b>Reset</b>: The mailbox is emptied and all the stored messages
  *            are lost.
  *          .
+ *          Post and fetch have batch variants transferring multiple messages
+ *          in a single critical zone.<br>
+ *          A single producer single consumer variant of the mailbox is also
+ *          available, messages are exchanged without entering the kernel
+ *          unless the producer or the consumer needs to wait or to be
+ *          awakened.
  *          A message is a variable of type msg_t that is guaranteed to have
  *          the same size of and be compatible with (data) pointers (anyway an
  *          explicit cast is needed).
@@ -70,6 +76,81 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+/**
+ * @brief   Reads a thread reference outside the critical zone.
+ */
+#define smb_is_waiting(trp) (*(thread_reference_t volatile *)(trp) != NULL)
+
+/**
+ * @brief   Posts messages in the free slots of a mailbox.
+ * @details A waiting reader is awakened for each posted message, no
+ *          rescheduling is performed.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msgs      pointer to the messages to be posted
+ * @param[in] n         maximum number of messages to be posted
+ * @return              The number of posted messages.
+ *
+ * @notapi
+ */
+static size_t mb_post_batch(mailbox_t *mbp, const msg_t *msgs, size_t n) {
+  size_t i, free = chMBGetFreeCountI(mbp);
+
+  if (n > free) {
+    n = free;
+  }
+
+  for (i = (size_t)0; i < n; i++) {
+    *mbp->wrptr++ = msgs[i];
+    if (mbp->wrptr >= mbp->top) {
+      mbp->wrptr = mbp->buffer;
+    }
+  }
+  mbp->cnt += n;
+
+  /* Waking up as many readers as the posted messages.*/
+  for (i = (size_t)0; (i < n) && !chThdQueueIsEmptyI(&mbp->qr); i++) {
+    chThdDequeueNextI(&mbp->qr, MSG_OK);
+  }
+
+  return n;
+}
+
+/**
+ * @brief   Fetches messages from a mailbox.
+ * @details A waiting writer is awakened for each fetched message, no
+ *          rescheduling is performed.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgs     pointer to the buffer for the fetched messages
+ * @param[in] n         maximum number of messages to be fetched
+ * @return              The number of fetched messages.
+ *
+ * @notapi
+ */
+static size_t mb_fetch_batch(mailbox_t *mbp, msg_t *msgs, size_t n) {
+  size_t i;
+
+  if (n > mbp->cnt) {
+    n = mbp->cnt;
+  }
+
+  for (i = (size_t)0; i < n; i++) {
+    msgs[i] = *mbp->rdptr++;
+    if (mbp->rdptr >= mbp->top) {
+      mbp->rdptr = mbp->buffer;
+    }
+  }
+  mbp->cnt -= n;
+
+  /* Waking up as many writers as the freed slots.*/
+  for (i = (size_t)0; (i < n) && !chThdQueueIsEmptyI(&mbp->qw); i++) {
+    chThdDequeueNextI(&mbp->qw, MSG_OK);
+  }
+
+  return n;
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -517,6 +598,420 @@ msg_t chMBFetchI(mailbox_t *mbp, msg_t *msgp) {
   /* No message, immediate timeout.*/
   return MSG_TIMEOUT;
 }
+
+/**
+ * @brief   Posts multiple messages into a mailbox.
+ * @details The invoking thread waits until at least an empty slot in the
+ *          mailbox becomes available or the specified time runs out, then
+ *          the messages fitting the free slots are posted at once.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msgs      pointer to the messages to be posted
+ * @param[in] n         number of messages to be posted, it must be greater
+ *                      than zero
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of posted messages, zero if the mailbox
+ *                      has been reset or the operation has timed out.
+ *
+ * @api
+ */
+size_t chMBPostBatchTimeout(mailbox_t *mbp, const msg_t *msgs, size_t n,
+                            sysinterval_t timeout) {
+
+  chSysLock();
+  n = chMBPostBatchTimeoutS(mbp, msgs, n, timeout);
+  chSysUnlock();
+
+  return n;
+}
+
+/**
+ * @brief   Posts multiple messages into a mailbox.
+ * @details The invoking thread waits until at least an empty slot in the
+ *          mailbox becomes available or the specified time runs out, then
+ *          the messages fitting the free slots are posted at once.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msgs      pointer to the messages to be posted
+ * @param[in] n         number of messages to be posted, it must be greater
+ *                      than zero
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of posted messages, zero if the mailbox
+ *                      has been reset or the operation has timed out.
+ *
+ * @sclass
+ */
+size_t chMBPostBatchTimeoutS(mailbox_t *mbp, const msg_t *msgs, size_t n,
+                             sysinterval_t timeout) {
+  msg_t rdymsg;
+
+  chDbgCheckClassS();
+  chDbgCheck((mbp != NULL) && (msgs != NULL) && (n > (size_t)0));
+
+  do {
+    /* If the mailbox is in reset state then returns immediately.*/
+    if (mbp->reset) {
+      return (size_t)0;
+    }
+
+    /* Are there free message slots in queue? if so then post.*/
+    if (chMBGetFreeCountI(mbp) > (size_t)0) {
+      n = mb_post_batch(mbp, msgs, n);
+      chSchRescheduleS();
+
+      return n;
+    }
+
+    /* No space in the queue, waiting for a slot to become available.*/
+    rdymsg = chThdEnqueueTimeoutS(&mbp->qw, timeout);
+  } while (rdymsg == MSG_OK);
+
+  return (size_t)0;
+}
+
+/**
+ * @brief   Posts multiple messages into a mailbox.
+ * @details This variant is non-blocking, the messages fitting the free
+ *          slots are posted.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[in] msgs      pointer to the messages to be posted
+ * @param[in] n         number of messages to be posted, it must be greater
+ *                      than zero
+ * @return              The number of posted messages, zero if the mailbox
+ *                      is in reset state or full.
+ *
+ * @iclass
+ */
+size_t chMBPostBatchI(mailbox_t *mbp, const msg_t *msgs, size_t n) {
+
+  chDbgCheckClassI();
+  chDbgCheck((mbp != NULL) && (msgs != NULL) && (n > (size_t)0));
+
+  /* If the mailbox is in reset state then returns immediately.*/
+  if (mbp->reset) {
+    return (size_t)0;
+  }
+
+  return mb_post_batch(mbp, msgs, n);
+}
+
+/**
+ * @brief   Retrieves multiple messages from a mailbox.
+ * @details The invoking thread waits until at least a message is posted in
+ *          the mailbox or the specified time runs out, then the queued
+ *          messages are fetched at once.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgs     pointer to the buffer for the received messages
+ * @param[in] n         maximum number of messages to be fetched, it must be
+ *                      greater than zero
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of fetched messages, zero if the mailbox
+ *                      has been reset or the operation has timed out.
+ *
+ * @api
+ */
+size_t chMBFetchBatchTimeout(mailbox_t *mbp, msg_t *msgs, size_t n,
+                             sysinterval_t timeout) {
+
+  chSysLock();
+  n = chMBFetchBatchTimeoutS(mbp, msgs, n, timeout);
+  chSysUnlock();
+
+  return n;
+}
+
+/**
+ * @brief   Retrieves multiple messages from a mailbox.
+ * @details The invoking thread waits until at least a message is posted in
+ *          the mailbox or the specified time runs out, then the queued
+ *          messages are fetched at once.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgs     pointer to the buffer for the received messages
+ * @param[in] n         maximum number of messages to be fetched, it must be
+ *                      greater than zero
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The number of fetched messages, zero if the mailbox
+ *                      has been reset or the operation has timed out.
+ *
+ * @sclass
+ */
+size_t chMBFetchBatchTimeoutS(mailbox_t *mbp, msg_t *msgs, size_t n,
+                              sysinterval_t timeout) {
+  msg_t rdymsg;
+
+  chDbgCheckClassS();
+  chDbgCheck((mbp != NULL) && (msgs != NULL) && (n > (size_t)0));
+
+  do {
+    /* If the mailbox is in reset state then returns immediately.*/
+    if (mbp->reset) {
+      return (size_t)0;
+    }
+
+    /* Are there messages in queue? if so then fetch.*/
+    if (chMBGetUsedCountI(mbp) > (size_t)0) {
+      n = mb_fetch_batch(mbp, msgs, n);
+      chSchRescheduleS();
+
+      return n;
+    }
+
+    /* No message in the queue, waiting for a message to become available.*/
+    rdymsg = chThdEnqueueTimeoutS(&mbp->qr, timeout);
+  } while (rdymsg == MSG_OK);
+
+  return (size_t)0;
+}
+
+/**
+ * @brief   Retrieves multiple messages from a mailbox.
+ * @details This variant is non-blocking, the queued messages are fetched
+ *          up to the specified number.
+ *
+ * @param[in] mbp       the pointer to an initialized @p mailbox_t object
+ * @param[out] msgs     pointer to the buffer for the received messages
+ * @param[in] n         maximum number of messages to be fetched, it must be
+ *                      greater than zero
+ * @return              The number of fetched messages, zero if the mailbox
+ *                      is in reset state or empty.
+ *
+ * @iclass
+ */
+size_t chMBFetchBatchI(mailbox_t *mbp, msg_t *msgs, size_t n) {
+
+  chDbgCheckClassI();
+  chDbgCheck((mbp != NULL) && (msgs != NULL) && (n > (size_t)0));
+
+  /* If the mailbox is in reset state then returns immediately.*/
+  if (mbp->reset) {
+    return (size_t)0;
+  }
+
+  return mb_fetch_batch(mbp, msgs, n);
+}
+
+/**
+ * @brief   Initializes a @p spsc_mailbox_t object.
+ * @note    A SPSC mailbox must have a single producer and a single consumer,
+ *          both running on the same core. The producer can be an ISR using
+ *          @p chSpscMBPostI().
+ *
+ * @param[out] smbp     the pointer to the @p spsc_mailbox_t structure to be
+ *                      initialized
+ * @param[in] buf       pointer to the messages buffer as an array of @p msg_t
+ * @param[in] n         number of elements in the buffer array, it must be a
+ *                      power of two
+ *
+ * @init
+ */
+void chSpscMBObjectInit(spsc_mailbox_t *smbp, msg_t *buf, size_t n) {
+
+  chDbgCheck((smbp != NULL) && (buf != NULL) && (n > (size_t)0) &&
+             ((n & (n - (size_t)1)) == (size_t)0));
+
+  smbp->buffer = buf;
+  smbp->mask   = n - (size_t)1;
+  smbp->wridx  = (size_t)0;
+  smbp->rdidx  = (size_t)0;
+  smbp->writer = NULL;
+  smbp->reader = NULL;
+}
+
+/**
+ * @brief   Posts a message into a SPSC mailbox.
+ * @details The kernel is only entered if the mailbox is full or if the
+ *          consumer is waiting for a message.
+ *
+ * @param[in] smbp      the pointer to an initialized @p spsc_mailbox_t object
+ * @param[in] msg       the message to be posted on the mailbox
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly posted.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chSpscMBPostTimeout(spsc_mailbox_t *smbp, msg_t msg,
+                          sysinterval_t timeout) {
+  size_t wr;
+
+  chDbgCheck(smbp != NULL);
+
+  wr = smbp->wridx;
+
+  /* Waiting for a free slot, the condition is checked again in the
+     critical zone because the consumer could free a slot meanwhile.*/
+  while ((wr - smbp->rdidx) > smbp->mask) {
+    msg_t rdymsg = MSG_OK;
+
+    chSysLock();
+    if ((wr - smbp->rdidx) > smbp->mask) {
+      rdymsg = chThdSuspendTimeoutS(&smbp->writer, timeout);
+    }
+    chSysUnlock();
+
+    if (rdymsg != MSG_OK) {
+      return rdymsg;
+    }
+  }
+
+  /* The message is published after being written, both the buffer and
+     the index are volatile so the order is preserved.*/
+  smbp->buffer[wr & smbp->mask] = msg;
+  smbp->wridx = wr + (size_t)1;
+
+  /* Waking up the consumer if it is waiting for a message.*/
+  if (smb_is_waiting(&smbp->reader)) {
+    chSysLock();
+    chThdResumeS(&smbp->reader, MSG_OK);
+    chSysUnlock();
+  }
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Posts a message into a SPSC mailbox.
+ * @details This variant is non-blocking, the function returns a timeout
+ *          condition if the queue is full.
+ *
+ * @param[in] smbp      the pointer to an initialized @p spsc_mailbox_t object
+ * @param[in] msg       the message to be posted on the mailbox
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly posted.
+ * @retval MSG_TIMEOUT  if the mailbox is full and the message cannot be
+ *                      posted.
+ *
+ * @iclass
+ */
+msg_t chSpscMBPostI(spsc_mailbox_t *smbp, msg_t msg) {
+  size_t wr;
+
+  chDbgCheckClassI();
+  chDbgCheck(smbp != NULL);
+
+  wr = smbp->wridx;
+  if ((wr - smbp->rdidx) > smbp->mask) {
+    return MSG_TIMEOUT;
+  }
+
+  smbp->buffer[wr & smbp->mask] = msg;
+  smbp->wridx = wr + (size_t)1;
+  chThdResumeI(&smbp->reader, MSG_OK);
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Retrieves a message from a SPSC mailbox.
+ * @details The kernel is only entered if the mailbox is empty or if the
+ *          producer is waiting for a free slot.
+ *
+ * @param[in] smbp      the pointer to an initialized @p spsc_mailbox_t object
+ * @param[out] msgp     pointer to a message variable for the received message
+ * @param[in] timeout   the number of ticks before the operation timeouts,
+ *                      the following special values are allowed:
+ *                      - @a TIME_IMMEDIATE immediate timeout.
+ *                      - @a TIME_INFINITE no timeout.
+ *                      .
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly fetched.
+ * @retval MSG_TIMEOUT  if the operation has timed out.
+ *
+ * @api
+ */
+msg_t chSpscMBFetchTimeout(spsc_mailbox_t *smbp, msg_t *msgp,
+                           sysinterval_t timeout) {
+  size_t rd;
+
+  chDbgCheck((smbp != NULL) && (msgp != NULL));
+
+  rd = smbp->rdidx;
+
+  /* Waiting for a message, the condition is checked again in the
+     critical zone because the producer could post meanwhile.*/
+  while (smbp->wridx == rd) {
+    msg_t rdymsg = MSG_OK;
+
+    chSysLock();
+    if (smbp->wridx == rd) {
+      rdymsg = chThdSuspendTimeoutS(&smbp->reader, timeout);
+    }
+    chSysUnlock();
+
+    if (rdymsg != MSG_OK) {
+      return rdymsg;
+    }
+  }
+
+  /* The slot is released after being read.*/
+  *msgp = smbp->buffer[rd & smbp->mask];
+  smbp->rdidx = rd + (size_t)1;
+
+  /* Waking up the producer if it is waiting for a free slot.*/
+  if (smb_is_waiting(&smbp->writer)) {
+    chSysLock();
+    chThdResumeS(&smbp->writer, MSG_OK);
+    chSysUnlock();
+  }
+
+  return MSG_OK;
+}
+
+/**
+ * @brief   Retrieves a message from a SPSC mailbox.
+ * @details This variant is non-blocking, the function returns a timeout
+ *          condition if the queue is empty.
+ *
+ * @param[in] smbp      the pointer to an initialized @p spsc_mailbox_t object
+ * @param[out] msgp     pointer to a message variable for the received message
+ * @return              The operation status.
+ * @retval MSG_OK       if a message has been correctly fetched.
+ * @retval MSG_TIMEOUT  if the mailbox is empty and a message cannot be
+ *                      fetched.
+ *
+ * @iclass
+ */
+msg_t chSpscMBFetchI(spsc_mailbox_t *smbp, msg_t *msgp) {
+  size_t rd;
+
+  chDbgCheckClassI();
+  chDbgCheck((smbp != NULL) && (msgp != NULL));
+
+  rd = smbp->rdidx;
+  if (smbp->wridx == rd) {
+    return MSG_TIMEOUT;
+  }
+
+  *msgp = smbp->buffer[rd & smbp->mask];
+  smbp->rdidx = rd + (size_t)1;
+  chThdResumeI(&smbp->writer, MSG_OK);
+
+  return MSG_OK;
+}
 #endif /* CH_CFG_USE_MAILBOXES == TRUE */
 
 /** @} */
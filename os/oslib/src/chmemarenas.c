@@ -0,0 +1,234 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    oslib/src/chmemarenas.c
+ * @brief   Memory Arenas code.
+ *
+ * @addtogroup oslib_memarenas
+ * @details Memory Arenas related APIs and services.
+ *          <h2>Operation mode</h2>
+ *          An arena allocates blocks from a buffer by just moving a pointer
+ *          upward, blocks cannot be freed individually but all the blocks
+ *          allocated after a mark, or all the blocks in the arena, are
+ *          released at once in <b>constant time</b>.<br>
+ *          Arenas are meant for short-lived groups of objects, for example
+ *          the objects created while processing a request, without the
+ *          costs and the fragmentation of many small heap allocations.<br>
+ *          The arena buffer can be a static buffer or a block obtained
+ *          from the core allocator or from a heap.
+ * @pre     In order to use the memory arenas APIs the @p CH_CFG_USE_ARENAS
+ *          option must be enabled in @p chconf.h.
+ * @note    Arenas are not protected by locks, an arena must be used by a
+ *          single thread or protected by the caller.
+ * @note    Compatible with RT and NIL.
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_CFG_USE_ARENAS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a memory arena on a static buffer.
+ *
+ * @param[out] ap       pointer to a @p memory_arena_t structure
+ * @param[in] buf       arena buffer base
+ * @param[in] size      arena buffer size
+ *
+ * @init
+ */
+void chArenaObjectInit(memory_arena_t *ap, void *buf, size_t size) {
+
+  chDbgCheck((ap != NULL) && (buf != NULL));
+
+  ap->base        = (uint8_t *)buf;
+  ap->next        = (uint8_t *)buf;
+  ap->top         = (uint8_t *)buf + size;
+  ap->block       = NULL;
+  ap->peak        = 0U;
+  ap->allocations = 0U;
+  ap->failures    = 0U;
+}
+
+#if (CH_CFG_USE_MEMCORE == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes a memory arena on a block of core memory.
+ * @note    The core memory cannot be returned, the arena is meant to be
+ *          reused using @p chArenaReset().
+ *
+ * @param[out] ap       pointer to a @p memory_arena_t structure
+ * @param[in] size      arena buffer size
+ * @return              The operation status.
+ * @retval false        if the core memory is exhausted.
+ *
+ * @init
+ */
+bool chArenaObjectInitFromCore(memory_arena_t *ap, size_t size) {
+  void *buf;
+
+  buf = chCoreAlloc(size);
+  if (buf == NULL) {
+    return false;
+  }
+
+  chArenaObjectInit(ap, buf, size);
+
+  return true;
+}
+#endif /* CH_CFG_USE_MEMCORE == TRUE */
+
+#if (CH_CFG_USE_HEAP == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes a memory arena on a heap block.
+ * @note    The block is returned to the heap by @p chArenaDispose().
+ *
+ * @param[out] ap       pointer to a @p memory_arena_t structure
+ * @param[in] heapp     pointer to a heap descriptor or @p NULL in order to
+ *                      access the default heap.
+ * @param[in] size      arena buffer size
+ * @return              The operation status.
+ * @retval false        if the heap block cannot be allocated.
+ *
+ * @init
+ */
+bool chArenaObjectInitFromHeap(memory_arena_t *ap,
+                               memory_heap_t *heapp,
+                               size_t size) {
+  void *buf;
+
+  buf = chHeapAlloc(heapp, size);
+  if (buf == NULL) {
+    return false;
+  }
+
+  chArenaObjectInit(ap, buf, size);
+  ap->block = buf;
+
+  return true;
+}
+
+/**
+ * @brief   Disposes a memory arena.
+ * @details If the arena buffer has been allocated from a heap then it is
+ *          returned to the heap, the arena must not be used anymore.
+ *
+ * @param[in] ap        pointer to a @p memory_arena_t structure
+ *
+ * @dispose
+ */
+void chArenaDispose(memory_arena_t *ap) {
+
+  chDbgCheck(ap != NULL);
+
+  if (ap->block != NULL) {
+    chHeapFree(ap->block);
+  }
+  ap->base  = NULL;
+  ap->next  = NULL;
+  ap->top   = NULL;
+  ap->block = NULL;
+}
+#endif /* CH_CFG_USE_HEAP == TRUE */
+
+/**
+ * @brief   Allocates a block from an arena.
+ * @details The allocated block is guaranteed to be properly aligned to the
+ *          specified alignment.
+ *
+ * @param[in] ap        pointer to a @p memory_arena_t structure
+ * @param[in] size      the size of the block to be allocated
+ * @param[in] align     desired memory alignment
+ * @return              A pointer to the allocated block.
+ * @retval NULL         if the arena is exhausted.
+ *
+ * @api
+ */
+void *chArenaAllocAligned(memory_arena_t *ap, size_t size, unsigned align) {
+  uint8_t *p, *next;
+  size_t used;
+
+  chDbgCheck((ap != NULL) && MEM_IS_VALID_ALIGNMENT(align));
+
+  p = (uint8_t *)MEM_ALIGN_NEXT(ap->next, align);
+  next = p + size;
+
+  /* Considering also the case where there is numeric overflow.*/
+  if ((next > ap->top) || (next < ap->next)) {
+    ap->failures++;
+    return NULL;
+  }
+
+  ap->next = next;
+  ap->allocations++;
+
+  /*lint -save -e9033 [10.8] The cast is safe.*/
+  used = (size_t)(next - ap->base);
+  /*lint -restore*/
+  if (used > ap->peak) {
+    ap->peak = used;
+  }
+
+  return p;
+}
+
+/**
+ * @brief   Reports the arena status.
+ *
+ * @param[in] ap        pointer to a @p memory_arena_t structure
+ * @param[out] asp      pointer to a @p arena_status_t structure
+ *
+ * @api
+ */
+void chArenaGetStatus(const memory_arena_t *ap, arena_status_t *asp) {
+
+  chDbgCheck((ap != NULL) && (asp != NULL));
+
+  /*lint -save -e9033 [10.8] The cast is safe.*/
+  asp->size        = (size_t)(ap->top - ap->base);
+  asp->used        = (size_t)(ap->next - ap->base);
+  /*lint -restore*/
+  asp->peak        = ap->peak;
+  asp->allocations = ap->allocations;
+  asp->failures    = ap->failures;
+}
+
+#endif /* CH_CFG_USE_ARENAS == TRUE */
+
+/** @} */
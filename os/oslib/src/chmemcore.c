@@ -37,13 +37,20 @@
  *          can coexist and share the main memory.<br>
  *          This allocator, alone, is also useful for very simple
  *          applications that just require a simple way to get memory
- *          blocks.
+ *          blocks.<br>
+ *          Optionally, additional memory regions with attributes can be
+ *          registered, for example fast RAM banks or DMA-capable RAM,
+ *          blocks can then be allocated from a specific region or from
+ *          the first region having the attributes specified in a placement
+ *          hint.
  * @pre     In order to use the core memory manager APIs the @p CH_CFG_USE_MEMCORE
  *          option must be enabled in @p chconf.h.
  * @note    Compatible with RT and NIL.
  * @{
  */
 
+#include <string.h>
+
 #include "ch.h"
 
 #if (CH_CFG_USE_MEMCORE == TRUE) || defined(__DOXYGEN__)
@@ -65,10 +72,34 @@ memcore_t ch_memcore;
 /* Module local variables.                                                   */
 /*===========================================================================*/
 
+#if (CH_CFG_USE_MEMCORE_REGIONS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Registered memory regions in placement order.
+ */
+static memregion_t *regions;
+#endif
+
 /*===========================================================================*/
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+static void *core_alloc_from_base(memcore_t *mcp, size_t size,
+                                  unsigned align, size_t offset) {
+  uint8_t *p, *next;
+
+  p = (uint8_t *)MEM_ALIGN_NEXT(mcp->basemem + offset, align);
+  next = p + size;
+
+  /* Considering also the case where there is numeric overflow.*/
+  if ((next > mcp->topmem) || (next < mcp->basemem)) {
+    return NULL;
+  }
+
+  mcp->basemem = next;
+
+  return p;
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -93,6 +124,9 @@ void __core_init(void) {
   ch_memcore.basemem = &static_heap[0];
   ch_memcore.topmem  = &static_heap[CH_CFG_MEMCORE_SIZE];
 #endif
+#if CH_CFG_USE_MEMCORE_REGIONS == TRUE
+  regions = NULL;
+#endif
 }
 
 /**
@@ -110,22 +144,11 @@ void __core_init(void) {
  * @iclass
  */
 void *chCoreAllocFromBaseI(size_t size, unsigned align, size_t offset) {
-  uint8_t *p, *next;
 
   chDbgCheckClassI();
   chDbgCheck(MEM_IS_VALID_ALIGNMENT(align));
 
-  p = (uint8_t *)MEM_ALIGN_NEXT(ch_memcore.basemem + offset, align);
-  next = p + size;
-
-  /* Considering also the case where there is numeric overflow.*/
-  if ((next > ch_memcore.topmem) || (next < ch_memcore.basemem)) {
-    return NULL;
-  }
-
-  ch_memcore.basemem = next;
-
-  return p;
+  return core_alloc_from_base(&ch_memcore, size, align, offset);
 }
 
 /**
@@ -222,6 +245,262 @@ size_t chCoreGetStatusX(void) {
   return (size_t)(ch_memcore.topmem - ch_memcore.basemem);
   /*lint -restore*/
 }
+
+#if (CH_CFG_USE_MEMCORE_REGIONS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes a memory region object.
+ *
+ * @param[out] rp       pointer to the @p memregion_t object
+ * @param[in] name      name of the region
+ * @param[in] buf       region base address
+ * @param[in] size      region size
+ * @param[in] attributes region attributes, a combination of the
+ *                      @p CH_MEM_ATTR_ flags
+ *
+ * @init
+ */
+void chCoreRegionObjectInit(memregion_t *rp, const char *name,
+                            void *buf, size_t size, memattr_t attributes) {
+
+  chDbgCheck((rp != NULL) && (buf != NULL) &&
+             ((attributes & CH_MEM_HINT_FALLBACK) == 0U));
+
+  rp->next         = NULL;
+  rp->name         = name;
+  rp->attributes   = attributes;
+  rp->start        = (uint8_t *)buf;
+  rp->core.basemem = (uint8_t *)buf;
+  rp->core.topmem  = (uint8_t *)buf + size;
+}
+
+/**
+ * @brief   Registers a memory region.
+ * @details The region is appended to the regions list, regions are
+ *          searched in registration order when allocating using placement
+ *          hints, the fastest regions should be registered first.
+ *
+ * @param[in] rp        pointer to the @p memregion_t object
+ *
+ * @api
+ */
+void chCoreRegionAdd(memregion_t *rp) {
+  memregion_t **rpp;
+
+  chDbgCheck(rp != NULL);
+
+  chSysLock();
+  rpp = &regions;
+  while (*rpp != NULL) {
+    chDbgAssert(*rpp != rp, "already registered");
+    rpp = &(*rpp)->next;
+  }
+  rp->next = NULL;
+  *rpp = rp;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Unregisters a memory region.
+ * @note    Blocks already allocated from the region are not affected.
+ *
+ * @param[in] rp        pointer to the @p memregion_t object
+ *
+ * @api
+ */
+void chCoreRegionRemove(memregion_t *rp) {
+  memregion_t **rpp;
+
+  chDbgCheck(rp != NULL);
+
+  chSysLock();
+  rpp = &regions;
+  while (*rpp != NULL) {
+    if (*rpp == rp) {
+      *rpp = rp->next;
+      break;
+    }
+    rpp = &(*rpp)->next;
+  }
+  chSysUnlock();
+}
+
+/**
+ * @brief   Finds a registered memory region by name.
+ *
+ * @param[in] name      name of the region
+ * @return              A pointer to the region.
+ * @retval NULL         if a region with the specified name does not exist.
+ *
+ * @api
+ */
+memregion_t *chCoreRegionFind(const char *name) {
+  memregion_t *rp;
+
+  chDbgCheck(name != NULL);
+
+  chSysLock();
+  rp = regions;
+  while (rp != NULL) {
+    if ((rp->name != NULL) && (strcmp(rp->name, name) == 0)) {
+      break;
+    }
+    rp = rp->next;
+  }
+  chSysUnlock();
+
+  return rp;
+}
+
+/**
+ * @brief   Allocates a memory block from a memory region.
+ * @details This function allocates a block of @p offset + @p size bytes. The
+ *          returned pointer has @p offset bytes before its address and
+ *          @p size bytes after.
+ * @note    The region is not required to be registered.
+ *
+ * @param[in] rp        pointer to the @p memregion_t object
+ * @param[in] size      the size of the block to be allocated.
+ * @param[in] align     desired memory alignment
+ * @param[in] offset    aligned pointer offset
+ * @return              A pointer to the allocated memory block.
+ * @retval NULL         allocation failed, region memory exhausted.
+ *
+ * @iclass
+ */
+void *chCoreAllocFromRegionI(memregion_t *rp, size_t size,
+                             unsigned align, size_t offset) {
+
+  chDbgCheckClassI();
+  chDbgCheck((rp != NULL) && MEM_IS_VALID_ALIGNMENT(align));
+
+  return core_alloc_from_base(&rp->core, size, align, offset);
+}
+
+/**
+ * @brief   Allocates a memory block from a memory region.
+ * @details This function allocates a block of @p offset + @p size bytes. The
+ *          returned pointer has @p offset bytes before its address and
+ *          @p size bytes after.
+ * @note    The region is not required to be registered.
+ *
+ * @param[in] rp        pointer to the @p memregion_t object
+ * @param[in] size      the size of the block to be allocated.
+ * @param[in] align     desired memory alignment
+ * @param[in] offset    aligned pointer offset
+ * @return              A pointer to the allocated memory block.
+ * @retval NULL         allocation failed, region memory exhausted.
+ *
+ * @api
+ */
+void *chCoreAllocFromRegion(memregion_t *rp, size_t size,
+                            unsigned align, size_t offset) {
+  void *p;
+
+  chSysLock();
+  p = chCoreAllocFromRegionI(rp, size, align, offset);
+  chSysUnlock();
+
+  return p;
+}
+
+/**
+ * @brief   Allocates a memory block using a placement hint.
+ * @details The block is allocated from the first registered region having
+ *          all the attributes specified in @p hint and enough free space.
+ *          If the hint is @p CH_MEM_HINT_DEFAULT then the block is
+ *          allocated from the default core memory as done by
+ *          @p chCoreAllocAlignedWithOffsetI().
+ *
+ * @param[in] size      the size of the block to be allocated.
+ * @param[in] align     desired memory alignment
+ * @param[in] offset    aligned pointer offset
+ * @param[in] hint      required region attributes, optionally combined
+ *                      with @p CH_MEM_HINT_FALLBACK
+ * @return              A pointer to the allocated memory block.
+ * @retval NULL         allocation failed, no suitable memory.
+ *
+ * @iclass
+ */
+void *chCoreAllocWithHintI(size_t size, unsigned align, size_t offset,
+                           memattr_t hint) {
+  memattr_t required = hint & ~CH_MEM_HINT_FALLBACK;
+  memregion_t *rp;
+
+  chDbgCheckClassI();
+  chDbgCheck(MEM_IS_VALID_ALIGNMENT(align));
+
+  if (hint != CH_MEM_HINT_DEFAULT) {
+    rp = regions;
+    while (rp != NULL) {
+      if ((rp->attributes & required) == required) {
+        void *p = core_alloc_from_base(&rp->core, size, align, offset);
+        if (p != NULL) {
+          return p;
+        }
+      }
+      rp = rp->next;
+    }
+
+    if ((hint & CH_MEM_HINT_FALLBACK) == 0U) {
+      return NULL;
+    }
+  }
+
+  return chCoreAllocAlignedWithOffsetI(size, align, offset);
+}
+
+/**
+ * @brief   Allocates a memory block using a placement hint.
+ * @details The block is allocated from the first registered region having
+ *          all the attributes specified in @p hint and enough free space.
+ *          If the hint is @p CH_MEM_HINT_DEFAULT then the block is
+ *          allocated from the default core memory as done by
+ *          @p chCoreAllocAlignedWithOffset().
+ *
+ * @param[in] size      the size of the block to be allocated.
+ * @param[in] align     desired memory alignment
+ * @param[in] offset    aligned pointer offset
+ * @param[in] hint      required region attributes, optionally combined
+ *                      with @p CH_MEM_HINT_FALLBACK
+ * @return              A pointer to the allocated memory block.
+ * @retval NULL         allocation failed, no suitable memory.
+ *
+ * @api
+ */
+void *chCoreAllocWithHint(size_t size, unsigned align, size_t offset,
+                          memattr_t hint) {
+  void *p;
+
+  chSysLock();
+  p = chCoreAllocWithHintI(size, align, offset, hint);
+  chSysUnlock();
+
+  return p;
+}
+
+/**
+ * @brief   Memory region status.
+ *
+ * @param[in] rp        pointer to the @p memregion_t object
+ * @param[out] totalp   pointer to a variable that will receive the total
+ *                      region size or @p NULL
+ * @return              The size, in bytes, of the free region memory.
+ *
+ * @xclass
+ */
+size_t chCoreGetRegionStatusX(const memregion_t *rp, size_t *totalp) {
+
+  chDbgCheck(rp != NULL);
+
+  /*lint -save -e9033 [10.8] The cast is safe.*/
+  if (totalp != NULL) {
+    *totalp = (size_t)(rp->core.topmem - rp->start);
+  }
+
+  return (size_t)(rp->core.topmem - rp->core.basemem);
+  /*lint -restore*/
+}
+#endif /* CH_CFG_USE_MEMCORE_REGIONS == TRUE */
 #endif /* CH_CFG_USE_MEMCORE == TRUE */
 
 /** @} */
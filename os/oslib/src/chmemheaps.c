@@ -107,6 +107,9 @@ static memory_heap_t default_heap;
 void __heap_init(void) {
 
   default_heap.provider = chCoreAllocAlignedWithOffset;
+#if CH_CFG_USE_MEMCORE_REGIONS == TRUE
+  default_heap.hint = CH_MEM_HINT_DEFAULT;
+#endif
   H_NEXT(&default_heap.header) = NULL;
   H_PAGES(&default_heap.header) = 0;
 #if (CH_CFG_USE_MUTEXES == TRUE) || defined(__DOXYGEN__)
@@ -141,6 +144,9 @@ void chHeapObjectInit(memory_heap_t *heapp, void *buf, size_t size) {
 
   /* Initializing the heap header.*/
   heapp->provider = NULL;
+#if CH_CFG_USE_MEMCORE_REGIONS == TRUE
+  heapp->hint = CH_MEM_HINT_DEFAULT;
+#endif
   H_NEXT(&heapp->header) = hp;
   H_PAGES(&heapp->header) = 0;
   H_NEXT(hp) = NULL;
@@ -152,6 +158,34 @@ void chHeapObjectInit(memory_heap_t *heapp, void *buf, size_t size) {
 #endif
 }
 
+#if (CH_CFG_USE_MEMCORE_REGIONS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes an empty memory heap placed in memory regions.
+ * @details The heap has no initial memory, it grows by getting blocks from
+ *          the core allocator using the specified placement hint, freed
+ *          blocks are kept by the heap.
+ *
+ * @param[out] heapp    pointer to the memory heap descriptor to be initialized
+ * @param[in] hint      placement hint, see @p chCoreAllocWithHint()
+ *
+ * @init
+ */
+void chHeapObjectInitWithHint(memory_heap_t *heapp, memattr_t hint) {
+
+  chDbgCheck(heapp != NULL);
+
+  heapp->provider = NULL;
+  heapp->hint = hint;
+  H_NEXT(&heapp->header) = NULL;
+  H_PAGES(&heapp->header) = 0;
+#if (CH_CFG_USE_MUTEXES == TRUE) || defined(__DOXYGEN__)
+  chMtxObjectInit(&heapp->mtx);
+#else
+  chSemObjectInit(&heapp->sem, (cnt_t)1);
+#endif
+}
+#endif /* CH_CFG_USE_MEMCORE_REGIONS == TRUE */
+
 /**
  * @brief   Allocates a block of memory from the heap by using the first-fit
  *          algorithm.
@@ -264,20 +298,32 @@ void *chHeapAllocAligned(memory_heap_t *heapp, size_t size, unsigned align) {
   H_UNLOCK(heapp);
 
   /* More memory is required, tries to get it from the associated provider
-     else fails.*/
+     or from the hinted memory regions else fails.*/
+  ahp = NULL;
   if (heapp->provider != NULL) {
     ahp = heapp->provider(pages * CH_HEAP_ALIGNMENT,
                           align,
                           sizeof (heap_header_t));
-    if (ahp != NULL) {
-      hp = ahp - 1U;
-      H_HEAP(hp) = heapp;
-      H_SIZE(hp) = size;
-
-      /*lint -save -e9087 [11.3] Safe cast.*/
-      return (void *)ahp;
-      /*lint -restore*/
-    }
+  }
+#if CH_CFG_USE_MEMCORE_REGIONS == TRUE
+  else if (heapp->hint != CH_MEM_HINT_DEFAULT) {
+    ahp = chCoreAllocWithHint(pages * CH_HEAP_ALIGNMENT,
+                              align,
+                              sizeof (heap_header_t),
+                              heapp->hint);
+  }
+#endif
+  else {
+    /* No memory source.*/
+  }
+  if (ahp != NULL) {
+    hp = ahp - 1U;
+    H_HEAP(hp) = heapp;
+    H_SIZE(hp) = size;
+
+    /*lint -save -e9087 [11.3] Safe cast.*/
+    return (void *)ahp;
+    /*lint -restore*/
   }
 
   return NULL;
@@ -86,7 +86,33 @@ void chPoolObjectInitAligned(memory_pool_t *mp, size_t size,
   mp->object_size = size;
   mp->align = align;
   mp->provider = provider;
+#if CH_CFG_USE_MEMCORE_REGIONS == TRUE
+  mp->hint = CH_MEM_HINT_DEFAULT;
+#endif
+}
+
+#if (CH_CFG_USE_MEMCORE_REGIONS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Initializes an empty memory pool placed in memory regions.
+ * @details The pool grows by getting objects from the core allocator using
+ *          the specified placement hint.
+ *
+ * @param[out] mp       pointer to a @p memory_pool_t structure
+ * @param[in] size      the size of the objects contained in this memory pool,
+ *                      the minimum accepted size is the size of a pointer to
+ *                      void.
+ * @param[in] align     required memory alignment
+ * @param[in] hint      placement hint, see @p chCoreAllocWithHint()
+ *
+ * @init
+ */
+void chPoolObjectInitAlignedWithHint(memory_pool_t *mp, size_t size,
+                                     unsigned align, memattr_t hint) {
+
+  chPoolObjectInitAligned(mp, size, align, NULL);
+  mp->hint = hint;
 }
+#endif /* CH_CFG_USE_MEMCORE_REGIONS == TRUE */
 
 /**
  * @brief   Loads a memory pool with an array of static objects.
@@ -143,6 +169,11 @@ void *chPoolAllocI(memory_pool_t *mp) {
     chDbgAssert(MEM_IS_ALIGNED(objp, mp->align),
                 "returned object not aligned");
   }
+#if CH_CFG_USE_MEMCORE_REGIONS == TRUE
+  else if (mp->hint != CH_MEM_HINT_DEFAULT) {
+    objp = chCoreAllocWithHintI(mp->object_size, mp->align, 0U, mp->hint);
+  }
+#endif
   /*lint -restore*/
 
   return objp;
@@ -42,7 +42,17 @@
  *            media.
  *          - <b>Release Object</b>: Releases an object to the cache handling
  *            the media update, if required.
+ *          - <b>Flush</b>: Writes back the objects marked for lazy write
+ *            in group and key order, it is meant to be called periodically
+ *            by a low priority thread (write-back mode).
+ *          - <b>Read Ahead</b>: Starts asynchronous reads of the objects
+ *            following the current one without waiting for buffers.
  *          .
+ *          Objects can be distributed among multiple independent caches
+ *          (shards), each one with its own hash table, LRU list and
+ *          buffers. Shards shorten the critical zones and the collision
+ *          lists, threads waiting for a free buffer only wait on their
+ *          shard.
  * @pre     In order to use the pipes APIs the @p CH_CFG_USE_OBJ_CACHES
  *          option must be enabled in @p chconf.h.
  * @note    Compatible with RT and NIL.
@@ -169,9 +179,12 @@ static oc_object_t *lru_get_last_s(objects_cache_t *ocp) {
     /* Waiting for an object buffer to become available in the LRU.*/
     (void) chSemWaitS(&ocp->lru_sem);
 
-    /* Now an object buffer is in the LRU for sure, taking it from the
-       LRU tail.*/
+    /* An object buffer could have been taken by a cache hit after the
+       semaphore has been signaled, waiting again in that case.*/
     objp = ocp->lru.lru_prev;
+    if (objp == (oc_object_t *)&ocp->lru) {
+      continue;
+    }
 
     chDbgAssert((objp->obj_flags & OC_FLAG_INLRU) == OC_FLAG_INLRU,
                 "not in LRU");
@@ -215,6 +228,130 @@ static oc_object_t *lru_get_last_s(objects_cache_t *ocp) {
   }
 }
 
+/**
+ * @brief   Takes ownership of an object in the LRU list.
+ * @pre     The LRU semaphore counter must be greater than zero.
+ *
+ * @param[in] ocp       pointer to the @p objects_cache_t structure
+ * @param[in] objp      pointer to the @p oc_object_t structure
+ *
+ * @notapi
+ */
+static void lru_take_s(objects_cache_t *ocp, oc_object_t *objp) {
+
+  chDbgAssert((objp->obj_flags & OC_FLAG_INLRU) == OC_FLAG_INLRU,
+              "not in LRU");
+  chDbgAssert(chSemGetCounterI(&objp->obj_sem) == (cnt_t)1,
+              "semaphore counter not 1");
+
+  LRU_REMOVE(objp);
+  objp->obj_flags &= ~OC_FLAG_INLRU;
+
+  /* The object is no more in the LRU and it is owned now, there are no
+     waiting threads on both semaphores so using the "fast" variants.*/
+  chSemFastWaitI(&ocp->lru_sem);
+  chSemFastWaitI(&objp->obj_sem);
+}
+
+/**
+ * @brief   Returns an object taken using @p lru_take_s() in the LRU list.
+ * @details The object is inserted next to its older neighbour so that it
+ *          keeps its position in the LRU list, if the neighbour is no more
+ *          in the LRU list then the object is placed on the LRU tail.
+ *
+ * @param[in] ocp       pointer to the @p objects_cache_t structure
+ * @param[in] objp      pointer to the @p oc_object_t structure
+ * @param[in] olderp    older neighbour of the object when it was taken
+ *
+ * @notapi
+ */
+static void lru_return_s(objects_cache_t *ocp,
+                         oc_object_t *objp,
+                         oc_object_t *olderp) {
+
+  /* If some thread is waiting for this specific buffer then it is
+     handed directly without going through the LRU.*/
+  if (chSemGetCounterI(&objp->obj_sem) < (cnt_t)0) {
+    chCacheReleaseObjectI(ocp, objp);
+    return;
+  }
+
+  if ((olderp != (oc_object_t *)&ocp->lru) &&
+      ((olderp->obj_flags & OC_FLAG_INLRU) == 0U)) {
+    olderp = (oc_object_t *)&ocp->lru;
+  }
+  objp->lru_next = olderp;
+  objp->lru_prev = olderp->lru_prev;
+  olderp->lru_prev->lru_next = objp;
+  olderp->lru_prev = objp;
+  objp->obj_flags &= OC_FLAG_INHASH | OC_FLAG_LAZYWRITE;
+  objp->obj_flags |= OC_FLAG_INLRU;
+
+  /* Increasing the LRU counter semaphore and releasing the object, there
+     are no threads waiting on the object.*/
+  chSemSignalI(&ocp->lru_sem);
+  chSemFastSignalI(&objp->obj_sem);
+}
+
+/**
+ * @brief   Starts reading an object if not already in cache.
+ * @details Only a clean buffer available without waiting is used.
+ *
+ * @param[in] ocp       pointer to the @p objects_cache_t structure
+ * @param[in] group     object group identifier
+ * @param[in] key       object identifier within the group
+ * @param[out] startedp pointer to a flag set if the read has been started
+ * @return              The operation status.
+ * @retval false        if the read has been started or if the object is
+ *                      already in cache.
+ * @retval true         if no clean buffer is available.
+ *
+ * @notapi
+ */
+static bool cache_prefetch(objects_cache_t *ocp,
+                           uint32_t group,
+                           uint32_t key,
+                           bool *startedp) {
+  oc_object_t *objp;
+
+  *startedp = false;
+
+  chSysLock();
+
+  /* Nothing to do if the object is in cache or already being read.*/
+  if (hash_get_s(ocp, group, key) != NULL) {
+    chSysUnlock();
+    return false;
+  }
+
+  /* The LRU tail is used only if it does not require a write.*/
+  objp = ocp->lru.lru_prev;
+  if ((chSemGetCounterI(&ocp->lru_sem) <= (cnt_t)0) ||
+      ((objp->obj_flags & OC_FLAG_LAZYWRITE) != 0U)) {
+    chSysUnlock();
+    return true;
+  }
+  lru_take_s(ocp, objp);
+  if ((objp->obj_flags & OC_FLAG_INHASH) != 0U) {
+    HASH_REMOVE(objp);
+  }
+
+  /* Naming this object and publishing it in the hash table, threads
+     getting it will wait for the read to complete.*/
+  objp->obj_group = group;
+  objp->obj_key   = key;
+  objp->obj_flags = OC_FLAG_INHASH | OC_FLAG_NOTSYNC;
+  HASH_INSERT(ocp, objp, group, key);
+
+  chSysUnlock();
+
+  /* The reader is responsible for releasing the object.*/
+  (void) chCacheReadObject(ocp, objp, true);
+  *startedp = true;
+
+  return false;
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -328,6 +465,14 @@ oc_object_t *chCacheGetObject(objects_cache_t *ocp,
       LRU_REMOVE(objp);
       objp->obj_flags &= ~OC_FLAG_INLRU;
 
+      /* The LRU semaphore must account for the removed object. If the
+         counter is not positive then the object was meant for a thread
+         already signaled, that thread will find another object or wait
+         again.*/
+      if (chSemGetCounterI(&ocp->lru_sem) > (cnt_t)0) {
+        chSemFastWaitI(&ocp->lru_sem);
+      }
+
       /* Getting the object semaphore, we know there is no wait so
          using the "fast" variant.*/
       chSemFastWaitI(&objp->obj_sem);
@@ -486,6 +631,227 @@ bool chCacheWriteObject(objects_cache_t *ocp,
   return ocp->writef(ocp, objp, async);
 }
 
+/**
+ * @brief   Writes back objects marked for lazy write.
+ * @details Up to @p OC_FLUSH_BATCH objects marked as @p OC_FLAG_LAZYWRITE
+ *          are taken from the LRU list, starting from the least recently
+ *          used, and written synchronously in ascending group and key
+ *          order. Written objects keep their position in the LRU list.
+ * @note    The function is meant to be called periodically by a low
+ *          priority thread, this way objects are usually clean when they
+ *          are evicted and cache misses do not wait for writes.
+ * @note    Objects failing the write are kept marked for lazy write.
+ * @note    The critical section is released every @p OC_FLUSH_SCAN
+ *          examined objects, the scan stops if the next object has been
+ *          taken meanwhile.
+ *
+ * @param[in] ocp       pointer to the @p objects_cache_t structure
+ * @return              The number of written objects.
+ *
+ * @api
+ */
+unsigned chCacheFlush(objects_cache_t *ocp) {
+  oc_object_t *objs[OC_FLUSH_BATCH];
+  oc_object_t *taken[OC_FLUSH_BATCH];
+  oc_object_t *olders[OC_FLUSH_BATCH];
+  oc_object_t *objp, *olderp;
+  unsigned i, n = 0U, scanned = 0U;
+
+  chSysLock();
+
+  /* Collecting dirty objects from the LRU tail, objects are taken only
+     while the LRU semaphore accounts for them, a thread could have been
+     already signaled for an object still in the list.*/
+  objp   = ocp->lru.lru_prev;
+  olderp = (oc_object_t *)&ocp->lru;
+  while ((objp != (oc_object_t *)&ocp->lru) &&
+         (n < (unsigned)OC_FLUSH_BATCH) &&
+         (scanned < (unsigned)ocp->objn) &&
+         (chSemGetCounterI(&ocp->lru_sem) > (cnt_t)0)) {
+    oc_object_t *prevp = objp->lru_prev;
+
+    if ((objp->obj_flags & OC_FLAG_LAZYWRITE) != 0U) {
+      /* The older neighbour is recorded in order to return the object
+         in the same LRU position, it is the previously examined object
+         because the links are changed by taking objects.*/
+      taken[n]  = objp;
+      olders[n] = olderp;
+      lru_take_s(ocp, objp);
+
+      /* Insertion sort by group and key.*/
+      for (i = n; i > 0U; i--) {
+        if ((objs[i - 1U]->obj_group < objp->obj_group) ||
+            ((objs[i - 1U]->obj_group == objp->obj_group) &&
+             (objs[i - 1U]->obj_key < objp->obj_key))) {
+          break;
+        }
+        objs[i] = objs[i - 1U];
+      }
+      objs[i] = objp;
+      n++;
+    }
+    olderp = objp;
+    objp   = prevp;
+    scanned++;
+
+    /* Bounding the time spent in the critical section, the scan cannot
+       continue if the next object has been taken meanwhile.*/
+    if ((scanned % (unsigned)OC_FLUSH_SCAN) == 0U) {
+      chSysUnlock();
+      chSysLock();
+      if ((objp != (oc_object_t *)&ocp->lru) &&
+          ((objp->obj_flags & OC_FLAG_INLRU) == 0U)) {
+        break;
+      }
+    }
+  }
+
+  chSysUnlock();
+
+  /* Writing in order, the writes to the media are sequential when the
+     keys are contiguous.*/
+  for (i = 0U; i < n; i++) {
+    objp = objs[i];
+    if (chCacheWriteObject(ocp, objp, false)) {
+      objp->obj_flags |= OC_FLAG_LAZYWRITE;
+    }
+  }
+
+  /* Returning the objects in the order they have been taken, older
+     objects first, this way the older neighbour of an object is already
+     back in the LRU list if it has been flushed too.*/
+  chSysLock();
+  for (i = 0U; i < n; i++) {
+    lru_return_s(ocp, taken[i], olders[i]);
+  }
+  chSchRescheduleS();
+  chSysUnlock();
+
+  return n;
+}
+
+/**
+ * @brief   Starts reading the objects following the current one.
+ * @details Objects with keys from @p key to <tt>key + n - 1</tt> not
+ *          already in cache are read asynchronously, the read function is
+ *          responsible for releasing the objects. Threads getting an
+ *          object being read wait for the read to complete.
+ * @note    The function does not wait, it stops on the first object
+ *          for which a clean buffer is not available.
+ * @note    The read function must support asynchronous operations in
+ *          order to overlap the reads with the processing of the current
+ *          object.
+ *
+ * @param[in] ocp       pointer to the @p objects_cache_t structure
+ * @param[in] group     object group identifier
+ * @param[in] key       first object identifier within the group
+ * @param[in] n         number of objects
+ * @return              The number of started reads.
+ *
+ * @api
+ */
+unsigned chCacheReadAhead(objects_cache_t *ocp,
+                          uint32_t group,
+                          uint32_t key,
+                          unsigned n) {
+  unsigned started = 0U;
+
+  while (n > 0U) {
+    bool b;
+
+    if (cache_prefetch(ocp, group, key, &b)) {
+      break;
+    }
+    if (b) {
+      started++;
+    }
+    key++;
+    n--;
+  }
+
+  return started;
+}
+
+/**
+ * @brief   Initializes a @p objects_cache_shards_t object.
+ * @note    The shard caches must be initialized using
+ *          @p chCacheObjectInit().
+ *
+ * @param[out] ocsp     pointer to the @p objects_cache_shards_t structure
+ *                      to be initialized
+ * @param[in] shardn    number of elements in the shards array, must be a
+ *                      power of two not greater than 256
+ * @param[in] shards    pointer to the shards array
+ *
+ * @init
+ */
+void chCacheShardsObjectInit(objects_cache_shards_t *ocsp,
+                             ucnt_t shardn,
+                             objects_cache_t *shards) {
+
+  chDbgCheck((ocsp != NULL) && (shards != NULL) &&
+             (shardn > (ucnt_t)0) && (shardn <= (ucnt_t)256) &&
+             ((shardn & (shardn - (ucnt_t)1)) == (ucnt_t)0));
+
+  ocsp->shardn = shardn;
+  ocsp->shards = shards;
+}
+
+/**
+ * @brief   Writes back objects marked for lazy write in all shards.
+ * @see     chCacheFlush()
+ *
+ * @param[in] ocsp      pointer to the @p objects_cache_shards_t structure
+ * @return              The number of written objects.
+ *
+ * @api
+ */
+unsigned chCacheShardsFlush(objects_cache_shards_t *ocsp) {
+  unsigned n = 0U;
+  ucnt_t i;
+
+  for (i = (ucnt_t)0; i < ocsp->shardn; i++) {
+    n += chCacheFlush(&ocsp->shards[i]);
+  }
+
+  return n;
+}
+
+/**
+ * @brief   Starts reading the objects following the current one.
+ * @details Each object is read by the shard responsible for it.
+ * @see     chCacheReadAhead()
+ *
+ * @param[in] ocsp      pointer to the @p objects_cache_shards_t structure
+ * @param[in] group     object group identifier
+ * @param[in] key       first object identifier within the group
+ * @param[in] n         number of objects
+ * @return              The number of started reads.
+ *
+ * @api
+ */
+unsigned chCacheShardsReadAhead(objects_cache_shards_t *ocsp,
+                                uint32_t group,
+                                uint32_t key,
+                                unsigned n) {
+  unsigned started = 0U;
+
+  while (n > 0U) {
+    bool b;
+
+    if (cache_prefetch(chCacheGetShardX(ocsp, group, key), group, key, &b)) {
+      break;
+    }
+    if (b) {
+      started++;
+    }
+    key++;
+    n--;
+  }
+
+  return started;
+}
+
 #endif /* CH_CFG_USE_OBJ_CACHES == TRUE */
 
 /** @} */
@@ -0,0 +1,351 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    oslib/src/chobjfifos.c
+ * @brief   Objects FIFOs code.
+ * @details Multicast objects FIFOs.
+ *          <h2>Operation mode</h2>
+ *          A multicast FIFO delivers each published object to all the
+ *          subscribers without copying it, a pointer is posted in the
+ *          mailbox of each subscriber and a references counter is
+ *          associated to the object. Subscribers release the received
+ *          objects, the object is returned to the pool of the free
+ *          objects when the last reference is released.<br>
+ *          Publishing is never blocking, if the mailbox of a subscriber
+ *          is full then the object is not delivered to that subscriber
+ *          and its dropped objects counter is incremented. A subscriber
+ *          mailbox able to hold all the FIFO objects can never be full.
+ * @pre     In order to use the objects FIFOs APIs the
+ *          @p CH_CFG_USE_OBJ_FIFOS option must be enabled in @p chconf.h.
+ * @note    Compatible with RT and NIL.
+ *
+ * @addtogroup oslib_objects_fifos
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_CFG_USE_OBJ_FIFOS == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+static ucnt_t *multicast_get_ref(objects_multicast_t *omp, void *objp) {
+  size_t offset = (size_t)((uint8_t *)objp - omp->objbuf);
+
+  chDbgAssert(((uint8_t *)objp >= omp->objbuf) &&
+              (offset < omp->objsize * omp->objn) &&
+              ((offset % omp->objsize) == 0U), "not a FIFO object");
+
+  return &omp->refs[offset / omp->objsize];
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a multicast FIFO object.
+ * @pre     The messages size must be a multiple of the alignment
+ *          requirement.
+ *
+ * @param[out] omp      pointer to a @p objects_multicast_t structure
+ * @param[in] objsize   size of objects
+ * @param[in] objn      number of objects available
+ * @param[in] objalign  required objects alignment
+ * @param[in] objbuf    pointer to the buffer of objects, it must be able
+ *                      to hold @p objn objects of @p objsize size with
+ *                      @p objalign alignment
+ * @param[in] refbuf    pointer to the buffer of references counters, it
+ *                      must be able to hold @p objn counters
+ *
+ * @init
+ */
+void chFifoMulticastObjectInitAligned(objects_multicast_t *omp,
+                                      size_t objsize, size_t objn,
+                                      unsigned objalign, void *objbuf,
+                                      ucnt_t *refbuf) {
+  size_t i;
+
+  chDbgCheck((omp != NULL) && (objn > 0U) && (objbuf != NULL) &&
+             (refbuf != NULL) &&
+             (objsize >= objalign) && ((objsize % objalign) == 0U));
+
+  chGuardedPoolObjectInitAligned(&omp->free, objsize, objalign);
+  chGuardedPoolLoadArray(&omp->free, objbuf, objn);
+  omp->objbuf      = (uint8_t *)objbuf;
+  omp->objsize     = objsize;
+  omp->objn        = objn;
+  omp->refs        = refbuf;
+  omp->subscribers = NULL;
+  for (i = 0U; i < objn; i++) {
+    refbuf[i] = (ucnt_t)0;
+  }
+}
+
+/**
+ * @brief   Initializes a multicast FIFO subscriber object.
+ * @note    A mailbox of @p n messages, where @p n is the number of objects
+ *          of the FIFO, guarantees that no objects are dropped.
+ *
+ * @param[out] osp      pointer to a @p objects_subscriber_t structure
+ * @param[in] msgbuf    pointer to the buffer of messages, it must be able
+ *                      to hold @p n messages
+ * @param[in] n         number of elements in the buffer of messages
+ *
+ * @init
+ */
+void chFifoSubscriberObjectInit(objects_subscriber_t *osp,
+                                msg_t *msgbuf, size_t n) {
+
+  chDbgCheck(osp != NULL);
+
+  chMBObjectInit(&osp->mbx, msgbuf, n);
+  osp->next    = NULL;
+  osp->dropped = (ucnt_t)0;
+}
+
+/**
+ * @brief   Adds a subscriber to a multicast FIFO.
+ * @note    Only the objects published after this call are received.
+ *
+ * @param[in] omp       pointer to a @p objects_multicast_t structure
+ * @param[in] osp       pointer to the @p objects_subscriber_t structure
+ *
+ * @api
+ */
+void chFifoSubscribe(objects_multicast_t *omp, objects_subscriber_t *osp) {
+
+  chDbgCheck((omp != NULL) && (osp != NULL));
+
+  chSysLock();
+  osp->next = omp->subscribers;
+  omp->subscribers = osp;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Removes a subscriber from a multicast FIFO.
+ * @details The objects still in the subscriber mailbox are released.
+ * @pre     No threads must be waiting on the subscriber mailbox.
+ *
+ * @param[in] omp       pointer to a @p objects_multicast_t structure
+ * @param[in] osp       pointer to the @p objects_subscriber_t structure
+ *
+ * @api
+ */
+void chFifoUnsubscribe(objects_multicast_t *omp, objects_subscriber_t *osp) {
+  objects_subscriber_t **ospp;
+  void *objp;
+
+  chDbgCheck((omp != NULL) && (osp != NULL));
+
+  chSysLock();
+  ospp = &omp->subscribers;
+  while (*ospp != NULL) {
+    if (*ospp == osp) {
+      *ospp = osp->next;
+      break;
+    }
+    ospp = &(*ospp)->next;
+  }
+  osp->next = NULL;
+
+  while (chMBFetchI(&osp->mbx, (msg_t *)&objp) == MSG_OK) {
+    chFifoReleaseObjectI(omp, objp);
+  }
+  chSchRescheduleS();
+  chSysUnlock();
+}
+
+/**
+ * @brief   Publishes an object to all the subscribers.
+ * @details A reference to the object is posted in the mailbox of each
+ *          subscriber, the object is returned to the pool immediately
+ *          if there are no subscribers.
+ * @note    By design the object is never copied and the function is
+ *          never blocking, the object must not be modified after being
+ *          published.
+ *
+ * @param[in] omp       pointer to a @p objects_multicast_t structure
+ * @param[in] objp      pointer to the object to be published
+ * @return              The number of subscribers the object has been
+ *                      delivered to.
+ *
+ * @iclass
+ */
+unsigned chFifoPublishObjectI(objects_multicast_t *omp, void *objp) {
+  objects_subscriber_t *osp;
+  ucnt_t *refp;
+  unsigned n = 0U;
+
+  chDbgCheckClassI();
+  chDbgCheck((omp != NULL) && (objp != NULL));
+
+  refp = multicast_get_ref(omp, objp);
+  chDbgAssert(*refp == (ucnt_t)0, "already published");
+
+  /* Posting is immediate, a full mailbox means that the subscriber is
+     lagging, the object is dropped for that subscriber only.*/
+  for (osp = omp->subscribers; osp != NULL; osp = osp->next) {
+    if (chMBPostI(&osp->mbx, (msg_t)objp) == MSG_OK) {
+      n++;
+    }
+    else {
+      osp->dropped++;
+    }
+  }
+
+  *refp = (ucnt_t)n;
+  if (n == 0U) {
+    chGuardedPoolFreeI(&omp->free, objp);
+  }
+
+  return n;
+}
+
+/**
+ * @brief   Publishes an object to all the subscribers.
+ * @details A reference to the object is posted in the mailbox of each
+ *          subscriber, the object is returned to the pool immediately
+ *          if there are no subscribers.
+ * @note    By design the object is never copied and the function is
+ *          never blocking, the object must not be modified after being
+ *          published.
+ *
+ * @param[in] omp       pointer to a @p objects_multicast_t structure
+ * @param[in] objp      pointer to the object to be published
+ * @return              The number of subscribers the object has been
+ *                      delivered to.
+ *
+ * @sclass
+ */
+unsigned chFifoPublishObjectS(objects_multicast_t *omp, void *objp) {
+  unsigned n;
+
+  n = chFifoPublishObjectI(omp, objp);
+  chSchRescheduleS();
+
+  return n;
+}
+
+/**
+ * @brief   Publishes an object to all the subscribers.
+ * @details A reference to the object is posted in the mailbox of each
+ *          subscriber, the object is returned to the pool immediately
+ *          if there are no subscribers.
+ * @note    By design the object is never copied and the function is
+ *          never blocking, the object must not be modified after being
+ *          published.
+ *
+ * @param[in] omp       pointer to a @p objects_multicast_t structure
+ * @param[in] objp      pointer to the object to be published
+ * @return              The number of subscribers the object has been
+ *                      delivered to.
+ *
+ * @api
+ */
+unsigned chFifoPublishObject(objects_multicast_t *omp, void *objp) {
+  unsigned n;
+
+  chSysLock();
+  n = chFifoPublishObjectS(omp, objp);
+  chSysUnlock();
+
+  return n;
+}
+
+/**
+ * @brief   Releases a received object.
+ * @details The object is returned to the pool when the last reference
+ *          is released.
+ *
+ * @param[in] omp       pointer to a @p objects_multicast_t structure
+ * @param[in] objp      pointer to the object to be released
+ *
+ * @iclass
+ */
+void chFifoReleaseObjectI(objects_multicast_t *omp, void *objp) {
+  ucnt_t *refp;
+
+  chDbgCheckClassI();
+  chDbgCheck((omp != NULL) && (objp != NULL));
+
+  refp = multicast_get_ref(omp, objp);
+  chDbgAssert(*refp > (ucnt_t)0, "not referenced");
+
+  if (--*refp == (ucnt_t)0) {
+    chGuardedPoolFreeI(&omp->free, objp);
+  }
+}
+
+/**
+ * @brief   Releases a received object.
+ * @details The object is returned to the pool when the last reference
+ *          is released.
+ *
+ * @param[in] omp       pointer to a @p objects_multicast_t structure
+ * @param[in] objp      pointer to the object to be released
+ *
+ * @sclass
+ */
+void chFifoReleaseObjectS(objects_multicast_t *omp, void *objp) {
+
+  chFifoReleaseObjectI(omp, objp);
+  chSchRescheduleS();
+}
+
+/**
+ * @brief   Releases a received object.
+ * @details The object is returned to the pool when the last reference
+ *          is released.
+ *
+ * @param[in] omp       pointer to a @p objects_multicast_t structure
+ * @param[in] objp      pointer to the object to be released
+ *
+ * @api
+ */
+void chFifoReleaseObject(objects_multicast_t *omp, void *objp) {
+
+  chSysLock();
+  chFifoReleaseObjectS(omp, objp);
+  chSysUnlock();
+}
+
+#endif /* CH_CFG_USE_OBJ_FIFOS == TRUE */
+
+/** @} */
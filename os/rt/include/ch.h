@@ -106,6 +106,8 @@
 #include "chport.h"
 #include "chtm.h"
 #include "chstats.h"
+#include "chsyncprof.h"
+#include "chprof.h"
 #include "chobjects.h"
 #include "chsys.h"
 #include "chinstances.h"
@@ -46,12 +46,49 @@
 #if !defined(CH_DBG_STACK_FILL_VALUE) || defined(__DOXYGEN__)
 #define CH_DBG_STACK_FILL_VALUE             0x55
 #endif
+
+/**
+ * @brief   Stack high-water tracking.
+ * @details If enabled then the idle thread incrementally scans the filled
+ *          stacks of the registered threads, the lowest stack address
+ *          found in use is cached in each thread.
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_DBG_STACK_WATERMARK) || defined(__DOXYGEN__)
+#define CH_DBG_STACK_WATERMARK              FALSE
+#endif
+
+/**
+ * @brief   Stack bytes scanned on each idle loop iteration.
+ * @note    The scan is performed within a critical zone.
+ */
+#if !defined(CH_DBG_STACK_WATERMARK_STEP) || defined(__DOXYGEN__)
+#define CH_DBG_STACK_WATERMARK_STEP         64
+#endif
 /** @} */
 
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if CH_DBG_STACK_WATERMARK == TRUE
+#if CH_DBG_FILL_THREADS == FALSE
+#error "CH_DBG_STACK_WATERMARK requires CH_DBG_FILL_THREADS"
+#endif
+
+#if CH_CFG_USE_REGISTRY == FALSE
+#error "CH_DBG_STACK_WATERMARK requires CH_CFG_USE_REGISTRY"
+#endif
+
+#if CH_CFG_NO_IDLE_THREAD == TRUE
+#error "CH_DBG_STACK_WATERMARK requires the idle thread"
+#endif
+
+#if CH_DBG_STACK_WATERMARK_STEP < 1
+#error "invalid CH_DBG_STACK_WATERMARK_STEP value"
+#endif
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -64,6 +64,9 @@ struct ch_mutex {
 #if (CH_CFG_USE_MUTEXES_RECURSIVE == TRUE) || defined(__DOXYGEN__)
   cnt_t                 cnt;        /**< @brief Mutex recursion counter.    */
 #endif
+#if (CH_DBG_SYNC_PROFILING == TRUE) || defined(__DOXYGEN__)
+  sync_profile_t        profile;    /**< @brief Contention profile.         */
+#endif
 };
 
 /*===========================================================================*/
@@ -78,9 +81,11 @@ struct ch_mutex {
  * @param[in] name      the name of the mutex variable
  */
 #if (CH_CFG_USE_MUTEXES_RECURSIVE == TRUE) || defined(__DOXYGEN__)
-#define __MUTEX_DATA(name) {__CH_QUEUE_DATA(name.queue), NULL, NULL, 0}
+#define __MUTEX_DATA(name) {__CH_QUEUE_DATA(name.queue), NULL, NULL, 0     \
+                            __SYNC_PROFILE_DATA}
 #else
-#define __MUTEX_DATA(name) {__CH_QUEUE_DATA(name.queue), NULL, NULL}
+#define __MUTEX_DATA(name) {__CH_QUEUE_DATA(name.queue), NULL, NULL         \
+                            __SYNC_PROFILE_DATA}
 #endif
 
 /**
@@ -161,6 +166,21 @@ static inline mutex_t *chMtxGetNextMutexX(void) {
   return chThdGetSelfX()->mtxlist;
 }
 
+#if (CH_DBG_SYNC_PROFILING == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Registers the mutex contention profile.
+ *
+ * @param[in] mp        pointer to a @p mutex_t structure
+ * @param[in] name      name to be assigned to the mutex
+ *
+ * @api
+ */
+static inline void chMtxProfileRegister(mutex_t *mp, const char *name) {
+
+  chSyncProfileRegister(&mp->profile, name);
+}
+#endif
+
 #endif /* CH_CFG_USE_MUTEXES == TRUE */
 
 #endif /* CHMTX_H */
@@ -36,10 +36,32 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Size of the registry names hash index.
+ * @details If greater than zero then the registered threads are also
+ *          linked in a hash table indexed by name, this way
+ *          @p chRegFindThreadByName() does not need to scan the whole
+ *          registry.
+ * @note    The value must be zero or a power of two.
+ * @note    The default is zero, the index is disabled.
+ */
+#if !defined(CH_CFG_REGISTRY_HASH_SIZE) || defined(__DOXYGEN__)
+#define CH_CFG_REGISTRY_HASH_SIZE           0
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
 
+#if (CH_CFG_REGISTRY_HASH_SIZE < 0) ||                                      \
+    ((CH_CFG_REGISTRY_HASH_SIZE & (CH_CFG_REGISTRY_HASH_SIZE - 1)) != 0)
+#error "CH_CFG_REGISTRY_HASH_SIZE must be zero or a power of two"
+#endif
+
+#if (CH_CFG_REGISTRY_HASH_SIZE > 0) && (CH_CFG_USE_REGISTRY == FALSE)
+#error "CH_CFG_REGISTRY_HASH_SIZE requires CH_CFG_USE_REGISTRY"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -130,6 +152,12 @@ typedef struct ch_registry {
    * @brief   Registry queue header.
    */
   ch_queue_t                    queue;
+#if (CH_CFG_REGISTRY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+  /**
+   * @brief   Names hash chains headers.
+   */
+  thread_t                      *hash[CH_CFG_REGISTRY_HASH_SIZE];
+#endif
 } registry_t;
 
 /**
@@ -191,6 +219,18 @@ struct ch_thread {
    */
   const char                    *name;
 #endif
+#if (CH_CFG_REGISTRY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+  /**
+   * @brief   Next thread in the names hash chain.
+   */
+  thread_t                      *hnext;
+  /**
+   * @brief   Pointer to the link pointing to this thread in the names hash
+   *          chain.
+   * @note    @p NULL if the thread is no more in the registry.
+   */
+  thread_t                      **hprevp;
+#endif
 #if (CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE) ||  \
     defined(__DOXYGEN__)
   /**
@@ -199,6 +239,21 @@ struct ch_thread {
    *          dynamic threading.
    */
   stkalign_t                    *wabase;
+#endif
+#if (CH_DBG_STACK_WATERMARK == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Stack limit for the watermark scan.
+   * @note    @p NULL if the stack is not tracked.
+   */
+  uint8_t                       *wmbase;
+  /**
+   * @brief   Next stack address to be scanned.
+   */
+  uint8_t                       *wmnext;
+  /**
+   * @brief   Lowest stack address found in use.
+   */
+  uint8_t                       *wmmark;
 #endif
   /**
    * @brief   Current thread state.
@@ -407,6 +462,12 @@ struct ch_os_instance {
    * @note    This field is present only if the SMP mode is disabled.
    */
   registry_t                    reglist;
+#endif
+#if (CH_DBG_STACK_WATERMARK == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Thread under stack watermark scan or @p NULL.
+   */
+  thread_t                      *wmthread;
 #endif
   /**
    * @brief   Core associated to this instance.
@@ -437,6 +498,12 @@ struct ch_os_instance {
    */
   trace_buffer_t                trace_buffer;
 #endif
+#if (CH_DBG_PROFILER == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Profiler samples buffer.
+   */
+  prof_buffer_t                 prof_buffer;
+#endif
 #if (CH_DBG_STATISTICS == TRUE) || defined(__DOXYGEN__)
   /**
    * @brief   Global kernel statistics.
@@ -477,6 +544,12 @@ typedef struct ch_system {
    */
   registry_t                    reglist;
 #endif
+#if (CH_DBG_SYNC_PROFILING == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Registered synchronization objects profiles.
+   */
+  sync_profile_t                *syncprof;
+#endif
 #if (CH_CFG_SMP_MODE == TRUE) || defined(__DOXYGEN__)
   /**
    * @brief   Runtime Faults Collection Unit.
@@ -0,0 +1,158 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    rt/include/chprof.h
+ * @brief   Sampling profiler macros and structures.
+ *
+ * @addtogroup profiler
+ * @{
+ */
+
+#ifndef CHPROF_H
+#define CHPROF_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Sampling profiler.
+ * @details If enabled then program counter samples can be collected in a
+ *          per-core buffer and fetched using @p chProfRead().
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_DBG_PROFILER) || defined(__DOXYGEN__)
+#define CH_DBG_PROFILER                     FALSE
+#endif
+
+/**
+ * @brief   Profiler buffer size.
+ * @note    The value must be a power of two.
+ */
+#if !defined(CH_DBG_PROFILER_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define CH_DBG_PROFILER_BUFFER_SIZE         256
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (CH_DBG_PROFILER_BUFFER_SIZE < 2) ||                                    \
+    ((CH_DBG_PROFILER_BUFFER_SIZE & (CH_DBG_PROFILER_BUFFER_SIZE - 1)) != 0)
+#error "CH_DBG_PROFILER_BUFFER_SIZE must be a power of two"
+#endif
+
+/**
+ * @brief   Port sampling source availability.
+ * @details Ports able to generate samples define this macro to @p TRUE and
+ *          implement @p port_prof_start() and @p port_prof_stop(). On
+ *          other ports samples are fed by the application calling
+ *          @p chProfSampleX() from a periodic interrupt.
+ */
+#if !defined(PORT_SUPPORTS_PROFILER) || defined(__DOXYGEN__)
+#define PORT_SUPPORTS_PROFILER              FALSE
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+#if (CH_DBG_PROFILER == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Profiler sample.
+ */
+typedef struct {
+  /**
+   * @brief   Interrupted program counter.
+   */
+  void                  *pc;
+  /**
+   * @brief   Thread running when the sample has been taken.
+   */
+  thread_t              *tp;
+} prof_sample_t;
+
+/**
+ * @brief   Profiler buffer.
+ * @details The buffer is a single producer single consumer ring, samples
+ *          are written without locking so that they can be taken from
+ *          contexts not masked by the kernel locks.
+ */
+typedef struct {
+  /**
+   * @brief   Sampling frequency or zero if not known.
+   */
+  uint32_t              frequency;
+  /**
+   * @brief   Write index, free running.
+   */
+  volatile ucnt_t       wridx;
+  /**
+   * @brief   Read index, free running.
+   */
+  volatile ucnt_t       rdidx;
+  /**
+   * @brief   Samples dropped because buffer full, cumulative.
+   */
+  volatile ucnt_t       lost;
+  /**
+   * @brief   Samples buffer.
+   */
+  volatile prof_sample_t buffer[CH_DBG_PROFILER_BUFFER_SIZE];
+} prof_buffer_t;
+#endif /* CH_DBG_PROFILER == TRUE */
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if (CH_DBG_PROFILER == TRUE) || defined(__DOXYGEN__)
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void __prof_object_init(prof_buffer_t *pbp);
+  void chProfSampleX(void *pc);
+  unsigned chProfRead(prof_sample_t *psp, unsigned n, ucnt_t *lostp);
+  unsigned chProfGetPendingX(void);
+  uint32_t chProfGetFrequencyX(void);
+#if (PORT_SUPPORTS_PROFILER == TRUE) || defined(__DOXYGEN__)
+  void chProfStart(uint32_t frequency);
+  void chProfStop(void);
+#endif
+#ifdef __cplusplus
+}
+#endif
+#endif /* CH_DBG_PROFILER == TRUE */
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+#endif /* CHPROF_H */
+
+/** @} */
@@ -34,6 +34,11 @@
 /* Module constants.                                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Unused stack space of a thread not tracked by the watermark.
+ */
+#define CH_REG_STACK_UNKNOWN                ((size_t)-1)
+
 /*===========================================================================*/
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
@@ -83,13 +88,31 @@ typedef struct {
 #define REG_HEADER(oip) (&(oip)->reglist.queue)
 #endif
 
+/**
+ * @brief   Access to the registry names hash index.
+ */
+#if (CH_CFG_SMP_MODE == TRUE) || defined(__DOXYGEN__)
+#define REG_HASH(oip) (&ch_system.reglist.hash[0])
+#else
+#define REG_HASH(oip) (&(oip)->reglist.hash[0])
+#endif
+
 /**
  * @brief   Removes a thread from the registry list.
  * @note    This macro is not meant for use in application code.
  *
  * @param[in] tp        thread to remove from the registry
  */
+#if (CH_CFG_REGISTRY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+#define REG_REMOVE(tp) __reg_remove(tp)
+#elif CH_DBG_STACK_WATERMARK == TRUE
+#define REG_REMOVE(tp) do {                                                 \
+  __reg_stack_forget(tp);                                                   \
+  (void) ch_queue_dequeue(&(tp)->rqueue);                                   \
+} while (false)
+#else
 #define REG_REMOVE(tp) (void) ch_queue_dequeue(&(tp)->rqueue)
+#endif
 
 /**
  * @brief   Adds a thread to the registry list.
@@ -98,7 +121,11 @@ typedef struct {
  * @param[in] oip       pointer to the OS instance
  * @param[in] tp        thread to add to the registry
  */
+#if (CH_CFG_REGISTRY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+#define REG_INSERT(oip, tp) __reg_insert(oip, tp)
+#else
 #define REG_INSERT(oip, tp) ch_queue_insert(REG_HEADER(oip), &(tp)->rqueue)
+#endif
 
 /*===========================================================================*/
 /* External declarations.                                                    */
@@ -113,6 +140,15 @@ extern "C" {
   thread_t *chRegFindThreadByName(const char *name);
   thread_t *chRegFindThreadByPointer(thread_t *tp);
   thread_t *chRegFindThreadByWorkingArea(stkalign_t *wa);
+#if CH_DBG_STACK_WATERMARK == TRUE
+  void __reg_stack_forget(thread_t *tp);
+  void __reg_stack_scan(os_instance_t *oip);
+#endif
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+  void __reg_insert(os_instance_t *oip, thread_t *tp);
+  void __reg_remove(thread_t *tp);
+  void __reg_rename(thread_t *tp, const char *name);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -132,6 +168,13 @@ extern "C" {
  * @init
  */
 static inline void __reg_object_init(registry_t *rp) {
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+  unsigned i;
+
+  for (i = 0U; i < (unsigned)CH_CFG_REGISTRY_HASH_SIZE; i++) {
+    rp->hash[i] = NULL;
+  }
+#endif
 
   ch_queue_init(&rp->queue);
 }
@@ -147,7 +190,9 @@ static inline void __reg_object_init(registry_t *rp) {
  */
 static inline void chRegSetThreadName(const char *name) {
 
-#if CH_CFG_USE_REGISTRY == TRUE
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+  __reg_rename(__sch_get_currthread(), name);
+#elif CH_CFG_USE_REGISTRY == TRUE
   __sch_get_currthread()->name = name;
 #else
   (void)name;
@@ -187,7 +232,9 @@ static inline const char *chRegGetThreadNameX(thread_t *tp) {
  */
 static inline void chRegSetThreadNameX(thread_t *tp, const char *name) {
 
-#if CH_CFG_USE_REGISTRY == TRUE
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+  __reg_rename(tp, name);
+#elif CH_CFG_USE_REGISTRY == TRUE
   tp->name = name;
 #else
   (void)tp;
@@ -195,6 +242,31 @@ static inline void chRegSetThreadNameX(thread_t *tp, const char *name) {
 #endif
 }
 
+#if (CH_DBG_STACK_WATERMARK == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Returns the stack space never used by the specified thread.
+ * @details The value is the one found by the last completed scan of the
+ *          thread stack, the stack usage can only be underestimated.
+ * @pre     The option @p CH_DBG_STACK_WATERMARK must be enabled.
+ *
+ * @param[in] tp        pointer to the thread
+ * @return              The unused stack space in bytes.
+ * @retval CH_REG_STACK_UNKNOWN if the thread stack is not tracked, this is
+ *                      the case of the main thread and of threads created
+ *                      without filling the stack.
+ *
+ * @xclass
+ */
+static inline size_t chRegGetStackUnusedX(thread_t *tp) {
+
+  if (tp->wmbase == NULL) {
+    return CH_REG_STACK_UNKNOWN;
+  }
+
+  return (size_t)(tp->wmmark - tp->wmbase);
+}
+#endif
+
 #endif /* CHREGISTRY_H */
 
 /** @} */
@@ -53,6 +53,9 @@ typedef struct ch_semaphore {
   ch_queue_t            queue;      /**< @brief Queue of the threads sleeping
                                                 on this semaphore.          */
   cnt_t                 cnt;        /**< @brief The semaphore counter.      */
+#if (CH_DBG_SYNC_PROFILING == TRUE) || defined(__DOXYGEN__)
+  sync_profile_t        profile;    /**< @brief Contention profile.         */
+#endif
 } semaphore_t;
 
 /*===========================================================================*/
@@ -68,7 +71,8 @@ typedef struct ch_semaphore {
  * @param[in] n         the counter initial value, this value must be
  *                      non-negative
  */
-#define __SEMAPHORE_DATA(name, n) {__CH_QUEUE_DATA(name.queue), n}
+#define __SEMAPHORE_DATA(name, n) {__CH_QUEUE_DATA(name.queue), n            \
+                                   __SYNC_PROFILE_DATA}
 
 /**
  * @brief   Static semaphore initializer.
@@ -193,6 +197,21 @@ static inline cnt_t chSemGetCounterI(const semaphore_t *sp) {
   return sp->cnt;
 }
 
+#if (CH_DBG_SYNC_PROFILING == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Registers the semaphore contention profile.
+ *
+ * @param[in] sp        pointer to a @p semaphore_t structure
+ * @param[in] name      name to be assigned to the semaphore
+ *
+ * @api
+ */
+static inline void chSemProfileRegister(semaphore_t *sp, const char *name) {
+
+  chSyncProfileRegister(&sp->profile, name);
+}
+#endif
+
 #endif /* CH_CFG_USE_SEMAPHORES == TRUE */
 
 #endif /* CHSEM_H */
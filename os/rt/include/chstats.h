@@ -38,6 +38,17 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   ISRs time accounting.
+ * @details If enabled the time spent in ISRs is measured and it is not
+ *          accounted to the interrupted threads.
+ * @note    The measurement adds some overhead to ISR prologue and epilogue
+ *          code.
+ */
+#if !defined(CH_DBG_STATISTICS_ISR) || defined(__DOXYGEN__)
+#define CH_DBG_STATISTICS_ISR               FALSE
+#endif
+
 #if CH_CFG_USE_TM == FALSE
 #error "CH_DBG_STATISTICS requires CH_CFG_USE_TM"
 #endif
@@ -60,6 +71,14 @@ typedef struct {
                                                 critical zones duration.    */
   time_measurement_t    m_crit_isr; /**< @brief Measurement of ISRs critical
                                                 zones duration.             */
+#if (CH_DBG_STATISTICS_ISR == TRUE) || defined(__DOXYGEN__)
+  ucnt_t                isr_nesting;/**< @brief ISRs nesting level.         */
+  rttime_t              isr_pending;/**< @brief ISRs time not yet removed
+                                                from the current thread.    */
+  time_measurement_t    m_isr;      /**< @brief Measurement of ISRs
+                                                duration, nested ISRs are
+                                                accounted as one.           */
+#endif
 } kernel_stats_t;
 
 /*===========================================================================*/
@@ -75,6 +94,9 @@ extern "C" {
 #endif
   void __stats_init(void);
   void __stats_increase_irq(void);
+#if CH_DBG_STATISTICS_ISR == TRUE
+  void __stats_leave_irq(void);
+#endif
   void __stats_ctxswc(thread_t *ntp, thread_t *otp);
   void __stats_start_measure_crit_thd(void);
   void __stats_stop_measure_crit_thd(void);
@@ -102,12 +124,22 @@ static inline void __stats_object_init(kernel_stats_t *ksp) {
   ksp->n_ctxswc = (ucnt_t)0;
   chTMObjectInit(&ksp->m_crit_thd);
   chTMObjectInit(&ksp->m_crit_isr);
+#if CH_DBG_STATISTICS_ISR == TRUE
+  ksp->isr_nesting = (ucnt_t)0;
+  ksp->isr_pending = (rttime_t)0;
+  chTMObjectInit(&ksp->m_isr);
+#endif
 }
 
+#if CH_DBG_STATISTICS_ISR == FALSE
+#define __stats_leave_irq()
+#endif
+
 #else /* CH_DBG_STATISTICS == FALSE */
 
 /* Stub functions for when the statistics module is disabled. */
 #define __stats_increase_irq()
+#define __stats_leave_irq()
 #define __stats_ctxswc(old, new)
 #define __stats_start_measure_crit_thd()
 #define __stats_stop_measure_crit_thd()
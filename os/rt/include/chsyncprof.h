@@ -0,0 +1,161 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    rt/include/chsyncprof.h
+ * @brief   Synchronization objects profiling macros and structures.
+ *
+ * @addtogroup sync_profiling
+ * @{
+ */
+
+#ifndef CHSYNCPROF_H
+#define CHSYNCPROF_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Synchronization objects contention profiling.
+ * @details If enabled then mutexes and semaphores collect acquisitions,
+ *          contention, wait and hold times statistics, objects registered
+ *          by name can be listed using @p chSyncProfileGetTop().
+ * @note    The default is @p FALSE.
+ * @note    The realtime counter is read on each acquisition and release,
+ *          this adds some overhead to the mutexes and semaphores code.
+ */
+#if !defined(CH_DBG_SYNC_PROFILING) || defined(__DOXYGEN__)
+#define CH_DBG_SYNC_PROFILING               FALSE
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (CH_DBG_SYNC_PROFILING == TRUE) && (CH_CFG_USE_TM == FALSE)
+#error "CH_DBG_SYNC_PROFILING requires CH_CFG_USE_TM"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a synchronization object profile.
+ */
+typedef struct ch_sync_profile sync_profile_t;
+
+/**
+ * @brief   Synchronization object profile structure.
+ * @note    Times are expressed in realtime counter cycles.
+ */
+struct ch_sync_profile {
+  sync_profile_t        *next;      /**< @brief Next registered profile.    */
+  const char            *name;      /**< @brief Object name or @p NULL if
+                                                not registered.             */
+  ucnt_t                n_acquire;  /**< @brief Number of acquisitions.     */
+  ucnt_t                n_contended;/**< @brief Number of acquisitions that
+                                                required waiting.           */
+  rttime_t              wait_total; /**< @brief Cumulative wait time.       */
+  rtcnt_t               wait_max;   /**< @brief Worst wait time.            */
+  rtcnt_t               hold_max;   /**< @brief Worst hold time, mutexes
+                                                only.                       */
+  rtcnt_t               hold_start; /**< @brief Last acquisition time.      */
+};
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @brief   Data part of a static profile initializer.
+ * @note    Internal use only, it expands to nothing if the profiling is
+ *          disabled.
+ */
+#if (CH_DBG_SYNC_PROFILING == TRUE) || defined(__DOXYGEN__)
+#define __SYNC_PROFILE_DATA                                                 \
+  , {NULL, NULL, (ucnt_t)0, (ucnt_t)0, (rttime_t)0,                         \
+     (rtcnt_t)0, (rtcnt_t)0, (rtcnt_t)0}
+#else
+#define __SYNC_PROFILE_DATA
+#endif
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#if (CH_DBG_SYNC_PROFILING == TRUE) || defined(__DOXYGEN__)
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void __sync_prof_acquired(sync_profile_t *spp);
+  void __sync_prof_waited(sync_profile_t *spp, rtcnt_t start, msg_t msg);
+  void __sync_prof_released(sync_profile_t *spp);
+  void chSyncProfileRegister(sync_profile_t *spp, const char *name);
+  void chSyncProfileUnregister(sync_profile_t *spp);
+  void chSyncProfileReset(void);
+  unsigned chSyncProfileGetTop(sync_profile_t *array, unsigned n);
+#ifdef __cplusplus
+}
+#endif
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+#if (CH_DBG_SYNC_PROFILING == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Profile initialization.
+ * @note    Internal use only.
+ *
+ * @param[out] spp      pointer to the @p sync_profile_t structure
+ *
+ * @notapi
+ */
+static inline void __sync_prof_object_init(sync_profile_t *spp) {
+
+  spp->next        = NULL;
+  spp->name        = NULL;
+  spp->n_acquire   = (ucnt_t)0;
+  spp->n_contended = (ucnt_t)0;
+  spp->wait_total  = (rttime_t)0;
+  spp->wait_max    = (rtcnt_t)0;
+  spp->hold_max    = (rtcnt_t)0;
+  spp->hold_start  = (rtcnt_t)0;
+}
+
+#else /* CH_DBG_SYNC_PROFILING == FALSE */
+
+/* Stub functions for when the profiling is disabled. */
+#define __sync_prof_object_init(spp)
+#define __sync_prof_acquired(spp)
+#define __sync_prof_waited(spp, start, msg)
+#define __sync_prof_released(spp)
+
+#endif /* CH_DBG_SYNC_PROFILING == FALSE */
+
+#endif /* CHSYNCPROF_H */
+
+/** @} */
@@ -162,6 +162,7 @@
 #define CH_IRQ_EPILOGUE()                                                   \
   __dbg_check_leave_isr();                                                  \
   __trace_isr_leave(__func__);                                              \
+  __stats_leave_irq();                                                      \
   CH_CFG_IRQ_EPILOGUE_HOOK();                                               \
   PORT_IRQ_EPILOGUE()
 
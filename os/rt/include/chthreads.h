@@ -292,6 +292,9 @@ extern "C" {
                                tprio_t prio);
 #if CH_DBG_FILL_THREADS == TRUE
   void __thd_memfill(uint8_t *startp, uint8_t *endp, uint8_t v);
+#endif
+#if CH_DBG_STACK_WATERMARK == TRUE
+  void __thd_stackwm_init(thread_t *tp, void *wbase);
 #endif
   thread_t *chThdCreateSuspendedI(const thread_descriptor_t *tdp);
   thread_t *chThdCreateSuspended(const thread_descriptor_t *tdp);
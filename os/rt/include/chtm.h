@@ -45,6 +45,24 @@
 /* Module pre-compile time settings.                                         */
 /*===========================================================================*/
 
+/**
+ * @brief   Histogram sub-buckets bits.
+ * @details Each power of two interval is split in 2^N linear sub-buckets,
+ *          the relative error of a recorded value is below 2^-N.
+ */
+#if !defined(CH_CFG_TM_HISTOGRAM_SUB_BITS) || defined(__DOXYGEN__)
+#define CH_CFG_TM_HISTOGRAM_SUB_BITS        2
+#endif
+
+/**
+ * @brief   Histogram range bits.
+ * @details Histograms cover values up to 2^N-1 cycles, larger values are
+ *          accounted in the last bucket.
+ */
+#if !defined(CH_CFG_TM_HISTOGRAM_RANGE_BITS) || defined(__DOXYGEN__)
+#define CH_CFG_TM_HISTOGRAM_RANGE_BITS      24
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -53,6 +71,22 @@
 #error "CH_CFG_USE_TM requires PORT_SUPPORTS_RT"
 #endif
 
+#if (CH_CFG_TM_HISTOGRAM_SUB_BITS < 1) || (CH_CFG_TM_HISTOGRAM_SUB_BITS > 8)
+#error "invalid CH_CFG_TM_HISTOGRAM_SUB_BITS value"
+#endif
+
+#if (CH_CFG_TM_HISTOGRAM_RANGE_BITS <= CH_CFG_TM_HISTOGRAM_SUB_BITS) ||     \
+    (CH_CFG_TM_HISTOGRAM_RANGE_BITS > 32)
+#error "invalid CH_CFG_TM_HISTOGRAM_RANGE_BITS value"
+#endif
+
+/**
+ * @brief   Number of buckets in a histogram.
+ */
+#define TM_HISTOGRAM_BUCKETS                                                \
+  ((CH_CFG_TM_HISTOGRAM_RANGE_BITS - CH_CFG_TM_HISTOGRAM_SUB_BITS + 1) <<   \
+   CH_CFG_TM_HISTOGRAM_SUB_BITS)
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -84,6 +118,17 @@ typedef struct {
   rttime_t              cumulative;     /**< @brief Cumulative measurement. */
 } time_measurement_t;
 
+/**
+ * @brief   Type of a Time Measurement histogram object.
+ * @details Measurements are accounted in log-linear buckets, values below
+ *          2^@p CH_CFG_TM_HISTOGRAM_SUB_BITS have a bucket each, larger
+ *          values share buckets whose width doubles every power of two.
+ */
+typedef struct {
+  time_measurement_t    tm;             /**< @brief Summary statistics.     */
+  ucnt_t                buckets[TM_HISTOGRAM_BUCKETS]; /**< @brief Counters.*/
+} tm_histogram_t;
+
 /*===========================================================================*/
 /* Module macros.                                                            */
 /*===========================================================================*/
@@ -100,6 +145,16 @@ extern "C" {
   NOINLINE void chTMStopMeasurementX(time_measurement_t *tmp);
   NOINLINE void chTMChainMeasurementToX(time_measurement_t *tmp1,
                                         time_measurement_t *tmp2);
+  void chTMHistogramObjectInit(tm_histogram_t *hp);
+  NOINLINE void chTMHistogramStartMeasurementX(tm_histogram_t *hp);
+  NOINLINE void chTMHistogramStopMeasurementX(tm_histogram_t *hp);
+  void chTMHistogramRecordX(tm_histogram_t *hp, rtcnt_t cycles);
+  void chTMHistogramSnapshotX(const tm_histogram_t *hp, tm_histogram_t *dst);
+  void chTMHistogramMergeX(tm_histogram_t *dst, const tm_histogram_t *src);
+  rtcnt_t chTMHistogramGetPercentileX(const tm_histogram_t *hp,
+                                      unsigned permille);
+  rtcnt_t chTMHistogramGetBucketBaseX(unsigned i);
+  rtcnt_t chTMHistogramGetBucketLimitX(unsigned i);
 #ifdef __cplusplus
 }
 #endif
@@ -202,6 +202,15 @@ typedef struct {
    * @brief   Pointer to the buffer front.
    */
   trace_event_t         *ptr;
+  /**
+   * @brief   Pointer to the oldest record not yet read.
+   * @note    The buffer is empty when this pointer is equal to @p ptr.
+   */
+  trace_event_t         *rdptr;
+  /**
+   * @brief   Records overwritten before being read.
+   */
+  ucnt_t                lost;
   /**
    * @brief   Ring buffer.
    */
@@ -260,6 +269,10 @@ extern "C" {
   void chTraceSuspend(uint16_t mask);
   void chTraceIResume(uint16_t mask);
   void chTraceResume(uint16_t mask);
+  unsigned chTraceReadI(trace_event_t *tep, unsigned n, ucnt_t *lostp);
+  unsigned chTraceRead(trace_event_t *tep, unsigned n, ucnt_t *lostp);
+  unsigned chTraceGetPendingI(void);
+  unsigned chTraceGetPending(void);
 #endif /* CH_DBG_TRACE_MASK != CH_DBG_TRACE_MASK_DISABLED */
 #ifdef __cplusplus
 }
@@ -27,6 +27,12 @@ endif
 ifneq ($(findstring CH_DBG_STATISTICS TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/rt/src/chstats.c
 endif
+ifneq ($(findstring CH_DBG_SYNC_PROFILING TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/rt/src/chsyncprof.c
+endif
+ifneq ($(findstring CH_DBG_PROFILER TRUE,$(CHCONF)),)
+KERNSRC += $(CHIBIOS)/os/rt/src/chprof.c
+endif
 ifneq ($(findstring CH_CFG_USE_REGISTRY TRUE,$(CHCONF)),)
 KERNSRC += $(CHIBIOS)/os/rt/src/chregistry.c
 endif
@@ -59,6 +65,8 @@ KERNSRC := $(CHIBIOS)/os/rt/src/chsys.c \
            $(CHIBIOS)/os/rt/src/chthreads.c \
            $(CHIBIOS)/os/rt/src/chtm.c \
            $(CHIBIOS)/os/rt/src/chstats.c \
+           $(CHIBIOS)/os/rt/src/chsyncprof.c \
+           $(CHIBIOS)/os/rt/src/chprof.c \
            $(CHIBIOS)/os/rt/src/chregistry.c \
            $(CHIBIOS)/os/rt/src/chsem.c \
            $(CHIBIOS)/os/rt/src/chmtx.c \
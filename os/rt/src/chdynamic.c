@@ -102,6 +102,9 @@ thread_t *chThdCreateFromHeap(memory_heap_t *heapp, size_t size,
 
   chSysLock();
   tp = chThdCreateSuspendedI(&td);
+#if CH_DBG_STACK_WATERMARK == TRUE
+  __thd_stackwm_init(tp, wsp);
+#endif
   tp->flags = CH_FLAG_MODE_HEAP;
   chSchWakeupS(tp, MSG_OK);
   chSysUnlock();
@@ -161,6 +164,9 @@ thread_t *chThdCreateFromMemoryPool(memory_pool_t *mp, const char *name,
 
   chSysLock();
   tp = chThdCreateSuspendedI(&td);
+#if CH_DBG_STACK_WATERMARK == TRUE
+  __thd_stackwm_init(tp, wsp);
+#endif
   tp->flags = CH_FLAG_MODE_MPOOL;
   tp->mpool = mp;
   chSchWakeupS(tp, MSG_OK);
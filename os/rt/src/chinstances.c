@@ -69,6 +69,9 @@ static void __idle_thread(void *p) {
     port_wait_for_interrupt();
     /*lint -restore*/
     CH_CFG_IDLE_LOOP_HOOK();
+#if CH_DBG_STACK_WATERMARK == TRUE
+    __reg_stack_scan(currcore);
+#endif
   }
 }
 #endif /* CH_CFG_NO_IDLE_THREAD == FALSE */
@@ -132,6 +135,11 @@ void chInstanceObjectInit(os_instance_t *oip,
   __trace_object_init(&oip->trace_buffer);
 #endif
 
+#if CH_DBG_PROFILER == TRUE
+  /* Profiler buffer initialization.*/
+  __prof_object_init(&oip->prof_buffer);
+#endif
+
   /* Statistics initialization.*/
 #if CH_DBG_STATISTICS == TRUE
   __stats_object_init(&oip->kernel_stats);
@@ -156,6 +164,12 @@ void chInstanceObjectInit(os_instance_t *oip,
   oip->rlist.current->wabase = oicp->mainthread_base;
 #endif
 
+#if CH_DBG_STACK_WATERMARK == TRUE
+  /* The main thread stack is not filled, it is not tracked.*/
+  oip->rlist.current->wmbase = NULL;
+  oip->wmthread = NULL;
+#endif
+
   /* Setting up the caller as current thread.*/
   oip->rlist.current->state = CH_STATE_CURRENT;
 
@@ -173,10 +187,21 @@ void chInstanceObjectInit(os_instance_t *oip,
       .arg      = NULL
     };
 
+#if CH_DBG_FILL_THREADS == TRUE
+    __thd_memfill((uint8_t *)idle_descriptor.wbase,
+                  (uint8_t *)idle_descriptor.wend,
+                  CH_DBG_STACK_FILL_VALUE);
+#endif
+
     /* This thread has the lowest priority in the system, its role is just to
        serve interrupts in its context while keeping the lowest energy saving
        mode compatible with the system status.*/
+#if CH_DBG_STACK_WATERMARK == TRUE
+    __thd_stackwm_init(chThdCreateI(&idle_descriptor),
+                       idle_descriptor.wbase);
+#else
     (void) chThdCreateI(&idle_descriptor);
+#endif
   }
 #endif
 }
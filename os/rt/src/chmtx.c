@@ -109,6 +109,7 @@ void chMtxObjectInit(mutex_t *mp) {
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
   mp->cnt = (cnt_t)0;
 #endif
+  __sync_prof_object_init(&mp->profile);
 }
 
 /**
@@ -159,6 +160,9 @@ void chMtxLockS(mutex_t *mp) {
          boosting the priority of all the affected threads to equal the
          priority of the running thread requesting the mutex.*/
       thread_t *tp = mp->owner;
+#if CH_DBG_SYNC_PROFILING == TRUE
+      rtcnt_t start;
+#endif
 
       /* Does the running thread have higher priority than the mutex
          owning thread? */
@@ -211,9 +215,13 @@ void chMtxLockS(mutex_t *mp) {
       }
 
       /* Sleep on the mutex.*/
+#if CH_DBG_SYNC_PROFILING == TRUE
+      start = chSysGetRealtimeCounterX();
+#endif
       ch_sch_prio_insert(&mp->queue, &currtp->hdr.queue);
       currtp->u.wtmtxp = mp;
       chSchGoSleepS(CH_STATE_WTMTX);
+      __sync_prof_waited(&mp->profile, start, MSG_OK);
 
       /* It is assumed that the thread performing the unlock operation assigns
          the mutex to this thread.*/
@@ -234,6 +242,7 @@ void chMtxLockS(mutex_t *mp) {
     mp->owner = currtp;
     mp->next = currtp->mtxlist;
     currtp->mtxlist = mp;
+    __sync_prof_acquired(&mp->profile);
   }
 }
 
@@ -308,6 +317,7 @@ bool chMtxTryLockS(mutex_t *mp) {
   mp->owner = currtp;
   mp->next = currtp->mtxlist;
   currtp->mtxlist = mp;
+  __sync_prof_acquired(&mp->profile);
   return true;
 }
 
@@ -345,6 +355,7 @@ void chMtxUnlock(mutex_t *mp) {
        it as not owned. Note, it is assumed to be the same mutex passed as
        parameter of this function.*/
     currtp->mtxlist = mp->next;
+    __sync_prof_released(&mp->profile);
 
     /* If a thread is waiting on the mutex then the fun part begins.*/
     if (chMtxQueueNotEmptyS(mp)) {
@@ -431,6 +442,7 @@ void chMtxUnlockS(mutex_t *mp) {
        it as not owned. Note, it is assumed to be the same mutex passed as
        parameter of this function.*/
     currtp->mtxlist = mp->next;
+    __sync_prof_released(&mp->profile);
 
     /* If a thread is waiting on the mutex then the fun part begins.*/
     if (chMtxQueueNotEmptyS(mp)) {
@@ -494,6 +506,7 @@ void chMtxUnlockAllS(void) {
     do {
       mutex_t *mp = currtp->mtxlist;
       currtp->mtxlist = mp->next;
+      __sync_prof_released(&mp->profile);
       if (chMtxQueueNotEmptyS(mp)) {
         thread_t *tp;
 #if CH_CFG_USE_MUTEXES_RECURSIVE == TRUE
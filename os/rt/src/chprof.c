@@ -0,0 +1,202 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    rt/src/chprof.c
+ * @brief   Sampling profiler code.
+ *
+ * @addtogroup profiler
+ * @details Statistical profiler collecting the interrupted program counter
+ *          and the current thread.
+ *          <br>Samples are taken by the port using a periodic timer or by
+ *          the application from a periodic interrupt, the samples buffer
+ *          is drained by a thread, usually through the prof_stream module,
+ *          and the samples are symbolized on the host using the
+ *          tools/profiler/chprof.py script.
+ * @pre     In order to use the profiler the @p CH_DBG_PROFILER option must
+ *          be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_DBG_PROFILER == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+#define PROF_MASK       ((ucnt_t)CH_DBG_PROFILER_BUFFER_SIZE - (ucnt_t)1)
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Profiler buffer initialization.
+ *
+ * @param[out] pbp      pointer to the @p prof_buffer_t object
+ *
+ * @notapi
+ */
+void __prof_object_init(prof_buffer_t *pbp) {
+
+  pbp->frequency = 0U;
+  pbp->wridx     = (ucnt_t)0;
+  pbp->rdidx     = (ucnt_t)0;
+  pbp->lost      = (ucnt_t)0;
+}
+
+/**
+ * @brief   Stores a sample in the profiler buffer.
+ * @details The sample is dropped if the buffer is full.
+ * @note    This function does not use the kernel locks, it can be called
+ *          from any interrupt, including interrupts not masked by the
+ *          kernel, but it must not be reentered.
+ *
+ * @param[in] pc        the interrupted program counter
+ *
+ * @xclass
+ */
+void chProfSampleX(void *pc) {
+  prof_buffer_t *pbp = &currcore->prof_buffer;
+  ucnt_t wr = pbp->wridx;
+  volatile prof_sample_t *psp;
+
+  if ((wr - pbp->rdidx) > PROF_MASK) {
+    pbp->lost++;
+    return;
+  }
+
+  psp = &pbp->buffer[wr & PROF_MASK];
+  psp->pc = pc;
+  psp->tp = chThdGetSelfX();
+
+  /* The sample is published after being written, the index is volatile
+     like the buffer so the order is preserved.*/
+  pbp->wridx = wr + (ucnt_t)1;
+}
+
+/**
+ * @brief   Fetches samples from the profiler buffer.
+ * @note    Samples of the current core are returned.
+ * @note    There must be a single reader for each core.
+ *
+ * @param[out] psp      pointer to an array of @p prof_sample_t structures
+ * @param[in] n         maximum number of samples to be fetched
+ * @param[out] lostp    pointer to a variable receiving the cumulative
+ *                      number of dropped samples or @p NULL
+ * @return              The number of fetched samples.
+ *
+ * @api
+ */
+unsigned chProfRead(prof_sample_t *psp, unsigned n, ucnt_t *lostp) {
+  prof_buffer_t *pbp = &currcore->prof_buffer;
+  ucnt_t rd = pbp->rdidx;
+  ucnt_t wr = pbp->wridx;
+  unsigned i = 0U;
+
+  while ((i < n) && (rd != wr)) {
+    psp[i].pc = pbp->buffer[rd & PROF_MASK].pc;
+    psp[i].tp = pbp->buffer[rd & PROF_MASK].tp;
+    rd++;
+    i++;
+  }
+  pbp->rdidx = rd;
+
+  if (lostp != NULL) {
+    *lostp = pbp->lost;
+  }
+
+  return i;
+}
+
+/**
+ * @brief   Returns the number of unread samples in the profiler buffer.
+ * @note    Samples of the current core are counted.
+ *
+ * @return              The number of unread samples.
+ *
+ * @xclass
+ */
+unsigned chProfGetPendingX(void) {
+  prof_buffer_t *pbp = &currcore->prof_buffer;
+
+  return (unsigned)(ucnt_t)(pbp->wridx - pbp->rdidx);
+}
+
+/**
+ * @brief   Returns the sampling frequency.
+ *
+ * @return              The sampling frequency in Hz or zero if not known.
+ *
+ * @xclass
+ */
+uint32_t chProfGetFrequencyX(void) {
+
+  return currcore->prof_buffer.frequency;
+}
+
+#if (PORT_SUPPORTS_PROFILER == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts sampling using the port sampling source.
+ * @note    The port can round the frequency, the effective frequency is
+ *          returned by @p chProfGetFrequencyX().
+ *
+ * @param[in] frequency sampling frequency in Hz
+ *
+ * @api
+ */
+void chProfStart(uint32_t frequency) {
+
+  chDbgCheck(frequency > 0U);
+
+  currcore->prof_buffer.frequency = port_prof_start(frequency);
+}
+
+/**
+ * @brief   Stops sampling.
+ *
+ * @api
+ */
+void chProfStop(void) {
+
+  port_prof_stop();
+}
+#endif /* PORT_SUPPORTS_PROFILER == TRUE */
+
+#endif /* CH_DBG_PROFILER == TRUE */
+
+/** @} */
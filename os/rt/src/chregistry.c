@@ -39,7 +39,10 @@
  *          Another possible use is for centralized threads memory management,
  *          terminating threads can pulse an event source and an event handler
  *          can perform a scansion of the registry in order to recover the
- *          memory.
+ *          memory.<br>
+ *          If @p CH_CFG_REGISTRY_HASH_SIZE is greater than zero then the
+ *          threads are also linked in a hash table indexed by name, the
+ *          lookup by name does not scan the whole registry.
  * @pre     In order to use the threads registry the @p CH_CFG_USE_REGISTRY
  *          option must be enabled in @p chconf.h.
  * @{
@@ -67,6 +70,44 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+/* FNV-1a hash of a thread name, unnamed threads are in the chain of the
+   empty name.*/
+static thread_t **reg_hash_chain(os_instance_t *oip, const char *name) {
+  uint32_t h = 2166136261U;
+
+  (void)oip;
+
+  if (name != NULL) {
+    while (*name != (char)0) {
+      h = (h ^ (uint32_t)(uint8_t)*name) * 16777619U;
+      name++;
+    }
+  }
+
+  return &REG_HASH(oip)[h & ((uint32_t)CH_CFG_REGISTRY_HASH_SIZE - 1U)];
+}
+
+static void reg_hash_link(thread_t **chainp, thread_t *tp) {
+
+  tp->hnext  = *chainp;
+  tp->hprevp = chainp;
+  if (*chainp != NULL) {
+    (*chainp)->hprevp = &tp->hnext;
+  }
+  *chainp = tp;
+}
+
+static void reg_hash_unlink(thread_t *tp) {
+
+  *tp->hprevp = tp->hnext;
+  if (tp->hnext != NULL) {
+    tp->hnext->hprevp = tp->hprevp;
+  }
+  tp->hprevp = NULL;
+}
+#endif /* CH_CFG_REGISTRY_HASH_SIZE > 0 */
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -199,6 +240,27 @@ thread_t *chRegNextThread(thread_t *tp) {
 thread_t *chRegFindThreadByName(const char *name) {
   thread_t *ctp;
 
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+  chSysLock();
+
+  /* Scanning the hash chain of the name.*/
+  ctp = *reg_hash_chain(currcore, name);
+  while (ctp != NULL) {
+    if ((ctp->name != NULL) && (strcmp(ctp->name, name) == 0)) {
+#if CH_CFG_USE_DYNAMIC == TRUE
+      chDbgAssert(ctp->refs < (trefs_t)255, "too many references");
+
+      ctp->refs++;
+#endif
+      break;
+    }
+    ctp = ctp->hnext;
+  }
+
+  chSysUnlock();
+
+  return ctp;
+#else
   /* Scanning registry.*/
   ctp = chRegFirstThread();
   do {
@@ -209,6 +271,7 @@ thread_t *chRegFindThreadByName(const char *name) {
   } while (ctp != NULL);
 
   return NULL;
+#endif
 }
 
 /**
@@ -268,6 +331,151 @@ thread_t *chRegFindThreadByWorkingArea(stkalign_t *wa) {
 }
 #endif
 
+#if (CH_DBG_STACK_WATERMARK == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Removes a thread from the stack watermark scan.
+ * @note    Internal use only, invoked when a thread is removed from the
+ *          registry.
+ *
+ * @param[in] tp        pointer to the thread
+ *
+ * @notapi
+ */
+void __reg_stack_forget(thread_t *tp) {
+  unsigned i;
+
+  /* In SMP mode all instances scan the same registry.*/
+  for (i = 0U; i < (unsigned)PORT_CORES_NUMBER; i++) {
+    os_instance_t *oip = ch_system.instances[i];
+
+    if ((oip != NULL) && (oip->wmthread == tp)) {
+      oip->wmthread = NULL;
+    }
+  }
+}
+
+/**
+ * @brief   Performs a step of the stack watermark scan.
+ * @details Up to @p CH_DBG_STACK_WATERMARK_STEP bytes of a thread stack
+ *          are checked for the fill value. The scan of each stack starts
+ *          from the stack limit and ends on the first byte found in use or
+ *          on the previous watermark, then the watermark is updated and
+ *          the scan continues with the next thread in the registry.
+ * @note    Internal use only, invoked by the idle thread.
+ *
+ * @param[in] oip       pointer to the OS instance
+ *
+ * @notapi
+ */
+void __reg_stack_scan(os_instance_t *oip) {
+  thread_t *tp;
+  uint8_t *p;
+  unsigned n;
+
+  chSysLock();
+
+  tp = oip->wmthread;
+  if (tp == NULL) {
+    /*lint -save -e413 [1.3] Safe to subtract a calculated offset.*/
+    tp = (thread_t *)((uint8_t *)REG_HEADER(oip)->next -
+                      __CH_OFFSETOF(thread_t, rqueue));
+    /*lint -restore*/
+  }
+
+  if (tp->wmbase != NULL) {
+    p = tp->wmnext;
+    n = (unsigned)CH_DBG_STACK_WATERMARK_STEP;
+    while ((n > 0U) && (p < tp->wmmark) &&
+           (*p == (uint8_t)CH_DBG_STACK_FILL_VALUE)) {
+      p++;
+      n--;
+    }
+
+    if ((p < tp->wmmark) && (*p == (uint8_t)CH_DBG_STACK_FILL_VALUE)) {
+      /* Step budget exhausted, the scan will continue from here.*/
+      tp->wmnext = p;
+      chSysUnlock();
+      return;
+    }
+
+    /* Scan completed, the watermark can only move down.*/
+    tp->wmmark = p;
+    tp->wmnext = tp->wmbase;
+  }
+
+  /* Next thread in the registry, the scan restarts after the last one.*/
+  if (tp->rqueue.next == REG_HEADER(oip)) {
+    oip->wmthread = NULL;
+  }
+  else {
+    /*lint -save -e413 [1.3] Safe to subtract a calculated offset.*/
+    oip->wmthread = (thread_t *)((uint8_t *)tp->rqueue.next -
+                                 __CH_OFFSETOF(thread_t, rqueue));
+    /*lint -restore*/
+  }
+
+  chSysUnlock();
+}
+#endif /* CH_DBG_STACK_WATERMARK == TRUE */
+
+#if (CH_CFG_REGISTRY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+/**
+ * @brief   Adds a thread to the registry and to the names index.
+ * @note    Internal use only.
+ *
+ * @param[in] oip       pointer to the OS instance
+ * @param[in] tp        pointer to the thread
+ *
+ * @notapi
+ */
+void __reg_insert(os_instance_t *oip, thread_t *tp) {
+
+  ch_queue_insert(REG_HEADER(oip), &tp->rqueue);
+  reg_hash_link(reg_hash_chain(oip, tp->name), tp);
+}
+
+/**
+ * @brief   Removes a thread from the registry and from the names index.
+ * @note    Internal use only.
+ *
+ * @param[in] tp        pointer to the thread
+ *
+ * @notapi
+ */
+void __reg_remove(thread_t *tp) {
+
+#if CH_DBG_STACK_WATERMARK == TRUE
+  __reg_stack_forget(tp);
+#endif
+  reg_hash_unlink(tp);
+  (void) ch_queue_dequeue(&tp->rqueue);
+}
+
+/**
+ * @brief   Changes the name of a thread updating the names index.
+ * @note    Internal use only, the name is stored but not indexed if the
+ *          thread is no more in the registry.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] name      thread name as a zero terminated string
+ *
+ * @xclass
+ */
+void __reg_rename(thread_t *tp, const char *name) {
+  syssts_t sts;
+
+  sts = chSysGetStatusAndLockX();
+
+  tp->name = name;
+  if (tp->hprevp != NULL) {
+    reg_hash_unlink(tp);
+    reg_hash_link(reg_hash_chain(tp->owner, name), tp);
+  }
+
+  chSysRestoreStatusX(sts);
+}
+#endif /* CH_CFG_REGISTRY_HASH_SIZE > 0 */
+
 #endif /* CH_CFG_USE_REGISTRY == TRUE */
 
 /** @} */
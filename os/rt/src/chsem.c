@@ -100,6 +100,7 @@ void chSemObjectInit(semaphore_t *sp, cnt_t n) {
 
   ch_queue_init(&sp->queue);
   sp->cnt = n;
+  __sync_prof_object_init(&sp->profile);
 }
 
 /**
@@ -198,12 +199,19 @@ msg_t chSemWaitS(semaphore_t *sp) {
 
   if (--sp->cnt < (cnt_t)0) {
     thread_t *currtp = chThdGetSelfX();
+#if CH_DBG_SYNC_PROFILING == TRUE
+    rtcnt_t start;
+
+    start = chSysGetRealtimeCounterX();
+#endif
     currtp->u.wtsemp = sp;
     sem_insert(&sp->queue, currtp);
     chSchGoSleepS(CH_STATE_WTSEM);
+    __sync_prof_waited(&sp->profile, start, currtp->u.rdymsg);
 
     return currtp->u.rdymsg;
   }
+  __sync_prof_acquired(&sp->profile);
 
   return MSG_OK;
 }
@@ -265,17 +273,33 @@ msg_t chSemWaitTimeoutS(semaphore_t *sp, sysinterval_t timeout) {
               "inconsistent semaphore");
 
   if (--sp->cnt < (cnt_t)0) {
+#if CH_DBG_SYNC_PROFILING == TRUE
+    rtcnt_t start;
+    msg_t msg;
+#endif
+
     if (unlikely(TIME_IMMEDIATE == timeout)) {
       sp->cnt++;
 
       return MSG_TIMEOUT;
     }
     thread_t *currtp = chThdGetSelfX();
+#if CH_DBG_SYNC_PROFILING == TRUE
+    start = chSysGetRealtimeCounterX();
+#endif
     currtp->u.wtsemp = sp;
     sem_insert(&sp->queue, currtp);
 
+#if CH_DBG_SYNC_PROFILING == TRUE
+    msg = chSchGoSleepTimeoutS(CH_STATE_WTSEM, timeout);
+    __sync_prof_waited(&sp->profile, start, msg);
+
+    return msg;
+#else
     return chSchGoSleepTimeoutS(CH_STATE_WTSEM, timeout);
+#endif
   }
+  __sync_prof_acquired(&sp->profile);
 
   return MSG_OK;
 }
@@ -388,12 +412,19 @@ msg_t chSemSignalWait(semaphore_t *sps, semaphore_t *spw) {
   }
   if (--spw->cnt < (cnt_t)0) {
     thread_t *currtp = chThdGetSelfX();
+#if CH_DBG_SYNC_PROFILING == TRUE
+    rtcnt_t start;
+
+    start = chSysGetRealtimeCounterX();
+#endif
     sem_insert(&spw->queue, currtp);
     currtp->u.wtsemp = spw;
     chSchGoSleepS(CH_STATE_WTSEM);
     msg = currtp->u.rdymsg;
+    __sync_prof_waited(&spw->profile, start, msg);
   }
   else {
+    __sync_prof_acquired(&spw->profile);
     chSchRescheduleS();
     msg = MSG_OK;
   }
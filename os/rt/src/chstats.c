@@ -56,14 +56,41 @@
 
 /**
  * @brief   Increases the IRQ counter.
+ * @note    If @p CH_DBG_STATISTICS_ISR is enabled then the measurement of
+ *          the ISR duration is also started.
  */
 void __stats_increase_irq(void) {
 
   port_lock_from_isr();
   currcore->kernel_stats.n_irq++;
+#if CH_DBG_STATISTICS_ISR == TRUE
+  if (currcore->kernel_stats.isr_nesting++ == (ucnt_t)0) {
+    chTMStartMeasurementX(&currcore->kernel_stats.m_isr);
+  }
+#endif
   port_unlock_from_isr();
 }
 
+#if (CH_DBG_STATISTICS_ISR == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Stops the measurement of the ISR duration.
+ * @note    The time spent in the outermost ISR is put aside in order to
+ *          be removed from the interrupted thread on the next context
+ *          switch.
+ */
+void __stats_leave_irq(void) {
+  kernel_stats_t *ksp;
+
+  port_lock_from_isr();
+  ksp = &currcore->kernel_stats;
+  if (--ksp->isr_nesting == (ucnt_t)0) {
+    chTMStopMeasurementX(&ksp->m_isr);
+    ksp->isr_pending += (rttime_t)ksp->m_isr.last;
+  }
+  port_unlock_from_isr();
+}
+#endif
+
 /**
  * @brief   Updates context switch related statistics.
  *
@@ -74,6 +101,13 @@ void __stats_ctxswc(thread_t *ntp, thread_t *otp) {
 
   currcore->kernel_stats.n_ctxswc++;
   chTMChainMeasurementToX(&otp->stats, &ntp->stats);
+#if CH_DBG_STATISTICS_ISR == TRUE
+  /* Time spent in ISRs is not accounted to the thread.*/
+  if (currcore->kernel_stats.isr_pending <= otp->stats.cumulative) {
+    otp->stats.cumulative -= currcore->kernel_stats.isr_pending;
+  }
+  currcore->kernel_stats.isr_pending = (rttime_t)0;
+#endif
 }
 
 /**
@@ -0,0 +1,242 @@
+/*
+    ChibiOS - Copyright (C) 2006,2007,2008,2009,2010,2011,2012,2013,2014,
+              2015,2016,2017,2018,2019,2020,2021 Giovanni Di Sirio.
+
+    This file is part of ChibiOS.
+
+    ChibiOS is free software; you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation version 3 of the License.
+
+    ChibiOS is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+ * @file    rt/src/chsyncprof.c
+ * @brief   Synchronization objects profiling code.
+ *
+ * @addtogroup sync_profiling
+ * @details Contention profiling of mutexes and semaphores.
+ *          <br>Each mutex and semaphore embeds a profile which is updated
+ *          by the kernel on acquisition and release. Profiles are
+ *          collected for all objects but only the registered ones can be
+ *          listed, registration gives the object a name and links it in a
+ *          system-wide list.
+ * @pre     In order to use the profiling the @p CH_DBG_SYNC_PROFILING
+ *          option must be enabled in @p chconf.h.
+ * @{
+ */
+
+#include "ch.h"
+
+#if (CH_DBG_SYNC_PROFILING == TRUE) || defined(__DOXYGEN__)
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+static bool sync_prof_greater(const sync_profile_t *spp1,
+                              const sync_profile_t *spp2) {
+
+  if (spp1->wait_total != spp2->wait_total) {
+    return spp1->wait_total > spp2->wait_total;
+  }
+  return spp1->n_contended > spp2->n_contended;
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Accounts an acquisition without waiting.
+ *
+ * @param[in] spp       pointer to the @p sync_profile_t structure
+ *
+ * @notapi
+ */
+void __sync_prof_acquired(sync_profile_t *spp) {
+
+  spp->n_acquire++;
+  spp->hold_start = chSysGetRealtimeCounterX();
+}
+
+/**
+ * @brief   Accounts an acquisition after waiting.
+ * @note    Failed waits, because timeout or reset, are not accounted.
+ *
+ * @param[in] spp       pointer to the @p sync_profile_t structure
+ * @param[in] start     realtime counter value at wait start
+ * @param[in] msg       the wait result
+ *
+ * @notapi
+ */
+void __sync_prof_waited(sync_profile_t *spp, rtcnt_t start, msg_t msg) {
+  rtcnt_t now, wait;
+
+  if (msg != MSG_OK) {
+    return;
+  }
+
+  now  = chSysGetRealtimeCounterX();
+  wait = now - start;
+  spp->n_acquire++;
+  spp->n_contended++;
+  spp->wait_total += (rttime_t)wait;
+  if (wait > spp->wait_max) {
+    spp->wait_max = wait;
+  }
+  spp->hold_start = now;
+}
+
+/**
+ * @brief   Accounts a release.
+ *
+ * @param[in] spp       pointer to the @p sync_profile_t structure
+ *
+ * @notapi
+ */
+void __sync_prof_released(sync_profile_t *spp) {
+  rtcnt_t hold = chSysGetRealtimeCounterX() - spp->hold_start;
+
+  if (hold > spp->hold_max) {
+    spp->hold_max = hold;
+  }
+}
+
+/**
+ * @brief   Registers a profile.
+ * @note    Objects allocated on the stack or in dynamic memory must be
+ *          unregistered before going out of scope.
+ *
+ * @param[in] spp       pointer to the @p sync_profile_t structure, usually
+ *                      the @p profile field of a mutex or semaphore
+ * @param[in] name      name to be assigned to the object
+ *
+ * @api
+ */
+void chSyncProfileRegister(sync_profile_t *spp, const char *name) {
+
+  chDbgCheck((spp != NULL) && (name != NULL));
+
+  chSysLock();
+  chDbgAssert(spp->name == NULL, "already registered");
+  spp->name = name;
+  spp->next = ch_system.syncprof;
+  ch_system.syncprof = spp;
+  chSysUnlock();
+}
+
+/**
+ * @brief   Unregisters a profile.
+ *
+ * @param[in] spp       pointer to the @p sync_profile_t structure
+ *
+ * @api
+ */
+void chSyncProfileUnregister(sync_profile_t *spp) {
+  sync_profile_t **pp;
+
+  chDbgCheck(spp != NULL);
+
+  chSysLock();
+  pp = &ch_system.syncprof;
+  while (*pp != NULL) {
+    if (*pp == spp) {
+      *pp = spp->next;
+      spp->next = NULL;
+      spp->name = NULL;
+      break;
+    }
+    pp = &(*pp)->next;
+  }
+  chSysUnlock();
+}
+
+/**
+ * @brief   Clears the statistics of all registered profiles.
+ *
+ * @api
+ */
+void chSyncProfileReset(void) {
+  sync_profile_t *spp;
+
+  chSysLock();
+  spp = ch_system.syncprof;
+  while (spp != NULL) {
+    spp->n_acquire   = (ucnt_t)0;
+    spp->n_contended = (ucnt_t)0;
+    spp->wait_total  = (rttime_t)0;
+    spp->wait_max    = (rtcnt_t)0;
+    spp->hold_max    = (rtcnt_t)0;
+    spp = spp->next;
+  }
+  chSysUnlock();
+}
+
+/**
+ * @brief   Returns the most contended registered objects.
+ * @details Copies of the profiles are stored in the array sorted by
+ *          cumulative wait time, the objects with the same wait time are
+ *          sorted by number of contended acquisitions.
+ * @note    The whole list is scanned within a critical zone.
+ *
+ * @param[out] array    array receiving the profiles copies
+ * @param[in] n         number of elements in the array
+ * @return              The number of profiles stored in the array.
+ *
+ * @api
+ */
+unsigned chSyncProfileGetTop(sync_profile_t *array, unsigned n) {
+  sync_profile_t *spp;
+  unsigned i, cnt = 0U;
+
+  chDbgCheck((array != NULL) || (n == 0U));
+
+  chSysLock();
+  spp = ch_system.syncprof;
+  while (spp != NULL) {
+    /* Insertion in the sorted array, the last element is dropped if the
+       array is full.*/
+    i = cnt < n ? cnt++ : n;
+    while ((i > 0U) && sync_prof_greater(spp, &array[i - 1U])) {
+      if (i < n) {
+        array[i] = array[i - 1U];
+      }
+      i--;
+    }
+    if (i < n) {
+      array[i] = *spp;
+    }
+    spp = spp->next;
+  }
+  chSysUnlock();
+
+  return cnt;
+}
+
+#endif /* CH_DBG_SYNC_PROFILING == TRUE */
+
+/** @} */
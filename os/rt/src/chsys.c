@@ -175,6 +175,11 @@ void chSysInit(void) {
   __reg_object_init(&ch_system.reglist);
 #endif
 
+#if CH_DBG_SYNC_PROFILING == TRUE
+  /* Registered profiles list initialization.*/
+  ch_system.syncprof = NULL;
+#endif
+
 #if CH_CFG_SMP_MODE == TRUE
   /* RFCU initialization when SMP mode is enabled.*/
   __rfcu_object_init(&ch_system.rfcu);
@@ -139,13 +139,45 @@ thread_t *__thd_object_init(os_instance_t *oip,
  * @notapi
  */
 void __thd_memfill(uint8_t *startp, uint8_t *endp, uint8_t v) {
+  uint32_t w = (uint32_t)v * 0x01010101U;
 
+  /* Working areas are usually aligned, the bulk of the area is filled
+     using words.*/
+  while ((startp < endp) && (((uintptr_t)startp & 3U) != 0U)) {
+    *startp++ = v;
+  }
+  while ((size_t)(endp - startp) >= sizeof (uint32_t)) {
+    /*lint -save -e9087 -e826 [11.3] Aligned word access.*/
+    *(uint32_t *)(void *)startp = w;
+    /*lint -restore*/
+    startp += sizeof (uint32_t);
+  }
   while (startp < endp) {
     *startp++ = v;
   }
 }
 #endif /* CH_DBG_FILL_THREADS */
 
+#if (CH_DBG_STACK_WATERMARK == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Enables the stack watermark tracking of a thread.
+ * @pre     The thread working area must have been filled with
+ *          @p CH_DBG_STACK_FILL_VALUE.
+ *
+ * @param[in] tp        pointer to the thread
+ * @param[in] wbase     pointer to the working area base
+ *
+ * @notapi
+ */
+void __thd_stackwm_init(thread_t *tp, void *wbase) {
+
+  /* Initially nothing below the thread structure is known to be in use.*/
+  tp->wmbase = (uint8_t *)wbase;
+  tp->wmnext = (uint8_t *)wbase;
+  tp->wmmark = (uint8_t *)tp;
+}
+#endif /* CH_DBG_STACK_WATERMARK */
+
 /**
  * @brief   Creates a new thread into a static memory area.
  * @details The new thread is initialized but not inserted in the ready list,
@@ -191,6 +223,14 @@ thread_t *chThdCreateSuspendedI(const thread_descriptor_t *tdp) {
   tp->wabase = tdp->wbase;
 #endif
 
+#if CH_DBG_STACK_WATERMARK == TRUE
+  /* The stack could be not filled, it is not tracked unless the caller
+     enables the watermark.*/
+  tp->wmbase = NULL;
+  tp->wmnext = NULL;
+  tp->wmmark = (uint8_t *)tp;
+#endif
+
   /* Setting up the port-dependent part of the working area.*/
   PORT_SETUP_CONTEXT(tp, tdp->wbase, tp, tdp->funcp, tdp->arg);
 
@@ -240,6 +280,9 @@ thread_t *chThdCreateSuspended(const thread_descriptor_t *tdp) {
 
   chSysLock();
   tp = chThdCreateSuspendedI(tdp);
+#if CH_DBG_STACK_WATERMARK == TRUE
+  __thd_stackwm_init(tp, tdp->wbase);
+#endif
   chSysUnlock();
 
   return tp;
@@ -305,6 +348,9 @@ thread_t *chThdCreate(const thread_descriptor_t *tdp) {
 
   chSysLock();
   tp = chThdCreateSuspendedI(tdp);
+#if CH_DBG_STACK_WATERMARK == TRUE
+  __thd_stackwm_init(tp, tdp->wbase);
+#endif
   chSchWakeupS(tp, MSG_OK);
   chSysUnlock();
 
@@ -366,6 +412,10 @@ thread_t *chThdCreateStatic(void *wsp, size_t size,
   tp->wabase = (stkalign_t *)wsp;
 #endif
 
+#if CH_DBG_STACK_WATERMARK == TRUE
+  __thd_stackwm_init(tp, wsp);
+#endif
+
   /* Setting up the port-dependent part of the working area.*/
   PORT_SETUP_CONTEXT(tp, wsp, tp, pf, arg);
 
@@ -50,12 +50,10 @@
 /* Module local functions.                                                   */
 /*===========================================================================*/
 
-static inline void tm_stop(time_measurement_t *tmp,
-                           rtcnt_t now,
-                           rtcnt_t offset) {
+static inline void tm_update(time_measurement_t *tmp, rtcnt_t cycles) {
 
   tmp->n++;
-  tmp->last = (now - tmp->last) - offset;
+  tmp->last = cycles;
   tmp->cumulative += (rttime_t)tmp->last;
   if (tmp->last > tmp->worst) {
     tmp->worst = tmp->last;
@@ -65,6 +63,40 @@ static inline void tm_stop(time_measurement_t *tmp,
   }
 }
 
+static inline void tm_stop(time_measurement_t *tmp,
+                           rtcnt_t now,
+                           rtcnt_t offset) {
+
+  tm_update(tmp, (now - tmp->last) - offset);
+}
+
+static unsigned tm_bucket(rtcnt_t cycles) {
+  unsigned msb;
+
+  /* Values below 2^SUB_BITS have a bucket each.*/
+  if (cycles < ((rtcnt_t)1 << CH_CFG_TM_HISTOGRAM_SUB_BITS)) {
+    return (unsigned)cycles;
+  }
+
+  /* Values out of range go in the last bucket.*/
+  if ((cycles >> (CH_CFG_TM_HISTOGRAM_RANGE_BITS - 1)) > (rtcnt_t)1) {
+    return TM_HISTOGRAM_BUCKETS - 1U;
+  }
+
+  /* Most significant bit position, the following SUB_BITS bits select
+     the sub-bucket within the power of two interval.*/
+  msb = CH_CFG_TM_HISTOGRAM_SUB_BITS;
+  while ((msb < (CH_CFG_TM_HISTOGRAM_RANGE_BITS - 1U)) &&
+         ((cycles >> (msb + 1U)) != (rtcnt_t)0)) {
+    msb++;
+  }
+
+  return ((msb - CH_CFG_TM_HISTOGRAM_SUB_BITS + 1U) <<
+          CH_CFG_TM_HISTOGRAM_SUB_BITS) |
+         ((unsigned)(cycles >> (msb - CH_CFG_TM_HISTOGRAM_SUB_BITS)) &
+          ((1U << CH_CFG_TM_HISTOGRAM_SUB_BITS) - 1U));
+}
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -133,6 +165,218 @@ NOINLINE void chTMChainMeasurementToX(time_measurement_t *tmp1,
   tm_stop(tmp1, tmp2->last, (rtcnt_t)0);
 }
 
+/**
+ * @brief   Initializes a @p tm_histogram_t object.
+ *
+ * @param[out] hp       pointer to a @p tm_histogram_t structure
+ *
+ * @init
+ */
+void chTMHistogramObjectInit(tm_histogram_t *hp) {
+  unsigned i;
+
+  chTMObjectInit(&hp->tm);
+  for (i = 0U; i < TM_HISTOGRAM_BUCKETS; i++) {
+    hp->buckets[i] = (ucnt_t)0;
+  }
+}
+
+/**
+ * @brief   Starts a histogram measurement.
+ * @pre     The @p tm_histogram_t structure must be initialized.
+ *
+ * @param[in,out] hp    pointer to a @p tm_histogram_t structure
+ *
+ * @xclass
+ */
+NOINLINE void chTMHistogramStartMeasurementX(tm_histogram_t *hp) {
+
+  hp->tm.last = chSysGetRealtimeCounterX();
+}
+
+/**
+ * @brief   Stops a histogram measurement and records it.
+ * @pre     The @p tm_histogram_t structure must be initialized.
+ *
+ * @param[in,out] hp    pointer to a @p tm_histogram_t structure
+ *
+ * @xclass
+ */
+NOINLINE void chTMHistogramStopMeasurementX(tm_histogram_t *hp) {
+  rtcnt_t now = chSysGetRealtimeCounterX();
+
+  chTMHistogramRecordX(hp, (now - hp->tm.last) - ch_system.tmc.offset);
+}
+
+/**
+ * @brief   Records a measurement into an histogram.
+ * @details This function allows to record measurements started and stopped
+ *          in different contexts, for example a time stamp taken in an ISR
+ *          and checked by the awakened thread.
+ * @note    The update is performed in a critical zone so the same histogram
+ *          can be fed from both threads and ISRs.
+ *
+ * @param[in,out] hp    pointer to a @p tm_histogram_t structure
+ * @param[in] cycles    the measurement in realtime counter cycles
+ *
+ * @xclass
+ */
+void chTMHistogramRecordX(tm_histogram_t *hp, rtcnt_t cycles) {
+  syssts_t sts;
+
+  sts = chSysGetStatusAndLockX();
+  tm_update(&hp->tm, cycles);
+  hp->buckets[tm_bucket(cycles)]++;
+  chSysRestoreStatusX(sts);
+}
+
+/**
+ * @brief   Takes a consistent copy of an histogram.
+ * @note    The copy is performed in a critical zone whose duration depends
+ *          on @p TM_HISTOGRAM_BUCKETS.
+ *
+ * @param[in] hp        pointer to the @p tm_histogram_t structure to be
+ *                      copied
+ * @param[out] dst      pointer to the destination @p tm_histogram_t
+ *                      structure
+ *
+ * @xclass
+ */
+void chTMHistogramSnapshotX(const tm_histogram_t *hp, tm_histogram_t *dst) {
+  syssts_t sts;
+
+  sts = chSysGetStatusAndLockX();
+  *dst = *hp;
+  chSysRestoreStatusX(sts);
+}
+
+/**
+ * @brief   Accumulates an histogram into another one.
+ * @note    The destination is updated in a critical zone, the source
+ *          histogram is not supposed to be updated during the operation,
+ *          use a snapshot when merging live histograms.
+ *
+ * @param[in,out] dst   pointer to the destination @p tm_histogram_t
+ *                      structure
+ * @param[in] src       pointer to the source @p tm_histogram_t structure
+ *
+ * @xclass
+ */
+void chTMHistogramMergeX(tm_histogram_t *dst, const tm_histogram_t *src) {
+  syssts_t sts;
+  unsigned i;
+
+  if (src->tm.n == (ucnt_t)0) {
+    return;
+  }
+
+  sts = chSysGetStatusAndLockX();
+  for (i = 0U; i < TM_HISTOGRAM_BUCKETS; i++) {
+    dst->buckets[i] += src->buckets[i];
+  }
+  dst->tm.n          += src->tm.n;
+  dst->tm.cumulative += src->tm.cumulative;
+  dst->tm.last        = src->tm.last;
+  if (src->tm.worst > dst->tm.worst) {
+    dst->tm.worst = src->tm.worst;
+  }
+  if (src->tm.best < dst->tm.best) {
+    dst->tm.best = src->tm.best;
+  }
+  chSysRestoreStatusX(sts);
+}
+
+/**
+ * @brief   Returns a percentile of the recorded measurements.
+ * @details The returned value is the upper limit of the bucket containing
+ *          the requested percentile, limited to the worst measurement.
+ *
+ * @param[in] hp        pointer to a @p tm_histogram_t structure, it is not
+ *                      supposed to be updated during the operation
+ * @param[in] permille  the percentile in tenths of percent, from 0 to 1000
+ * @return              The percentile value in cycles.
+ * @retval 0            if the histogram is empty.
+ *
+ * @xclass
+ */
+rtcnt_t chTMHistogramGetPercentileX(const tm_histogram_t *hp,
+                                    unsigned permille) {
+  rttime_t target, count;
+  rtcnt_t limit;
+  unsigned i;
+
+  if (hp->tm.n == (ucnt_t)0) {
+    return (rtcnt_t)0;
+  }
+
+  /* Rank of the requested sample, rounded up.*/
+  target = (((rttime_t)hp->tm.n * (rttime_t)permille) + (rttime_t)999) /
+           (rttime_t)1000;
+  if (target == (rttime_t)0) {
+    target = (rttime_t)1;
+  }
+
+  count = (rttime_t)0;
+  for (i = 0U; i < TM_HISTOGRAM_BUCKETS - 1U; i++) {
+    count += (rttime_t)hp->buckets[i];
+    if (count >= target) {
+      break;
+    }
+  }
+
+  limit = chTMHistogramGetBucketLimitX(i);
+  if ((i == TM_HISTOGRAM_BUCKETS - 1U) || (limit > hp->tm.worst)) {
+    limit = hp->tm.worst;
+  }
+
+  return limit;
+}
+
+/**
+ * @brief   Returns the lowest value accounted in a bucket.
+ *
+ * @param[in] i         the bucket index
+ * @return              The bucket base value in cycles.
+ *
+ * @xclass
+ */
+rtcnt_t chTMHistogramGetBucketBaseX(unsigned i) {
+  unsigned e, m;
+
+  chDbgCheck(i < TM_HISTOGRAM_BUCKETS);
+
+  e = i >> CH_CFG_TM_HISTOGRAM_SUB_BITS;
+  if (e == 0U) {
+    return (rtcnt_t)i;
+  }
+  m = i & ((1U << CH_CFG_TM_HISTOGRAM_SUB_BITS) - 1U);
+
+  return ((rtcnt_t)((1U << CH_CFG_TM_HISTOGRAM_SUB_BITS) | m)) << (e - 1U);
+}
+
+/**
+ * @brief   Returns the highest value accounted in a bucket.
+ * @note    The last bucket also accounts all values exceeding its limit.
+ *
+ * @param[in] i         the bucket index
+ * @return              The bucket limit value in cycles.
+ *
+ * @xclass
+ */
+rtcnt_t chTMHistogramGetBucketLimitX(unsigned i) {
+  unsigned e;
+
+  chDbgCheck(i < TM_HISTOGRAM_BUCKETS);
+
+  e = i >> CH_CFG_TM_HISTOGRAM_SUB_BITS;
+  if (e == 0U) {
+    return (rtcnt_t)i;
+  }
+
+  return chTMHistogramGetBucketBaseX(i) +
+         (((rtcnt_t)1 << (e - 1U)) - (rtcnt_t)1);
+}
+
 #endif /* CH_CFG_USE_TM == TRUE */
 
 /** @} */
@@ -69,6 +69,14 @@ NOINLINE static void trace_next(os_instance_t *oip) {
   if (++oip->trace_buffer.ptr >= &oip->trace_buffer.buffer[CH_DBG_TRACE_BUFFER_SIZE]) {
     oip->trace_buffer.ptr = &oip->trace_buffer.buffer[0];
   }
+
+  /* If the buffer is full then the oldest unread record is dropped.*/
+  if (oip->trace_buffer.ptr == oip->trace_buffer.rdptr) {
+    if (++oip->trace_buffer.rdptr >= &oip->trace_buffer.buffer[CH_DBG_TRACE_BUFFER_SIZE]) {
+      oip->trace_buffer.rdptr = &oip->trace_buffer.buffer[0];
+    }
+    oip->trace_buffer.lost++;
+  }
 }
 #endif
 
@@ -91,6 +99,8 @@ void __trace_object_init(trace_buffer_t *tbp) {
   tbp->suspended = (uint16_t)~CH_DBG_TRACE_MASK;
   tbp->size      = CH_DBG_TRACE_BUFFER_SIZE;
   tbp->ptr       = &tbp->buffer[0];
+  tbp->rdptr     = &tbp->buffer[0];
+  tbp->lost      = (ucnt_t)0;
   for (i = 0U; i < (unsigned)CH_DBG_TRACE_BUFFER_SIZE; i++) {
     tbp->buffer[i].type = CH_TRACE_TYPE_UNUSED;
   }
@@ -286,6 +296,112 @@ void chTraceResume(uint16_t mask) {
   chTraceResumeI(mask);
   chSysUnlock();
 }
+
+/**
+ * @brief   Fetches records from the trace buffer.
+ * @details Records are returned in chronological order and are removed
+ *          from the set of unread records, the buffer content is not
+ *          altered and remains available to debuggers.
+ * @note    Records of the current core are returned.
+ *
+ * @param[out] tep      pointer to an array of @p trace_event_t structures
+ * @param[in] n         maximum number of records to be fetched
+ * @param[out] lostp    pointer to a variable receiving the number of records
+ *                      overwritten before being read since the previous
+ *                      call or @p NULL
+ * @return              The number of fetched records.
+ *
+ * @iclass
+ */
+unsigned chTraceReadI(trace_event_t *tep, unsigned n, ucnt_t *lostp) {
+  trace_buffer_t *tbp = &currcore->trace_buffer;
+  unsigned i = 0U;
+
+  chDbgCheckClassI();
+
+  while ((i < n) && (tbp->rdptr != tbp->ptr)) {
+    tep[i] = *tbp->rdptr;
+    if (++tbp->rdptr >= &tbp->buffer[CH_DBG_TRACE_BUFFER_SIZE]) {
+      tbp->rdptr = &tbp->buffer[0];
+    }
+    i++;
+  }
+
+  if (lostp != NULL) {
+    *lostp = tbp->lost;
+  }
+  tbp->lost = (ucnt_t)0;
+
+  return i;
+}
+
+/**
+ * @brief   Fetches records from the trace buffer.
+ * @details Records are returned in chronological order and are removed
+ *          from the set of unread records, the buffer content is not
+ *          altered and remains available to debuggers.
+ * @note    Records of the current core are returned.
+ * @note    Records are copied in a critical zone, small values of @p n
+ *          should be used in order to not affect system latency.
+ *
+ * @param[out] tep      pointer to an array of @p trace_event_t structures
+ * @param[in] n         maximum number of records to be fetched
+ * @param[out] lostp    pointer to a variable receiving the number of records
+ *                      overwritten before being read since the previous
+ *                      call or @p NULL
+ * @return              The number of fetched records.
+ *
+ * @api
+ */
+unsigned chTraceRead(trace_event_t *tep, unsigned n, ucnt_t *lostp) {
+  unsigned i;
+
+  chSysLock();
+  i = chTraceReadI(tep, n, lostp);
+  chSysUnlock();
+
+  return i;
+}
+
+/**
+ * @brief   Returns the number of unread records in the trace buffer.
+ * @note    Records of the current core are counted.
+ *
+ * @return              The number of unread records.
+ *
+ * @iclass
+ */
+unsigned chTraceGetPendingI(void) {
+  trace_buffer_t *tbp = &currcore->trace_buffer;
+
+  chDbgCheckClassI();
+
+  /* The buffer is never completely filled, the oldest record is dropped
+     instead, so equal pointers always mean an empty buffer.*/
+  if (tbp->ptr >= tbp->rdptr) {
+    return (unsigned)(tbp->ptr - tbp->rdptr);
+  }
+
+  return (unsigned)((tbp->ptr + CH_DBG_TRACE_BUFFER_SIZE) - tbp->rdptr);
+}
+
+/**
+ * @brief   Returns the number of unread records in the trace buffer.
+ * @note    Records of the current core are counted.
+ *
+ * @return              The number of unread records.
+ *
+ * @api
+ */
+unsigned chTraceGetPending(void) {
+  unsigned n;
+
+  chSysLock();
+  n = chTraceGetPendingI();
+  chSysUnlock();
+
+  return n;
+}
 #endif /* CH_DBG_TRACE_MASK != CH_DBG_TRACE_MASK_DISABLED */
 
 /** @} */
@@ -92,6 +92,16 @@
 #define TEST_CFG_SIZE_REPORT                TRUE
 #endif
 
+/**
+ * @brief   Maximum number of samples collected by a benchmark.
+ * @note    Zero disables the benchmark support.
+ * @note    Requires @p TEST_CFG_CHIBIOS_SUPPORT and the RT time measurement
+ *          subsystem.
+ */
+#if !defined(TEST_CFG_BENCHMARK_SAMPLES) || defined(__DOXYGEN__)
+#define TEST_CFG_BENCHMARK_SAMPLES          32
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -112,6 +122,20 @@
 #error "TEST_CFG_DELAY_BETWEEN_TESTS requires TEST_CFG_CHIBIOS_SUPPORT"
 #endif
 
+/**
+ * @brief   Benchmark support availability.
+ */
+#if ((TEST_CFG_CHIBIOS_SUPPORT == TRUE) && (TEST_CFG_BENCHMARK_SAMPLES > 0) && \
+     defined(CH_CFG_USE_TM)) || defined(__DOXYGEN__)
+#if (CH_CFG_USE_TM == TRUE) || defined(__DOXYGEN__)
+#define TEST_BENCHMARK_SUPPORT              TRUE
+#else
+#define TEST_BENCHMARK_SUPPORT              FALSE
+#endif
+#else
+#define TEST_BENCHMARK_SUPPORT              FALSE
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
@@ -160,6 +184,32 @@ typedef struct {
    */
   BaseSequentialStream *stream;
 #endif
+#if (TEST_BENCHMARK_SUPPORT == TRUE) || defined(__DOXYGEN__)
+  /**
+   * @brief   Test sequence being executed.
+   */
+  unsigned          current_sequence;
+  /**
+   * @brief   Test case being executed.
+   */
+  unsigned          current_case;
+  /**
+   * @brief   Benchmark time measurement object.
+   */
+  time_measurement_t tm;
+  /**
+   * @brief   Number of collected benchmark samples.
+   */
+  unsigned          nsamples;
+  /**
+   * @brief   Benchmark samples in cycles.
+   */
+  rtcnt_t           samples[TEST_CFG_BENCHMARK_SAMPLES];
+  /**
+   * @brief   Machine-readable benchmark report stream or @p NULL.
+   */
+  BaseSequentialStream *report;
+#endif
 } ch_test_context_t;
 
 /**
@@ -316,6 +366,11 @@ extern "C" {
   bool test_execute_stream(BaseSequentialStream *stream,
                            const testsuite_t *tsp);
 #endif
+#if TEST_BENCHMARK_SUPPORT == TRUE
+  void test_set_report_stream(BaseSequentialStream *stream);
+  void test_benchmark_reset(void);
+  void test_benchmark_report(const char *name);
+#endif
 #ifdef __cplusplus
 }
 #endif
@@ -346,6 +401,32 @@ static inline msg_t test_execute(BaseSequentialStream *stream,
 #endif
 
 
+#if (TEST_BENCHMARK_SUPPORT == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Starts a benchmark sample measurement.
+ *
+ * @api
+ */
+static inline void test_benchmark_start(void) {
+
+  chTMStartMeasurementX(&chtest.tm);
+}
+
+/**
+ * @brief   Stops a benchmark sample measurement and stores the sample.
+ * @note    Samples exceeding @p TEST_CFG_BENCHMARK_SAMPLES are discarded.
+ *
+ * @api
+ */
+static inline void test_benchmark_stop(void) {
+
+  chTMStopMeasurementX(&chtest.tm);
+  if (chtest.nsamples < (unsigned)TEST_CFG_BENCHMARK_SAMPLES) {
+    chtest.samples[chtest.nsamples++] = chtest.tm.last;
+  }
+}
+#endif /* TEST_BENCHMARK_SUPPORT == TRUE */
+
 /**
  * @brief   Prints a decimal unsigned number.
  *
@@ -61,6 +61,28 @@ static int test_stream_putchar(int c) {
 }
 #endif
 
+#if (TEST_BENCHMARK_SUPPORT == TRUE) || defined(__DOXYGEN__)
+static int test_report_putchar(int c) {
+
+  streamPut(chtest.report, (uint8_t)c);
+
+  return c;
+}
+
+static void test_sort_samples(rtcnt_t *samples, unsigned n) {
+  unsigned i, j;
+
+  /* Insertion sort, samples are few and mostly ordered already.*/
+  for (i = 1U; i < n; i++) {
+    rtcnt_t s = samples[i];
+    for (j = i; (j > 0U) && (samples[j - 1U] > s); j--) {
+      samples[j] = samples[j - 1U];
+    }
+    samples[j] = s;
+  }
+}
+#endif
+
 static void test_clear_tokens(void) {
 
   chtest.tokp = chtest.tokens_buffer;
@@ -79,6 +101,9 @@ static void test_execute_case(const testcase_t *tcp) {
   /* Initialization */
   test_clear_tokens();
   chtest.local_fail = false;
+#if TEST_BENCHMARK_SUPPORT == TRUE
+  test_benchmark_reset();
+#endif
 
   if (tcp->setup != NULL) {
     tcp->setup();
@@ -173,6 +198,10 @@ static bool test_execute_inner(const testsuite_t *tsp) {
 #endif
     tcase = 0U;
     while (tsp->sequences[tseq]->cases[tcase] != NULL) {
+#if TEST_BENCHMARK_SUPPORT == TRUE
+      chtest.current_sequence = tseq + 1U;
+      chtest.current_case     = tcase + 1U;
+#endif
       test_print_line();
       test_printf("--- Test Case %u.%u (%s)"TEST_CFG_EOL_STRING, tseq + 1U, tcase + 1U, tsp->sequences[tseq]->cases[tcase]->name);
 #if TEST_CFG_DELAY_BETWEEN_TESTS > 0
@@ -315,4 +344,80 @@ bool test_execute_stream(BaseSequentialStream *stream,
 }
 #endif /* TEST_CFG_CHIBIOS_SUPPORT == TRUE */
 
+#if (TEST_BENCHMARK_SUPPORT == TRUE) || defined(__DOXYGEN__)
+/**
+ * @brief   Sets the machine-readable benchmark report stream.
+ * @details Each call to @p test_benchmark_report() emits a line containing
+ *          a JSON object on this stream, in addition to the human-readable
+ *          output on the test stream.
+ *
+ * @param[in] stream    pointer to a @p BaseSequentialStream object or
+ *                      @p NULL for no report
+ *
+ * @api
+ */
+void test_set_report_stream(BaseSequentialStream *stream) {
+
+  chtest.report = stream;
+}
+
+/**
+ * @brief   Discards the collected benchmark samples.
+ * @note    Samples are discarded automatically before each test case.
+ *
+ * @api
+ */
+void test_benchmark_reset(void) {
+
+  chTMObjectInit(&chtest.tm);
+  chtest.nsamples = 0U;
+}
+
+/**
+ * @brief   Reports statistics on the collected benchmark samples.
+ * @details Samples are sorted and minimum, median, 99th percentile and
+ *          maximum are printed, in cycles, on the test stream and on the
+ *          report stream, if any.
+ * @note    The measurement calibration is already compensated by the time
+ *          measurement subsystem.
+ *
+ * @param[in] name      name of the measured quantity
+ *
+ * @api
+ */
+void test_benchmark_report(const char *name) {
+  unsigned n = chtest.nsamples;
+  rtcnt_t *s = chtest.samples;
+  rtcnt_t med, p99;
+
+  if (n == 0U) {
+    test_printf("--- %s: no samples"TEST_CFG_EOL_STRING, name);
+    return;
+  }
+
+  test_sort_samples(s, n);
+  med = s[(n - 1U) / 2U];
+  p99 = s[((99U * n) + 99U) / 100U - 1U];
+
+  test_printf("--- %s: min %U, med %U, p99 %U, max %U cycles (%u samples)"
+              TEST_CFG_EOL_STRING, name,
+              (unsigned long)s[0], (unsigned long)med,
+              (unsigned long)p99, (unsigned long)s[n - 1U], n);
+
+  if (chtest.report != NULL) {
+    test_putchar_t putfunc = chtest.putchar;
+
+    /* Reusing the formatter by temporarily redirecting the output.*/
+    chtest.putchar = test_report_putchar;
+    test_printf("{\"case\":\"%u.%u\",\"name\":\"%s\",\"unit\":\"cycles\","
+                "\"samples\":%u,\"min\":%U,\"median\":%U,\"p99\":%U,"
+                "\"max\":%U}"TEST_CFG_EOL_STRING,
+                chtest.current_sequence, chtest.current_case, name, n,
+                (unsigned long)s[0], (unsigned long)med,
+                (unsigned long)p99, (unsigned long)s[n - 1U]);
+    chtest.putchar = putfunc;
+  }
+}
+#endif /* TEST_BENCHMARK_SUPPORT == TRUE */
+
 /** @} */
@@ -24,6 +24,11 @@
 
 #include <ch.h>
 
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <utility>
+
 #ifndef _CH_HPP_
 #define _CH_HPP_
 
@@ -2401,6 +2406,26 @@ namespace chibios_rt {
       chEvtRegisterMask(&ev_source, &elp->ev_listener, emask);
     }
 
+    /**
+     * @brief   Registers an Event Listener on an Event Source.
+     * @details The listener is signaled only if the broadcasted flags
+     *          match the specified flags mask.
+     *
+     * @param[in] elp       pointer to the @p EvtListener object
+     * @param[in] emask     the mask of event flags to be pended to the
+     *                      thread when the event source is broadcasted
+     * @param[in] wflags    mask of flags the listener is interested in
+     *
+     * @api
+     */
+    void registerMaskWithFlags(EventListener *elp,
+                               eventmask_t emask,
+                               eventflags_t wflags) {
+
+      chEvtRegisterMaskWithFlags(&ev_source, &elp->ev_listener,
+                                 emask, wflags);
+    }
+
     /**
      * @brief   Unregisters a listener.
      * @details The specified listeners is no more signaled by the event
@@ -2773,6 +2798,791 @@ namespace chibios_rt {
   };
 #endif /* CH_CFG_USE_MAILBOXES == TRUE */
 
+  /*------------------------------------------------------------------------*
+   * chibios_rt::LockFreeWaitPoint                                          *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief     Waiting side of a lock-free queue.
+   * @details   Threads are suspended only when the lock-free operation
+   *            fails, the other side of the queue enters the kernel only
+   *            if there are waiting threads.
+   *
+   * @param W               waiting threads object, @p ThreadStayPoint for a
+   *                        single waiting thread or @p ThreadsQueue
+   */
+  template <class W>
+  class LockFreeWaitPoint {
+    /**
+     * @brief   Number of waiting threads, changed with the kernel locked.
+     */
+    std::atomic<unsigned> waiting;
+
+    /**
+     * @brief   Waiting threads.
+     */
+    W threads;
+
+    static msg_t suspendS(ThreadStayPoint &tsp, sysinterval_t timeout) {
+
+      return tsp.suspendS(timeout);
+    }
+
+    static msg_t suspendS(ThreadsQueue &tq, sysinterval_t timeout) {
+
+      return tq.enqueueSelfS(timeout);
+    }
+
+    static void resumeI(ThreadStayPoint &tsp) {
+
+      tsp.resumeI(MSG_OK);
+    }
+
+    static void resumeI(ThreadsQueue &tq) {
+
+      tq.dequeueNextI(MSG_OK);
+    }
+
+  public:
+    /**
+     * @brief   LockFreeWaitPoint constructor.
+     *
+     * @init
+     */
+    LockFreeWaitPoint(void) : waiting(0U), threads() {
+    }
+
+    /* Prohibit copy construction and assignment.*/
+    LockFreeWaitPoint(const LockFreeWaitPoint &) = delete;
+    LockFreeWaitPoint &operator=(const LockFreeWaitPoint &) = delete;
+
+    /**
+     * @brief   Retries an operation until success or timeout.
+     * @details The operation is retried after announcing the waiting thread
+     *          and with the kernel locked, the thread is suspended only if
+     *          the operation still fails.
+     *
+     * @param[in] op        the lock-free operation, it must not enter the
+     *                      kernel
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The operation result.
+     * @retval MSG_OK       if the operation succeeded.
+     * @retval MSG_TIMEOUT  if the operation did not succeed within the
+     *                      specified timeout.
+     *
+     * @api
+     */
+    template <typename F>
+    msg_t wait(F op, sysinterval_t timeout) {
+      systime_t start = chVTGetSystemTimeX();
+
+      while (!op()) {
+        sysinterval_t left = timeout;
+        msg_t msg;
+
+        if (timeout != TIME_INFINITE) {
+          sysinterval_t elapsed = chTimeDiffX(start, chVTGetSystemTimeX());
+
+          if (elapsed >= timeout) {
+            return MSG_TIMEOUT;
+          }
+          left = timeout - elapsed;
+        }
+
+        chSysLock();
+        waiting.store(waiting.load(std::memory_order_relaxed) + 1U,
+                      std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (op()) {
+          msg = MSG_OK;
+        }
+        else {
+          msg = suspendS(threads, left);
+        }
+        waiting.store(waiting.load(std::memory_order_relaxed) - 1U,
+                      std::memory_order_relaxed);
+        chSysUnlock();
+
+        if (msg != MSG_OK) {
+          return msg;
+        }
+      }
+
+      return MSG_OK;
+    }
+
+    /**
+     * @brief   Wakes up one waiting thread, if any.
+     *
+     * @api
+     */
+    void notify(void) {
+
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (waiting.load(std::memory_order_relaxed) != 0U) {
+        chSysLock();
+        resumeI(threads);
+        chSchRescheduleS();
+        chSysUnlock();
+      }
+    }
+
+    /**
+     * @brief   Wakes up one waiting thread, if any.
+     *
+     * @iclass
+     */
+    void notifyI(void) {
+
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (waiting.load(std::memory_order_relaxed) != 0U) {
+        resumeI(threads);
+      }
+    }
+  };
+
+  /**
+   * @brief     Waiting side of a non-blocking lock-free queue.
+   */
+  class LockFreeNoWait {
+  public:
+    void notify(void) {
+    }
+
+    void notifyI(void) {
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::SPSCQueue                                                  *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief     Single producer single consumer lock-free queue.
+   * @details   Elements are moved in and out of the queue, move-only types
+   *            are supported. The fast path does not enter the kernel, the
+   *            other side is notified only if a thread is waiting on it.
+   * @note      There must be a single producer and a single consumer, the
+   *            producer and the consumer can be threads or ISRs.
+   *
+   * @param T               type of the elements
+   * @param N               capacity of the queue, must be a power of two
+   * @param B               enables the blocking @p post() and @p fetch()
+   */
+  template <typename T, size_t N, bool B = false>
+  class SPSCQueue {
+
+    static_assert((N >= 2U) && ((N & (N - 1U)) == 0U),
+                  "SPSCQueue capacity must be a power of two");
+
+    typedef typename std::conditional<B, LockFreeWaitPoint<ThreadStayPoint>,
+                                      LockFreeNoWait>::type wait_point_t;
+
+    static constexpr size_t MASK = N - 1U;
+
+    /**
+     * @brief   Read index, free running, written by the consumer.
+     */
+    std::atomic<size_t> head;
+
+    /**
+     * @brief   Write index, free running, written by the producer.
+     */
+    std::atomic<size_t> tail;
+
+    /**
+     * @brief   Elements storage.
+     */
+    alignas(T) uint8_t storage[N][sizeof (T)];
+
+    /**
+     * @brief   Consumer waiting for elements.
+     */
+    wait_point_t not_empty;
+
+    /**
+     * @brief   Producer waiting for space.
+     */
+    wait_point_t not_full;
+
+    T *slot(size_t i) {
+
+      return reinterpret_cast<T *>(storage[i & MASK]);
+    }
+
+    template <typename... Args>
+    bool put(Args &&... args) {
+      size_t t = tail.load(std::memory_order_relaxed);
+
+      if ((t - head.load(std::memory_order_acquire)) >= N) {
+        return false;
+      }
+      new (storage[t & MASK]) T(std::forward<Args>(args)...);
+      tail.store(t + 1U, std::memory_order_release);
+
+      return true;
+    }
+
+    bool get(T *msgp) {
+      size_t h = head.load(std::memory_order_relaxed);
+      T *p;
+
+      if (tail.load(std::memory_order_acquire) == h) {
+        return false;
+      }
+      p = slot(h);
+      *msgp = std::move(*p);
+      p->~T();
+      head.store(h + 1U, std::memory_order_release);
+
+      return true;
+    }
+
+  public:
+    /**
+     * @brief   SPSCQueue constructor.
+     *
+     * @init
+     */
+    SPSCQueue(void) : head(0U), tail(0U), not_empty(), not_full() {
+    }
+
+    /**
+     * @brief   SPSCQueue destructor.
+     * @details The elements still in the queue are destroyed.
+     */
+    ~SPSCQueue() {
+      size_t h, t = tail.load(std::memory_order_relaxed);
+
+      for (h = head.load(std::memory_order_relaxed); h != t; h++) {
+        slot(h)->~T();
+      }
+    }
+
+    /* Prohibit copy construction and assignment.*/
+    SPSCQueue(const SPSCQueue &) = delete;
+    SPSCQueue &operator=(const SPSCQueue &) = delete;
+
+    /**
+     * @brief   Returns the capacity of the queue.
+     */
+    static constexpr size_t getSizeX(void) {
+
+      return N;
+    }
+
+    /**
+     * @brief   Returns the number of elements in the queue.
+     * @note    The value can be outdated when returned if the other side
+     *          is operating on the queue.
+     *
+     * @return              The number of elements.
+     *
+     * @xclass
+     */
+    size_t getUsedCountX(void) const {
+
+      return tail.load(std::memory_order_acquire) -
+             head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief   Constructs an element in the queue, if there is space.
+     *
+     * @param[in] args      the element constructor arguments
+     * @return              The operation result.
+     * @retval true         if the element has been posted.
+     * @retval false        if the queue is full.
+     *
+     * @api
+     */
+    template <typename... Args>
+    bool tryEmplace(Args &&... args) {
+
+      if (!put(std::forward<Args>(args)...)) {
+        return false;
+      }
+      not_empty.notify();
+
+      return true;
+    }
+
+    /**
+     * @brief   Posts an element into the queue, if there is space.
+     *
+     * @param[in] msg       the element to be posted
+     * @return              The operation result.
+     * @retval true         if the element has been posted.
+     * @retval false        if the queue is full.
+     *
+     * @api
+     */
+    bool tryPost(T msg) {
+
+      return tryEmplace(std::move(msg));
+    }
+
+    /**
+     * @brief   Posts an element into the queue, if there is space.
+     *
+     * @param[in] msg       the element to be posted
+     * @return              The operation result.
+     * @retval true         if the element has been posted.
+     * @retval false        if the queue is full.
+     *
+     * @iclass
+     */
+    bool tryPostI(T msg) {
+
+      if (!put(std::move(msg))) {
+        return false;
+      }
+      not_empty.notifyI();
+
+      return true;
+    }
+
+    /**
+     * @brief   Fetches an element from the queue, if any.
+     *
+     * @param[out] msgp     pointer to the fetched element
+     * @return              The operation result.
+     * @retval true         if an element has been fetched.
+     * @retval false        if the queue is empty.
+     *
+     * @api
+     */
+    bool tryFetch(T *msgp) {
+
+      if (!get(msgp)) {
+        return false;
+      }
+      not_full.notify();
+
+      return true;
+    }
+
+    /**
+     * @brief   Fetches an element from the queue, if any.
+     *
+     * @param[out] msgp     pointer to the fetched element
+     * @return              The operation result.
+     * @retval true         if an element has been fetched.
+     * @retval false        if the queue is empty.
+     *
+     * @iclass
+     */
+    bool tryFetchI(T *msgp) {
+
+      if (!get(msgp)) {
+        return false;
+      }
+      not_full.notifyI();
+
+      return true;
+    }
+
+    /**
+     * @brief   Posts an element into the queue.
+     * @details The invoking thread waits for space if the queue is full.
+     * @pre     The queue must be blocking.
+     *
+     * @param[in] msg       the element to be posted
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The operation status.
+     * @retval MSG_OK       if the element has been posted.
+     * @retval MSG_TIMEOUT  if the operation has timed out.
+     *
+     * @api
+     */
+    msg_t post(T msg, sysinterval_t timeout) {
+      msg_t rdymsg;
+
+      static_assert(B, "SPSCQueue is not blocking");
+
+      rdymsg = not_full.wait([&]() { return put(std::move(msg)); }, timeout);
+      if (rdymsg == MSG_OK) {
+        not_empty.notify();
+      }
+
+      return rdymsg;
+    }
+
+    /**
+     * @brief   Fetches an element from the queue.
+     * @details The invoking thread waits for an element if the queue is
+     *          empty.
+     * @pre     The queue must be blocking.
+     *
+     * @param[out] msgp     pointer to the fetched element
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The operation status.
+     * @retval MSG_OK       if an element has been fetched.
+     * @retval MSG_TIMEOUT  if the operation has timed out.
+     *
+     * @api
+     */
+    msg_t fetch(T *msgp, sysinterval_t timeout) {
+      msg_t rdymsg;
+
+      static_assert(B, "SPSCQueue is not blocking");
+
+      rdymsg = not_empty.wait([&]() { return get(msgp); }, timeout);
+      if (rdymsg == MSG_OK) {
+        not_full.notify();
+      }
+
+      return rdymsg;
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::MPMCQueue                                                  *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief     Bounded multiple producers multiple consumers lock-free queue.
+   * @details   Each slot carries a sequence number, producers and consumers
+   *            claim slots with a compare-and-swap on the respective index.
+   *            Elements are moved in and out of the queue, move-only types
+   *            are supported.
+   * @note      A producer preempted between claiming a slot and publishing
+   *            the element delays the consumers of that slot, the other
+   *            slots are not affected.
+   * @note      Requires lock-free compare-and-swap, not available on
+   *            ARMv6-M cores.
+   *
+   * @param T               type of the elements
+   * @param N               capacity of the queue, must be a power of two
+   * @param B               enables the blocking @p post() and @p fetch()
+   */
+  template <typename T, size_t N, bool B = false>
+  class MPMCQueue {
+
+    static_assert((N >= 2U) && ((N & (N - 1U)) == 0U),
+                  "MPMCQueue capacity must be a power of two");
+    static_assert(ATOMIC_POINTER_LOCK_FREE == 2,
+                  "MPMCQueue requires lock-free atomic operations");
+
+    typedef typename std::conditional<B, LockFreeWaitPoint<ThreadsQueue>,
+                                      LockFreeNoWait>::type wait_point_t;
+
+    static constexpr size_t MASK = N - 1U;
+
+    /**
+     * @brief   Queue slot.
+     */
+    struct cell_t {
+      std::atomic<size_t>   seq;
+      alignas(T) uint8_t    data[sizeof (T)];
+    };
+
+    /**
+     * @brief   Write index, free running.
+     */
+    std::atomic<size_t> tail;
+
+    /**
+     * @brief   Read index, free running.
+     */
+    std::atomic<size_t> head;
+
+    /**
+     * @brief   Slots.
+     */
+    cell_t cells[N];
+
+    /**
+     * @brief   Consumers waiting for elements.
+     */
+    wait_point_t not_empty;
+
+    /**
+     * @brief   Producers waiting for space.
+     */
+    wait_point_t not_full;
+
+    template <typename... Args>
+    bool put(Args &&... args) {
+      size_t pos = tail.load(std::memory_order_relaxed);
+      cell_t *cp;
+
+      while (true) {
+        size_t seq;
+
+        cp = &cells[pos & MASK];
+        seq = cp->seq.load(std::memory_order_acquire);
+        if (seq == pos) {
+          if (tail.compare_exchange_weak(pos, pos + 1U,
+                                         std::memory_order_relaxed)) {
+            break;
+          }
+        }
+        else if ((ptrdiff_t)(seq - pos) < 0) {
+          return false;
+        }
+        else {
+          pos = tail.load(std::memory_order_relaxed);
+        }
+      }
+      new (cp->data) T(std::forward<Args>(args)...);
+      cp->seq.store(pos + 1U, std::memory_order_release);
+
+      return true;
+    }
+
+    bool get(T *msgp) {
+      size_t pos = head.load(std::memory_order_relaxed);
+      cell_t *cp;
+      T *p;
+
+      while (true) {
+        size_t seq;
+
+        cp = &cells[pos & MASK];
+        seq = cp->seq.load(std::memory_order_acquire);
+        if (seq == pos + 1U) {
+          if (head.compare_exchange_weak(pos, pos + 1U,
+                                         std::memory_order_relaxed)) {
+            break;
+          }
+        }
+        else if ((ptrdiff_t)(seq - (pos + 1U)) < 0) {
+          return false;
+        }
+        else {
+          pos = head.load(std::memory_order_relaxed);
+        }
+      }
+      p = reinterpret_cast<T *>(cp->data);
+      *msgp = std::move(*p);
+      p->~T();
+      cp->seq.store(pos + N, std::memory_order_release);
+
+      return true;
+    }
+
+  public:
+    /**
+     * @brief   MPMCQueue constructor.
+     *
+     * @init
+     */
+    MPMCQueue(void) : tail(0U), head(0U), not_empty(), not_full() {
+      size_t i;
+
+      for (i = 0U; i < N; i++) {
+        cells[i].seq.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    /**
+     * @brief   MPMCQueue destructor.
+     * @details The elements still in the queue are destroyed.
+     */
+    ~MPMCQueue() {
+      size_t pos, t = tail.load(std::memory_order_relaxed);
+
+      for (pos = head.load(std::memory_order_relaxed); pos != t; pos++) {
+        reinterpret_cast<T *>(cells[pos & MASK].data)->~T();
+      }
+    }
+
+    /* Prohibit copy construction and assignment.*/
+    MPMCQueue(const MPMCQueue &) = delete;
+    MPMCQueue &operator=(const MPMCQueue &) = delete;
+
+    /**
+     * @brief   Returns the capacity of the queue.
+     */
+    static constexpr size_t getSizeX(void) {
+
+      return N;
+    }
+
+    /**
+     * @brief   Returns the number of elements in the queue.
+     * @note    The value is approximated if producers or consumers are
+     *          operating on the queue.
+     *
+     * @return              The number of elements.
+     *
+     * @xclass
+     */
+    size_t getUsedCountX(void) const {
+      size_t n = tail.load(std::memory_order_acquire) -
+                 head.load(std::memory_order_acquire);
+
+      return (ptrdiff_t)n < 0 ? 0U : (n > N ? N : n);
+    }
+
+    /**
+     * @brief   Constructs an element in the queue, if there is space.
+     *
+     * @param[in] args      the element constructor arguments
+     * @return              The operation result.
+     * @retval true         if the element has been posted.
+     * @retval false        if the queue is full.
+     *
+     * @api
+     */
+    template <typename... Args>
+    bool tryEmplace(Args &&... args) {
+
+      if (!put(std::forward<Args>(args)...)) {
+        return false;
+      }
+      not_empty.notify();
+
+      return true;
+    }
+
+    /**
+     * @brief   Posts an element into the queue, if there is space.
+     *
+     * @param[in] msg       the element to be posted
+     * @return              The operation result.
+     * @retval true         if the element has been posted.
+     * @retval false        if the queue is full.
+     *
+     * @api
+     */
+    bool tryPost(T msg) {
+
+      return tryEmplace(std::move(msg));
+    }
+
+    /**
+     * @brief   Posts an element into the queue, if there is space.
+     *
+     * @param[in] msg       the element to be posted
+     * @return              The operation result.
+     * @retval true         if the element has been posted.
+     * @retval false        if the queue is full.
+     *
+     * @iclass
+     */
+    bool tryPostI(T msg) {
+
+      if (!put(std::move(msg))) {
+        return false;
+      }
+      not_empty.notifyI();
+
+      return true;
+    }
+
+    /**
+     * @brief   Fetches an element from the queue, if any.
+     *
+     * @param[out] msgp     pointer to the fetched element
+     * @return              The operation result.
+     * @retval true         if an element has been fetched.
+     * @retval false        if the queue is empty.
+     *
+     * @api
+     */
+    bool tryFetch(T *msgp) {
+
+      if (!get(msgp)) {
+        return false;
+      }
+      not_full.notify();
+
+      return true;
+    }
+
+    /**
+     * @brief   Fetches an element from the queue, if any.
+     *
+     * @param[out] msgp     pointer to the fetched element
+     * @return              The operation result.
+     * @retval true         if an element has been fetched.
+     * @retval false        if the queue is empty.
+     *
+     * @iclass
+     */
+    bool tryFetchI(T *msgp) {
+
+      if (!get(msgp)) {
+        return false;
+      }
+      not_full.notifyI();
+
+      return true;
+    }
+
+    /**
+     * @brief   Posts an element into the queue.
+     * @details The invoking thread waits for space if the queue is full.
+     * @pre     The queue must be blocking.
+     *
+     * @param[in] msg       the element to be posted
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The operation status.
+     * @retval MSG_OK       if the element has been posted.
+     * @retval MSG_TIMEOUT  if the operation has timed out.
+     *
+     * @api
+     */
+    msg_t post(T msg, sysinterval_t timeout) {
+      msg_t rdymsg;
+
+      static_assert(B, "MPMCQueue is not blocking");
+
+      rdymsg = not_full.wait([&]() { return put(std::move(msg)); }, timeout);
+      if (rdymsg == MSG_OK) {
+        not_empty.notify();
+      }
+
+      return rdymsg;
+    }
+
+    /**
+     * @brief   Fetches an element from the queue.
+     * @details The invoking thread waits for an element if the queue is
+     *          empty.
+     * @pre     The queue must be blocking.
+     *
+     * @param[out] msgp     pointer to the fetched element
+     * @param[in] timeout   the number of ticks before the operation timeouts,
+     *                      the following special values are allowed:
+     *                      - @a TIME_IMMEDIATE immediate timeout.
+     *                      - @a TIME_INFINITE no timeout.
+     *                      .
+     * @return              The operation status.
+     * @retval MSG_OK       if an element has been fetched.
+     * @retval MSG_TIMEOUT  if the operation has timed out.
+     *
+     * @api
+     */
+    msg_t fetch(T *msgp, sysinterval_t timeout) {
+      msg_t rdymsg;
+
+      static_assert(B, "MPMCQueue is not blocking");
+
+      rdymsg = not_empty.wait([&]() { return get(msgp); }, timeout);
+      if (rdymsg == MSG_OK) {
+        not_full.notify();
+      }
+
+      return rdymsg;
+    }
+  };
+
 #if (CH_CFG_USE_MEMPOOLS == TRUE) || defined(__DOXYGEN__)
   /*------------------------------------------------------------------------*
    * chibios_rt::MemoryPool                                                 *
@@ -3060,6 +3870,185 @@ namespace chibios_rt {
   };
 #endif /* CH_CFG_USE_MEMPOOLS == TRUE */
 
+#if (CH_CFG_USE_ARENAS == TRUE) || defined(__DOXYGEN__)
+  /*------------------------------------------------------------------------*
+   * chibios_rt::MemoryArena                                                *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Class encapsulating a memory arena.
+   */
+  class MemoryArena {
+    /**
+     * @brief   Embedded @p memory_arena_t structure.
+     */
+    memory_arena_t arena;
+
+  public:
+    /**
+     * @brief   MemoryArena constructor.
+     *
+     * @param[in] buffer    arena buffer base
+     * @param[in] size      the size of the memory area located at \e buffer
+     *
+     * @init
+     */
+    MemoryArena(void *buffer, const size_t size) : arena() {
+
+      chArenaObjectInit(&arena, buffer, size);
+    }
+
+    /* Prohibit copy construction and assignment.*/
+    MemoryArena(const MemoryArena &) = delete;
+    MemoryArena &operator=(const MemoryArena &) = delete;
+
+    /**
+     * @brief   Allocates a block from the arena.
+     *
+     * @param[in] size      the size of the block to be allocated
+     * @param[in] align     desired memory alignment
+     * @return              The pointer to the allocated block.
+     * @retval nullptr      if the arena is exhausted.
+     *
+     * @api
+     */
+    void *alloc(const size_t size, unsigned align=PORT_NATURAL_ALIGN) {
+
+      return chArenaAllocAligned(&arena, size, align);
+    }
+
+    /**
+     * @brief   Allocates an array of objects from the arena.
+     * @note    Constructors are not invoked, destructors are not invoked
+     *          when the arena is released.
+     *
+     * @param[in] n         number of objects
+     * @return              The pointer to the first object.
+     * @retval nullptr      if the arena is exhausted.
+     *
+     * @api
+     */
+    template<typename T>
+    T *alloc(const size_t n=1) {
+
+      return static_cast<T *>(chArenaAllocAligned(&arena, n * sizeof (T),
+                                                  alignof (T)));
+    }
+
+    /**
+     * @brief   Returns a mark of the current arena position.
+     *
+     * @return              The arena mark.
+     *
+     * @api
+     */
+    arena_mark_t getMark(void) const {
+
+      return chArenaGetMark(&arena);
+    }
+
+    /**
+     * @brief   Releases all the blocks allocated after a mark.
+     *
+     * @param[in] mark      a mark previously returned by @p getMark()
+     *
+     * @api
+     */
+    void release(arena_mark_t mark) {
+
+      chArenaRelease(&arena, mark);
+    }
+
+    /**
+     * @brief   Releases all the blocks allocated from the arena.
+     *
+     * @api
+     */
+    void reset(void) {
+
+      chArenaReset(&arena);
+    }
+
+    /**
+     * @brief   Reports the arena status.
+     *
+     * @param[out] status   the arena status
+     *
+     * @api
+     */
+    void getStatus(arena_status_t &status) const {
+
+      chArenaGetStatus(&arena, &status);
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::StaticMemoryArena                                          *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Template class encapsulating a memory arena and its buffer.
+   */
+  template<size_t N>
+  class StaticMemoryArena : public MemoryArena {
+    /* The buffer is declared as an array of pointers in order to have the
+       base aligned for a pointer data type.*/
+    void *arena_buf[(N + sizeof (void *) - 1U) / sizeof (void *)];
+
+  public:
+    /**
+     * @brief   StaticMemoryArena constructor.
+     *
+     * @init
+     */
+    StaticMemoryArena(void) : MemoryArena(arena_buf, sizeof (arena_buf)) {
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::ArenaScope                                                 *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Scope guard of a memory arena.
+   * @details The arena position is marked on construction, all the blocks
+   *          allocated during the object lifetime are released on
+   *          destruction. Scopes can be nested.
+   */
+  class ArenaScope {
+    /**
+     * @brief   Guarded arena.
+     */
+    MemoryArena &arena;
+    /**
+     * @brief   Arena mark taken on construction.
+     */
+    arena_mark_t mark;
+
+  public:
+    /**
+     * @brief   ArenaScope constructor.
+     *
+     * @param[in] a         the guarded arena
+     *
+     * @api
+     */
+    ArenaScope(MemoryArena &a) : arena(a), mark(a.getMark()) {
+    }
+
+    /**
+     * @brief   ArenaScope destructor.
+     *
+     * @api
+     */
+    ~ArenaScope() {
+
+      arena.release(mark);
+    }
+
+    /* Prohibit copy construction and assignment.*/
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+  };
+#endif /* CH_CFG_USE_ARENAS == TRUE */
+
   /*------------------------------------------------------------------------*
    * chibios_rt::BaseSequentialStreamInterface                              *
    *------------------------------------------------------------------------*/
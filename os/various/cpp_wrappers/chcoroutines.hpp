@@ -0,0 +1,1307 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    chcoroutines.hpp
+ * @brief   C++20 coroutines executor and awaitable objects.
+ * @details Coroutines are run by an executor on a single thread, the
+ *          coroutine frames are allocated from a memory pool owned by the
+ *          executor so the RAM required by a coroutine is known and fixed.
+ *          <br>Coroutines are suspended by awaiting on the objects in this
+ *          module: sleeps, event sources, and the coroutine-native
+ *          semaphores, mailboxes and completions. The wake-up side of the
+ *          coroutine-native objects is I-class and can be used from ISRs
+ *          and driver callbacks.
+ * @note    Coroutines must be free or static functions returning
+ *          @p CoroutineTask and taking the executor as first parameter,
+ *          the frame allocator is selected using that parameter.
+ *
+ * @addtogroup cpp_library
+ * @{
+ */
+
+#include <coroutine>
+#include <cstddef>
+#include <new>
+
+#include "ch.hpp"
+
+#ifndef _CHCOROUTINES_HPP_
+#define _CHCOROUTINES_HPP_
+
+/**
+ * @brief   Number of event sources an executor can wait on at once.
+ * @note    Each event source uses an event flag of the executor thread,
+ *          event flag zero is used for the ready list.
+ */
+#if !defined(CH_CORO_EVENT_SOURCES) || defined(__DOXYGEN__)
+#define CH_CORO_EVENT_SOURCES               8
+#endif
+
+#if !defined(__cpp_impl_coroutine)
+#error "chcoroutines.hpp requires C++20 coroutines support"
+#endif
+
+#if CH_CFG_USE_MEMPOOLS == FALSE
+#error "chcoroutines.hpp requires CH_CFG_USE_MEMPOOLS"
+#endif
+
+#if CH_CFG_USE_EVENTS == FALSE
+#error "chcoroutines.hpp requires CH_CFG_USE_EVENTS"
+#endif
+
+#if (CH_CORO_EVENT_SOURCES < 1) || (CH_CORO_EVENT_SOURCES > 31)
+#error "invalid CH_CORO_EVENT_SOURCES value"
+#endif
+
+namespace chibios_rt {
+
+  class BaseCoroutineExecutor;
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutineNode                                              *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Ready list element of a coroutine.
+   * @details Each coroutine frame contains a node, the node is linked in
+   *          the executor ready list when the coroutine is made ready.
+   */
+  struct CoroutineNode {
+    /**
+     * @brief   Next node in the ready list.
+     */
+    CoroutineNode               *next;
+    /**
+     * @brief   Handle of the coroutine to be resumed.
+     */
+    std::coroutine_handle<>     handle;
+    /**
+     * @brief   Executor running the coroutine.
+     */
+    BaseCoroutineExecutor       *executor;
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutineTask                                              *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Return type of coroutines.
+   * @details A task is either spawned on its executor or awaited by another
+   *          coroutine of the same executor, in the latter case the caller
+   *          is resumed when the task returns.
+   */
+  class CoroutineTask {
+  public:
+    /**
+     * @brief   Promise type of coroutines.
+     */
+    class promise_type {
+    public:
+      /**
+       * @brief   Ready list node.
+       */
+      CoroutineNode             node;
+      /**
+       * @brief   Coroutine to be resumed on return or @p nullptr.
+       */
+      std::coroutine_handle<>   continuation;
+      /**
+       * @brief   Task spawned on the executor.
+       */
+      bool                      detached;
+
+      /**
+       * @brief   Promise constructor.
+       *
+       * @param[in] exec    executor running the coroutine
+       */
+      template<typename... Args>
+      promise_type(BaseCoroutineExecutor &exec, Args &...) :
+        node{nullptr,
+             std::coroutine_handle<promise_type>::from_promise(*this),
+             &exec},
+        continuation(nullptr), detached(false) {
+      }
+
+      /**
+       * @brief   Allocates a coroutine frame from the executor pool.
+       *
+       * @param[in] size    size of the coroutine frame
+       * @param[in] exec    executor running the coroutine
+       * @return            The pointer to the frame.
+       * @retval nullptr    if the pool is empty or the frame is too large.
+       */
+      template<typename... Args>
+      static void *operator new(size_t size,
+                                BaseCoroutineExecutor &exec,
+                                Args &...) noexcept;
+
+      /**
+       * @brief   Returns a coroutine frame to the executor pool.
+       *
+       * @param[in] p       pointer to the frame
+       */
+      static void operator delete(void *p, size_t);
+
+      /**
+       * @brief   Task returned when the frame allocation fails.
+       */
+      static CoroutineTask get_return_object_on_allocation_failure(void) {
+
+        return CoroutineTask(nullptr);
+      }
+
+      CoroutineTask get_return_object(void) {
+
+        return CoroutineTask(std::coroutine_handle<promise_type>::
+                             from_promise(*this));
+      }
+
+      std::suspend_always initial_suspend(void) noexcept {
+
+        return {};
+      }
+
+      /**
+       * @brief   Awaiter of the coroutine return.
+       * @details The caller is resumed if any, detached tasks release
+       *          their own frame.
+       */
+      struct FinalAwaiter {
+        bool await_ready(void) noexcept {
+
+          return false;
+        }
+
+        std::coroutine_handle<>
+        await_suspend(std::coroutine_handle<promise_type> h) noexcept;
+
+        void await_resume(void) noexcept {
+        }
+      };
+
+      FinalAwaiter final_suspend(void) noexcept {
+
+        return {};
+      }
+
+      void return_void(void) noexcept {
+      }
+
+      void unhandled_exception(void) noexcept {
+
+        chSysHalt("coroutine exception");
+      }
+    };
+
+    /**
+     * @brief   Type of the coroutine handle.
+     */
+    using handle_type = std::coroutine_handle<promise_type>;
+
+  private:
+    friend class BaseCoroutineExecutor;
+
+    /**
+     * @brief   Coroutine handle.
+     */
+    handle_type handle;
+
+    explicit CoroutineTask(handle_type h) : handle(h) {
+    }
+
+    explicit CoroutineTask(std::nullptr_t) : handle(nullptr) {
+    }
+
+  public:
+    /* Prohibit copy construction and assignment, but allow move.*/
+    CoroutineTask(const CoroutineTask &) = delete;
+    CoroutineTask &operator=(const CoroutineTask &) = delete;
+    CoroutineTask(CoroutineTask &&other) noexcept : handle(other.handle) {
+
+      other.handle = nullptr;
+    }
+
+    /**
+     * @brief   CoroutineTask destructor.
+     * @details The frame of a task not spawned is released.
+     */
+    ~CoroutineTask() {
+
+      if (handle) {
+        handle.destroy();
+      }
+    }
+
+    /**
+     * @brief   Checks if the frame allocation failed.
+     *
+     * @return              The task state.
+     * @retval true         if the task has a frame.
+     * @retval false        if the frame allocation failed.
+     */
+    bool isValid(void) const {
+
+      return (bool)handle;
+    }
+
+    /**
+     * @brief   Awaiter of a task.
+     */
+    struct Awaiter {
+      handle_type               callee;
+
+      bool await_ready(void) noexcept {
+
+        return !callee;
+      }
+
+      std::coroutine_handle<>
+      await_suspend(std::coroutine_handle<> caller) noexcept {
+
+        callee.promise().continuation = caller;
+        return callee;
+      }
+
+      void await_resume(void) noexcept {
+      }
+    };
+
+    /**
+     * @brief   Runs the task as part of the awaiting coroutine.
+     * @note    A task whose frame allocation failed returns immediately.
+     */
+    Awaiter operator co_await() && noexcept {
+
+      return Awaiter{handle};
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::BaseCoroutineExecutor                                      *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Base class of coroutines executors.
+   * @details The executor runs the ready coroutines in FIFO order on the
+   *          thread calling @p run(), when there are no ready coroutines
+   *          the thread waits for events.
+   * @note    The executor uses all the event flags of its thread.
+   */
+  class BaseCoroutineExecutor {
+  public:
+    /**
+     * @brief   Event flag of the ready list.
+     */
+    static constexpr eventmask_t READY_EVENT = EVENT_MASK(0);
+
+    /**
+     * @brief   Size of the frame header storing the executor pointer.
+     */
+    static constexpr size_t FRAME_HEADER = alignof(std::max_align_t);
+
+    /**
+     * @brief   Awaiter of an event source.
+     */
+    struct EventAwaiter {
+      EventAwaiter              *next;
+      CoroutineNode             *node;
+      EventSource               *source;
+      eventflags_t              wflags;
+      eventflags_t              flags;
+
+      bool await_ready(void) noexcept {
+
+        return false;
+      }
+
+      bool await_suspend(std::coroutine_handle<CoroutineTask::promise_type> h)
+                                                                    noexcept {
+
+        node = &h.promise().node;
+        return node->executor->waitEvent(this);
+      }
+
+      eventflags_t await_resume(void) noexcept {
+
+        return flags;
+      }
+    };
+
+  private:
+    /**
+     * @brief   Event source slot.
+     */
+    struct EventSlot {
+      EventSource               *source;
+      EventListener             listener;
+      eventflags_t              pending;
+      EventAwaiter              *waiters;
+    };
+
+    /**
+     * @brief   Frames pool.
+     */
+    MemoryPool                  frames;
+    /**
+     * @brief   Size of the frames, header included.
+     */
+    size_t                      frame_size;
+    /**
+     * @brief   Largest frame requested so far, header included.
+     */
+    size_t                      frame_max;
+    /**
+     * @brief   Thread running the executor or @p nullptr.
+     */
+    thread_t                    *thread;
+    /**
+     * @brief   Ready list head.
+     */
+    CoroutineNode               *ready_head;
+    /**
+     * @brief   Ready list tail.
+     */
+    CoroutineNode               *ready_tail;
+    /**
+     * @brief   Number of spawned tasks not yet returned.
+     */
+    unsigned                    alive;
+    /**
+     * @brief   Event source slots.
+     */
+    EventSlot                   slots[CH_CORO_EVENT_SOURCES];
+
+    friend struct CoroutineTask::promise_type::FinalAwaiter;
+
+    void terminated(void) {
+
+      chSysLock();
+      alive--;
+      chSysUnlock();
+    }
+
+    void dispatchEvents(eventmask_t events) {
+      unsigned i;
+
+      for (i = 0U; i < (unsigned)CH_CORO_EVENT_SOURCES; i++) {
+        EventSlot *sp = &slots[i];
+        EventAwaiter **pp;
+        eventflags_t flags, consumed = 0U;
+
+        if ((events & EVENT_MASK(i + 1U)) == 0U) {
+          continue;
+        }
+
+        /* Flags not matching any waiter are kept pending for the next
+           waiters.*/
+        flags = sp->pending | sp->listener.getAndClearFlags();
+        pp = &sp->waiters;
+        while (*pp != nullptr) {
+          EventAwaiter *wp = *pp;
+
+          if ((wp->wflags & flags) != 0U) {
+            wp->flags = wp->wflags & flags;
+            consumed |= wp->flags;
+            *pp = wp->next;
+            chSysLock();
+            readyI(wp->node);
+            chSysUnlock();
+          }
+          else {
+            pp = &wp->next;
+          }
+        }
+        sp->pending = flags & ~consumed;
+      }
+    }
+
+  protected:
+    /**
+     * @brief   BaseCoroutineExecutor constructor.
+     *
+     * @param[in] size      size of the frames, header included, must be a
+     *                      multiple of @p alignof(std::max_align_t)
+     * @param[in] p         pointer to the frames array, must be aligned to
+     *                      @p alignof(std::max_align_t)
+     * @param[in] n         number of frames in the array
+     *
+     * @init
+     */
+    BaseCoroutineExecutor(size_t size, void *p, size_t n) :
+      frames(size, p, n), frame_size(size), frame_max(0U),
+      thread(nullptr), ready_head(nullptr), ready_tail(nullptr),
+      alive(0U), slots() {
+    }
+
+  public:
+    /* Prohibit copy construction and assignment.*/
+    BaseCoroutineExecutor(const BaseCoroutineExecutor &) = delete;
+    BaseCoroutineExecutor &operator=(const BaseCoroutineExecutor &) = delete;
+
+    /**
+     * @brief   Allocates a coroutine frame.
+     *
+     * @param[in] size      size of the frame, header included
+     * @return              The pointer to the frame.
+     * @retval nullptr      if the pool is empty or the frame is too large.
+     *
+     * @api
+     */
+    void *allocFrame(size_t size) {
+
+      if (size > frame_max) {
+        frame_max = size;
+      }
+      if (size > frame_size) {
+        return nullptr;
+      }
+      return frames.alloc();
+    }
+
+    /**
+     * @brief   Releases a coroutine frame.
+     *
+     * @param[in] p         pointer to the frame
+     *
+     * @api
+     */
+    void freeFrame(void *p) {
+
+      frames.free(p);
+    }
+
+    /**
+     * @brief   Returns the largest frame requested so far.
+     * @note    This value can be used to tune the frames size.
+     *
+     * @return              The frame size, header included.
+     *
+     * @xclass
+     */
+    size_t getMaxFrameSizeX(void) const {
+
+      return frame_max;
+    }
+
+    /**
+     * @brief   Returns the number of spawned tasks not yet returned.
+     *
+     * @return              The number of tasks.
+     *
+     * @xclass
+     */
+    unsigned getAliveX(void) const {
+
+      return alive;
+    }
+
+    /**
+     * @brief   Makes a coroutine ready.
+     *
+     * @param[in] np        ready list node of the coroutine
+     *
+     * @iclass
+     */
+    void readyI(CoroutineNode *np) {
+
+      chDbgCheckClassI();
+
+      np->next = nullptr;
+      if (ready_tail == nullptr) {
+        ready_head = np;
+      }
+      else {
+        ready_tail->next = np;
+      }
+      ready_tail = np;
+      if (thread != nullptr) {
+        chEvtSignalI(thread, READY_EVENT);
+      }
+    }
+
+    /**
+     * @brief   Spawns a task on the executor.
+     * @details The task starts running when the executor is run, the task
+     *          frame is released when the task returns.
+     *
+     * @param[in] task      the task to be spawned
+     * @return              The operation result.
+     * @retval true         if the task has been spawned.
+     * @retval false        if the task frame allocation failed.
+     *
+     * @api
+     */
+    bool spawn(CoroutineTask &&task) {
+      CoroutineTask::handle_type h = task.handle;
+
+      if (!h) {
+        return false;
+      }
+      task.handle = nullptr;
+      h.promise().detached = true;
+
+      chSysLock();
+      alive++;
+      readyI(&h.promise().node);
+      chSchRescheduleS();
+      chSysUnlock();
+
+      return true;
+    }
+
+    /**
+     * @brief   Registers a waiter on an event source.
+     * @note    Used by the event sources awaiters, not meant to be called
+     *          directly.
+     *
+     * @param[in] wp        pointer to the awaiter
+     * @return              The suspension state.
+     * @retval true         if the coroutine has been suspended.
+     * @retval false        if matching flags were pending or no slot was
+     *                      available, in the latter case the returned flags
+     *                      are zero.
+     *
+     * @notapi
+     */
+    bool waitEvent(EventAwaiter *wp) {
+      EventSlot *sp = nullptr;
+      unsigned i;
+
+      chDbgAssert(chThdGetSelfX() == thread, "not executor thread");
+
+      /* Looking for the slot of the source or a free slot, slots without
+         waiters are reused only if there is no free slot.*/
+      for (i = 0U; i < (unsigned)CH_CORO_EVENT_SOURCES; i++) {
+        if (slots[i].source == wp->source) {
+          sp = &slots[i];
+          break;
+        }
+        if ((sp == nullptr) && (slots[i].source == nullptr)) {
+          sp = &slots[i];
+        }
+      }
+      if (sp == nullptr) {
+        for (i = 0U; i < (unsigned)CH_CORO_EVENT_SOURCES; i++) {
+          if (slots[i].waiters == nullptr) {
+            sp = &slots[i];
+            sp->source->unregister(&sp->listener);
+            sp->source = nullptr;
+            (void) chEvtGetAndClearEvents(EVENT_MASK(i + 1U));
+            break;
+          }
+        }
+      }
+      if (sp == nullptr) {
+        chDbgAssert(false, "no event slot available");
+        wp->flags = 0U;
+        return false;
+      }
+
+      if (sp->source == nullptr) {
+        sp->source  = wp->source;
+        sp->pending = 0U;
+        sp->source->registerMaskWithFlags(&sp->listener,
+                                          EVENT_MASK((sp - slots) + 1),
+                                          ALL_EVENTS);
+      }
+
+      /* Flags broadcasted while no coroutine was waiting.*/
+      sp->pending |= sp->listener.getAndClearFlags();
+      if ((sp->pending & wp->wflags) != 0U) {
+        wp->flags = sp->pending & wp->wflags;
+        sp->pending &= ~wp->flags;
+        return false;
+      }
+
+      wp->next = sp->waiters;
+      sp->waiters = wp;
+      return true;
+    }
+
+    /**
+     * @brief   Runs the coroutines.
+     * @details The function returns when all the spawned tasks returned.
+     * @note    Coroutines waiting on event sources are not counted, a task
+     *          still waiting keeps the executor running.
+     *
+     * @api
+     */
+    void run(void) {
+      unsigned i;
+
+      thread = chThdGetSelfX();
+      while (true) {
+        CoroutineNode *np;
+
+        chSysLock();
+        np = ready_head;
+        ready_head = nullptr;
+        ready_tail = nullptr;
+        if (np == nullptr) {
+          if (alive == 0U) {
+            chSysUnlock();
+            break;
+          }
+          chSysUnlock();
+          dispatchEvents(chEvtWaitAny(ALL_EVENTS));
+          continue;
+        }
+        chSysUnlock();
+
+        /* The batch is detached, coroutines made ready while running it
+           are run in the next batch.*/
+        while (np != nullptr) {
+          CoroutineNode *next = np->next;
+
+          np->handle.resume();
+          np = next;
+        }
+      }
+
+      for (i = 0U; i < (unsigned)CH_CORO_EVENT_SOURCES; i++) {
+        if (slots[i].source != nullptr) {
+          slots[i].source->unregister(&slots[i].listener);
+          slots[i].source = nullptr;
+        }
+      }
+      (void) chEvtGetAndClearEvents(ALL_EVENTS);
+      thread = nullptr;
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutineExecutor                                          *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Template class encapsulating an executor and its frames.
+   *
+   * @param S               maximum size of a coroutine frame
+   * @param N               number of coroutine frames
+   */
+  template<size_t S, size_t N>
+  class CoroutineExecutor : public BaseCoroutineExecutor {
+  public:
+    /**
+     * @brief   Size of the pool blocks.
+     */
+    static constexpr size_t BLOCK_SIZE =
+        ((S + FRAME_HEADER + alignof(std::max_align_t) - 1U) /
+         alignof(std::max_align_t)) * alignof(std::max_align_t);
+
+  private:
+    alignas(std::max_align_t) uint8_t frames_buf[N][BLOCK_SIZE];
+
+  public:
+    /**
+     * @brief   CoroutineExecutor constructor.
+     *
+     * @init
+     */
+    CoroutineExecutor(void) :
+      BaseCoroutineExecutor(BLOCK_SIZE, frames_buf, N) {
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutineTask (deferred)                                   *
+   *------------------------------------------------------------------------*/
+  template<typename... Args>
+  inline void *CoroutineTask::promise_type::operator new(size_t size,
+                                                         BaseCoroutineExecutor &exec,
+                                                         Args &...) noexcept {
+    uint8_t *p;
+
+    p = (uint8_t *)exec.allocFrame(size + BaseCoroutineExecutor::FRAME_HEADER);
+    if (p == nullptr) {
+      return nullptr;
+    }
+    *(BaseCoroutineExecutor **)p = &exec;
+
+    return p + BaseCoroutineExecutor::FRAME_HEADER;
+  }
+
+  inline void CoroutineTask::promise_type::operator delete(void *p, size_t) {
+    uint8_t *fp = (uint8_t *)p - BaseCoroutineExecutor::FRAME_HEADER;
+
+    (*(BaseCoroutineExecutor **)fp)->freeFrame(fp);
+  }
+
+  inline std::coroutine_handle<>
+  CoroutineTask::promise_type::FinalAwaiter::
+  await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+    promise_type &promise = h.promise();
+
+    if (promise.continuation) {
+      return promise.continuation;
+    }
+    if (promise.detached) {
+      BaseCoroutineExecutor *exec = promise.node.executor;
+
+      h.destroy();
+      exec->terminated();
+    }
+
+    return std::noop_coroutine();
+  }
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::Coroutine                                                  *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Coroutines awaitable operations.
+   */
+  class Coroutine {
+  public:
+    /**
+     * @brief   Awaiter of a sleep.
+     */
+    struct SleepAwaiter {
+      sysinterval_t             time;
+      CoroutineNode             *node;
+      virtual_timer_t           vt;
+
+      static void wakeup(virtual_timer_t *vtp, void *p) {
+        CoroutineNode *np = (CoroutineNode *)p;
+
+        (void)vtp;
+
+        chSysLockFromISR();
+        np->executor->readyI(np);
+        chSysUnlockFromISR();
+      }
+
+      bool await_ready(void) noexcept {
+
+        return false;
+      }
+
+      void await_suspend(std::coroutine_handle<CoroutineTask::promise_type> h)
+                                                                    noexcept {
+
+        node = &h.promise().node;
+        chSysLock();
+        if (time == TIME_IMMEDIATE) {
+          node->executor->readyI(node);
+        }
+        else {
+          chVTObjectInit(&vt);
+          chVTSetI(&vt, time, wakeup, (void *)node);
+        }
+        chSysUnlock();
+      }
+
+      void await_resume(void) noexcept {
+      }
+    };
+
+    /**
+     * @brief   Suspends the invoking coroutine for the specified time.
+     *
+     * @param[in] time      the delay in system ticks, the special values are
+     *                      handled as follow:
+     *                      - @a TIME_INFINITE is not allowed.
+     *                      - @a TIME_IMMEDIATE the coroutine is moved at the
+     *                        end of the ready list.
+     *                      .
+     * @return              The awaiter.
+     *
+     * @api
+     */
+    static SleepAwaiter sleep(sysinterval_t time) {
+
+      chDbgCheck(time != TIME_INFINITE);
+
+      return SleepAwaiter{time, nullptr, {}};
+    }
+
+    /**
+     * @brief   Yields to the other ready coroutines.
+     *
+     * @return              The awaiter.
+     *
+     * @api
+     */
+    static SleepAwaiter yield(void) {
+
+      return SleepAwaiter{TIME_IMMEDIATE, nullptr, {}};
+    }
+
+    /**
+     * @brief   Waits for flags broadcasted on an event source.
+     * @details Flags broadcasted while no coroutine is waiting are kept
+     *          pending in the executor and returned to the next waiter.
+     * @note    The awaiter resumes immediately returning zero if all the
+     *          executor event slots are in use.
+     *
+     * @param[in] source    the event source
+     * @param[in] wflags    mask of flags the coroutine is interested in
+     * @return              The awaiter, the awaited value is the mask of
+     *                      matched flags.
+     *
+     * @api
+     */
+    static BaseCoroutineExecutor::EventAwaiter
+    waitEvents(EventSource &source, eventflags_t wflags = ALL_EVENTS) {
+
+      return BaseCoroutineExecutor::EventAwaiter{nullptr, nullptr, &source,
+                                                 wflags, 0U};
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutineSemaphore                                         *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Counter semaphore for coroutines.
+   * @details Coroutines waiting on the semaphore are queued in FIFO order.
+   */
+  class CoroutineSemaphore {
+  public:
+    /**
+     * @brief   Awaiter of a semaphore.
+     */
+    struct Awaiter {
+      CoroutineSemaphore        *sem;
+      Awaiter                   *next;
+      CoroutineNode             *node;
+
+      bool await_ready(void) noexcept {
+
+        return false;
+      }
+
+      bool await_suspend(std::coroutine_handle<CoroutineTask::promise_type> h)
+                                                                    noexcept {
+        CoroutineSemaphore *sp = sem;
+
+        chSysLock();
+        if (sp->cnt > (cnt_t)0) {
+          sp->cnt--;
+          chSysUnlock();
+          return false;
+        }
+        node = &h.promise().node;
+        next = nullptr;
+        if (sp->tail == nullptr) {
+          sp->head = this;
+        }
+        else {
+          sp->tail->next = this;
+        }
+        sp->tail = this;
+        chSysUnlock();
+
+        return true;
+      }
+
+      void await_resume(void) noexcept {
+      }
+    };
+
+  private:
+    cnt_t                       cnt;
+    Awaiter                     *head;
+    Awaiter                     *tail;
+
+  public:
+    /**
+     * @brief   CoroutineSemaphore constructor.
+     *
+     * @param[in] n         the semaphore counter value, must be greater
+     *                      or equal to zero
+     *
+     * @init
+     */
+    CoroutineSemaphore(cnt_t n) : cnt(n), head(nullptr), tail(nullptr) {
+
+      chDbgCheck(n >= (cnt_t)0);
+    }
+
+    /* Prohibit copy construction and assignment.*/
+    CoroutineSemaphore(const CoroutineSemaphore &) = delete;
+    CoroutineSemaphore &operator=(const CoroutineSemaphore &) = delete;
+
+    /**
+     * @brief   Waits on the semaphore.
+     *
+     * @return              The awaiter.
+     *
+     * @api
+     */
+    Awaiter wait(void) {
+
+      return Awaiter{this, nullptr, nullptr};
+    }
+
+    /**
+     * @brief   Signals the semaphore.
+     * @details The first waiting coroutine, if any, is made ready else the
+     *          counter is increased.
+     *
+     * @iclass
+     */
+    void signalI(void) {
+      Awaiter *wp = head;
+
+      chDbgCheckClassI();
+
+      if (wp == nullptr) {
+        cnt++;
+        return;
+      }
+      head = wp->next;
+      if (head == nullptr) {
+        tail = nullptr;
+      }
+      wp->node->executor->readyI(wp->node);
+    }
+
+    /**
+     * @brief   Signals the semaphore.
+     *
+     * @api
+     */
+    void signal(void) {
+
+      chSysLock();
+      signalI();
+      chSchRescheduleS();
+      chSysUnlock();
+    }
+
+    /**
+     * @brief   Returns the semaphore counter.
+     *
+     * @return              The semaphore counter.
+     *
+     * @iclass
+     */
+    cnt_t getCounterI(void) const {
+
+      chDbgCheckClassI();
+
+      return cnt;
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutineMailbox                                           *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Mailbox for coroutines.
+   * @details Messages are fetched by coroutines and posted, without
+   *          waiting, by coroutines, threads or ISRs. A message posted
+   *          while a coroutine is waiting is handed directly to it.
+   *
+   * @param T               type of the messages, must be default
+   *                        constructible and movable
+   * @param N               mailbox capacity
+   */
+  template<typename T, size_t N>
+  class CoroutineMailbox {
+  public:
+    /**
+     * @brief   Awaiter of a fetch operation.
+     */
+    struct Awaiter {
+      CoroutineMailbox          *mbx;
+      Awaiter                   *next;
+      CoroutineNode             *node;
+      T                         msg;
+
+      bool await_ready(void) noexcept {
+
+        return false;
+      }
+
+      bool await_suspend(std::coroutine_handle<CoroutineTask::promise_type> h)
+                                                                    noexcept {
+        CoroutineMailbox *mp = mbx;
+
+        chSysLock();
+        if (mp->fetchI(msg) == MSG_OK) {
+          chSysUnlock();
+          return false;
+        }
+        node = &h.promise().node;
+        next = nullptr;
+        if (mp->tail == nullptr) {
+          mp->head = this;
+        }
+        else {
+          mp->tail->next = this;
+        }
+        mp->tail = this;
+        chSysUnlock();
+
+        return true;
+      }
+
+      T await_resume(void) noexcept {
+
+        return static_cast<T &&>(msg);
+      }
+    };
+
+  private:
+    T                           buffer[N];
+    size_t                      rdidx;
+    size_t                      cnt;
+    Awaiter                     *head;
+    Awaiter                     *tail;
+
+  public:
+    /**
+     * @brief   CoroutineMailbox constructor.
+     *
+     * @init
+     */
+    CoroutineMailbox(void) : buffer(), rdidx(0U), cnt(0U),
+                             head(nullptr), tail(nullptr) {
+    }
+
+    /* Prohibit copy construction and assignment.*/
+    CoroutineMailbox(const CoroutineMailbox &) = delete;
+    CoroutineMailbox &operator=(const CoroutineMailbox &) = delete;
+
+    /**
+     * @brief   Fetches a message from the mailbox.
+     *
+     * @return              The awaiter, the awaited value is the message.
+     *
+     * @api
+     */
+    Awaiter fetch(void) {
+
+      return Awaiter{this, nullptr, nullptr, T()};
+    }
+
+    /**
+     * @brief   Fetches a message from the mailbox.
+     *
+     * @param[out] msg      the fetched message
+     * @return              The operation status.
+     * @retval MSG_OK       if a message has been fetched.
+     * @retval MSG_TIMEOUT  if the mailbox is empty.
+     *
+     * @iclass
+     */
+    msg_t fetchI(T &msg) {
+
+      chDbgCheckClassI();
+
+      if (cnt == 0U) {
+        return MSG_TIMEOUT;
+      }
+      msg = static_cast<T &&>(buffer[rdidx]);
+      rdidx = (rdidx + 1U) % N;
+      cnt--;
+
+      return MSG_OK;
+    }
+
+    /**
+     * @brief   Posts a message into the mailbox.
+     * @details The first waiting coroutine, if any, receives the message
+     *          and is made ready.
+     *
+     * @param[in] msg       the message to be posted
+     * @return              The operation status.
+     * @retval MSG_OK       if the message has been posted.
+     * @retval MSG_TIMEOUT  if the mailbox is full.
+     *
+     * @iclass
+     */
+    msg_t postI(T msg) {
+      Awaiter *wp = head;
+
+      chDbgCheckClassI();
+
+      if (wp != nullptr) {
+        head = wp->next;
+        if (head == nullptr) {
+          tail = nullptr;
+        }
+        wp->msg = static_cast<T &&>(msg);
+        wp->node->executor->readyI(wp->node);
+        return MSG_OK;
+      }
+      if (cnt >= N) {
+        return MSG_TIMEOUT;
+      }
+      buffer[(rdidx + cnt) % N] = static_cast<T &&>(msg);
+      cnt++;
+
+      return MSG_OK;
+    }
+
+    /**
+     * @brief   Posts a message into the mailbox.
+     *
+     * @param[in] msg       the message to be posted
+     * @return              The operation status.
+     * @retval MSG_OK       if the message has been posted.
+     * @retval MSG_TIMEOUT  if the mailbox is full.
+     *
+     * @api
+     */
+    msg_t post(T msg) {
+      msg_t rdymsg;
+
+      chSysLock();
+      rdymsg = postI(static_cast<T &&>(msg));
+      chSchRescheduleS();
+      chSysUnlock();
+
+      return rdymsg;
+    }
+
+    /**
+     * @brief   Returns the number of messages in the mailbox.
+     *
+     * @return              The number of messages.
+     *
+     * @iclass
+     */
+    size_t getUsedCountI(void) const {
+
+      chDbgCheckClassI();
+
+      return cnt;
+    }
+  };
+
+  /*------------------------------------------------------------------------*
+   * chibios_rt::CoroutineCompletion                                        *
+   *------------------------------------------------------------------------*/
+  /**
+   * @brief   Completion of an asynchronous operation.
+   * @details A coroutine starts an operation, for example a HAL driver
+   *          transfer, and awaits the completion. The completion is
+   *          signaled with a result from the driver callback.
+   * @note    Only one coroutine can wait on a completion.
+   */
+  class CoroutineCompletion {
+  public:
+    /**
+     * @brief   Awaiter of a completion.
+     */
+    struct Awaiter {
+      CoroutineCompletion       *cp;
+
+      bool await_ready(void) noexcept {
+
+        return false;
+      }
+
+      bool await_suspend(std::coroutine_handle<CoroutineTask::promise_type> h)
+                                                                    noexcept {
+        CoroutineCompletion *p = cp;
+
+        chSysLock();
+        if (p->done) {
+          chSysUnlock();
+          return false;
+        }
+        chDbgAssert(p->node == nullptr, "already waiting");
+        p->node = &h.promise().node;
+        chSysUnlock();
+
+        return true;
+      }
+
+      msg_t await_resume(void) noexcept {
+
+        return cp->msg;
+      }
+    };
+
+  private:
+    CoroutineNode               *node;
+    msg_t                       msg;
+    bool                        done;
+
+  public:
+    /**
+     * @brief   CoroutineCompletion constructor.
+     *
+     * @init
+     */
+    CoroutineCompletion(void) : node(nullptr), msg(MSG_OK), done(false) {
+    }
+
+    /* Prohibit copy construction and assignment.*/
+    CoroutineCompletion(const CoroutineCompletion &) = delete;
+    CoroutineCompletion &operator=(const CoroutineCompletion &) = delete;
+
+    /**
+     * @brief   Rearms the completion.
+     * @note    Must be invoked before starting the operation.
+     *
+     * @api
+     */
+    void reset(void) {
+
+      chSysLock();
+      chDbgAssert(node == nullptr, "waiting");
+      done = false;
+      chSysUnlock();
+    }
+
+    /**
+     * @brief   Waits for the completion.
+     * @details The coroutine resumes immediately if the completion has
+     *          already been signaled.
+     *
+     * @return              The awaiter, the awaited value is the message
+     *                      passed to @p signalI().
+     *
+     * @api
+     */
+    Awaiter wait(void) {
+
+      return Awaiter{this};
+    }
+
+    /**
+     * @brief   Signals the completion.
+     * @details The waiting coroutine, if any, is made ready.
+     * @note    This function is meant to be called from driver callbacks
+     *          within a @p chSysLockFromISR() / @p chSysUnlockFromISR()
+     *          zone.
+     *
+     * @param[in] result    message to be returned by the wait
+     *
+     * @iclass
+     */
+    void signalI(msg_t result) {
+      CoroutineNode *np = node;
+
+      chDbgCheckClassI();
+
+      msg  = result;
+      done = true;
+      if (np != nullptr) {
+        node = nullptr;
+        np->executor->readyI(np);
+      }
+    }
+  };
+}
+
+#endif /* _CHCOROUTINES_HPP_ */
+
+/** @} */
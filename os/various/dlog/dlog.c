@@ -0,0 +1,321 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    dlog.c
+ * @brief   Deferred logging module code.
+ *
+ * @addtogroup dlog
+ * @{
+ */
+
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "dlog.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Ring buffer index mask.
+ */
+#define DLOG_MASK           ((ucnt_t)DLOG_BUFFER_SIZE - (ucnt_t)1)
+
+/**
+ * @brief   Mask of the time stamps stored in the messages headers.
+ */
+#define DLOG_TIME_MASK      ((UINTPTR_MAX >> DLOG_NARGS_BITS) &             \
+                             (uintptr_t)(systime_t)-1)
+
+/**
+ * @brief   Largest time delta considered forward, larger deltas come from
+ *          time stamps older than the previous one.
+ */
+#define DLOG_TIME_HALF      (DLOG_TIME_MASK >> 1)
+
+/**
+ * @brief   Maximum size of an encoded record.
+ */
+#define DLOG_RECORD_SIZE    (1U + ((3U + DLOG_MAX_ARGS) * 10U))
+
+/**
+ * @brief   Ring buffer of the current core.
+ */
+#if (PORT_CORES_NUMBER > 1) || defined(__DOXYGEN__)
+#define dlog_ring()         (&dlog_rings[currcore->core_id])
+#else
+#define dlog_ring()         (&dlog_rings[0])
+#endif
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/**
+ * @brief   Record encoding buffer.
+ */
+typedef struct {
+  size_t                n;
+  uint8_t               buf[DLOG_RECORD_SIZE];
+} dlog_record_t;
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/**
+ * @brief   Per-core ring buffers.
+ */
+static dlog_ring_t dlog_rings[PORT_CORES_NUMBER];
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+/* The rings are per-core so masking the interrupts of the current core is
+   enough, the system spinlock is not taken.*/
+static inline syssts_t dlog_lock(void) {
+  syssts_t sts = port_get_irq_status();
+
+  if (port_irq_enabled(sts)) {
+    if (port_is_isr_context()) {
+      port_lock_from_isr();
+    }
+    else {
+      port_lock();
+    }
+  }
+
+  return sts;
+}
+
+static inline void dlog_unlock(syssts_t sts) {
+
+  if (port_irq_enabled(sts)) {
+    if (port_is_isr_context()) {
+      port_unlock_from_isr();
+    }
+    else {
+      port_unlock();
+    }
+  }
+}
+
+static void dlog_begin(dlog_record_t *rp, uint8_t type) {
+
+  rp->buf[0] = type;
+  rp->n      = 1U;
+}
+
+static void dlog_varint(dlog_record_t *rp, uint64_t x) {
+
+  while (x >= 0x80U) {
+    rp->buf[rp->n++] = (uint8_t)(x | 0x80U);
+    x >>= 7;
+  }
+  rp->buf[rp->n++] = (uint8_t)x;
+}
+
+static void dlog_write(dlog_stream_t *dsp, const dlog_record_t *rp) {
+
+  (void) streamWrite(dsp->stream, rp->buf, rp->n);
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Stores a message in the ring buffer of the current core.
+ * @note    Use the @p dlogX() macro instead of calling this function
+ *          directly.
+ *
+ * @param[in] fmt       format string
+ * @param[in] n         number of arguments
+ * @param[in] args      pointer to the arguments array
+ *
+ * @xclass
+ */
+void dlogWriteX(const char *fmt, unsigned n, const uintptr_t *args) {
+  dlog_ring_t *rp = dlog_ring();
+  uintptr_t hdr;
+  syssts_t sts;
+  ucnt_t wr;
+  unsigned i;
+
+  chDbgCheck(n <= DLOG_MAX_ARGS);
+
+  /* The time stamp is taken in the critical zone, messages are stored in
+     time order.*/
+  sts = dlog_lock();
+  hdr = ((uintptr_t)chVTGetSystemTimeX() << DLOG_NARGS_BITS) | (uintptr_t)n;
+  wr = rp->wridx;
+  if (((ucnt_t)DLOG_BUFFER_SIZE - (wr - rp->rdidx)) < ((ucnt_t)n + 2U)) {
+    rp->lost++;
+    dlog_unlock(sts);
+    return;
+  }
+
+  rp->buffer[wr & DLOG_MASK]              = (uintptr_t)fmt;
+  rp->buffer[(wr + (ucnt_t)1) & DLOG_MASK] = hdr;
+  for (i = 0U; i < n; i++) {
+    rp->buffer[(wr + (ucnt_t)2 + (ucnt_t)i) & DLOG_MASK] = args[i];
+  }
+
+  /* The message is published after being written, the index is volatile
+     like the buffer so the order is preserved.*/
+  rp->wridx = wr + (ucnt_t)2 + (ucnt_t)n;
+  dlog_unlock(sts);
+}
+
+/**
+ * @brief   Initializes a deferred log stream object.
+ *
+ * @param[out] dsp      pointer to a @p dlog_stream_t object
+ * @param[in] stream    pointer to the output @p BaseSequentialStream
+ *
+ * @init
+ */
+void dlogObjectInit(dlog_stream_t *dsp, BaseSequentialStream *stream) {
+
+  memset((void *)dsp, 0, sizeof (dlog_stream_t));
+  dsp->stream = stream;
+}
+
+/**
+ * @brief   Starts a new deferred log stream.
+ * @details The stream header is written, messages already in the ring
+ *          buffer are kept and written by the next drain.
+ * @note    Time stamps in the stream are relative to the oldest pending
+ *          message or to this call if there are no pending messages.
+ *
+ * @param[in] dsp       pointer to a @p dlog_stream_t object
+ *
+ * @api
+ */
+void dlogStart(dlog_stream_t *dsp) {
+  static const uint8_t magic[4] = {'C', 'H', 'D', 'L'};
+  dlog_ring_t *rp = dlog_ring();
+  dlog_record_t r;
+  uint32_t f = (uint32_t)CH_CFG_ST_FREQUENCY;
+  uintptr_t ts;
+  ucnt_t rd;
+  unsigned i;
+
+  (void) streamWrite(dsp->stream, magic, sizeof (magic));
+  r.n = 0U;
+  r.buf[r.n++] = (uint8_t)DLOG_VERSION;
+  r.buf[r.n++] = (uint8_t)sizeof (void *);
+  for (i = 0U; i < 4U; i++) {
+    r.buf[r.n++] = (uint8_t)(f >> (i * 8U));
+  }
+  dlog_varint(&r, (uint64_t)(uintptr_t)chSysInit);
+  dlog_write(dsp, &r);
+
+  rd = rp->rdidx;
+  if (rd != rp->wridx) {
+    ts = rp->buffer[(rd + (ucnt_t)1) & DLOG_MASK] >> DLOG_NARGS_BITS;
+  }
+  else {
+    ts = (uintptr_t)chVTGetSystemTimeX();
+  }
+  dsp->lastts   = ts & DLOG_TIME_MASK;
+  dsp->lastlost = rp->lost;
+  dsp->messages = 0U;
+  dsp->lost     = 0U;
+}
+
+/**
+ * @brief   Writes the pending messages on the stream.
+ * @details The function is meant to be called periodically from a low
+ *          priority thread, the period must be short enough to not let
+ *          the ring buffer overflow, lost messages are reported in the
+ *          stream.
+ * @note    The messages of the current core are written, there must be a
+ *          single drain thread for each core.
+ *
+ * @param[in] dsp       pointer to a @p dlog_stream_t object
+ * @return              The number of written messages.
+ *
+ * @api
+ */
+unsigned dlogDrain(dlog_stream_t *dsp) {
+  dlog_ring_t *rp = dlog_ring();
+  unsigned total = 0U;
+  ucnt_t rd, wr, lost;
+
+  rd = rp->rdidx;
+  wr = rp->wridx;
+  while (rd != wr) {
+    dlog_record_t r;
+    uintptr_t fmt, hdr, ts, delta;
+    unsigned i, n;
+
+    fmt = rp->buffer[rd & DLOG_MASK];
+    hdr = rp->buffer[(rd + (ucnt_t)1) & DLOG_MASK];
+    n   = (unsigned)(hdr & (((uintptr_t)1 << DLOG_NARGS_BITS) - 1U));
+    ts  = (hdr >> DLOG_NARGS_BITS) & DLOG_TIME_MASK;
+
+    /* Non-monotonic time stamps are clamped to the previous one, the
+       stream only carries forward deltas.*/
+    delta = (ts - dsp->lastts) & DLOG_TIME_MASK;
+    if (delta > DLOG_TIME_HALF) {
+      delta = (uintptr_t)0;
+      ts    = dsp->lastts;
+    }
+
+    dlog_begin(&r, DLOG_REC_MESSAGE);
+    dlog_varint(&r, (uint64_t)delta);
+    dlog_varint(&r, (uint64_t)fmt);
+    dlog_varint(&r, (uint64_t)n);
+    for (i = 0U; i < n; i++) {
+      dlog_varint(&r, (uint64_t)rp->buffer[(rd + (ucnt_t)2 + (ucnt_t)i) &
+                                           DLOG_MASK]);
+    }
+    dsp->lastts = ts;
+
+    /* Space is released before writing on the stream, the record has
+       already been copied.*/
+    rd += (ucnt_t)2 + (ucnt_t)n;
+    rp->rdidx = rd;
+    dlog_write(dsp, &r);
+
+    total++;
+  }
+
+  lost = rp->lost;
+  if (lost != dsp->lastlost) {
+    dlog_record_t r;
+
+    dlog_begin(&r, DLOG_REC_LOST);
+    dlog_varint(&r, (uint64_t)(ucnt_t)(lost - dsp->lastlost));
+    dlog_write(dsp, &r);
+    dsp->lost    += (uint32_t)(lost - dsp->lastlost);
+    dsp->lastlost = lost;
+  }
+  dsp->messages += (uint32_t)total;
+
+  return total;
+}
+
+/** @} */
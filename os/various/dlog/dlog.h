@@ -0,0 +1,220 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    dlog.h
+ * @brief   Deferred logging module header.
+ * @details Log calls store the format string address, a time stamp and the
+ *          raw arguments in a per-core ring buffer, no formatting is
+ *          performed on the target. The ring is drained on a stream by a
+ *          low priority thread and the text is reconstructed on the host
+ *          by the tools/dlog/chdlog.py script using the ELF file.
+ *          <br>The stream starts with an header:
+ *          - 4 bytes magic "CHDL".
+ *          - 1 byte format version.
+ *          - 1 byte size of pointers in bytes.
+ *          - 4 bytes system time frequency, little endian.
+ *          - The run-time address of @p chSysInit(), used to relocate
+ *            position independent executables.
+ *          .
+ *          Then records follow, the first byte of each record is the
+ *          record type, all other fields are unsigned LEB128 variable
+ *          length integers: log messages and lost messages count.
+ *
+ * @addtogroup dlog
+ * @{
+ */
+
+#ifndef DLOG_H
+#define DLOG_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Stream format version.
+ */
+#define DLOG_VERSION                        1U
+
+/**
+ * @name    Stream records
+ * @{
+ */
+#define DLOG_REC_MESSAGE                    1U
+#define DLOG_REC_LOST                       2U
+/** @} */
+
+/**
+ * @brief   Maximum number of arguments of a log message.
+ */
+#define DLOG_MAX_ARGS                       6U
+
+/**
+ * @brief   Bits of the message header word holding the arguments number.
+ */
+#define DLOG_NARGS_BITS                     3U
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Size of each per-core ring buffer in words.
+ * @note    The value must be a power of two, each message takes two words
+ *          plus one word for each argument.
+ */
+#if !defined(DLOG_BUFFER_SIZE) || defined(__DOXYGEN__)
+#define DLOG_BUFFER_SIZE                    256
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+#if (DLOG_BUFFER_SIZE < 16) ||                                              \
+    ((DLOG_BUFFER_SIZE & (DLOG_BUFFER_SIZE - 1)) != 0)
+#error "DLOG_BUFFER_SIZE must be a power of two not lower than 16"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a per-core log ring buffer.
+ * @details Messages are written by threads and ISRs of the owner core,
+ *          the ring is read by a single drain thread of the same core.
+ */
+typedef struct {
+  /**
+   * @brief   Write index, free running.
+   */
+  volatile ucnt_t       wridx;
+  /**
+   * @brief   Read index, free running.
+   */
+  volatile ucnt_t       rdidx;
+  /**
+   * @brief   Messages dropped because buffer full, cumulative.
+   */
+  volatile ucnt_t       lost;
+  /**
+   * @brief   Messages buffer.
+   */
+  volatile uintptr_t    buffer[DLOG_BUFFER_SIZE];
+} dlog_ring_t;
+
+/**
+ * @brief   Type of a deferred log stream object.
+ */
+typedef struct {
+  /**
+   * @brief   Output stream.
+   */
+  BaseSequentialStream  *stream;
+  /**
+   * @brief   Time stamp of the previous message.
+   */
+  uintptr_t             lastts;
+  /**
+   * @brief   Lost messages counter at the previous drain.
+   */
+  ucnt_t                lastlost;
+  /**
+   * @brief   Total number of written messages.
+   */
+  uint32_t              messages;
+  /**
+   * @brief   Total number of lost messages.
+   */
+  uint32_t              lost;
+} dlog_stream_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/**
+ * @name    Arguments packing
+ * @{
+ */
+#define __DLOG_SELECT(_0, _1, _2, _3, _4, _5, _6, m, ...) m
+#define __DLOG_0(fmt)                                                       \
+  dlogWriteX(fmt, 0U, NULL)
+#define __DLOG_N(fmt, n, ...) do {                                          \
+  const uintptr_t __dlog_args[n] = {__VA_ARGS__};                           \
+  dlogWriteX(fmt, n, __dlog_args);                                          \
+} while (false)
+#define __DLOG_1(fmt, a1)                                                   \
+  __DLOG_N(fmt, 1U, (uintptr_t)(a1))
+#define __DLOG_2(fmt, a1, a2)                                               \
+  __DLOG_N(fmt, 2U, (uintptr_t)(a1), (uintptr_t)(a2))
+#define __DLOG_3(fmt, a1, a2, a3)                                           \
+  __DLOG_N(fmt, 3U, (uintptr_t)(a1), (uintptr_t)(a2), (uintptr_t)(a3))
+#define __DLOG_4(fmt, a1, a2, a3, a4)                                       \
+  __DLOG_N(fmt, 4U, (uintptr_t)(a1), (uintptr_t)(a2), (uintptr_t)(a3),     \
+           (uintptr_t)(a4))
+#define __DLOG_5(fmt, a1, a2, a3, a4, a5)                                   \
+  __DLOG_N(fmt, 5U, (uintptr_t)(a1), (uintptr_t)(a2), (uintptr_t)(a3),     \
+           (uintptr_t)(a4), (uintptr_t)(a5))
+#define __DLOG_6(fmt, a1, a2, a3, a4, a5, a6)                               \
+  __DLOG_N(fmt, 6U, (uintptr_t)(a1), (uintptr_t)(a2), (uintptr_t)(a3),     \
+           (uintptr_t)(a4), (uintptr_t)(a5), (uintptr_t)(a6))
+/** @} */
+
+/**
+ * @brief   Logs a message.
+ * @details The format string uses the @p chprintf() syntax, up to
+ *          @p DLOG_MAX_ARGS arguments are accepted.
+ * @note    The format string must be a constant string in the image, the
+ *          host tool reads it from the ELF file.
+ * @note    Arguments are stored as @p uintptr_t values, floating point
+ *          arguments are not supported, arguments of @p %s conversions are
+ *          printed only if pointing to constant strings in the image.
+ * @note    This macro can be called from any context except fast
+ *          interrupts, the message is dropped if the ring is full.
+ *
+ * @param[in] ...       format string followed by the arguments
+ *
+ * @xclass
+ */
+#define dlogX(...)                                                          \
+  __DLOG_SELECT(__VA_ARGS__, __DLOG_6, __DLOG_5, __DLOG_4, __DLOG_3,       \
+                __DLOG_2, __DLOG_1, __DLOG_0, ~)(__VA_ARGS__)
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void dlogWriteX(const char *fmt, unsigned n, const uintptr_t *args);
+  void dlogObjectInit(dlog_stream_t *dsp, BaseSequentialStream *stream);
+  void dlogStart(dlog_stream_t *dsp);
+  unsigned dlogDrain(dlog_stream_t *dsp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+#endif /* DLOG_H */
+
+/** @} */
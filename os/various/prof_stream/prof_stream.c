@@ -0,0 +1,253 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    prof_stream.c
+ * @brief   Profiler streaming module code.
+ *
+ * @addtogroup prof_stream
+ * @{
+ */
+
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "prof_stream.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Maximum size of an encoded record header.
+ */
+#define PRS_RECORD_SIZE     (1U + (3U * 10U))
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/**
+ * @brief   Record encoding buffer.
+ */
+typedef struct {
+  size_t                n;
+  uint8_t               buf[PRS_RECORD_SIZE];
+} prs_record_t;
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+static void prs_begin(prs_record_t *rp, uint8_t type) {
+
+  rp->buf[0] = type;
+  rp->n      = 1U;
+}
+
+static void prs_varint(prs_record_t *rp, uint64_t x) {
+
+  while (x >= 0x80U) {
+    rp->buf[rp->n++] = (uint8_t)(x | 0x80U);
+    x >>= 7;
+  }
+  rp->buf[rp->n++] = (uint8_t)x;
+}
+
+static void prs_pointer(prs_record_t *rp, const void *p) {
+
+  prs_varint(rp, (uint64_t)(uintptr_t)p);
+}
+
+static void prs_write(prof_stream_t *psp, const prs_record_t *rp) {
+
+  (void) streamWrite(psp->stream, rp->buf, rp->n);
+}
+
+static void prs_check_thread(prof_stream_t *psp, thread_t *tp) {
+  unsigned i;
+
+  for (i = 0U; i < PRS_CACHE_SIZE; i++) {
+    if (psp->threads[i] == tp) {
+      return;
+    }
+  }
+  psp->rescan = true;
+}
+
+static void prs_define_threads(prof_stream_t *psp) {
+#if CH_CFG_USE_REGISTRY == TRUE
+  thread_t *tp;
+
+  /* Threads are scanned using the registry, an undefined thread in the
+     stream is a thread already terminated.*/
+  tp = chRegFirstThread();
+  do {
+    unsigned i;
+
+    for (i = 0U; i < PRS_CACHE_SIZE; i++) {
+      if (psp->threads[i] == tp) {
+        break;
+      }
+    }
+    if (i >= PRS_CACHE_SIZE) {
+      const char *name = tp->name == NULL ? "" : tp->name;
+      size_t len = strlen(name);
+      prs_record_t r;
+
+      psp->threads[psp->nextthread] = tp;
+      psp->nextthread = (psp->nextthread + 1U) % PRS_CACHE_SIZE;
+
+      prs_begin(&r, PRS_REC_THREAD);
+      prs_pointer(&r, tp);
+      prs_varint(&r, (uint64_t)len);
+      prs_write(psp, &r);
+      (void) streamWrite(psp->stream, (const uint8_t *)name, len);
+    }
+    tp = chRegNextThread(tp);
+  } while (tp != NULL);
+#else
+  (void)psp;
+#endif
+  psp->rescan = false;
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a profiler stream object.
+ *
+ * @param[out] psp      pointer to a @p prof_stream_t object
+ * @param[in] stream    pointer to the output @p BaseSequentialStream
+ *
+ * @init
+ */
+void prsObjectInit(prof_stream_t *psp, BaseSequentialStream *stream) {
+
+  memset((void *)psp, 0, sizeof (prof_stream_t));
+  psp->stream = stream;
+}
+
+/**
+ * @brief   Starts a new profiler stream.
+ * @details The stream header and the definitions of the existing threads
+ *          are written, samples already in the profiler buffer are
+ *          discarded.
+ * @note    The sampling should be started before calling this function
+ *          in order to have the sampling frequency in the header.
+ *
+ * @param[in] psp       pointer to a @p prof_stream_t object
+ *
+ * @api
+ */
+void prsStart(prof_stream_t *psp) {
+  static const uint8_t magic[4] = {'C', 'H', 'P', 'F'};
+  prof_sample_t sample;
+  prs_record_t r;
+  uint32_t f;
+  unsigned i;
+
+  /* Discarding old samples.*/
+  while (chProfRead(&sample, 1U, &psp->lastlost) > 0U) {
+  }
+
+  (void) streamWrite(psp->stream, magic, sizeof (magic));
+  r.n = 0U;
+  r.buf[r.n++] = (uint8_t)PRS_VERSION;
+  r.buf[r.n++] = (uint8_t)sizeof (void *);
+  f = chProfGetFrequencyX();
+  for (i = 0U; i < 4U; i++) {
+    r.buf[r.n++] = (uint8_t)(f >> (i * 8U));
+  }
+  prs_varint(&r, (uint64_t)(uintptr_t)chSysInit);
+  prs_write(psp, &r);
+
+  for (i = 0U; i < PRS_CACHE_SIZE; i++) {
+    psp->threads[i] = NULL;
+  }
+  psp->nextthread = 0U;
+  psp->samples    = 0U;
+  psp->lost       = 0U;
+  prs_define_threads(psp);
+}
+
+/**
+ * @brief   Writes the pending samples on the stream.
+ * @details The function is meant to be called periodically from a low
+ *          priority thread, the period must be short enough to not let
+ *          the profiler buffer overflow, lost samples are reported in the
+ *          stream. Only the samples already present on entry are written,
+ *          samples taken while draining are left for the next call.
+ * @note    The samples of the current core are written.
+ *
+ * @param[in] psp       pointer to a @p prof_stream_t object
+ * @return              The number of written samples.
+ *
+ * @api
+ */
+unsigned prsDrain(prof_stream_t *psp) {
+  prof_sample_t samples[PRS_READ_BATCH];
+  unsigned i, n, pending, total = 0U;
+  ucnt_t lost;
+
+  pending = chProfGetPendingX();
+  do {
+    n = chProfRead(samples,
+                   pending < (unsigned)PRS_READ_BATCH ?
+                   pending : (unsigned)PRS_READ_BATCH,
+                   &lost);
+    if (lost != psp->lastlost) {
+      prs_record_t r;
+
+      prs_begin(&r, PRS_REC_LOST);
+      prs_varint(&r, (uint64_t)(ucnt_t)(lost - psp->lastlost));
+      prs_write(psp, &r);
+      psp->lost    += (uint32_t)(lost - psp->lastlost);
+      psp->lastlost = lost;
+    }
+    for (i = 0U; i < n; i++) {
+      prs_record_t r;
+
+      prs_check_thread(psp, samples[i].tp);
+      prs_begin(&r, PRS_REC_SAMPLE);
+      prs_pointer(&r, samples[i].pc);
+      prs_pointer(&r, samples[i].tp);
+      prs_write(psp, &r);
+    }
+    psp->samples += (uint32_t)n;
+    total   += n;
+    pending -= n;
+  } while ((n > 0U) && (pending > 0U));
+
+  if (psp->rescan) {
+    prs_define_threads(psp);
+  }
+
+  return total;
+}
+
+/** @} */
@@ -0,0 +1,156 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    prof_stream.h
+ * @brief   Profiler streaming module header.
+ * @details The module drains the RT profiler buffer and writes the samples
+ *          on a stream, the stream can be symbolized using the
+ *          tools/profiler/chprof.py script.
+ *          <br>The stream starts with an header:
+ *          - 4 bytes magic "CHPF".
+ *          - 1 byte format version.
+ *          - 1 byte size of pointers in bytes.
+ *          - 4 bytes sampling frequency, little endian, zero if unknown.
+ *          - The run-time address of @p chSysInit(), used to relocate
+ *            position independent executables.
+ *          .
+ *          Then records follow, the first byte of each record is the
+ *          record type, all other fields are unsigned LEB128 variable
+ *          length integers: samples, thread definitions and lost samples
+ *          count.
+ *
+ * @addtogroup prof_stream
+ * @{
+ */
+
+#ifndef PROF_STREAM_H
+#define PROF_STREAM_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Stream format version.
+ */
+#define PRS_VERSION                         1U
+
+/**
+ * @name    Stream records
+ * @{
+ */
+#define PRS_REC_SAMPLE                      1U
+#define PRS_REC_THREAD                      2U
+#define PRS_REC_LOST                        3U
+/** @} */
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Number of samples fetched from the profiler buffer at once.
+ */
+#if !defined(PRS_READ_BATCH) || defined(__DOXYGEN__)
+#define PRS_READ_BATCH                      8
+#endif
+
+/**
+ * @brief   Number of remembered threads definitions.
+ */
+#if !defined(PRS_CACHE_SIZE) || defined(__DOXYGEN__)
+#define PRS_CACHE_SIZE                      16
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*
+ * Module dependencies check.
+ */
+#if CH_DBG_PROFILER == FALSE
+#error "profiler streaming requires CH_DBG_PROFILER"
+#endif
+
+#if PRS_CACHE_SIZE < 1
+#error "invalid PRS_CACHE_SIZE value"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a profiler stream object.
+ */
+typedef struct {
+  /**
+   * @brief   Output stream.
+   */
+  BaseSequentialStream  *stream;
+  /**
+   * @brief   Threads already defined in the stream.
+   */
+  thread_t              *threads[PRS_CACHE_SIZE];
+  /**
+   * @brief   Next threads cache entry to be replaced.
+   */
+  unsigned              nextthread;
+  /**
+   * @brief   Unknown threads found since the last definitions scan.
+   */
+  bool                  rescan;
+  /**
+   * @brief   Lost samples counter at the previous drain.
+   */
+  ucnt_t                lastlost;
+  /**
+   * @brief   Total number of written samples.
+   */
+  uint32_t              samples;
+  /**
+   * @brief   Total number of lost samples.
+   */
+  uint32_t              lost;
+} prof_stream_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void prsObjectInit(prof_stream_t *psp, BaseSequentialStream *stream);
+  void prsStart(prof_stream_t *psp);
+  unsigned prsDrain(prof_stream_t *psp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+#endif /* PROF_STREAM_H */
+
+/** @} */
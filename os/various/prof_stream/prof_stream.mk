@@ -0,0 +1,8 @@
+# RT profiler streaming files.
+PRSSRC = $(CHIBIOS)/os/various/prof_stream/prof_stream.c
+
+PRSINC = $(CHIBIOS)/os/various/prof_stream
+
+# Shared variables
+ALLCSRC += $(PRSSRC)
+ALLINC  += $(PRSINC)
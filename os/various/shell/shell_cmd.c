@@ -22,6 +22,7 @@
  * @{
  */
 
+#include <stdlib.h>
 #include <string.h>
 
 #include "ch.h"
@@ -224,6 +225,257 @@ static void cmd_test(BaseSequentialStream *chp, int argc, char *argv[]) {
 }
 #endif
 
+#if (SHELL_CMD_TOP_ENABLED == TRUE) || defined(__DOXYGEN__)
+typedef struct {
+  thread_t      *tp;
+  const char    *name;
+  tprio_t       prio;
+  unsigned long stkfree;
+  rttime_t      cycles;
+  ucnt_t        n;
+} top_sample_t;
+
+/* Stack space not known, printed as "?".*/
+#define TOP_STKFREE_UNKNOWN     (~0UL)
+
+/* Maximum sleep between realtime counter samples, short enough for the
+   counter to not wrap in between.*/
+#define TOP_SLICE               TIME_MS2I(100)
+
+static unsigned long top_stack_free(thread_t *tp) {
+#if CH_DBG_STACK_WATERMARK == TRUE
+  size_t n;
+
+  /* Watermark tracked by the idle thread, no stack scan required.*/
+  n = chRegGetStackUnusedX(tp);
+  if (n == CH_REG_STACK_UNKNOWN) {
+    return TOP_STKFREE_UNKNOWN;
+  }
+
+  return (unsigned long)n;
+#elif (CH_DBG_FILL_THREADS == TRUE) &&                                        \
+    ((CH_DBG_ENABLE_STACK_CHECK == TRUE) || (CH_CFG_USE_DYNAMIC == TRUE))
+  uint8_t *p = (uint8_t *)chThdGetWorkingAreaX(tp);
+
+  while ((p < (uint8_t *)tp) && (*p == (uint8_t)CH_DBG_STACK_FILL_VALUE)) {
+    p++;
+  }
+
+  return (unsigned long)(p - (uint8_t *)chThdGetWorkingAreaX(tp));
+#else
+  (void)tp;
+
+  return 0UL;
+#endif
+}
+
+static unsigned top_sample(top_sample_t *samples) {
+  thread_t *tp;
+  unsigned i = 0U;
+
+  /* Threads data is captured while a reference is held, threads could
+     be disposed before printing.*/
+  tp = chRegFirstThread();
+  do {
+    if (i < SHELL_CMD_TOP_MAX_THREADS) {
+      samples[i].tp      = tp;
+      samples[i].name    = tp->name == NULL ? "" : tp->name;
+      samples[i].stkfree = top_stack_free(tp);
+      chSysLock();
+      samples[i].prio    = tp->hdr.pqueue.prio;
+      samples[i].cycles  = tp->stats.cumulative;
+      samples[i].n       = tp->stats.n;
+      chSysUnlock();
+      i++;
+    }
+    tp = chRegNextThread(tp);
+  } while (tp != NULL);
+
+  return i;
+}
+
+static const top_sample_t *top_find(const top_sample_t *samples,
+                                    unsigned n, thread_t *tp) {
+  unsigned i;
+
+  for (i = 0U; i < n; i++) {
+    if (samples[i].tp == tp) {
+      return &samples[i];
+    }
+  }
+
+  return NULL;
+}
+
+static void cmd_top(BaseSequentialStream *chp, int argc, char *argv[]) {
+  top_sample_t prev[SHELL_CMD_TOP_MAX_THREADS], curr[SHELL_CMD_TOP_MAX_THREADS];
+  unsigned i, nprev, ncurr, iterations;
+  sysinterval_t interval, left;
+  ucnt_t nirq, nctxswc;
+  rtcnt_t last, now;
+  rttime_t elapsed;
+#if CH_DBG_STATISTICS_ISR == TRUE
+  rttime_t isr;
+#endif
+
+  if (argc > 2) {
+    shellUsage(chp, "top [ms [iterations]]");
+    return;
+  }
+  interval   = TIME_MS2I(argc > 0 ? atoi(argv[0]) : 1000);
+  iterations = argc > 1 ? (unsigned)atoi(argv[1]) : 1U;
+  if ((interval == (sysinterval_t)0) || (iterations == 0U)) {
+    shellUsage(chp, "top [ms [iterations]]");
+    return;
+  }
+
+  nprev = top_sample(prev);
+  while (iterations-- > 0U) {
+    nirq    = currcore->kernel_stats.n_irq;
+    nctxswc = currcore->kernel_stats.n_ctxswc;
+#if CH_DBG_STATISTICS_ISR == TRUE
+    isr     = currcore->kernel_stats.m_isr.cumulative;
+#endif
+    /* The interval is slept in slices, the counter differences are
+       accumulated in 64 bits so long intervals do not wrap.*/
+    elapsed = (rttime_t)0;
+    last    = chSysGetRealtimeCounterX();
+    left    = interval;
+    while (left > (sysinterval_t)0) {
+      sysinterval_t t = left > TOP_SLICE ? TOP_SLICE : left;
+
+      chThdSleep(t);
+      left    -= t;
+      now      = chSysGetRealtimeCounterX();
+      elapsed += (rttime_t)(rtcnt_t)(now - last);
+      last     = now;
+    }
+    ncurr   = top_sample(curr);
+    if (elapsed == (rttime_t)0) {
+      elapsed = (rttime_t)1;
+    }
+
+    chprintf(chp, "irq %lu, ctxswc %lu" SHELL_NEWLINE_STR,
+             (unsigned long)(currcore->kernel_stats.n_irq - nirq),
+             (unsigned long)(currcore->kernel_stats.n_ctxswc - nctxswc));
+#if CH_DBG_STATISTICS_ISR == TRUE
+    isr = ((currcore->kernel_stats.m_isr.cumulative - isr) * (rttime_t)1000) /
+          elapsed;
+    chprintf(chp, "isr %3lu.%lu%%" SHELL_NEWLINE_STR,
+             (unsigned long)(isr / (rttime_t)10),
+             (unsigned long)(isr % (rttime_t)10));
+#endif
+    chprintf(chp, "    addr prio   cpu%%   switches  stkfree         name" SHELL_NEWLINE_STR);
+    for (i = 0U; i < ncurr; i++) {
+      const top_sample_t *psp = top_find(prev, nprev, curr[i].tp);
+      rttime_t cycles = curr[i].cycles;
+      ucnt_t n = curr[i].n;
+      unsigned long pct;
+
+      /* Threads appeared during the interval are accounted from zero.*/
+      if ((psp != NULL) && (psp->cycles <= cycles)) {
+        cycles -= psp->cycles;
+        n      -= psp->n;
+      }
+      pct = (unsigned long)((cycles * (rttime_t)1000) / elapsed);
+      chprintf(chp, "%08lx %4lu %3lu.%lu%% %10lu ",
+               (uint32_t)curr[i].tp,
+               (uint32_t)curr[i].prio,
+               pct / 10UL, pct % 10UL,
+               (unsigned long)n);
+      if (curr[i].stkfree == TOP_STKFREE_UNKNOWN) {
+        chprintf(chp, "%8s", "?");
+      }
+      else {
+        chprintf(chp, "%8lu", curr[i].stkfree);
+      }
+      chprintf(chp, " %12s" SHELL_NEWLINE_STR, curr[i].name);
+    }
+    memcpy(prev, curr, sizeof (prev));
+    nprev = ncurr;
+  }
+}
+#endif
+
+#if (SHELL_CMD_TMHIST_ENABLED == TRUE) || defined(__DOXYGEN__)
+static void cmd_tmhist(BaseSequentialStream *chp, int argc, char *argv[]) {
+  registered_object_t *rop;
+  tm_histogram_t h;
+  unsigned i;
+
+  if (argc != 1) {
+    shellUsage(chp, "tmhist name");
+    return;
+  }
+  rop = chFactoryFindObject(argv[0]);
+  if (rop == NULL) {
+    chprintf(chp, "not found" SHELL_NEWLINE_STR);
+    return;
+  }
+  chTMHistogramSnapshotX((const tm_histogram_t *)chFactoryGetObject(rop), &h);
+  chFactoryReleaseObject(rop);
+
+  if (h.tm.n == (ucnt_t)0) {
+    chprintf(chp, "no samples" SHELL_NEWLINE_STR);
+    return;
+  }
+  chprintf(chp, "samples %lu, best %lu, avg %lu, worst %lu" SHELL_NEWLINE_STR,
+           (unsigned long)h.tm.n,
+           (unsigned long)h.tm.best,
+           (unsigned long)(h.tm.cumulative / (rttime_t)h.tm.n),
+           (unsigned long)h.tm.worst);
+  chprintf(chp, "p50 %lu, p90 %lu, p99 %lu, p99.9 %lu" SHELL_NEWLINE_STR,
+           (unsigned long)chTMHistogramGetPercentileX(&h, 500U),
+           (unsigned long)chTMHistogramGetPercentileX(&h, 900U),
+           (unsigned long)chTMHistogramGetPercentileX(&h, 990U),
+           (unsigned long)chTMHistogramGetPercentileX(&h, 999U));
+  chprintf(chp, "      from         to      count" SHELL_NEWLINE_STR);
+  for (i = 0U; i < TM_HISTOGRAM_BUCKETS; i++) {
+    if (h.buckets[i] > (ucnt_t)0) {
+      chprintf(chp, "%10lu %10lu %10lu" SHELL_NEWLINE_STR,
+               (unsigned long)chTMHistogramGetBucketBaseX(i),
+               (unsigned long)chTMHistogramGetBucketLimitX(i),
+               (unsigned long)h.buckets[i]);
+    }
+  }
+}
+#endif
+
+#if (SHELL_CMD_CONTENTION_ENABLED == TRUE) || defined(__DOXYGEN__)
+static void cmd_contention(BaseSequentialStream *chp, int argc, char *argv[]) {
+  sync_profile_t profiles[SHELL_CMD_CONTENTION_MAX_OBJECTS];
+  unsigned i, n, max = SHELL_CMD_CONTENTION_MAX_OBJECTS;
+
+  if (argc > 1) {
+    shellUsage(chp, "contention [n|reset]");
+    return;
+  }
+  if (argc == 1) {
+    if (strcmp(argv[0], "reset") == 0) {
+      chSyncProfileReset();
+      return;
+    }
+    max = (unsigned)atoi(argv[0]);
+    if ((max == 0U) || (max > SHELL_CMD_CONTENTION_MAX_OBJECTS)) {
+      shellUsage(chp, "contention [n|reset]");
+      return;
+    }
+  }
+
+  n = chSyncProfileGetTop(profiles, max);
+  chprintf(chp, "  acquired contended wait_total   wait_max   hold_max name" SHELL_NEWLINE_STR);
+  for (i = 0U; i < n; i++) {
+    chprintf(chp, "%10lu %9lu %10lu %10lu %10lu %s" SHELL_NEWLINE_STR,
+             (unsigned long)profiles[i].n_acquire,
+             (unsigned long)profiles[i].n_contended,
+             (unsigned long)profiles[i].wait_total,
+             (unsigned long)profiles[i].wait_max,
+             (unsigned long)profiles[i].hold_max,
+             profiles[i].name);
+  }
+}
+#endif
+
 /*===========================================================================*/
 /* Module exported functions.                                                */
 /*===========================================================================*/
@@ -252,6 +504,15 @@ const ShellCommand shell_local_commands[] = {
 #endif
 #if SHELL_CMD_TEST_ENABLED == TRUE
   {"test", cmd_test},
+#endif
+#if SHELL_CMD_TOP_ENABLED == TRUE
+  {"top", cmd_top},
+#endif
+#if SHELL_CMD_TMHIST_ENABLED == TRUE
+  {"tmhist", cmd_tmhist},
+#endif
+#if SHELL_CMD_CONTENTION_ENABLED == TRUE
+  {"contention", cmd_contention},
 #endif
   {NULL, NULL}
 };
@@ -65,6 +65,44 @@
 #define SHELL_CMD_TEST_WA_SIZE              THD_WORKING_AREA_SIZE(256)
 #endif
 
+/**
+ * @brief   Time measurement histograms dump command.
+ * @note    Histograms are looked up by name in the factory objects
+ *          registry, the registered objects must be @p tm_histogram_t
+ *          objects.
+ */
+#if !defined(SHELL_CMD_TMHIST_ENABLED) || defined(__DOXYGEN__)
+#define SHELL_CMD_TMHIST_ENABLED            FALSE
+#endif
+
+/**
+ * @brief   Threads CPU usage command.
+ */
+#if !defined(SHELL_CMD_TOP_ENABLED) || defined(__DOXYGEN__)
+#define SHELL_CMD_TOP_ENABLED               FALSE
+#endif
+
+/**
+ * @brief   Maximum number of threads shown by the top command.
+ */
+#if !defined(SHELL_CMD_TOP_MAX_THREADS) || defined(__DOXYGEN__)
+#define SHELL_CMD_TOP_MAX_THREADS           16
+#endif
+
+/**
+ * @brief   Synchronization objects contention command.
+ */
+#if !defined(SHELL_CMD_CONTENTION_ENABLED) || defined(__DOXYGEN__)
+#define SHELL_CMD_CONTENTION_ENABLED        FALSE
+#endif
+
+/**
+ * @brief   Maximum number of objects shown by the contention command.
+ */
+#if !defined(SHELL_CMD_CONTENTION_MAX_OBJECTS) || defined(__DOXYGEN__)
+#define SHELL_CMD_CONTENTION_MAX_OBJECTS    8
+#endif
+
 /*===========================================================================*/
 /* Derived constants and error checks.                                       */
 /*===========================================================================*/
@@ -81,6 +119,27 @@
 #error "SHELL_CMD_THREADS_ENABLED requires CH_CFG_USE_REGISTRY"
 #endif
 
+#if (SHELL_CMD_TOP_ENABLED == TRUE) && (CH_CFG_USE_REGISTRY == FALSE)
+#error "SHELL_CMD_TOP_ENABLED requires CH_CFG_USE_REGISTRY"
+#endif
+
+#if (SHELL_CMD_TOP_ENABLED == TRUE) && (CH_DBG_STATISTICS == FALSE)
+#error "SHELL_CMD_TOP_ENABLED requires CH_DBG_STATISTICS"
+#endif
+
+#if (SHELL_CMD_TMHIST_ENABLED == TRUE) && (CH_CFG_USE_TM == FALSE)
+#error "SHELL_CMD_TMHIST_ENABLED requires CH_CFG_USE_TM"
+#endif
+
+#if (SHELL_CMD_TMHIST_ENABLED == TRUE) &&                                   \
+    ((CH_CFG_USE_FACTORY == FALSE) || (CH_CFG_FACTORY_OBJECTS_REGISTRY == FALSE))
+#error "SHELL_CMD_TMHIST_ENABLED requires CH_CFG_FACTORY_OBJECTS_REGISTRY"
+#endif
+
+#if (SHELL_CMD_CONTENTION_ENABLED == TRUE) && (CH_DBG_SYNC_PROFILING == FALSE)
+#error "SHELL_CMD_CONTENTION_ENABLED requires CH_DBG_SYNC_PROFILING"
+#endif
+
 /*===========================================================================*/
 /* Module data structures and types.                                         */
 /*===========================================================================*/
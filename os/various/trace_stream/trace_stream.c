@@ -0,0 +1,319 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    trace_stream.c
+ * @brief   Trace streaming module code.
+ *
+ * @addtogroup trace_stream
+ * @{
+ */
+
+#include <string.h>
+
+#include "ch.h"
+#include "hal.h"
+#include "trace_stream.h"
+
+/*===========================================================================*/
+/* Module local definitions.                                                 */
+/*===========================================================================*/
+
+/**
+ * @brief   Maximum size of an encoded record header.
+ */
+#define TRS_RECORD_SIZE     (1U + (5U * 10U))
+
+/*===========================================================================*/
+/* Module exported variables.                                                */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local types.                                                       */
+/*===========================================================================*/
+
+/**
+ * @brief   Record encoding buffer.
+ */
+typedef struct {
+  size_t                n;
+  uint8_t               buf[TRS_RECORD_SIZE];
+} trs_record_t;
+
+/*===========================================================================*/
+/* Module local variables.                                                   */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* Module local functions.                                                   */
+/*===========================================================================*/
+
+static void trs_begin(trs_record_t *rp, uint8_t type, uint8_t state) {
+
+  rp->buf[0] = (uint8_t)((state << 3) | (type & 7U));
+  rp->n      = 1U;
+}
+
+static void trs_varint(trs_record_t *rp, uint64_t x) {
+
+  while (x >= 0x80U) {
+    rp->buf[rp->n++] = (uint8_t)(x | 0x80U);
+    x >>= 7;
+  }
+  rp->buf[rp->n++] = (uint8_t)x;
+}
+
+static void trs_pointer(trs_record_t *rp, const void *p) {
+
+  trs_varint(rp, (uint64_t)(uintptr_t)p);
+}
+
+static void trs_write(trace_stream_t *tsp, const trs_record_t *rp) {
+
+  (void) streamWrite(tsp->stream, rp->buf, rp->n);
+}
+
+static void trs_define_string(trace_stream_t *tsp, const char *s) {
+  trs_record_t r;
+  size_t len;
+  unsigned i;
+
+  if (s == NULL) {
+    return;
+  }
+  for (i = 0U; i < TRS_CACHE_SIZE; i++) {
+    if (tsp->strings[i] == s) {
+      return;
+    }
+  }
+  tsp->strings[tsp->nextstring] = s;
+  tsp->nextstring = (tsp->nextstring + 1U) % TRS_CACHE_SIZE;
+
+  len = strlen(s);
+  trs_begin(&r, CH_TRACE_TYPE_UNUSED, TRS_CTRL_STRING);
+  trs_pointer(&r, s);
+  trs_varint(&r, (uint64_t)len);
+  trs_write(tsp, &r);
+  (void) streamWrite(tsp->stream, (const uint8_t *)s, len);
+}
+
+static void trs_define_thread(trace_stream_t *tsp, thread_t *tp) {
+#if CH_CFG_USE_REGISTRY == TRUE
+  const char *name = "";
+  tprio_t prio = (tprio_t)0;
+  trs_record_t r;
+  size_t len;
+  unsigned i;
+
+  for (i = 0U; i < TRS_CACHE_SIZE; i++) {
+    if (tsp->threads[i] == tp) {
+      return;
+    }
+  }
+  tsp->threads[tsp->nextthread] = tp;
+  tsp->nextthread = (tsp->nextthread + 1U) % TRS_CACHE_SIZE;
+
+  /* The thread is accessed only if it is still in the registry, a thread
+     already terminated is defined without a name.*/
+  if (chRegFindThreadByPointer(tp) != NULL) {
+    if (tp->name != NULL) {
+      name = tp->name;
+    }
+    prio = tp->hdr.pqueue.prio;
+#if CH_CFG_USE_DYNAMIC == TRUE
+    chThdRelease(tp);
+#endif
+  }
+
+  len = strlen(name);
+  trs_begin(&r, CH_TRACE_TYPE_UNUSED, TRS_CTRL_THREAD);
+  trs_pointer(&r, tp);
+  trs_varint(&r, (uint64_t)prio);
+  trs_varint(&r, (uint64_t)len);
+  trs_write(tsp, &r);
+  (void) streamWrite(tsp->stream, (const uint8_t *)name, len);
+#else
+  (void)tsp;
+  (void)tp;
+#endif
+}
+
+static void trs_event(trace_stream_t *tsp, const trace_event_t *tep) {
+  trs_record_t r;
+
+  /* Strings and threads referred by the record are defined before the
+     record.*/
+  if (tep->type == CH_TRACE_TYPE_READY) {
+    trs_define_thread(tsp, tep->u.rdy.tp);
+  }
+  else if (tep->type == CH_TRACE_TYPE_SWITCH) {
+    trs_define_thread(tsp, tep->u.sw.ntp);
+  }
+  else if ((tep->type == CH_TRACE_TYPE_ISR_ENTER) ||
+           (tep->type == CH_TRACE_TYPE_ISR_LEAVE)) {
+    trs_define_string(tsp, tep->u.isr.name);
+  }
+  else if (tep->type == CH_TRACE_TYPE_HALT) {
+    trs_define_string(tsp, tep->u.halt.reason);
+  }
+
+  trs_begin(&r, (uint8_t)tep->type, (uint8_t)tep->state);
+  trs_varint(&r, (uint64_t)(systime_t)(tep->time - tsp->last_time));
+  trs_varint(&r, (uint64_t)((tep->rtstamp - tsp->last_rtstamp) & 0xFFFFFFU));
+  tsp->last_time    = tep->time;
+  tsp->last_rtstamp = tep->rtstamp;
+
+  switch (tep->type) {
+  case CH_TRACE_TYPE_READY:
+    trs_pointer(&r, tep->u.rdy.tp);
+    /* Zig-zag encoding of the signed message.*/
+    trs_varint(&r, ((uint64_t)(int64_t)tep->u.rdy.msg << 1) ^
+                   (uint64_t)((int64_t)tep->u.rdy.msg >> 63));
+    break;
+  case CH_TRACE_TYPE_SWITCH:
+    trs_pointer(&r, tep->u.sw.ntp);
+    trs_pointer(&r, tep->u.sw.wtobjp);
+    break;
+  case CH_TRACE_TYPE_ISR_ENTER:
+  case CH_TRACE_TYPE_ISR_LEAVE:
+    trs_pointer(&r, tep->u.isr.name);
+    break;
+  case CH_TRACE_TYPE_HALT:
+    trs_pointer(&r, tep->u.halt.reason);
+    break;
+  case CH_TRACE_TYPE_USER:
+    trs_pointer(&r, tep->u.user.up1);
+    trs_pointer(&r, tep->u.user.up2);
+    break;
+  default:
+    return;
+  }
+  trs_write(tsp, &r);
+  tsp->records++;
+}
+
+/*===========================================================================*/
+/* Module exported functions.                                                */
+/*===========================================================================*/
+
+/**
+ * @brief   Initializes a trace stream object.
+ *
+ * @param[out] tsp      pointer to a @p trace_stream_t object
+ * @param[in] stream    pointer to the output @p BaseSequentialStream
+ *
+ * @init
+ */
+void trsObjectInit(trace_stream_t *tsp, BaseSequentialStream *stream) {
+
+  memset((void *)tsp, 0, sizeof (trace_stream_t));
+  tsp->stream = stream;
+}
+
+/**
+ * @brief   Starts a new trace stream.
+ * @details The stream header is written, records already in the trace
+ *          buffer are discarded.
+ *
+ * @param[in] tsp       pointer to a @p trace_stream_t object
+ *
+ * @api
+ */
+void trsStart(trace_stream_t *tsp) {
+  static const uint8_t magic[4] = {'C', 'H', 'T', 'R'};
+  trace_event_t te;
+  trs_record_t r;
+  uint32_t f;
+  unsigned i;
+
+  /* Discarding old records.*/
+  while (chTraceRead(&te, 1U, NULL) > 0U) {
+  }
+
+  (void) streamWrite(tsp->stream, magic, sizeof (magic));
+  r.n = 0U;
+  r.buf[r.n++] = (uint8_t)TRS_VERSION;
+  r.buf[r.n++] = (uint8_t)(sizeof (systime_t) * 8U);
+  f = (uint32_t)CH_CFG_ST_FREQUENCY;
+  for (i = 0U; i < 4U; i++) {
+    r.buf[r.n++] = (uint8_t)(f >> (i * 8U));
+  }
+  f = (uint32_t)TRS_RT_FREQUENCY;
+  for (i = 0U; i < 4U; i++) {
+    r.buf[r.n++] = (uint8_t)(f >> (i * 8U));
+  }
+  trs_write(tsp, &r);
+
+  /* Initial state, the first event is relative to time zero.*/
+  for (i = 0U; i < TRS_CACHE_SIZE; i++) {
+    tsp->strings[i] = NULL;
+    tsp->threads[i] = NULL;
+  }
+  tsp->nextstring   = 0U;
+  tsp->nextthread   = 0U;
+  tsp->last_time    = (systime_t)0;
+  tsp->last_rtstamp = 0U;
+  tsp->records      = 0U;
+  tsp->lost         = 0U;
+}
+
+/**
+ * @brief   Writes the pending trace records on the stream.
+ * @details The function is meant to be called periodically from a low
+ *          priority thread, the period must be short enough to not let
+ *          the trace buffer overflow, lost records are reported in the
+ *          stream. Only the records already present on entry are written,
+ *          records generated while draining are left for the next call.
+ * @note    The records of the trace buffer of the current core are
+ *          written.
+ *
+ * @param[in] tsp       pointer to a @p trace_stream_t object
+ * @return              The number of written records.
+ *
+ * @api
+ */
+unsigned trsDrain(trace_stream_t *tsp) {
+  trace_event_t events[TRS_READ_BATCH];
+  unsigned i, n, pending, total = 0U;
+  ucnt_t lost;
+
+  /* The drain is bounded by the records present on entry, the stream
+     output generates trace records itself.*/
+  pending = chTraceGetPending();
+  do {
+    n = chTraceRead(events,
+                    pending < (unsigned)TRS_READ_BATCH ?
+                    pending : (unsigned)TRS_READ_BATCH,
+                    &lost);
+    if (lost > (ucnt_t)0) {
+      trs_record_t r;
+
+      trs_begin(&r, CH_TRACE_TYPE_UNUSED, TRS_CTRL_LOST);
+      trs_varint(&r, (uint64_t)lost);
+      trs_write(tsp, &r);
+      tsp->lost += (uint32_t)lost;
+    }
+    for (i = 0U; i < n; i++) {
+      trs_event(tsp, &events[i]);
+    }
+    total   += n;
+    pending -= n;
+  } while ((n > 0U) && (pending > 0U));
+
+  return total;
+}
+
+/** @} */
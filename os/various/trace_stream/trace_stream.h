@@ -0,0 +1,180 @@
+/*
+    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+/**
+ * @file    trace_stream.h
+ * @brief   Trace streaming module header.
+ * @details The module drains the RT trace buffer and writes the records on
+ *          a stream using a compact binary encoding, the stream can be
+ *          converted using the tools/trace/chtrace.py script.
+ *          <br>The stream starts with an header:
+ *          - 4 bytes magic "CHTR".
+ *          - 1 byte format version.
+ *          - 1 byte size of @p systime_t in bits.
+ *          - 4 bytes system time frequency, little endian.
+ *          - 4 bytes realtime counter frequency, little endian, zero if
+ *            unknown.
+ *          .
+ *          Then records follow, the first byte of each record contains the
+ *          record type in bits 0..2 and the thread state in bits 3..7. All
+ *          other fields are unsigned LEB128 variable length integers.
+ *          Event records contain the system time and realtime counter
+ *          deltas from the previous event record followed by the event
+ *          fields, the realtime counter delta is modulo 2^24. Records with
+ *          type zero are stream control records identified by the state
+ *          field: lost records count, string and thread definitions.
+ *          Strings and threads are defined before the first record
+ *          referring them.
+ *
+ * @addtogroup trace_stream
+ * @{
+ */
+
+#ifndef TRACE_STREAM_H
+#define TRACE_STREAM_H
+
+/*===========================================================================*/
+/* Module constants.                                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Stream format version.
+ */
+#define TRS_VERSION                         1U
+
+/**
+ * @name    Stream control records
+ * @{
+ */
+#define TRS_CTRL_LOST                       1U
+#define TRS_CTRL_STRING                     2U
+#define TRS_CTRL_THREAD                     3U
+/** @} */
+
+/*===========================================================================*/
+/* Module pre-compile time settings.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Number of records fetched from the trace buffer at once.
+ * @note    Records are fetched in a critical zone.
+ */
+#if !defined(TRS_READ_BATCH) || defined(__DOXYGEN__)
+#define TRS_READ_BATCH                      4
+#endif
+
+/**
+ * @brief   Number of remembered strings and threads definitions.
+ */
+#if !defined(TRS_CACHE_SIZE) || defined(__DOXYGEN__)
+#define TRS_CACHE_SIZE                      16
+#endif
+
+/**
+ * @brief   Realtime counter frequency written in the stream header.
+ * @note    Zero means unknown, the frequency can be specified to the
+ *          converter.
+ */
+#if !defined(TRS_RT_FREQUENCY) || defined(__DOXYGEN__)
+#define TRS_RT_FREQUENCY                    0
+#endif
+
+/*===========================================================================*/
+/* Derived constants and error checks.                                       */
+/*===========================================================================*/
+
+/*
+ * Module dependencies check.
+ */
+#if CH_DBG_TRACE_MASK == CH_DBG_TRACE_MASK_DISABLED
+#error "trace streaming requires CH_DBG_TRACE_MASK"
+#endif
+
+#if TRS_CACHE_SIZE < 1
+#error "invalid TRS_CACHE_SIZE value"
+#endif
+
+/*===========================================================================*/
+/* Module data structures and types.                                         */
+/*===========================================================================*/
+
+/**
+ * @brief   Type of a trace stream object.
+ */
+typedef struct {
+  /**
+   * @brief   Output stream.
+   */
+  BaseSequentialStream  *stream;
+  /**
+   * @brief   System time of the previous event record.
+   */
+  systime_t             last_time;
+  /**
+   * @brief   Realtime stamp of the previous event record.
+   */
+  uint32_t              last_rtstamp;
+  /**
+   * @brief   Strings already defined in the stream.
+   */
+  const char            *strings[TRS_CACHE_SIZE];
+  /**
+   * @brief   Next strings cache entry to be replaced.
+   */
+  unsigned              nextstring;
+  /**
+   * @brief   Threads already defined in the stream.
+   */
+  thread_t              *threads[TRS_CACHE_SIZE];
+  /**
+   * @brief   Next threads cache entry to be replaced.
+   */
+  unsigned              nextthread;
+  /**
+   * @brief   Total number of written event records.
+   */
+  uint32_t              records;
+  /**
+   * @brief   Total number of lost records.
+   */
+  uint32_t              lost;
+} trace_stream_t;
+
+/*===========================================================================*/
+/* Module macros.                                                            */
+/*===========================================================================*/
+
+/*===========================================================================*/
+/* External declarations.                                                    */
+/*===========================================================================*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+  void trsObjectInit(trace_stream_t *tsp, BaseSequentialStream *stream);
+  void trsStart(trace_stream_t *tsp);
+  unsigned trsDrain(trace_stream_t *tsp);
+#ifdef __cplusplus
+}
+#endif
+
+/*===========================================================================*/
+/* Module inline functions.                                                  */
+/*===========================================================================*/
+
+#endif /* TRACE_STREAM_H */
+
+/** @} */
@@ -0,0 +1,8 @@
+# RT trace streaming files.
+TRSSRC = $(CHIBIOS)/os/various/trace_stream/trace_stream.c
+
+TRSINC = $(CHIBIOS)/os/various/trace_stream
+
+# Shared variables
+ALLCSRC += $(TRSSRC)
+ALLINC  += $(TRSINC)
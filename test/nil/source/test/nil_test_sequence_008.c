@@ -41,6 +41,7 @@
  * - @subpage nil_test_008_005
  * - @subpage nil_test_008_006
  * - @subpage nil_test_008_007
+ * - @subpage nil_test_008_008
  * .
  */
 
@@ -104,6 +105,19 @@ static THD_FUNCTION(bmk_thread4, p) {
   chSysUnlock();
 }
 
+#if (CH_CFG_ST_TIMEDELTA == 0) && (PORT_SUPPORTS_RT == TRUE) &&                  \
+    (CH_DBG_SYSTEM_STATE_CHECK == FALSE)
+static thread_reference_t tr1;
+
+static THD_FUNCTION(bmk_thread5, p) {
+
+  (void)p;
+  chSysLock();
+  (void) chThdSuspendTimeoutS(&tr1, (sysinterval_t)1000);
+  chSysUnlock();
+}
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -629,6 +643,110 @@ static const testcase_t nil_test_008_007 = {
   nil_test_008_007_execute
 };
 
+#if ((CH_CFG_ST_TIMEDELTA == 0) && (PORT_SUPPORTS_RT == TRUE) && (CH_DBG_SYSTEM_STATE_CHECK == FALSE)) || defined(__DOXYGEN__)
+/**
+ * @page nil_test_008_008 [8.8] Timer handler cost
+ *
+ * <h2>Description</h2>
+ * A thread is put to sleep with a timeout and the cost of the system
+ * tick handler is measured using the realtime counter. The test is
+ * meant to be run with CH_CFG_MAX_THREADS set to 8, 16 and 32 in order
+ * to compare the linear and the bitmap schedulers, 32 threads require
+ * CH_CFG_USE_BITMAP_SCHEDULER. The handler is invoked from thread
+ * context so the state checker must be disabled, the system time is
+ * restored after the measurement.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - (CH_CFG_ST_TIMEDELTA == 0) && (PORT_SUPPORTS_RT == TRUE) && (CH_DBG_SYSTEM_STATE_CHECK == FALSE)
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [8.8.1] Starting a thread at an higher priority level, the thread
+ *   waits with a timeout.
+ * - [8.8.2] The tick handler is invoked 100 times in a critical zone,
+ *   the elapsed realtime counter cycles are measured.
+ * - [8.8.3] Stopping the sleeping thread.
+ * - [8.8.4] Score is printed.
+ * .
+ */
+
+static void nil_test_008_008_execute(void) {
+  thread_t *tp;
+  uint32_t n;
+
+  /* [8.8.1] Starting a thread at an higher priority level, the thread
+     waits with a timeout.*/
+  test_set_step(1);
+  {
+    thread_descriptor_t td = {
+      .name  = "sleeper",
+      .wbase = wa_common,
+      .wend  = THD_WORKING_AREA_END(wa_common),
+      .prio  = chThdGetPriorityX() - 1,
+      .funcp = bmk_thread5,
+      .arg   = NULL
+    };
+    tp = chThdCreate(&td);
+  }
+  test_end_step(1);
+
+  /* [8.8.2] The tick handler is invoked 100 times in a critical zone,
+     the elapsed realtime counter cycles are measured.*/
+  test_set_step(2);
+  {
+    rtcnt_t start, end;
+    unsigned i;
+
+    chSysLock();
+    start = chSysGetRealtimeCounterX();
+    for (i = 0; i < 100; i++) {
+      chSysTimerHandlerI();
+    }
+    end = chSysGetRealtimeCounterX();
+
+    /* Restoring the system time, the only armed timeout is the one of
+       the sleeping thread and it is discarded in the next step.*/
+    nil.systime -= (systime_t)100;
+    chSchRescheduleS();
+    chSysUnlock();
+    n = (uint32_t)(end - start) / 100U;
+  }
+  test_end_step(2);
+
+  /* [8.8.3] Stopping the sleeping thread.*/
+  test_set_step(3);
+  {
+    chThdResume(&tr1, MSG_OK);
+    chThdWait(tp);
+  }
+  test_end_step(3);
+
+  /* [8.8.4] Score is printed.*/
+  test_set_step(4);
+  {
+    test_print("--- Score : ");
+    test_printn(n);
+    test_print(" cycles/tick, ");
+    test_printn(CH_CFG_MAX_THREADS);
+#if CH_CFG_USE_BITMAP_SCHEDULER == TRUE
+    test_println(" threads, bitmap");
+#else
+    test_println(" threads, linear");
+#endif
+  }
+  test_end_step(4);
+}
+
+static const testcase_t nil_test_008_008 = {
+  "Timer handler cost",
+  NULL,
+  NULL,
+  nil_test_008_008_execute
+};
+#endif /* (CH_CFG_ST_TIMEDELTA == 0) && (PORT_SUPPORTS_RT == TRUE) && (CH_DBG_SYSTEM_STATE_CHECK == FALSE) */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -650,6 +768,9 @@ const testcase_t * const nil_test_sequence_008_array[] = {
   &nil_test_008_006,
 #endif
   &nil_test_008_007,
+#if ((CH_CFG_ST_TIMEDELTA == 0) && (PORT_SUPPORTS_RT == TRUE) && (CH_DBG_SYSTEM_STATE_CHECK == FALSE)) || defined(__DOXYGEN__)
+  &nil_test_008_008,
+#endif
   NULL
 };
 
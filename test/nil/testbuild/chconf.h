@@ -51,6 +51,17 @@
 #define CH_CFG_MAX_THREADS                  4
 #endif
 
+/**
+ * @brief   Bitmap scheduler.
+ * @details If enabled then the next ready thread is found using a bitmap
+ *          and the timer handler only processes expiring timeouts, up to
+ *          64 threads are supported in this mode.
+ * @note    The legacy mode supports up to 16 threads and is more compact.
+ */
+#if !defined(CH_CFG_USE_BITMAP_SCHEDULER)
+#define CH_CFG_USE_BITMAP_SCHEDULER         FALSE
+#endif
+
 /**
  * @brief   Auto starts threads when @p chSysInit() is invoked.
  */
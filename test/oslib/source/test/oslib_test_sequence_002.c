@@ -39,6 +39,9 @@
  * - @subpage oslib_test_002_001
  * - @subpage oslib_test_002_002
  * - @subpage oslib_test_002_003
+ * - @subpage oslib_test_002_004
+ * - @subpage oslib_test_002_005
+ * - @subpage oslib_test_002_006
  * .
  */
 
@@ -49,10 +52,81 @@
  ****************************************************************************/
 
 #define MB_SIZE 4
+#define MB_BMK_SIZE 16
 
 static msg_t mb_buffer[MB_SIZE];
 static MAILBOX_DECL(mb1, mb_buffer, MB_SIZE);
 
+static msg_t smb_buffer[MB_SIZE];
+static SPSC_MAILBOX_DECL(smb1, smb_buffer, MB_SIZE);
+
+static msg_t mb_bmk_buffer[MB_BMK_SIZE];
+static mailbox_t mb2;
+static spsc_mailbox_t smb2;
+
+static THD_WORKING_AREA(waThread1, 256);
+
+static THD_FUNCTION(mb_consumer, arg) {
+  msg_t msg;
+
+  (void)arg;
+  do {
+    if (chMBFetchTimeout(&mb2, &msg, TIME_INFINITE) != MSG_OK) {
+      break;
+    }
+  } while (msg != (msg_t)0);
+  chThdExit(MSG_OK);
+}
+
+static THD_FUNCTION(mb_batch_consumer, arg) {
+  msg_t msgs[MB_BMK_SIZE];
+  size_t n;
+
+  (void)arg;
+  do {
+    n = chMBFetchBatchTimeout(&mb2, msgs, MB_BMK_SIZE, TIME_INFINITE);
+  } while ((n > (size_t)0) && (msgs[n - (size_t)1] != (msg_t)0));
+  chThdExit(MSG_OK);
+}
+
+static THD_FUNCTION(smb_consumer, arg) {
+  msg_t msg;
+
+  (void)arg;
+  do {
+    if (chSpscMBFetchTimeout(&smb2, &msg, TIME_INFINITE) != MSG_OK) {
+      break;
+    }
+  } while (msg != (msg_t)0);
+  chThdExit(MSG_OK);
+}
+
+/* The consumer does not preempt the tester thread, messages are
+   transferred in bursts when the mailbox is full or empty instead of
+   measuring the wakeup path on each message. On RT the consumer runs at
+   the same priority of the tester thread, on NIL priorities are thread
+   slots and the consumer takes the next, lower priority, slot.*/
+#if defined(__CHIBIOS_NIL__)
+#define MB_BMK_PRIO         (chThdGetPriorityX() + 1)
+#define MB_BMK_PRIO_STR     ", lower priority"
+#else
+#define MB_BMK_PRIO         chThdGetPriorityX()
+#define MB_BMK_PRIO_STR     ", same priority"
+#endif
+
+static thread_t *mb_bmk_start(tfunc_t funcp) {
+  thread_descriptor_t td = {
+    .name  = "consumer",
+    .wbase = waThread1,
+    .wend  = THD_WORKING_AREA_END(waThread1),
+    .prio  = MB_BMK_PRIO,
+    .funcp = funcp,
+    .arg   = NULL
+  };
+
+  return chThdCreate(&td);
+}
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -410,6 +484,316 @@ static const testcase_t oslib_test_002_003 = {
   oslib_test_002_003_execute
 };
 
+/**
+ * @page oslib_test_002_004 [2.4] Mailbox batch API
+ *
+ * <h2>Description</h2>
+ * The mailbox batch API is tested, messages order, partial transfers,
+ * wrap-around, reset state and timeouts are checked.
+ *
+ * <h2>Test Steps</h2>
+ * - [2.4.1] Posting batches larger than the free space, only the
+ *   messages fitting the mailbox are posted.
+ * - [2.4.2] Fetching all the messages with a single call, the order is
+ *   checked.
+ * - [2.4.3] Testing the I-Class API and the buffer wrap-around.
+ * - [2.4.4] Testing the behavior of the batch API in reset state and on
+ *   timeout.
+ * .
+ */
+
+static void oslib_test_002_004_setup(void) {
+  chMBObjectInit(&mb1, mb_buffer, MB_SIZE);
+}
+
+static void oslib_test_002_004_teardown(void) {
+  chMBReset(&mb1);
+}
+
+static void oslib_test_002_004_execute(void) {
+  msg_t msgs[MB_SIZE + 2], fetched[MB_SIZE + 2];
+  size_t n;
+  unsigned i;
+
+  /* [2.4.1] Posting batches larger than the free space, only the messages
+     fitting the mailbox are posted.*/
+  test_set_step(1);
+  {
+    for (i = 0; i < MB_SIZE + 2; i++) {
+      msgs[i] = 'A' + i;
+    }
+    n = chMBPostBatchTimeout(&mb1, msgs, 3, TIME_INFINITE);
+    test_assert(n == 3, "wrong posted count");
+    n = chMBPostBatchTimeout(&mb1, &msgs[3], 3, TIME_INFINITE);
+    test_assert(n == MB_SIZE - 3, "wrong posted count");
+    chSysLock();
+    n = chMBPostBatchI(&mb1, msgs, 1);
+    chSysUnlock();
+    test_assert(n == 0, "not full");
+    n = chMBPostBatchTimeout(&mb1, msgs, 1, 1);
+    test_assert(n == 0, "not full");
+  }
+  test_end_step(1);
+
+  /* [2.4.2] Fetching all the messages with a single call, the order is
+     checked.*/
+  test_set_step(2);
+  {
+    n = chMBFetchBatchTimeout(&mb1, fetched, MB_SIZE + 2, TIME_INFINITE);
+    test_assert(n == MB_SIZE, "wrong fetched count");
+    for (i = 0; i < MB_SIZE; i++) {
+      test_assert(fetched[i] == (msg_t)('A' + i), "wrong message");
+    }
+  }
+  test_end_step(2);
+
+  /* [2.4.3] Testing the I-Class API and the buffer wrap-around.*/
+  test_set_step(3);
+  {
+    chSysLock();
+    n = chMBPostBatchI(&mb1, msgs, 3);
+    chSysUnlock();
+    test_assert(n == 3, "wrong posted count");
+    chSysLock();
+    n = chMBFetchBatchI(&mb1, fetched, 2);
+    chSysUnlock();
+    test_assert(n == 2, "wrong fetched count");
+    test_assert((fetched[0] == 'A') && (fetched[1] == 'B'), "wrong message");
+    n = chMBPostBatchTimeout(&mb1, msgs, 3, TIME_INFINITE);
+    test_assert(n == 3, "wrong posted count");
+    n = chMBFetchBatchTimeout(&mb1, fetched, MB_SIZE + 2, TIME_INFINITE);
+    test_assert(n == 4, "wrong fetched count");
+    test_assert((fetched[0] == 'C') && (fetched[1] == 'A') &&
+                (fetched[2] == 'B') && (fetched[3] == 'C'), "wrong message");
+  }
+  test_end_step(3);
+
+  /* [2.4.4] Testing the behavior of the batch API in reset state and on
+     timeout.*/
+  test_set_step(4);
+  {
+    chMBReset(&mb1);
+    n = chMBPostBatchTimeout(&mb1, msgs, 1, TIME_INFINITE);
+    test_assert(n == 0, "not in reset state");
+    n = chMBFetchBatchTimeout(&mb1, fetched, 1, TIME_INFINITE);
+    test_assert(n == 0, "not in reset state");
+    chMBResumeX(&mb1);
+    n = chMBFetchBatchTimeout(&mb1, fetched, 1, 1);
+    test_assert(n == 0, "not empty");
+    chSysLock();
+    n = chMBFetchBatchI(&mb1, fetched, 1);
+    chSysUnlock();
+    test_assert(n == 0, "not empty");
+  }
+  test_end_step(4);
+}
+
+static const testcase_t oslib_test_002_004 = {
+  "Mailbox batch API",
+  oslib_test_002_004_setup,
+  oslib_test_002_004_teardown,
+  oslib_test_002_004_execute
+};
+
+/**
+ * @page oslib_test_002_005 [2.5] SPSC mailbox API
+ *
+ * <h2>Description</h2>
+ * The single producer single consumer mailbox API is tested, messages
+ * order, full and empty conditions are checked.
+ *
+ * <h2>Test Steps</h2>
+ * - [2.5.1] Testing the mailbox size and the initial state.
+ * - [2.5.2] Filling the mailbox using chSpscMBPostTimeout(), then
+ *   testing chSpscMBPostTimeout() and chSpscMBPostI() timeout.
+ * - [2.5.3] Emptying the mailbox using chSpscMBFetchTimeout(), then
+ *   testing chSpscMBFetchTimeout() and chSpscMBFetchI() timeout.
+ * - [2.5.4] Posting and fetching one more message using the I-Class
+ *   API, the buffer wraps around.
+ * .
+ */
+
+static void oslib_test_002_005_setup(void) {
+  chSpscMBObjectInit(&smb1, smb_buffer, MB_SIZE);
+}
+
+static void oslib_test_002_005_execute(void) {
+  msg_t msg1, msg2;
+  unsigned i;
+
+  /* [2.5.1] Testing the mailbox size and the initial state.*/
+  test_set_step(1);
+  {
+    test_assert(chSpscMBGetSizeX(&smb1) == MB_SIZE, "wrong size");
+    test_assert(chSpscMBGetUsedCountX(&smb1) == 0, "not empty");
+  }
+  test_end_step(1);
+
+  /* [2.5.2] Filling the mailbox using chSpscMBPostTimeout(), then testing
+     chSpscMBPostTimeout() and chSpscMBPostI() timeout.*/
+  test_set_step(2);
+  {
+    for (i = 0; i < MB_SIZE; i++) {
+      msg1 = chSpscMBPostTimeout(&smb1, 'A' + i, TIME_INFINITE);
+      test_assert(msg1 == MSG_OK, "wrong wake-up message");
+    }
+    test_assert(chSpscMBGetUsedCountX(&smb1) == MB_SIZE, "not full");
+    msg1 = chSpscMBPostTimeout(&smb1, 'X', 1);
+    test_assert(msg1 == MSG_TIMEOUT, "wrong wake-up message");
+    chSysLock();
+    msg1 = chSpscMBPostI(&smb1, 'X');
+    chSysUnlock();
+    test_assert(msg1 == MSG_TIMEOUT, "wrong wake-up message");
+  }
+  test_end_step(2);
+
+  /* [2.5.3] Emptying the mailbox using chSpscMBFetchTimeout(), then
+     testing chSpscMBFetchTimeout() and chSpscMBFetchI() timeout.*/
+  test_set_step(3);
+  {
+    for (i = 0; i < MB_SIZE; i++) {
+      msg1 = chSpscMBFetchTimeout(&smb1, &msg2, TIME_INFINITE);
+      test_assert(msg1 == MSG_OK, "wrong wake-up message");
+      test_emit_token(msg2);
+    }
+    test_assert_sequence("ABCD", "wrong get sequence");
+    test_assert(chSpscMBGetUsedCountX(&smb1) == 0, "not empty");
+    msg1 = chSpscMBFetchTimeout(&smb1, &msg2, 1);
+    test_assert(msg1 == MSG_TIMEOUT, "wrong wake-up message");
+    chSysLock();
+    msg1 = chSpscMBFetchI(&smb1, &msg2);
+    chSysUnlock();
+    test_assert(msg1 == MSG_TIMEOUT, "wrong wake-up message");
+  }
+  test_end_step(3);
+
+  /* [2.5.4] Posting and fetching one more message using the I-Class API,
+     the buffer wraps around.*/
+  test_set_step(4);
+  {
+    chSysLock();
+    msg1 = chSpscMBPostI(&smb1, 'E');
+    chSysUnlock();
+    test_assert(msg1 == MSG_OK, "wrong wake-up message");
+    chSysLock();
+    msg1 = chSpscMBFetchI(&smb1, &msg2);
+    chSysUnlock();
+    test_assert(msg1 == MSG_OK, "wrong wake-up message");
+    test_assert(msg2 == 'E', "wrong message");
+  }
+  test_end_step(4);
+}
+
+static const testcase_t oslib_test_002_005 = {
+  "SPSC mailbox API",
+  oslib_test_002_005_setup,
+  NULL,
+  oslib_test_002_005_execute
+};
+
+/**
+ * @page oslib_test_002_006 [2.6] Mailboxes throughput
+ *
+ * <h2>Description</h2>
+ * A consumer thread not preempting the tester thread fetches messages
+ * posted by the tester thread, the number of messages transferred in a
+ * one second time window is measured for the normal API, the batch API
+ * and the SPSC mailbox.
+ *
+ * <h2>Test Steps</h2>
+ * - [2.6.1] Transferring messages one at time using the normal API.
+ * - [2.6.2] Transferring messages in batches using the batch API.
+ * - [2.6.3] Transferring messages one at time using a SPSC mailbox.
+ * .
+ */
+
+static void oslib_test_002_006_execute(void) {
+  thread_t *tp;
+  systime_t start, end;
+  uint32_t n;
+
+  /* [2.6.1] Transferring messages one at time using the normal API.*/
+  test_set_step(1);
+  {
+    chMBObjectInit(&mb2, mb_bmk_buffer, MB_BMK_SIZE);
+    tp = mb_bmk_start(mb_consumer);
+    n = 0;
+    start = chVTGetSystemTimeX();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      (void) chMBPostTimeout(&mb2, (msg_t)1, TIME_INFINITE);
+      n++;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+    (void) chMBPostTimeout(&mb2, (msg_t)0, TIME_INFINITE);
+    chThdWait(tp);
+    test_print("--- Single: ");
+    test_printn(n);
+    test_println(" msgs/S" MB_BMK_PRIO_STR);
+  }
+  test_end_step(1);
+
+  /* [2.6.2] Transferring messages in batches using the batch API.*/
+  test_set_step(2);
+  {
+    msg_t msgs[MB_BMK_SIZE];
+    unsigned i;
+
+    for (i = 0; i < MB_BMK_SIZE; i++) {
+      msgs[i] = (msg_t)1;
+    }
+    chMBObjectInit(&mb2, mb_bmk_buffer, MB_BMK_SIZE);
+    tp = mb_bmk_start(mb_batch_consumer);
+    n = 0;
+    start = chVTGetSystemTimeX();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      n += (uint32_t)chMBPostBatchTimeout(&mb2, msgs, MB_BMK_SIZE, TIME_INFINITE);
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+    (void) chMBPostTimeout(&mb2, (msg_t)0, TIME_INFINITE);
+    chThdWait(tp);
+    test_print("--- Batch : ");
+    test_printn(n);
+    test_println(" msgs/S" MB_BMK_PRIO_STR);
+  }
+  test_end_step(2);
+
+  /* [2.6.3] Transferring messages one at time using a SPSC mailbox.*/
+  test_set_step(3);
+  {
+    chSpscMBObjectInit(&smb2, mb_bmk_buffer, MB_BMK_SIZE);
+    tp = mb_bmk_start(smb_consumer);
+    n = 0;
+    start = chVTGetSystemTimeX();
+    end = chTimeAddX(start, TIME_MS2I(1000));
+    do {
+      (void) chSpscMBPostTimeout(&smb2, (msg_t)1, TIME_INFINITE);
+      n++;
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    } while (chVTIsSystemTimeWithinX(start, end));
+    (void) chSpscMBPostTimeout(&smb2, (msg_t)0, TIME_INFINITE);
+    chThdWait(tp);
+    test_print("--- SPSC  : ");
+    test_printn(n);
+    test_println(" msgs/S" MB_BMK_PRIO_STR);
+  }
+  test_end_step(3);
+}
+
+static const testcase_t oslib_test_002_006 = {
+  "Mailboxes throughput",
+  NULL,
+  NULL,
+  oslib_test_002_006_execute
+};
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -421,6 +805,9 @@ const testcase_t * const oslib_test_sequence_002_array[] = {
   &oslib_test_002_001,
   &oslib_test_002_002,
   &oslib_test_002_003,
+  &oslib_test_002_004,
+  &oslib_test_002_005,
+  &oslib_test_002_006,
   NULL
 };
 
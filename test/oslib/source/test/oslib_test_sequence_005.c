@@ -37,6 +37,7 @@
  *
  * <h2>Test Cases</h2>
  * - @subpage oslib_test_005_001
+ * - @subpage oslib_test_005_002
  * .
  */
 
@@ -110,6 +111,47 @@ static THD_FUNCTION(Thread1, arg) {
   chThdExit(0x0FA5);
 }
 
+#define ASYNC_CALLS 5
+#define MAX_BATCHES 8
+
+/* The dispatcher runs at a priority lower than the tester thread, on NIL
+   priorities are thread slots and a greater slot is a lower priority.*/
+#if defined(__CHIBIOS_NIL__)
+#define DISPATCHER_PRIO (chThdGetPriorityX() + 1)
+#else
+#define DISPATCHER_PRIO (chThdGetPriorityX() - 1)
+#endif
+
+static delegates_queue_t dq;
+static delegate_future_t futures[ASYNC_CALLS];
+static unsigned batches[MAX_BATCHES];
+static unsigned nbatches;
+
+static void dis_chain(delegate_future_t *fp) {
+  msg_t r = chDelegateFutureGetResultX(fp);
+
+  if (r < (msg_t)'M') {
+    (void)chDelegateCallAsync1(&dq, fp, (delegate_fn1_t)dis_func1, r + 1);
+  }
+}
+
+static THD_WORKING_AREA(waThread2, 256);
+static THD_FUNCTION(Thread2, arg) {
+
+  (void)arg;
+
+  exit_flag = false;
+  nbatches = 0U;
+  do {
+    unsigned n = chDelegateDispatchQueue(&dq);
+    if (nbatches < MAX_BATCHES) {
+      batches[nbatches++] = n;
+    }
+  } while (!exit_flag);
+
+  chThdExit(0x0FA5);
+}
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -190,6 +232,125 @@ static const testcase_t oslib_test_005_001 = {
   oslib_test_005_001_execute
 };
 
+/**
+ * @page oslib_test_005_002 [5.2] Asynchronous calls test
+ *
+ * <h2>Description</h2>
+ * The asynchronous calls API is tested for functionality, calls are
+ * posted, polled, waited and chained, the calls queued before the
+ * dispatcher wakeup must be executed in a single batch.
+ *
+ * <h2>Test Steps</h2>
+ * - [5.2.1] Starting the dispatcher thread with a priority lower than
+ *   the test thread.
+ * - [5.2.2] Posting calls, the dispatcher cannot run so the futures
+ *   must not be completed, posting a pending future again must be
+ *   rejected.
+ * - [5.2.3] Waiting for the last call, all calls must be completed in
+ *   order.
+ * - [5.2.4] Posting a call with a completion callback chaining two more
+ *   calls, the future must be completed after the last call.
+ * - [5.2.5] Terminating the dispatcher and checking the batches, the
+ *   first five calls must have been executed by a single dispatch.
+ * .
+ */
+
+static void oslib_test_005_002_execute(void) {
+  thread_t *tp;
+  unsigned i;
+
+  /* [5.2.1] Starting the dispatcher thread with a priority lower than the
+     test thread.*/
+  test_set_step(1);
+  {
+    chDelegateQueueObjectInit(&dq);
+    for (i = 0U; i < ASYNC_CALLS; i++) {
+      chDelegateFutureObjectInit(&futures[i], NULL);
+    }
+    {
+      thread_descriptor_t td = {
+        .name  = "dispatcher",
+        .wbase = waThread2,
+        .wend  = THD_WORKING_AREA_END(waThread2),
+        .prio  = DISPATCHER_PRIO,
+        .funcp = Thread2,
+        .arg   = NULL
+      };
+      tp = chThdCreate(&td);
+    }
+  }
+  test_end_step(1);
+
+  /* [5.2.2] Posting calls, the dispatcher cannot run so the futures must
+     not be completed, posting a pending future again must be rejected.*/
+  test_set_step(2);
+  {
+    (void)chDelegateCallAsync0(&dq, &futures[0], (delegate_fn0_t)dis_func0);
+    (void)chDelegateCallAsync1(&dq, &futures[1], (delegate_fn1_t)dis_func1, 'A');
+    (void)chDelegateCallAsync2(&dq, &futures[2], (delegate_fn2_t)dis_func2, 'B', 'C');
+    (void)chDelegateCallAsync3(&dq, &futures[3], (delegate_fn3_t)dis_func3, 'D', 'E', 'F');
+    (void)chDelegateCallAsync4(&dq, &futures[4], (delegate_fn4_t)dis_func4, 'G', 'H', 'I', 'J');
+    for (i = 0U; i < ASYNC_CALLS; i++) {
+      test_assert(!chDelegateFutureIsDoneX(&futures[i]), "completed");
+    }
+    test_assert(chDelegateCallAsync0(&dq, &futures[0], (delegate_fn0_t)dis_func0) == MSG_RESET,
+                "pending future posted");
+    test_assert(chDelegateFutureWaitTimeout(&futures[0], TIME_IMMEDIATE) == MSG_TIMEOUT,
+                "not timed out");
+  }
+  test_end_step(2);
+
+  /* [5.2.3] Waiting for the last call, all calls must be completed in
+     order.*/
+  test_set_step(3);
+  {
+    test_assert(chDelegateFutureWait(&futures[4]) == (msg_t)'G', "invalid return value");
+    for (i = 0U; i < ASYNC_CALLS; i++) {
+      test_assert(chDelegateFutureIsDoneX(&futures[i]), "not completed");
+    }
+    test_assert(chDelegateFutureGetResultX(&futures[0]) == 0x55AA, "invalid return value");
+    test_assert(chDelegateFutureGetResultX(&futures[1]) == (msg_t)'A', "invalid return value");
+    test_assert(chDelegateFutureGetResultX(&futures[2]) == (msg_t)'B', "invalid return value");
+    test_assert(chDelegateFutureGetResultX(&futures[3]) == (msg_t)'D', "invalid return value");
+    test_assert_sequence("0ABCDEFGHIJ", "unexpected tokens");
+  }
+  test_end_step(3);
+
+  /* [5.2.4] Posting a call with a completion callback chaining two more
+     calls, the future must be completed after the last call.*/
+  test_set_step(4);
+  {
+    chDelegateFutureObjectInit(&futures[0], dis_chain);
+    (void)chDelegateCallAsync1(&dq, &futures[0], (delegate_fn1_t)dis_func1, 'K');
+    test_assert(chDelegateFutureWaitTimeout(&futures[0], TIME_INFINITE) == MSG_OK,
+                "wait failed");
+    test_assert(chDelegateFutureGetResultX(&futures[0]) == (msg_t)'M', "invalid return value");
+    test_assert_sequence("KLM", "unexpected tokens");
+  }
+  test_end_step(4);
+
+  /* [5.2.5] Terminating the dispatcher and checking the batches, the
+     first five calls must have been executed by a single dispatch.*/
+  test_set_step(5);
+  {
+    chDelegateFutureObjectInit(&futures[0], NULL);
+    (void)chDelegateCallAsync0(&dq, &futures[0], (delegate_fn0_t)dis_func_end);
+    test_assert(chDelegateFutureWait(&futures[0]) == 0xAA55, "invalid return value");
+    test_assert(chThdWait(tp) == 0x0FA5, "invalid exit code");
+    test_assert_sequence("Z", "unexpected tokens");
+    test_assert(nbatches == 5U, "wrong number of batches");
+    test_assert(batches[0] == ASYNC_CALLS, "calls not batched");
+  }
+  test_end_step(5);
+}
+
+static const testcase_t oslib_test_005_002 = {
+  "Asynchronous calls test",
+  NULL,
+  NULL,
+  oslib_test_005_002_execute
+};
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -199,6 +360,7 @@ static const testcase_t oslib_test_005_001 = {
  */
 const testcase_t * const oslib_test_sequence_005_array[] = {
   &oslib_test_005_001,
+  &oslib_test_005_002,
   NULL
 };
 
@@ -37,6 +37,9 @@
  *
  * <h2>Test Cases</h2>
  * - @subpage oslib_test_006_001
+ * - @subpage oslib_test_006_002
+ * - @subpage oslib_test_006_003
+ * - @subpage oslib_test_006_004
  * .
  */
 
@@ -51,6 +54,8 @@
 #define SIZE_OBJECTS        16
 #define NUM_OBJECTS         4
 #define NUM_HASH_ENTRIES    (NUM_OBJECTS * 2)
+#define NUM_SHARDS          2
+#define NUM_SCAN            32
 
 /* Cached object type used for test.*/
 typedef struct {
@@ -88,6 +93,97 @@ static bool obj_write(objects_cache_t *ocp,
   return false;
 }
 
+static oc_hash_header_t shards_hash_headers[NUM_SHARDS][NUM_HASH_ENTRIES];
+static cached_object_t shards_objects[NUM_SHARDS][NUM_OBJECTS];
+static objects_cache_t shards_caches[NUM_SHARDS];
+static objects_cache_shards_t shards1;
+
+#if CH_CFG_USE_MAILBOXES == TRUE
+static msg_t store_buffer[NUM_OBJECTS];
+static mailbox_t store_mb;
+static thread_t *store_tp;
+static uint32_t store_hits, store_misses;
+static THD_WORKING_AREA(waStore, 256);
+
+/* Simulated storage, asynchronous reads are queued to the store thread
+   as indexes of the objects.*/
+static bool store_read(objects_cache_t *ocp,
+                       oc_object_t *objp,
+                       bool async) {
+  (void)ocp;
+
+  if (async) {
+    (void) chMBPostTimeout(&store_mb,
+                           (msg_t)((cached_object_t *)objp - objects),
+                           TIME_INFINITE);
+    return false;
+  }
+
+  chThdSleep(1);
+  objp->obj_flags &= ~OC_FLAG_NOTSYNC;
+
+  return false;
+}
+
+static THD_FUNCTION(store_thread, arg) {
+  msg_t msg;
+
+  (void)arg;
+  while (chMBFetchTimeout(&store_mb, &msg, TIME_INFINITE) == MSG_OK) {
+    oc_object_t *objp = &objects[msg].header;
+
+    chThdSleep(1);
+    objp->obj_flags &= ~OC_FLAG_NOTSYNC;
+    chCacheReleaseObject(&cache1, objp);
+  }
+  chThdExit(MSG_OK);
+}
+
+static sysinterval_t store_scan(uint32_t group, bool readahead) {
+  systime_t start;
+  uint32_t i;
+
+  store_hits   = 0U;
+  store_misses = 0U;
+  chThdSleep(1);
+  start = chVTGetSystemTimeX();
+  for (i = 0; i < NUM_SCAN; i++) {
+    oc_object_t *objp;
+
+    if (readahead) {
+      (void) chCacheReadAhead(&cache1, group, i + 1U, NUM_OBJECTS - 2);
+    }
+    objp = chCacheGetObject(&cache1, group, i);
+    if ((objp->obj_flags & OC_FLAG_NOTSYNC) != 0U) {
+      (void) chCacheReadObject(&cache1, objp, false);
+      store_misses++;
+    }
+    else {
+      store_hits++;
+    }
+
+    /* Processing time.*/
+    chThdSleep(1);
+    chCacheReleaseObject(&cache1, objp);
+  }
+
+  return chTimeDiffX(start, chVTGetSystemTimeX());
+}
+
+static void store_print(const char *msgp, sysinterval_t t) {
+
+  test_print(msgp);
+  test_printn((uint32_t)t);
+  test_print(" ticks, ");
+  test_printn(store_hits);
+  test_print(" hits, ");
+  test_printn(store_misses);
+  test_print(" misses, ");
+  test_printn((store_hits * 100U) / (store_hits + store_misses));
+  test_println("% hit rate");
+}
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -243,6 +339,331 @@ static const testcase_t oslib_test_006_001 = {
   oslib_test_006_001_execute
 };
 
+/**
+ * @page oslib_test_006_002 [6.2] Write-back flush and read-ahead
+ *
+ * <h2>Description</h2>
+ * Objects marked for lazy write are written back by the flush function
+ * in key order, objects following the current one are read ahead
+ * asynchronously.
+ *
+ * <h2>Test Steps</h2>
+ * - [6.2.1] Marking objects for lazy write in reverse order, nothing is
+ *   written on release.
+ * - [6.2.2] Flushing the cache, objects are written in key order and
+ *   only once.
+ * - [6.2.3] Reading ahead objects not in cache, objects already in
+ *   cache are not read again.
+ * - [6.2.4] Getting the objects read ahead, they are in sync.
+ * - [6.2.5] Marking all objects for lazy write, read-ahead does not
+ *   evict dirty objects.
+ * - [6.2.6] Flushing the cache, read-ahead is possible again.
+ * .
+ */
+
+static void oslib_test_006_002_setup(void) {
+  chCacheObjectInit(&cache1,
+                    NUM_HASH_ENTRIES,
+                    hash_headers,
+                    NUM_OBJECTS,
+                    sizeof (cached_object_t),
+                    objects,
+                    obj_read,
+                    obj_write);
+}
+
+static void oslib_test_006_002_execute(void) {
+  oc_object_t *objp;
+  unsigned n;
+  uint32_t i;
+
+  /* [6.2.1] Marking objects for lazy write in reverse order, nothing is
+     written on release.*/
+  test_set_step(1);
+  {
+    static const uint32_t keys[] = {3U, 1U, 2U};
+
+    for (i = 0; i < 3; i++) {
+      objp = chCacheGetObject(&cache1, 0U, keys[i]);
+      objp->obj_flags &= ~OC_FLAG_NOTSYNC;
+      objp->obj_flags |= OC_FLAG_LAZYWRITE;
+      chCacheReleaseObject(&cache1, objp);
+    }
+    test_assert_sequence("", "unexpected tokens");
+  }
+  test_end_step(1);
+
+  /* [6.2.2] Flushing the cache, objects are written in key order and only
+     once.*/
+  test_set_step(2);
+  {
+    n = chCacheFlush(&cache1);
+    test_assert(n == 3U, "wrong written count");
+    test_assert_sequence("BCD", "unexpected tokens");
+    n = chCacheFlush(&cache1);
+    test_assert(n == 0U, "objects still dirty");
+    test_assert_sequence("", "unexpected tokens");
+  }
+  test_end_step(2);
+
+  /* [6.2.3] Reading ahead objects not in cache, objects already in cache
+     are not read again.*/
+  test_set_step(3);
+  {
+    n = chCacheReadAhead(&cache1, 0U, 8U, 3U);
+    test_assert(n == 3U, "wrong started count");
+    test_assert_sequence("ijk", "unexpected tokens");
+    n = chCacheReadAhead(&cache1, 0U, 8U, 3U);
+    test_assert(n == 0U, "objects read again");
+    test_assert_sequence("", "unexpected tokens");
+  }
+  test_end_step(3);
+
+  /* [6.2.4] Getting the objects read ahead, they are in sync.*/
+  test_set_step(4);
+  {
+    for (i = 8; i < 11; i++) {
+      objp = chCacheGetObject(&cache1, 0U, i);
+      test_assert((objp->obj_flags & OC_FLAG_INHASH) != 0U, "not in hash");
+      test_assert((objp->obj_flags & OC_FLAG_NOTSYNC) == 0U, "not in sync");
+      chCacheReleaseObject(&cache1, objp);
+    }
+    test_assert_sequence("", "unexpected tokens");
+  }
+  test_end_step(4);
+
+  /* [6.2.5] Marking all objects for lazy write, read-ahead does not evict
+     dirty objects.*/
+  test_set_step(5);
+  {
+    for (i = 8; i < 12; i++) {
+      objp = chCacheGetObject(&cache1, 0U, i);
+      objp->obj_flags &= ~OC_FLAG_NOTSYNC;
+      objp->obj_flags |= OC_FLAG_LAZYWRITE;
+      chCacheReleaseObject(&cache1, objp);
+    }
+    n = chCacheReadAhead(&cache1, 0U, 20U, 2U);
+    test_assert(n == 0U, "dirty object evicted");
+    test_assert_sequence("", "unexpected tokens");
+  }
+  test_end_step(5);
+
+  /* [6.2.6] Flushing the cache, read-ahead is possible again.*/
+  test_set_step(6);
+  {
+    n = chCacheFlush(&cache1);
+    test_assert(n == 4U, "wrong written count");
+    test_assert_sequence("IJKL", "unexpected tokens");
+    n = chCacheReadAhead(&cache1, 0U, 20U, 2U);
+    test_assert(n == 2U, "wrong started count");
+    test_assert_sequence("uv", "unexpected tokens");
+  }
+  test_end_step(6);
+}
+
+static const testcase_t oslib_test_006_002 = {
+  "Write-back flush and read-ahead",
+  oslib_test_006_002_setup,
+  NULL,
+  oslib_test_006_002_execute
+};
+
+/**
+ * @page oslib_test_006_003 [6.3] Sharded caches
+ *
+ * <h2>Description</h2>
+ * Objects are distributed among two caches, routing, read-ahead and
+ * flush are tested across the shards.
+ *
+ * <h2>Test Steps</h2>
+ * - [6.3.1] Initializing the shards.
+ * - [6.3.2] Checking the routing of objects, all shards must be used.
+ * - [6.3.3] Reading objects, each object is stored in the buffers of
+ *   its shard.
+ * - [6.3.4] Reading ahead objects across the shards.
+ * - [6.3.5] Marking objects of both shards for lazy write and flushing.
+ * .
+ */
+
+static void oslib_test_006_003_setup(void) {
+  chCacheShardsObjectInit(&shards1, NUM_SHARDS, shards_caches);
+}
+
+static void oslib_test_006_003_execute(void) {
+  objects_cache_t *ocp;
+  oc_object_t *objp;
+  unsigned n, cnt[NUM_SHARDS];
+  uint32_t i;
+
+  /* [6.3.1] Initializing the shards.*/
+  test_set_step(1);
+  {
+    for (i = 0; i < NUM_SHARDS; i++) {
+      chCacheObjectInit(&shards_caches[i],
+                        NUM_HASH_ENTRIES,
+                        shards_hash_headers[i],
+                        NUM_OBJECTS,
+                        sizeof (cached_object_t),
+                        shards_objects[i],
+                        obj_read,
+                        obj_write);
+    }
+  }
+  test_end_step(1);
+
+  /* [6.3.2] Checking the routing of objects, all shards must be used.*/
+  test_set_step(2);
+  {
+    for (i = 0; i < NUM_SHARDS; i++) {
+      cnt[i] = 0U;
+    }
+    for (i = 0; i < 16; i++) {
+      ocp = chCacheGetShardX(&shards1, 0U, i);
+      test_assert(ocp == chCacheGetShardX(&shards1, 0U, i), "unstable routing");
+      test_assert((ocp >= &shards_caches[0]) &&
+                  (ocp < &shards_caches[NUM_SHARDS]), "invalid shard");
+      cnt[ocp - &shards_caches[0]]++;
+    }
+    for (i = 0; i < NUM_SHARDS; i++) {
+      test_assert(cnt[i] > 0U, "unused shard");
+    }
+  }
+  test_end_step(2);
+
+  /* [6.3.3] Reading objects, each object is stored in the buffers of its
+     shard.*/
+  test_set_step(3);
+  {
+    for (i = 0; i < 4; i++) {
+      ocp  = chCacheGetShardX(&shards1, 0U, i);
+      objp = chCacheGetObject(ocp, 0U, i);
+      n    = (unsigned)(ocp - &shards_caches[0]);
+      test_assert(((void *)objp >= (void *)&shards_objects[n][0]) &&
+                  ((void *)objp < (void *)&shards_objects[n][NUM_OBJECTS]),
+                  "wrong buffer");
+      (void) chCacheReadObject(ocp, objp, false);
+      chCacheReleaseObject(ocp, objp);
+    }
+    test_assert_sequence("abcd", "unexpected tokens");
+  }
+  test_end_step(3);
+
+  /* [6.3.4] Reading ahead objects across the shards.*/
+  test_set_step(4);
+  {
+    n = chCacheShardsReadAhead(&shards1, 0U, 2U, 6U);
+    test_assert(n == 4U, "wrong started count");
+    test_assert_sequence("efgh", "unexpected tokens");
+  }
+  test_end_step(4);
+
+  /* [6.3.5] Marking objects of both shards for lazy write and flushing.*/
+  test_set_step(5);
+  {
+    static const uint32_t keys[] = {0U, 5U};
+
+    for (i = 0; i < 2; i++) {
+      ocp  = chCacheGetShardX(&shards1, 0U, keys[i]);
+      objp = chCacheGetObject(ocp, 0U, keys[i]);
+      test_assert((objp->obj_flags & OC_FLAG_NOTSYNC) == 0U, "not in sync");
+      objp->obj_flags |= OC_FLAG_LAZYWRITE;
+      chCacheReleaseObject(ocp, objp);
+    }
+    n = chCacheShardsFlush(&shards1);
+    test_assert(n == 2U, "wrong written count");
+    test_assert_sequence("AF", "unexpected tokens");
+    n = chCacheShardsFlush(&shards1);
+    test_assert(n == 0U, "objects still dirty");
+  }
+  test_end_step(5);
+}
+
+static const testcase_t oslib_test_006_003 = {
+  "Sharded caches",
+  oslib_test_006_003_setup,
+  NULL,
+  oslib_test_006_003_execute
+};
+
+#if (CH_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_006_004 [6.4] Read-ahead benchmark
+ *
+ * <h2>Description</h2>
+ * A storage with a latency of one system tick is simulated by a thread,
+ * objects are scanned sequentially and each object takes one system
+ * tick to be processed. The scan is performed without and with read-
+ * ahead, the elapsed time and the hit rate are printed, objects not
+ * requiring a synchronous read are counted as hits.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_MAILBOXES == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [6.4.1] Scanning objects without read-ahead.
+ * - [6.4.2] Scanning objects with read-ahead.
+ * .
+ */
+
+static void oslib_test_006_004_setup(void) {
+  chMBObjectInit(&store_mb, store_buffer, NUM_OBJECTS);
+  chCacheObjectInit(&cache1,
+                    NUM_HASH_ENTRIES,
+                    hash_headers,
+                    NUM_OBJECTS,
+                    sizeof (cached_object_t),
+                    objects,
+                    store_read,
+                    obj_write);
+  {
+    thread_descriptor_t td = {
+      .name  = "store",
+      .wbase = waStore,
+      .wend  = THD_WORKING_AREA_END(waStore),
+      .prio  = chThdGetPriorityX() + 1,
+      .funcp = store_thread,
+      .arg   = NULL
+    };
+    store_tp = chThdCreate(&td);
+  }
+}
+
+static void oslib_test_006_004_teardown(void) {
+  chMBReset(&store_mb);
+  chThdWait(store_tp);
+}
+
+static void oslib_test_006_004_execute(void) {
+  sysinterval_t t;
+
+  /* [6.4.1] Scanning objects without read-ahead.*/
+  test_set_step(1);
+  {
+    t = store_scan(1U, false);
+    store_print("--- No read-ahead: ", t);
+  }
+  test_end_step(1);
+
+  /* [6.4.2] Scanning objects with read-ahead.*/
+  test_set_step(2);
+  {
+    t = store_scan(2U, true);
+    store_print("--- Read-ahead   : ", t);
+  }
+  test_end_step(2);
+}
+
+static const testcase_t oslib_test_006_004 = {
+  "Read-ahead benchmark",
+  oslib_test_006_004_setup,
+  oslib_test_006_004_teardown,
+  oslib_test_006_004_execute
+};
+#endif /* CH_CFG_USE_MAILBOXES == TRUE */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -252,6 +673,11 @@ static const testcase_t oslib_test_006_001 = {
  */
 const testcase_t * const oslib_test_sequence_006_array[] = {
   &oslib_test_006_001,
+  &oslib_test_006_002,
+  &oslib_test_006_003,
+#if (CH_CFG_USE_MAILBOXES == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_006_004,
+#endif
   NULL
 };
 
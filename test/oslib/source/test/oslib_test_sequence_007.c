@@ -39,6 +39,7 @@
  * - @subpage oslib_test_007_001
  * - @subpage oslib_test_007_002
  * - @subpage oslib_test_007_003
+ * - @subpage oslib_test_007_004
  * .
  */
 
@@ -65,6 +66,12 @@ static void *null_provider(size_t size, unsigned align) {
   return NULL;
 }
 
+#if CH_CFG_USE_MEMCORE_REGIONS == TRUE
+static memory_pool_t mp2;
+static memregion_t pool_region;
+static uint32_t pool_bank[MEMORY_POOL_SIZE];
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -288,6 +295,79 @@ static const testcase_t oslib_test_007_003 = {
 };
 #endif /* CH_CFG_USE_SEMAPHORES == TRUE */
 
+#if (CH_CFG_USE_MEMCORE_REGIONS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_007_004 [7.4] Memory Pools placed in memory regions
+ *
+ * <h2>Description</h2>
+ * A memory pool is initialized with a placement hint, objects must be
+ * taken from the memory region having the required attributes.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_MEMCORE_REGIONS == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [7.4.1] Allocating objects until the region is exhausted, all
+ *   objects must be inside the region.
+ * - [7.4.2] Returning an object to the pool, the same object must be
+ *   allocated again.
+ * .
+ */
+
+static void oslib_test_007_004_setup(void) {
+  chCoreRegionObjectInit(&pool_region, "pool", pool_bank,
+                         sizeof (pool_bank), CH_MEM_ATTR_FAST);
+  chCoreRegionAdd(&pool_region);
+  chPoolObjectInitWithHint(&mp2, sizeof (uint32_t), CH_MEM_ATTR_FAST);
+}
+
+static void oslib_test_007_004_teardown(void) {
+  chCoreRegionRemove(&pool_region);
+}
+
+static void oslib_test_007_004_execute(void) {
+  void *p, *last;
+  unsigned n;
+
+  /* [7.4.1] Allocating objects until the region is exhausted, all objects
+     must be inside the region.*/
+  test_set_step(1);
+  {
+    last = NULL;
+    n = 0U;
+    while ((p = chPoolAlloc(&mp2)) != NULL) {
+      test_assert(((uint8_t *)p >= (uint8_t *)pool_bank) &&
+                  ((uint8_t *)p < (uint8_t *)pool_bank + sizeof (pool_bank)),
+                  "outside region");
+      last = p;
+      n++;
+    }
+    test_assert(n > 0U, "no objects allocated");
+  }
+  test_end_step(1);
+
+  /* [7.4.2] Returning an object to the pool, the same object must be
+     allocated again.*/
+  test_set_step(2);
+  {
+    chPoolFree(&mp2, last);
+    test_assert(chPoolAlloc(&mp2) == last, "wrong object");
+    test_assert(chPoolAlloc(&mp2) == NULL, "list not empty");
+  }
+  test_end_step(2);
+}
+
+static const testcase_t oslib_test_007_004 = {
+  "Memory Pools placed in memory regions",
+  oslib_test_007_004_setup,
+  oslib_test_007_004_teardown,
+  oslib_test_007_004_execute
+};
+#endif /* CH_CFG_USE_MEMCORE_REGIONS == TRUE */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -302,6 +382,9 @@ const testcase_t * const oslib_test_sequence_007_array[] = {
 #endif
 #if (CH_CFG_USE_SEMAPHORES == TRUE) || defined(__DOXYGEN__)
   &oslib_test_007_003,
+#endif
+#if (CH_CFG_USE_MEMCORE_REGIONS == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_007_004,
 #endif
   NULL
 };
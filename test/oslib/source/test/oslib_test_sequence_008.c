@@ -38,6 +38,7 @@
  * <h2>Test Cases</h2>
  * - @subpage oslib_test_008_001
  * - @subpage oslib_test_008_002
+ * - @subpage oslib_test_008_003
  * .
  */
 
@@ -53,6 +54,16 @@
 static memory_heap_t test_heap;
 static uint8_t test_heap_buffer[HEAP_SIZE];
 
+#if CH_CFG_USE_MEMCORE_REGIONS == TRUE
+#define BANK_SIZE 256
+#define IN_BANK(p, bank) (((uint8_t *)(p) >= (bank)) &&                    \
+                          ((uint8_t *)(p) < (bank) + sizeof (bank)))
+
+static memregion_t fast_region, dma_region;
+static uint8_t fast_bank[BANK_SIZE];
+static uint8_t dma_bank[BANK_SIZE];
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -268,6 +279,139 @@ static const testcase_t oslib_test_008_002 = {
   oslib_test_008_002_execute
 };
 
+#if (CH_CFG_USE_MEMCORE_REGIONS == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_008_003 [8.3] Memory regions placement
+ *
+ * <h2>Description</h2>
+ * Memory regions with different attributes are registered, blocks are
+ * allocated directly from the regions, using placement hints and from
+ * an heap placed in a region.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_MEMCORE_REGIONS == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [8.3.1] Finding the regions by name.
+ * - [8.3.2] Checking the initial regions status.
+ * - [8.3.3] Allocating a block directly from a region, the block must
+ *   be inside the region and the region free space must decrease.
+ * - [8.3.4] Allocating using placement hints, the first region having
+ *   the required attributes must be used, if there are no suitable
+ *   regions the allocation must fail.
+ * - [8.3.5] Exhausting the first region, allocations must continue in
+ *   the next region having the required attributes.
+ * - [8.3.6] Initializing an heap placed in the non-cacheable region,
+ *   blocks must be allocated from the region and freed blocks must be
+ *   reused.
+ * .
+ */
+
+static void oslib_test_008_003_setup(void) {
+  chCoreRegionObjectInit(&fast_region, "fast", fast_bank,
+                         sizeof (fast_bank), CH_MEM_ATTR_FAST | CH_MEM_ATTR_DMA);
+  chCoreRegionObjectInit(&dma_region, "dma", dma_bank,
+                         sizeof (dma_bank), CH_MEM_ATTR_DMA | CH_MEM_ATTR_NOCACHE);
+  chCoreRegionAdd(&fast_region);
+  chCoreRegionAdd(&dma_region);
+}
+
+static void oslib_test_008_003_teardown(void) {
+  chCoreRegionRemove(&dma_region);
+  chCoreRegionRemove(&fast_region);
+}
+
+static void oslib_test_008_003_execute(void) {
+  void *p1, *p2;
+  size_t n, total;
+
+  /* [8.3.1] Finding the regions by name.*/
+  test_set_step(1);
+  {
+    test_assert(chCoreRegionFind("fast") == &fast_region, "not found");
+    test_assert(chCoreRegionFind("dma") == &dma_region, "not found");
+    test_assert(chCoreRegionFind("sdram") == NULL, "found");
+  }
+  test_end_step(1);
+
+  /* [8.3.2] Checking the initial regions status.*/
+  test_set_step(2);
+  {
+    n = chCoreGetRegionStatusX(&fast_region, &total);
+    test_assert(n == total, "not empty");
+    test_assert(total == sizeof (fast_bank), "wrong size");
+    n = chCoreGetRegionStatusX(&dma_region, &total);
+    test_assert(n == total, "not empty");
+    test_assert(total == sizeof (dma_bank), "wrong size");
+  }
+  test_end_step(2);
+
+  /* [8.3.3] Allocating a block directly from a region, the block must be
+     inside the region and the region free space must decrease.*/
+  test_set_step(3);
+  {
+    p1 = chCoreAllocFromRegion(&dma_region, ALLOC_SIZE, PORT_NATURAL_ALIGN, 0U);
+    test_assert(IN_BANK(p1, dma_bank), "outside region");
+    test_assert(chCoreGetRegionStatusX(&dma_region, NULL) <= sizeof (dma_bank) - ALLOC_SIZE,
+                "free space not decreased");
+  }
+  test_end_step(3);
+
+  /* [8.3.4] Allocating using placement hints, the first region having the
+     required attributes must be used, if there are no suitable regions
+     the allocation must fail.*/
+  test_set_step(4);
+  {
+    p1 = chCoreAllocWithHint(ALLOC_SIZE, PORT_NATURAL_ALIGN, 0U, CH_MEM_ATTR_DMA);
+    test_assert(IN_BANK(p1, fast_bank), "not in first region");
+    p1 = chCoreAllocWithHint(ALLOC_SIZE, PORT_NATURAL_ALIGN, 0U, CH_MEM_ATTR_NOCACHE);
+    test_assert(IN_BANK(p1, dma_bank), "not in matching region");
+    p1 = chCoreAllocWithHint(ALLOC_SIZE, PORT_NATURAL_ALIGN, 0U,
+                             CH_MEM_ATTR_FAST | CH_MEM_ATTR_NOCACHE);
+    test_assert(p1 == NULL, "allocation not failed");
+  }
+  test_end_step(4);
+
+  /* [8.3.5] Exhausting the first region, allocations must continue in the
+     next region having the required attributes.*/
+  test_set_step(5);
+  {
+    n = chCoreGetRegionStatusX(&fast_region, NULL);
+    p1 = chCoreAllocFromRegion(&fast_region, n, 1U, 0U);
+    test_assert(IN_BANK(p1, fast_bank), "allocation failed");
+    p1 = chCoreAllocWithHint(ALLOC_SIZE, PORT_NATURAL_ALIGN, 0U, CH_MEM_ATTR_DMA);
+    test_assert(IN_BANK(p1, dma_bank), "not in next region");
+  }
+  test_end_step(5);
+
+  /* [8.3.6] Initializing an heap placed in the non-cacheable region,
+     blocks must be allocated from the region and freed blocks must be
+     reused.*/
+  test_set_step(6);
+  {
+    chHeapObjectInitWithHint(&test_heap, CH_MEM_ATTR_NOCACHE);
+    p1 = chHeapAlloc(&test_heap, ALLOC_SIZE);
+    test_assert(IN_BANK(p1, dma_bank), "outside region");
+    chHeapFree(p1);
+    p2 = chHeapAlloc(&test_heap, ALLOC_SIZE);
+    test_assert(p2 == p1, "block not reused");
+    chHeapFree(p2);
+    test_assert(chHeapStatus(&test_heap, NULL, NULL) == 1, "wrong free blocks");
+  }
+  test_end_step(6);
+}
+
+static const testcase_t oslib_test_008_003 = {
+  "Memory regions placement",
+  oslib_test_008_003_setup,
+  oslib_test_008_003_teardown,
+  oslib_test_008_003_execute
+};
+#endif /* CH_CFG_USE_MEMCORE_REGIONS == TRUE */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -278,6 +422,9 @@ static const testcase_t oslib_test_008_002 = {
 const testcase_t * const oslib_test_sequence_008_array[] = {
   &oslib_test_008_001,
   &oslib_test_008_002,
+#if (CH_CFG_USE_MEMCORE_REGIONS == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_008_003,
+#endif
   NULL
 };
 
@@ -42,6 +42,7 @@
  * - @subpage oslib_test_009_004
  * - @subpage oslib_test_009_005
  * - @subpage oslib_test_009_006
+ * - @subpage oslib_test_009_007
  * .
  */
 
@@ -51,6 +52,115 @@
  * Shared code.
  ****************************************************************************/
 
+#if CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE
+#define BMK_NAMES           16
+
+static void bmk_name(char *p, unsigned i) {
+  char digits[4];
+  unsigned n = 0U;
+
+  *p++ = 'o';
+  do {
+    digits[n++] = (char)('0' + (i % 10U));
+    i /= 10U;
+  } while (i > 0U);
+  while (n > 0U) {
+    *p++ = digits[--n];
+  }
+  *p = '\0';
+}
+
+static void bmk_lookups(unsigned objn) {
+  char names[BMK_NAMES][8];
+  char name[8];
+  systime_t start, end;
+  uint32_t n;
+  unsigned i;
+
+  /* Registering the objects, the number is limited by the available
+     memory.*/
+  for (i = 0U; i < objn; i++) {
+    bmk_name(name, i);
+    if (chFactoryRegisterObject(name, NULL) == NULL) {
+      break;
+    }
+  }
+  objn = i;
+  test_assert(objn > 0U, "no objects");
+
+  /* Names of objects spread over the whole list.*/
+  for (i = 0U; i < BMK_NAMES; i++) {
+    bmk_name(names[i], (i * objn) / BMK_NAMES);
+  }
+
+  n = 0;
+  start = chVTGetSystemTimeX();
+  end = chTimeAddX(start, TIME_MS2I(1000));
+  do {
+    chFactoryReleaseObject(chFactoryFindObject(names[n % BMK_NAMES]));
+    n++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  } while (chVTIsSystemTimeWithinX(start, end));
+
+  for (i = 0U; i < objn; i++) {
+    registered_object_t *rop;
+
+    bmk_name(name, i);
+    rop = chFactoryFindObject(name);
+    chFactoryReleaseObject(rop);
+    chFactoryReleaseObject(rop);
+  }
+
+  test_print("--- Objects ");
+  test_printn(objn);
+  test_print(": ");
+  test_printn(n);
+  test_println(" lookups/S");
+}
+
+#if defined(__CHIBIOS_RT__) && (CH_CFG_USE_REGISTRY == TRUE)
+static void bmk_thread_lookups(void) {
+  const char *names[BMK_NAMES];
+  systime_t start, end;
+  thread_t *tp;
+  uint32_t n;
+  unsigned i;
+
+  /* Names of the threads currently in the registry.*/
+  i = 0U;
+  tp = chRegFirstThread();
+  do {
+    if ((i < BMK_NAMES) && (chRegGetThreadNameX(tp) != NULL)) {
+      names[i++] = chRegGetThreadNameX(tp);
+    }
+    tp = chRegNextThread(tp);
+  } while (tp != NULL);
+  test_assert(i > 0U, "no named threads");
+
+  n = 0;
+  start = chVTGetSystemTimeX();
+  end = chTimeAddX(start, TIME_MS2I(1000));
+  do {
+    tp = chRegFindThreadByName(names[n % i]);
+#if CH_CFG_USE_DYNAMIC == TRUE
+    chThdRelease(tp);
+#endif
+    n++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  } while (chVTIsSystemTimeWithinX(start, end));
+
+  test_print("--- Threads ");
+  test_printn(i);
+  test_print(": ");
+  test_printn(n);
+  test_println(" lookups/S");
+}
+#endif
+#endif
 
 /****************************************************************************
  * Test cases.
@@ -777,6 +887,71 @@ static const testcase_t oslib_test_009_006 = {
 };
 #endif /* CH_CFG_FACTORY_PIPES == TRUE */
 
+#if (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_009_007 [9.7] Objects lookup benchmark
+ *
+ * <h2>Description</h2>
+ * The time needed to retrieve registered objects by name is measured
+ * with 10, 100 and 1000 objects in the registry, the number of objects
+ * is limited by the available memory. On RT the time needed to
+ * retrieve threads by name from the threads registry is measured too.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [9.7.1] Retrieving objects by name with 10 registered objects.
+ * - [9.7.2] Retrieving objects by name with 100 registered objects.
+ * - [9.7.3] Retrieving objects by name with 1000 registered objects.
+ * - [9.7.4] Retrieving threads by name from the threads registry.
+ * .
+ */
+
+static void oslib_test_009_007_execute(void) {
+
+  /* [9.7.1] Retrieving objects by name with 10 registered objects.*/
+  test_set_step(1);
+  {
+    bmk_lookups(10U);
+  }
+  test_end_step(1);
+
+  /* [9.7.2] Retrieving objects by name with 100 registered objects.*/
+  test_set_step(2);
+  {
+    bmk_lookups(100U);
+  }
+  test_end_step(2);
+
+  /* [9.7.3] Retrieving objects by name with 1000 registered objects.*/
+  test_set_step(3);
+  {
+    bmk_lookups(1000U);
+  }
+  test_end_step(3);
+
+  /* [9.7.4] Retrieving threads by name from the threads registry.*/
+  test_set_step(4);
+  {
+#if defined(__CHIBIOS_RT__) && (CH_CFG_USE_REGISTRY == TRUE)
+    bmk_thread_lookups();
+#endif
+  }
+  test_end_step(4);
+}
+
+static const testcase_t oslib_test_009_007 = {
+  "Objects lookup benchmark",
+  NULL,
+  NULL,
+  oslib_test_009_007_execute
+};
+#endif /* CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -802,6 +977,9 @@ const testcase_t * const oslib_test_sequence_009_array[] = {
 #endif
 #if (CH_CFG_FACTORY_PIPES == TRUE) || defined(__DOXYGEN__)
   &oslib_test_009_006,
+#endif
+#if (CH_CFG_FACTORY_OBJECTS_REGISTRY == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_009_007,
 #endif
   NULL
 };
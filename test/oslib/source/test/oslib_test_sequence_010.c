@@ -0,0 +1,313 @@
+/*
+    ChibiOS - Copyright (C) 2006..2017 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "oslib_test_root.h"
+
+/**
+ * @file    oslib_test_sequence_010.c
+ * @brief   Test Sequence 010 code.
+ *
+ * @page oslib_test_sequence_010 [10] Memory Arenas
+ *
+ * File: @ref oslib_test_sequence_010.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the ChibiOS library functionalities related to
+ * memory arenas.
+ *
+ * <h2>Conditions</h2>
+ * This sequence is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_ARENAS == TRUE
+ * .
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage oslib_test_010_001
+ * - @subpage oslib_test_010_002
+ * - @subpage oslib_test_010_003
+ * .
+ */
+
+#if (CH_CFG_USE_ARENAS == TRUE) || defined(__DOXYGEN__)
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#define ARENA_SIZE 128
+#define ALLOC_SIZE 16
+
+static memory_arena_t test_arena;
+static void *test_arena_buffer[ARENA_SIZE / sizeof (void *)];
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page oslib_test_010_001 [10.1] Allocation and reset
+ *
+ * <h2>Description</h2>
+ * Blocks are allocated from an arena until it is exhausted, then the
+ * arena is reset and the whole space must be available again.
+ *
+ * <h2>Test Steps</h2>
+ * - [10.1.1] Testing initial conditions, the arena must be empty.
+ * - [10.1.2] Allocating blocks until the arena is exhausted, blocks
+ *   must be aligned, contiguous and inside the arena buffer.
+ * - [10.1.3] Checking the statistics, the failed allocation must be
+ *   counted.
+ * - [10.1.4] Resetting the arena, the space must be available again and
+ *   the peak must be retained.
+ * - [10.1.5] Testing aligned allocations and allocation failure.
+ * .
+ */
+
+static void oslib_test_010_001_setup(void) {
+  chArenaObjectInit(&test_arena, test_arena_buffer, sizeof (test_arena_buffer));
+}
+
+static void oslib_test_010_001_execute(void) {
+  void *p, *first;
+  arena_status_t status;
+  unsigned n;
+
+  /* [10.1.1] Testing initial conditions, the arena must be empty.*/
+  test_set_step(1);
+  {
+    chArenaGetStatus(&test_arena, &status);
+    test_assert(status.size == ARENA_SIZE, "wrong size");
+    test_assert(status.used == 0U, "not empty");
+    test_assert(status.peak == 0U, "wrong peak");
+  }
+  test_end_step(1);
+
+  /* [10.1.2] Allocating blocks until the arena is exhausted, blocks must
+     be aligned, contiguous and inside the arena buffer.*/
+  test_set_step(2);
+  {
+    first = chArenaAlloc(&test_arena, ALLOC_SIZE);
+    test_assert(first == (void *)test_arena_buffer, "not at base");
+    n = 1U;
+    while ((p = chArenaAlloc(&test_arena, ALLOC_SIZE)) != NULL) {
+      test_assert(MEM_IS_ALIGNED(p, PORT_NATURAL_ALIGN), "not aligned");
+      test_assert(p == (void *)((uint8_t *)first + (n * ALLOC_SIZE)), "not contiguous");
+      n++;
+    }
+    test_assert(n == ARENA_SIZE / ALLOC_SIZE, "wrong number of blocks");
+  }
+  test_end_step(2);
+
+  /* [10.1.3] Checking the statistics, the failed allocation must be
+     counted.*/
+  test_set_step(3);
+  {
+    chArenaGetStatus(&test_arena, &status);
+    test_assert(status.used == ARENA_SIZE, "wrong used size");
+    test_assert(status.peak == ARENA_SIZE, "wrong peak");
+    test_assert(status.allocations == n, "wrong allocations");
+    test_assert(status.failures == 1U, "wrong failures");
+  }
+  test_end_step(3);
+
+  /* [10.1.4] Resetting the arena, the space must be available again and
+     the peak must be retained.*/
+  test_set_step(4);
+  {
+    chArenaReset(&test_arena);
+    chArenaGetStatus(&test_arena, &status);
+    test_assert(status.used == 0U, "not empty");
+    test_assert(status.peak == ARENA_SIZE, "peak not retained");
+    p = chArenaAlloc(&test_arena, ALLOC_SIZE);
+    test_assert(p == first, "not at base");
+  }
+  test_end_step(4);
+
+  /* [10.1.5] Testing aligned allocations and allocation failure.*/
+  test_set_step(5);
+  {
+    p = chArenaAllocAligned(&test_arena, 1U, 32U);
+    test_assert(MEM_IS_ALIGNED(p, 32U), "not aligned");
+    p = chArenaAlloc(&test_arena, (size_t)-256);
+    test_assert(p == NULL, "allocation not failed");
+  }
+  test_end_step(5);
+}
+
+static const testcase_t oslib_test_010_001 = {
+  "Allocation and reset",
+  oslib_test_010_001_setup,
+  NULL,
+  oslib_test_010_001_execute
+};
+
+/**
+ * @page oslib_test_010_002 [10.2] Nested scopes
+ *
+ * <h2>Description</h2>
+ * Marks are taken at different nesting levels, releasing a mark must
+ * release all the blocks allocated after it and only those.
+ *
+ * <h2>Test Steps</h2>
+ * - [10.2.1] Allocating blocks in two nested scopes.
+ * - [10.2.2] Releasing the inner scope, the next allocation must reuse
+ *   the inner block.
+ * - [10.2.3] Releasing the outer scope, the blocks allocated in the
+ *   outer scope must be released and the block allocated before must be
+ *   kept.
+ * .
+ */
+
+static void oslib_test_010_002_setup(void) {
+  chArenaObjectInit(&test_arena, test_arena_buffer, sizeof (test_arena_buffer));
+}
+
+static void oslib_test_010_002_execute(void) {
+  arena_mark_t mark1, mark2;
+  void *p1, *p2, *p3;
+  arena_status_t status;
+
+  /* [10.2.1] Allocating blocks in two nested scopes.*/
+  test_set_step(1);
+  {
+    p1 = chArenaAlloc(&test_arena, ALLOC_SIZE);
+    mark1 = chArenaGetMark(&test_arena);
+    p2 = chArenaAlloc(&test_arena, ALLOC_SIZE);
+    mark2 = chArenaGetMark(&test_arena);
+    p3 = chArenaAlloc(&test_arena, ALLOC_SIZE);
+    test_assert((p1 != NULL) && (p2 != NULL) && (p3 != NULL), "allocation failed");
+  }
+  test_end_step(1);
+
+  /* [10.2.2] Releasing the inner scope, the next allocation must reuse
+     the inner block.*/
+  test_set_step(2);
+  {
+    chArenaRelease(&test_arena, mark2);
+    test_assert(chArenaAlloc(&test_arena, ALLOC_SIZE) == p3, "not reused");
+    chArenaRelease(&test_arena, mark2);
+  }
+  test_end_step(2);
+
+  /* [10.2.3] Releasing the outer scope, the blocks allocated in the outer
+     scope must be released and the block allocated before must be kept.*/
+  test_set_step(3);
+  {
+    chArenaRelease(&test_arena, mark1);
+    chArenaGetStatus(&test_arena, &status);
+    test_assert(status.used == ALLOC_SIZE, "wrong used size");
+    test_assert(chArenaAlloc(&test_arena, ALLOC_SIZE) == p2, "not reused");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t oslib_test_010_002 = {
+  "Nested scopes",
+  oslib_test_010_002_setup,
+  NULL,
+  oslib_test_010_002_execute
+};
+
+#if (CH_CFG_USE_HEAP == TRUE) || defined(__DOXYGEN__)
+/**
+ * @page oslib_test_010_003 [10.3] Arenas allocated from heaps
+ *
+ * <h2>Description</h2>
+ * An arena buffer is allocated from the default heap, the heap block is
+ * returned on arena disposal.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_HEAP == TRUE
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [10.3.1] Creating an arena on the default heap and allocating from
+ *   it, the blocks must be inside the heap block.
+ * - [10.3.2] Disposing the arena, the block must be returned to the
+ *   heap.
+ * - [10.3.3] Testing allocation failure.
+ * .
+ */
+
+static void oslib_test_010_003_execute(void) {
+  size_t total1, total2;
+  void *p;
+
+  /* [10.3.1] Creating an arena on the default heap and allocating from
+     it, the blocks must be inside the heap block.*/
+  test_set_step(1);
+  {
+    test_assert(chArenaObjectInitFromHeap(&test_arena, NULL, ARENA_SIZE), "heap allocation failed");
+    test_assert(chHeapGetSize(test_arena.block) == ARENA_SIZE, "wrong heap block size");
+    p = chArenaAlloc(&test_arena, ALLOC_SIZE);
+    test_assert(p == test_arena.block, "not at base");
+    (void)chHeapStatus(NULL, &total1, NULL);
+  }
+  test_end_step(1);
+
+  /* [10.3.2] Disposing the arena, the block must be returned to the heap.*/
+  test_set_step(2);
+  {
+    chArenaDispose(&test_arena);
+    (void)chHeapStatus(NULL, &total2, NULL);
+    test_assert(total2 >= total1 + ARENA_SIZE, "block not returned");
+  }
+  test_end_step(2);
+
+  /* [10.3.3] Testing allocation failure.*/
+  test_set_step(3);
+  {
+    test_assert(!chArenaObjectInitFromHeap(&test_arena, NULL, (size_t)-256), "allocation not failed");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t oslib_test_010_003 = {
+  "Arenas allocated from heaps",
+  NULL,
+  NULL,
+  oslib_test_010_003_execute
+};
+#endif /* CH_CFG_USE_HEAP == TRUE */
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const oslib_test_sequence_010_array[] = {
+  &oslib_test_010_001,
+  &oslib_test_010_002,
+#if (CH_CFG_USE_HEAP == TRUE) || defined(__DOXYGEN__)
+  &oslib_test_010_003,
+#endif
+  NULL
+};
+
+/**
+ * @brief   Memory Arenas.
+ */
+const testsequence_t oslib_test_sequence_010 = {
+  "Memory Arenas",
+  oslib_test_sequence_010_array
+};
+
+#endif /* CH_CFG_USE_ARENAS == TRUE */
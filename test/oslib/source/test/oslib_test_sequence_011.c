@@ -0,0 +1,457 @@
+/*
+    ChibiOS - Copyright (C) 2006..2017 Giovanni Di Sirio
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "hal.h"
+#include "oslib_test_root.h"
+/**
+ * @file    oslib_test_sequence_011.c
+ * @brief   Test Sequence 011 code.
+ *
+ * @page oslib_test_sequence_011 [11] Objects FIFOs
+ *
+ * File: @ref oslib_test_sequence_011.c
+ *
+ * <h2>Description</h2>
+ * This sequence tests the ChibiOS library functionalities related to
+ * the objects FIFOs.
+ *
+ * <h2>Conditions</h2>
+ * This sequence is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_USE_OBJ_FIFOS == TRUE
+ * .
+ *
+ * <h2>Test Cases</h2>
+ * - @subpage oslib_test_011_001
+ * - @subpage oslib_test_011_002
+ * .
+ */
+
+#if (CH_CFG_USE_OBJ_FIFOS == TRUE) || defined(__DOXYGEN__)
+
+/****************************************************************************
+ * Shared code.
+ ****************************************************************************/
+
+#include <string.h>
+
+#define FRAME_SIZE          128
+#define FRAME_OBJECTS       4
+#define MAX_SUBSCRIBERS     8
+
+typedef struct {
+  uint32_t              seq;
+  uint8_t               payload[FRAME_SIZE - sizeof (uint32_t)];
+} frame_t;
+
+static objects_multicast_t mc;
+static void *mc_frames[(FRAME_OBJECTS * FRAME_SIZE) / sizeof (void *)];
+static ucnt_t mc_refs[FRAME_OBJECTS];
+static objects_subscriber_t subscribers[MAX_SUBSCRIBERS];
+static msg_t subscribers_msgs[MAX_SUBSCRIBERS][FRAME_OBJECTS];
+
+static void mc_init(unsigned n) {
+  unsigned i;
+
+  chFifoMulticastObjectInit(&mc, FRAME_SIZE, FRAME_OBJECTS,
+                            mc_frames, mc_refs);
+  for (i = 0U; i < n; i++) {
+    chFifoSubscriberObjectInit(&subscribers[i], subscribers_msgs[i],
+                               FRAME_OBJECTS);
+    chFifoSubscribe(&mc, &subscribers[i]);
+  }
+}
+
+static cnt_t mc_get_free(void) {
+  cnt_t n;
+
+  chSysLock();
+  n = chGuardedPoolGetCounterI(&mc.free);
+  chSysUnlock();
+
+  return n;
+}
+
+/* Benchmark time window, results are scaled to one second.*/
+#define MC_BMK_MS           100U
+
+/* Sequence number marking the last frame, the consumer exits after
+   receiving it from all the subscribers.*/
+#define MC_BMK_STOP         0xFFFFFFFFU
+
+/* The consumer does not preempt the tester thread, on NIL priorities
+   are thread slots and the consumer takes the next, lower priority,
+   slot.*/
+#if defined(__CHIBIOS_NIL__)
+#define MC_BMK_PRIO         (chThdGetPriorityX() + 1)
+#else
+#define MC_BMK_PRIO         chThdGetPriorityX()
+#endif
+
+static objects_fifo_t copy_fifos[MAX_SUBSCRIBERS];
+static void *copy_frames[MAX_SUBSCRIBERS]
+                        [(FRAME_OBJECTS * FRAME_SIZE) / sizeof (void *)];
+static msg_t copy_msgs[MAX_SUBSCRIBERS][FRAME_OBJECTS];
+static frame_t source_frame;
+static unsigned mc_bmk_n;
+
+static THD_WORKING_AREA(waConsumer, 256);
+
+static THD_FUNCTION(copy_consumer, arg) {
+  uint32_t seq;
+  unsigned i;
+
+  (void)arg;
+  do {
+    seq = MC_BMK_STOP;
+    for (i = 0U; i < mc_bmk_n; i++) {
+      frame_t *fp = NULL;
+
+      (void) chFifoReceiveObjectTimeout(&copy_fifos[i], (void **)&fp,
+                                        TIME_INFINITE);
+      seq = fp->seq;
+      chFifoReturnObject(&copy_fifos[i], (void *)fp);
+    }
+  } while (seq != MC_BMK_STOP);
+  chThdExit(MSG_OK);
+}
+
+static THD_FUNCTION(mc_consumer, arg) {
+  uint32_t seq;
+  unsigned i;
+
+  (void)arg;
+  do {
+    seq = MC_BMK_STOP;
+    for (i = 0U; i < mc_bmk_n; i++) {
+      frame_t *fp = NULL;
+
+      (void) chFifoSubscriberReceiveObjectTimeout(&subscribers[i],
+                                                  (void **)&fp,
+                                                  TIME_INFINITE);
+      seq = fp->seq;
+      chFifoReleaseObject(&mc, (void *)fp);
+    }
+  } while (seq != MC_BMK_STOP);
+  chThdExit(MSG_OK);
+}
+
+static thread_t *mc_bmk_start(unsigned n, tfunc_t funcp) {
+  thread_descriptor_t td = {
+    .name  = "consumer",
+    .wbase = waConsumer,
+    .wend  = THD_WORKING_AREA_END(waConsumer),
+    .prio  = MC_BMK_PRIO,
+    .funcp = funcp,
+    .arg   = NULL
+  };
+
+  mc_bmk_n = n;
+
+  return chThdCreate(&td);
+}
+
+static void copy_send(unsigned n, uint32_t seq) {
+  unsigned i;
+
+  /* Each subscriber gets its own copy of the frame.*/
+  source_frame.seq = seq;
+  for (i = 0U; i < n; i++) {
+    frame_t *fp = chFifoTakeObjectTimeout(&copy_fifos[i], TIME_INFINITE);
+    memcpy((void *)fp, (const void *)&source_frame, FRAME_SIZE);
+    chFifoSendObject(&copy_fifos[i], (void *)fp);
+  }
+}
+
+static void mc_send(uint32_t seq) {
+  frame_t *fp;
+
+  /* The frame is delivered by reference to all subscribers.*/
+  fp = chFifoMulticastTakeObjectTimeout(&mc, TIME_INFINITE);
+  fp->seq = seq;
+  (void) chFifoPublishObject(&mc, (void *)fp);
+}
+
+static uint32_t mc_bmk_copy(unsigned n) {
+  systime_t start, end;
+  uint32_t frames = 0U;
+  thread_t *tp;
+  unsigned i;
+
+  for (i = 0U; i < n; i++) {
+    chFifoObjectInit(&copy_fifos[i], FRAME_SIZE, FRAME_OBJECTS,
+                     copy_frames[i], copy_msgs[i]);
+  }
+  tp = mc_bmk_start(n, copy_consumer);
+
+  start = chVTGetSystemTimeX();
+  end = chTimeAddX(start, TIME_MS2I(MC_BMK_MS));
+  do {
+    copy_send(n, frames);
+    frames++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  } while (chVTIsSystemTimeWithinX(start, end));
+  copy_send(n, MC_BMK_STOP);
+  chThdWait(tp);
+
+  return frames * (1000U / MC_BMK_MS);
+}
+
+static uint32_t mc_bmk_multicast(unsigned n) {
+  systime_t start, end;
+  uint32_t frames = 0U;
+  thread_t *tp;
+
+  mc_init(n);
+  tp = mc_bmk_start(n, mc_consumer);
+
+  start = chVTGetSystemTimeX();
+  end = chTimeAddX(start, TIME_MS2I(MC_BMK_MS));
+  do {
+    mc_send(frames);
+    frames++;
+#if defined(SIMULATOR)
+    _sim_check_for_interrupts();
+#endif
+  } while (chVTIsSystemTimeWithinX(start, end));
+  mc_send(MC_BMK_STOP);
+  chThdWait(tp);
+
+  return frames * (1000U / MC_BMK_MS);
+}
+
+static void mc_bmk(unsigned n) {
+  uint32_t frames;
+
+  frames = mc_bmk_copy(n);
+  test_print("--- Subscribers ");
+  test_printn(n);
+  test_print(", copy     : ");
+  test_printn(frames);
+  test_println(" frames/S");
+
+  frames = mc_bmk_multicast(n);
+  test_print("--- Subscribers ");
+  test_printn(n);
+  test_print(", zero-copy: ");
+  test_printn(frames);
+  test_println(" frames/S");
+}
+
+/****************************************************************************
+ * Test cases.
+ ****************************************************************************/
+
+/**
+ * @page oslib_test_011_001 [11.1] Multicast FIFO
+ *
+ * <h2>Description</h2>
+ * Frames are published on a multicast FIFO with several subscribers,
+ * the frames must be delivered by reference to all subscribers and
+ * returned to the pool when released by the last subscriber.
+ *
+ * <h2>Test Steps</h2>
+ * - [11.1.1] Publishing a frame to three subscribers, the same frame
+ *   must be received by all subscribers.
+ * - [11.1.2] Releasing the frame, it must be returned to the pool after
+ *   the last release only.
+ * - [11.1.3] Unsubscribing a subscriber with a pending frame, the
+ *   reference must be released by the unsubscribe operation.
+ * - [11.1.4] Publishing without subscribers, the frame must be returned
+ *   to the pool immediately.
+ * - [11.1.5] Publishing to a lagging subscriber with a single slot
+ *   mailbox, frames exceeding the mailbox size must be dropped for that
+ *   subscriber only.
+ * .
+ */
+
+static void oslib_test_011_001_setup(void) {
+  mc_init(3U);
+}
+
+static void oslib_test_011_001_execute(void) {
+  frame_t *fp, *rp;
+  unsigned i;
+
+  /* [11.1.1] Publishing a frame to three subscribers, the same frame must
+     be received by all subscribers.*/
+  test_set_step(1);
+  {
+    fp = chFifoMulticastTakeObjectTimeout(&mc, TIME_IMMEDIATE);
+    test_assert(fp != NULL, "no frame");
+    fp->seq = 0x55AA;
+    test_assert(chFifoPublishObject(&mc, (void *)fp) == 3U, "not delivered");
+    for (i = 0U; i < 3U; i++) {
+      rp = NULL;
+      test_assert(chFifoSubscriberReceiveObjectTimeout(&subscribers[i],
+                                                       (void **)&rp,
+                                                       TIME_IMMEDIATE) == MSG_OK,
+                  "not received");
+      test_assert(rp == fp, "not the same frame");
+      test_assert(rp->seq == 0x55AA, "wrong content");
+    }
+  }
+  test_end_step(1);
+
+  /* [11.1.2] Releasing the frame, it must be returned to the pool after
+     the last release only.*/
+  test_set_step(2);
+  {
+    chFifoReleaseObject(&mc, (void *)fp);
+    chFifoReleaseObject(&mc, (void *)fp);
+    test_assert(mc_get_free() == FRAME_OBJECTS - 1, "returned early");
+    chFifoReleaseObject(&mc, (void *)fp);
+    test_assert(mc_get_free() == FRAME_OBJECTS, "not returned");
+  }
+  test_end_step(2);
+
+  /* [11.1.3] Unsubscribing a subscriber with a pending frame, the
+     reference must be released by the unsubscribe operation.*/
+  test_set_step(3);
+  {
+    fp = chFifoMulticastTakeObjectTimeout(&mc, TIME_IMMEDIATE);
+    test_assert(chFifoPublishObject(&mc, (void *)fp) == 3U, "not delivered");
+    chFifoUnsubscribe(&mc, &subscribers[0]);
+    for (i = 1U; i < 3U; i++) {
+      rp = NULL;
+      (void) chFifoSubscriberReceiveObjectTimeout(&subscribers[i],
+                                                  (void **)&rp,
+                                                  TIME_IMMEDIATE);
+      test_assert(rp == fp, "not the same frame");
+      chFifoReleaseObject(&mc, (void *)rp);
+    }
+    test_assert(mc_get_free() == FRAME_OBJECTS, "not returned");
+  }
+  test_end_step(3);
+
+  /* [11.1.4] Publishing without subscribers, the frame must be returned
+     to the pool immediately.*/
+  test_set_step(4);
+  {
+    chFifoUnsubscribe(&mc, &subscribers[1]);
+    chFifoUnsubscribe(&mc, &subscribers[2]);
+    fp = chFifoMulticastTakeObjectTimeout(&mc, TIME_IMMEDIATE);
+    test_assert(chFifoPublishObject(&mc, (void *)fp) == 0U, "delivered");
+    test_assert(mc_get_free() == FRAME_OBJECTS, "not returned");
+  }
+  test_end_step(4);
+
+  /* [11.1.5] Publishing to a lagging subscriber with a single slot
+     mailbox, frames exceeding the mailbox size must be dropped for that
+     subscriber only.*/
+  test_set_step(5);
+  {
+    chFifoSubscriberObjectInit(&subscribers[0], subscribers_msgs[0], 1U);
+    chFifoSubscribe(&mc, &subscribers[0]);
+    chFifoSubscribe(&mc, &subscribers[1]);
+    for (i = 0U; i < 2U; i++) {
+      fp = chFifoMulticastTakeObjectTimeout(&mc, TIME_IMMEDIATE);
+      (void) chFifoPublishObject(&mc, (void *)fp);
+    }
+    test_assert(subscribers[0].dropped == 1U, "not dropped");
+    test_assert(subscribers[1].dropped == 0U, "dropped");
+    rp = NULL;
+    while (chFifoSubscriberReceiveObjectTimeout(&subscribers[0], (void **)&rp,
+                                                TIME_IMMEDIATE) == MSG_OK) {
+      chFifoReleaseObject(&mc, (void *)rp);
+    }
+    while (chFifoSubscriberReceiveObjectTimeout(&subscribers[1], (void **)&rp,
+                                                TIME_IMMEDIATE) == MSG_OK) {
+      chFifoReleaseObject(&mc, (void *)rp);
+    }
+    test_assert(mc_get_free() == FRAME_OBJECTS, "not returned");
+  }
+  test_end_step(5);
+}
+
+static const testcase_t oslib_test_011_001 = {
+  "Multicast FIFO",
+  oslib_test_011_001_setup,
+  NULL,
+  oslib_test_011_001_execute
+};
+
+/**
+ * @page oslib_test_011_002 [11.2] Multicast fan-out benchmark
+ *
+ * <h2>Description</h2>
+ * A frame is delivered to 1, 4 and 8 subscribers served by a consumer
+ * thread, first by copying it in a per-subscriber objects FIFO then by
+ * reference using a multicast FIFO. The number of frames delivered per
+ * second is printed for both methods.
+ *
+ * <h2>Test Steps</h2>
+ * - [11.2.1] Delivering frames to one subscriber.
+ * - [11.2.2] Delivering frames to four subscribers.
+ * - [11.2.3] Delivering frames to eight subscribers.
+ * .
+ */
+
+static void oslib_test_011_002_execute(void) {
+
+  /* [11.2.1] Delivering frames to one subscriber.*/
+  test_set_step(1);
+  {
+    mc_bmk(1U);
+  }
+  test_end_step(1);
+
+  /* [11.2.2] Delivering frames to four subscribers.*/
+  test_set_step(2);
+  {
+    mc_bmk(4U);
+  }
+  test_end_step(2);
+
+  /* [11.2.3] Delivering frames to eight subscribers.*/
+  test_set_step(3);
+  {
+    mc_bmk(8U);
+  }
+  test_end_step(3);
+}
+
+static const testcase_t oslib_test_011_002 = {
+  "Multicast fan-out benchmark",
+  NULL,
+  NULL,
+  oslib_test_011_002_execute
+};
+
+/****************************************************************************
+ * Exported data.
+ ****************************************************************************/
+
+/**
+ * @brief   Array of test cases.
+ */
+const testcase_t * const oslib_test_sequence_011_array[] = {
+  &oslib_test_011_001,
+  &oslib_test_011_002,
+  NULL
+};
+
+/**
+ * @brief   Objects FIFOs.
+ */
+const testsequence_t oslib_test_sequence_011 = {
+  "Objects FIFOs",
+  oslib_test_sequence_011_array
+};
+
+#endif /* CH_CFG_USE_OBJ_FIFOS == TRUE */
@@ -34,6 +34,7 @@
  * - @subpage rt_test_005_002
  * - @subpage rt_test_005_003
  * - @subpage rt_test_005_004
+ * - @subpage rt_test_005_005
  * .
  */
 
@@ -46,6 +47,30 @@ static THD_FUNCTION(thread, p) {
   test_emit_token(*(char *)p);
 }
 
+#if CH_CFG_REGISTRY_HASH_SIZE > 0
+static THD_FUNCTION(reg_thread, p) {
+
+  (void)p;
+  while (!chThdShouldTerminateX()) {
+    chThdSleepMilliseconds(1);
+  }
+}
+
+/* Finds a thread by name, the reference taken by the lookup is released
+   immediately.*/
+static thread_t *reg_find(const char *name) {
+  thread_t *tp = chRegFindThreadByName(name);
+
+#if CH_CFG_USE_DYNAMIC == TRUE
+  if (tp != NULL) {
+    chThdRelease(tp);
+  }
+#endif
+
+  return tp;
+}
+#endif
+
 /****************************************************************************
  * Test cases.
  ****************************************************************************/
@@ -339,6 +364,117 @@ static const testcase_t rt_test_005_004 = {
 };
 #endif /* CH_CFG_USE_MUTEXES == TRUE */
 
+#if (CH_CFG_REGISTRY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_005_005 [5.5] Registry names lookup
+ *
+ * <h2>Description</h2>
+ * The threads lookup by name is tested with the registry names hash
+ * enabled. Lookup hits and misses, duplicated names and renamed threads
+ * are checked.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - CH_CFG_REGISTRY_HASH_SIZE > 0
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [5.5.1] Creating three threads, two of them with the same name.
+ * - [5.5.2] Looking up the names of the threads, the threads must be
+ *   found, one of the two threads is returned for the duplicated name.
+ * - [5.5.3] Looking up names not in the registry, no thread must be
+ *   found.
+ * - [5.5.4] Renaming threads, the new names must be found and the old
+ *   names must not, the remaining thread with the duplicated name must
+ *   be found.
+ * - [5.5.5] Terminating the threads, the names must not be found
+ *   anymore.
+ * .
+ */
+
+static void rt_test_005_005_teardown(void) {
+  test_terminate_threads();
+  test_wait_threads();
+}
+
+static void rt_test_005_005_execute(void) {
+  thread_t *tp;
+
+  /* [5.5.1] Creating three threads, two of them with the same name.*/
+  test_set_step(1);
+  {
+    static const char * const names[] = {"reg_a", "reg_b", "reg_b"};
+    unsigned i;
+
+    for (i = 0; i < 3; i++) {
+      thread_descriptor_t td = {
+        .name  = names[i],
+        .wbase = (stkalign_t *)wa[i],
+        .wend  = (stkalign_t *)((uint8_t *)wa[i] + WA_SIZE),
+        .prio  = chThdGetPriorityX() - 1,
+        .funcp = reg_thread,
+        .arg   = NULL
+      };
+      threads[i] = chThdCreate(&td);
+    }
+  }
+  test_end_step(1);
+
+  /* [5.5.2] Looking up the names of the threads, the threads must be
+     found, one of the two threads is returned for the duplicated name.*/
+  test_set_step(2);
+  {
+    test_assert(reg_find("reg_a") == threads[0], "not found");
+    tp = reg_find("reg_b");
+    test_assert((tp == threads[1]) || (tp == threads[2]), "not found");
+  }
+  test_end_step(2);
+
+  /* [5.5.3] Looking up names not in the registry, no thread must be
+     found.*/
+  test_set_step(3);
+  {
+    test_assert(reg_find("reg_c") == NULL, "found");
+    test_assert(reg_find("reg_") == NULL, "found");
+    test_assert(reg_find("") == NULL, "found");
+  }
+  test_end_step(3);
+
+  /* [5.5.4] Renaming threads, the new names must be found and the old
+     names must not, the remaining thread with the duplicated name must be
+     found.*/
+  test_set_step(4);
+  {
+    chRegSetThreadNameX(threads[0], "reg_c");
+    test_assert(reg_find("reg_c") == threads[0], "not found");
+    test_assert(reg_find("reg_a") == NULL, "found");
+    chRegSetThreadNameX(threads[1], "reg_d");
+    test_assert(reg_find("reg_d") == threads[1], "not found");
+    test_assert(reg_find("reg_b") == threads[2], "not found");
+  }
+  test_end_step(4);
+
+  /* [5.5.5] Terminating the threads, the names must not be found anymore.*/
+  test_set_step(5);
+  {
+    test_terminate_threads();
+    test_wait_threads();
+    test_assert(reg_find("reg_b") == NULL, "found");
+    test_assert(reg_find("reg_c") == NULL, "found");
+    test_assert(reg_find("reg_d") == NULL, "found");
+  }
+  test_end_step(5);
+}
+
+static const testcase_t rt_test_005_005 = {
+  "Registry names lookup",
+  NULL,
+  rt_test_005_005_teardown,
+  rt_test_005_005_execute
+};
+#endif /* CH_CFG_REGISTRY_HASH_SIZE > 0 */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -352,6 +488,9 @@ const testcase_t * const rt_test_sequence_005_array[] = {
   &rt_test_005_003,
 #if (CH_CFG_USE_MUTEXES == TRUE) || defined(__DOXYGEN__)
   &rt_test_005_004,
+#endif
+#if (CH_CFG_REGISTRY_HASH_SIZE > 0) || defined(__DOXYGEN__)
+  &rt_test_005_005,
 #endif
   NULL
 };
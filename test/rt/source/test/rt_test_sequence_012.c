@@ -46,6 +46,7 @@
  * - @subpage rt_test_012_010
  * - @subpage rt_test_012_011
  * - @subpage rt_test_012_012
+ * - @subpage rt_test_012_013
  * .
  */
 
@@ -1038,6 +1039,74 @@ static const testcase_t rt_test_012_012 = {
   rt_test_012_012_execute
 };
 
+#if ((CH_CFG_USE_MESSAGES == TRUE) && (TEST_BENCHMARK_SUPPORT == TRUE)) || defined(__DOXYGEN__)
+/**
+ * @page rt_test_012_013 [12.13] Messages latency distribution
+ *
+ * <h2>Description</h2>
+ * A message server thread is created with a lower priority than the
+ * client thread, the duration of single messages round trips is
+ * sampled and the latency distribution printed on the output log.
+ *
+ * <h2>Conditions</h2>
+ * This test is only executed if the following preprocessor condition
+ * evaluates to true:
+ * - (CH_CFG_USE_MESSAGES == TRUE) && (TEST_BENCHMARK_SUPPORT == TRUE)
+ * .
+ *
+ * <h2>Test Steps</h2>
+ * - [12.13.1] The messenger thread is started at a lower priority than
+ *   the current thread.
+ * - [12.13.2] Messages round trips are sampled, then the messenger
+ *   thread is terminated.
+ * - [12.13.3] Latency distribution is printed.
+ * .
+ */
+
+static void rt_test_012_013_execute(void) {
+  unsigned i;
+
+  /* [12.13.1] The messenger thread is started at a lower priority than
+     the current thread.*/
+  test_set_step(1);
+  {
+    threads[0] = chThdCreateStatic(wa[0], WA_SIZE, chThdGetPriorityX()-1, bmk_thread1, NULL);
+  }
+  test_end_step(1);
+
+  /* [12.13.2] Messages round trips are sampled, then the messenger
+     thread is terminated.*/
+  test_set_step(2);
+  {
+    for (i = 0; i < TEST_CFG_BENCHMARK_SAMPLES; i++) {
+      test_benchmark_start();
+      (void) chMsgSend(threads[0], 1);
+      test_benchmark_stop();
+#if defined(SIMULATOR)
+      _sim_check_for_interrupts();
+#endif
+    }
+    (void) chMsgSend(threads[0], 0);
+    test_wait_threads();
+  }
+  test_end_step(2);
+
+  /* [12.13.3] Latency distribution is printed.*/
+  test_set_step(3);
+  {
+    test_benchmark_report("Msg RTT");
+  }
+  test_end_step(3);
+}
+
+static const testcase_t rt_test_012_013 = {
+  "Messages latency distribution",
+  NULL,
+  NULL,
+  rt_test_012_013_execute
+};
+#endif /* (CH_CFG_USE_MESSAGES == TRUE) && (TEST_BENCHMARK_SUPPORT == TRUE) */
+
 /****************************************************************************
  * Exported data.
  ****************************************************************************/
@@ -1070,6 +1139,9 @@ const testcase_t * const rt_test_sequence_012_array[] = {
   &rt_test_012_011,
 #endif
   &rt_test_012_012,
+#if ((CH_CFG_USE_MESSAGES == TRUE) && (TEST_BENCHMARK_SUPPORT == TRUE)) || defined(__DOXYGEN__)
+  &rt_test_012_013,
+#endif
   NULL
 };
 
@@ -201,6 +201,17 @@
 #define CH_CFG_USE_REGISTRY                 TRUE
 #endif
 
+/**
+ * @brief   Size of the registry names hash index.
+ * @details If greater than zero then @p chRegFindThreadByName() uses a
+ *          hash table instead of scanning the registry.
+ * @note    The value must be zero or a power of two.
+ * @note    Requires @p CH_CFG_USE_REGISTRY.
+ */
+#if !defined(CH_CFG_REGISTRY_HASH_SIZE)
+#define CH_CFG_REGISTRY_HASH_SIZE           8
+#endif
+
 /**
  * @brief   Threads synchronization APIs.
  * @details If enabled then the @p chThdWait() function is included in
@@ -387,6 +398,19 @@
 #define CH_CFG_MEMCORE_SIZE                 0x20000
 #endif
 
+/**
+ * @brief   Memory regions APIs.
+ * @details If enabled then additional memory regions with attributes can
+ *          be registered, blocks can be placed in the regions directly or
+ *          through placement hints by the core allocator, heaps and pools.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_MEMCORE.
+ */
+#if !defined(CH_CFG_USE_MEMCORE_REGIONS)
+#define CH_CFG_USE_MEMCORE_REGIONS          TRUE
+#endif
+
 /**
  * @brief   Heap Allocator APIs.
  * @details If enabled then the memory heap allocator APIs are included
@@ -412,6 +436,17 @@
 #define CH_CFG_USE_MEMPOOLS                 TRUE
 #endif
 
+/**
+ * @brief   Memory Arenas Allocator APIs.
+ * @details If enabled then the memory arenas allocator APIs are included
+ *          in the kernel.
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_CFG_USE_ARENAS)
+#define CH_CFG_USE_ARENAS                   TRUE
+#endif
+
 /**
  * @brief   Objects FIFOs APIs.
  * @details If enabled then the objects FIFOs APIs are included
@@ -496,6 +531,16 @@
 #define CH_CFG_FACTORY_MAX_NAMES_LENGTH     8
 #endif
 
+/**
+ * @brief   Size of the names hash index of each factory list.
+ * @details If greater than zero then lookups by name use a hash table
+ *          instead of scanning the objects list.
+ * @note    The value must be zero or a power of two.
+ */
+#if !defined(CH_CFG_FACTORY_HASH_SIZE)
+#define CH_CFG_FACTORY_HASH_SIZE            8
+#endif
+
 /**
  * @brief   Enables the registry of generic objects.
  */
@@ -556,6 +601,18 @@
 #define CH_DBG_STATISTICS                   FALSE
 #endif
 
+/**
+ * @brief   Debug option, ISRs time accounting.
+ * @details If enabled the time spent in ISRs is measured and it is not
+ *          accounted to the interrupted threads.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_DBG_STATISTICS.
+ */
+#if !defined(CH_DBG_STATISTICS_ISR)
+#define CH_DBG_STATISTICS_ISR               FALSE
+#endif
+
 /**
  * @brief   Debug option, system state check.
  * @details If enabled the correct call protocol for system APIs is checked
@@ -635,6 +692,19 @@
 #define CH_DBG_FILL_THREADS                 FALSE
 #endif
 
+/**
+ * @brief   Debug option, stacks watermark.
+ * @details If enabled then the idle thread incrementally scans the filled
+ *          stacks of the registered threads, the unused stack space is
+ *          returned by @p chRegGetStackUnusedX().
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_DBG_FILL_THREADS and @p CH_CFG_USE_REGISTRY.
+ */
+#if !defined(CH_DBG_STACK_WATERMARK)
+#define CH_DBG_STACK_WATERMARK              FALSE
+#endif
+
 /**
  * @brief   Debug option, threads profiling.
  * @details If enabled then a field is added to the @p thread_t structure that
@@ -648,6 +718,39 @@
 #define CH_DBG_THREADS_PROFILING            TRUE
 #endif
 
+/**
+ * @brief   Debug option, sampling profiler.
+ * @details If enabled then program counter samples can be collected in a
+ *          per-core buffer and fetched using @p chProfRead().
+ *
+ * @note    The default is @p FALSE.
+ */
+#if !defined(CH_DBG_PROFILER)
+#define CH_DBG_PROFILER                     FALSE
+#endif
+
+/**
+ * @brief   Profiler buffer entries.
+ * @note    The value must be a power of two.
+ * @note    The profiler buffer is only allocated if @p CH_DBG_PROFILER is
+ *          enabled.
+ */
+#if !defined(CH_DBG_PROFILER_BUFFER_SIZE)
+#define CH_DBG_PROFILER_BUFFER_SIZE         256
+#endif
+
+/**
+ * @brief   Debug option, synchronization objects profiling.
+ * @details If enabled then mutexes and semaphores collect acquisitions,
+ *          contention, wait and hold times statistics.
+ *
+ * @note    The default is @p FALSE.
+ * @note    Requires @p CH_CFG_USE_TM.
+ */
+#if !defined(CH_DBG_SYNC_PROFILING)
+#define CH_DBG_SYNC_PROFILING               FALSE
+#endif
+
 /** @} */
 
 /*===========================================================================*/
@@ -0,0 +1,343 @@
+#!/usr/bin/env python3
+#
+#    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+#
+#    Licensed under the Apache License, Version 2.0 (the "License");
+#    you may not use this file except in compliance with the License.
+#    You may obtain a copy of the License at
+#
+#        http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing, software
+#    distributed under the License is distributed on an "AS IS" BASIS,
+#    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#    See the License for the specific language governing permissions and
+#    limitations under the License.
+#
+
+"""Formats a ChibiOS deferred log stream.
+
+The input is the binary stream produced by the dlog module under
+os/various/dlog. Messages only carry the address of the format string and
+the raw arguments, format strings and constant string arguments are read
+from the ELF file of the image and the messages are formatted using the
+chprintf() rules.
+
+Usage:
+    chdlog.py [--no-time] elf input
+"""
+
+import argparse
+import struct
+import sys
+
+REC_MESSAGE     = 1
+REC_LOST        = 2
+
+# Symbol used to compute the load offset of position independent images.
+ANCHOR_SYMBOL   = "chSysInit"
+
+SHT_SYMTAB      = 2
+SHT_NOBITS      = 8
+SHF_ALLOC       = 2
+
+
+class StreamError(Exception):
+    pass
+
+
+class TruncatedStream(StreamError):
+    pass
+
+
+class Reader:
+
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def eof(self):
+        return self.pos >= len(self.data)
+
+    def byte(self):
+        if self.pos >= len(self.data):
+            raise TruncatedStream("truncated stream")
+        b = self.data[self.pos]
+        self.pos += 1
+        return b
+
+    def bytes(self, n):
+        if self.pos + n > len(self.data):
+            raise TruncatedStream("truncated stream")
+        b = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return b
+
+    def u32(self):
+        return int.from_bytes(self.bytes(4), "little")
+
+    def varint(self):
+        x = 0
+        shift = 0
+        while True:
+            b = self.byte()
+            x |= (b & 0x7F) << shift
+            if b < 0x80:
+                return x
+            shift += 7
+
+
+def parse(data):
+    """Decodes a stream, returns the header and the list of records, each
+    record is a (type, value) tuple."""
+    rd = Reader(data)
+    if rd.bytes(4) != b"CHDL":
+        raise StreamError("not a deferred log stream")
+    hdr = {}
+    hdr["version"] = rd.byte()
+    if hdr["version"] != 1:
+        raise StreamError("unsupported version %d" % hdr["version"])
+    hdr["ptr_size"] = rd.byte()
+    hdr["frequency"] = rd.u32()
+    hdr["anchor"] = rd.varint()
+
+    records = []
+    while not rd.eof():
+        pos = rd.pos
+        try:
+            rtype = rd.byte()
+            if rtype == REC_MESSAGE:
+                delta = rd.varint()
+                fmt = rd.varint()
+                args = [rd.varint() for _ in range(rd.varint())]
+                records.append((REC_MESSAGE, (delta, fmt, args)))
+            elif rtype == REC_LOST:
+                records.append((REC_LOST, rd.varint()))
+            else:
+                raise StreamError("unknown record type %d at offset %d" %
+                                  (rtype, pos))
+        except TruncatedStream:
+            # Captures usually end in the middle of a record.
+            break
+    return hdr, records
+
+
+class Image:
+    """Allocated sections and symbols of an ELF file."""
+
+    def __init__(self, path):
+        try:
+            with open(path, "rb") as f:
+                self.data = f.read()
+        except OSError as e:
+            raise StreamError("cannot read ELF file: %s" % e)
+        if self.data[:4] != b"\x7fELF":
+            raise StreamError("not an ELF file")
+        is64 = self.data[4] == 2
+        self.endian = "<" if self.data[5] == 1 else ">"
+        if is64:
+            shoff, = self.unpack("Q", 0x28)
+            shentsize, shnum = self.unpack("HH", 0x3A)
+        else:
+            shoff, = self.unpack("I", 0x20)
+            shentsize, shnum = self.unpack("HH", 0x2E)
+
+        sections = []
+        for i in range(shnum):
+            pos = shoff + i * shentsize
+            if is64:
+                (_, stype, flags, addr, offset, size, link, _, _,
+                 entsize) = self.unpack("IIQQQQIIQQ", pos)
+            else:
+                (_, stype, flags, addr, offset, size, link, _, _,
+                 entsize) = self.unpack("IIIIIIIIII", pos)
+            sections.append((stype, flags, addr, offset, size, link,
+                             entsize))
+
+        self.regions = []
+        self.anchor = None
+        for stype, flags, addr, offset, size, link, entsize in sections:
+            if (flags & SHF_ALLOC) and stype != SHT_NOBITS and addr != 0:
+                self.regions.append((addr, offset, size))
+            elif stype == SHT_SYMTAB:
+                strtab = sections[link][3]
+                for pos in range(offset, offset + size, entsize):
+                    if is64:
+                        name, _, _, _, value, _ = self.unpack("IBBHQQ", pos)
+                    else:
+                        name, value, _, _, _, _ = self.unpack("IIIBBH", pos)
+                    if self.cstring(strtab + name) == ANCHOR_SYMBOL:
+                        self.anchor = value & ~1
+
+    def unpack(self, fmt, pos):
+        fmt = self.endian + fmt
+        return struct.unpack_from(fmt, self.data, pos)
+
+    def cstring(self, pos):
+        end = self.data.find(b"\0", pos)
+        if end < 0:
+            end = len(self.data)
+        return self.data[pos:end].decode("ascii", "replace")
+
+    def offset(self, anchor):
+        """Load offset of the image, zero if not relocated."""
+        if self.anchor is None or anchor == 0:
+            return 0
+        return anchor - self.anchor
+
+    def string(self, addr):
+        """Returns the string at the specified link address or None."""
+        for base, offset, size in self.regions:
+            if base <= addr < base + size:
+                return self.cstring(offset + addr - base)
+        return None
+
+
+def signed(x, bits):
+    x &= (1 << bits) - 1
+    if x >= 1 << (bits - 1):
+        x -= 1 << bits
+    return x
+
+
+def format_message(fmt, args, image, offset, ptr_bits):
+    """Formats a message following the chvprintf() rules, hexadecimal
+    digits are upper case and the long modifier is implied by upper case
+    conversions."""
+    out = []
+    args = list(args)
+    i = 0
+
+    def arg():
+        return args.pop(0) if args else 0
+
+    while i < len(fmt):
+        c = fmt[i]
+        i += 1
+        if c != "%":
+            out.append(c)
+            continue
+        left = sign = False
+        filler = " "
+        if fmt[i:i + 1] == "-":
+            left = True
+            i += 1
+        if fmt[i:i + 1] == "+":
+            sign = True
+            i += 1
+        if fmt[i:i + 1] == "0":
+            filler = "0"
+            i += 1
+        width = 0
+        if fmt[i:i + 1] == "*":
+            width = signed(arg(), 32)
+            i += 1
+        else:
+            while fmt[i:i + 1].isdigit():
+                width = width * 10 + int(fmt[i])
+                i += 1
+        precision = 0
+        if fmt[i:i + 1] == ".":
+            i += 1
+            if fmt[i:i + 1] == "*":
+                precision = signed(arg(), 32)
+                i += 1
+            else:
+                while fmt[i:i + 1].isdigit():
+                    precision = precision * 10 + int(fmt[i])
+                    i += 1
+        if i >= len(fmt):
+            break
+        c = fmt[i]
+        i += 1
+        if c in "lL":
+            is_long = True
+            if i >= len(fmt):
+                break
+            c = fmt[i]
+            i += 1
+        else:
+            is_long = "A" <= c <= "Z"
+        bits = ptr_bits if is_long else 32
+
+        if c == "c":
+            filler = " "
+            s = chr(arg() & 0xFF)
+        elif c == "s":
+            filler = " "
+            addr = arg()
+            if addr == 0:
+                s = "(null)"
+            else:
+                s = image.string(addr - offset)
+                if s is None:
+                    s = "<0x%x>" % addr
+            if precision > 0:
+                s = s[:precision]
+        elif c in "DdIi":
+            v = signed(arg(), bits)
+            s = "-%d" % -v if v < 0 else ("+%d" % v if sign else "%d" % v)
+        elif c in "XxPp":
+            s = "%X" % (arg() & ((1 << bits) - 1))
+        elif c in "Uu":
+            s = "%d" % (arg() & ((1 << bits) - 1))
+        elif c in "Oo":
+            s = "%o" % (arg() & ((1 << bits) - 1))
+        elif c == "f":
+            arg()
+            s = "?"
+        else:
+            s = c
+        pad = width - len(s)
+        if pad > 0:
+            if left:
+                s = s + filler * pad
+            elif filler == "0" and s[:1] in "+-" and s:
+                s = s[0] + "0" * pad + s[1:]
+            else:
+                s = filler * pad + s
+        out.append(s)
+    return "".join(out)
+
+
+def main():
+    ap = argparse.ArgumentParser(description="ChibiOS deferred log "
+                                             "formatter.")
+    ap.add_argument("elf", help="ELF file of the logging image")
+    ap.add_argument("input", help="binary deferred log stream")
+    ap.add_argument("--no-time", action="store_true",
+                    help="do not prefix messages with time stamps")
+    args = ap.parse_args()
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+    try:
+        hdr, records = parse(data)
+        image = Image(args.elf)
+    except StreamError as e:
+        sys.exit("chdlog: %s" % e)
+
+    offset = image.offset(hdr["anchor"])
+    ptr_bits = hdr["ptr_size"] * 8
+    frequency = hdr["frequency"] or 1
+    time = 0
+    out = sys.stdout
+    for rtype, value in records:
+        if rtype == REC_LOST:
+            out.write("*** %d messages lost\n" % value)
+            continue
+        delta, fmt, margs = value
+        time += delta
+        text = image.string(fmt - offset)
+        if text is None:
+            text = "<unknown format 0x%x>" % fmt
+        else:
+            text = format_message(text, margs, image, offset, ptr_bits)
+        text = text.rstrip("\r\n")
+        if not args.no_time:
+            text = "[%12.6f] %s" % (time / frequency, text)
+        out.write(text + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,231 @@
+#!/usr/bin/env python3
+#
+#    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+#
+#    Licensed under the Apache License, Version 2.0 (the "License");
+#    you may not use this file except in compliance with the License.
+#    You may obtain a copy of the License at
+#
+#        http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing, software
+#    distributed under the License is distributed on an "AS IS" BASIS,
+#    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#    See the License for the specific language governing permissions and
+#    limitations under the License.
+#
+
+"""Symbolizes a ChibiOS/RT profiler stream.
+
+The input is the binary stream produced by the prof_stream module under
+os/various/prof_stream. Samples are resolved to functions using the symbol
+table of the ELF file, obtained with nm, and a flat profile is printed,
+optionally followed by a profile for each thread.
+
+Usage:
+    chprof.py [--nm NM] [--top N] [--per-thread] elf input
+"""
+
+import argparse
+import bisect
+import subprocess
+import sys
+
+REC_SAMPLE      = 1
+REC_THREAD      = 2
+REC_LOST        = 3
+
+# Symbol used to compute the load offset of position independent images.
+ANCHOR_SYMBOL   = "chSysInit"
+
+
+class StreamError(Exception):
+    pass
+
+
+class TruncatedStream(StreamError):
+    pass
+
+
+class Reader:
+
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def eof(self):
+        return self.pos >= len(self.data)
+
+    def byte(self):
+        if self.pos >= len(self.data):
+            raise TruncatedStream("truncated stream")
+        b = self.data[self.pos]
+        self.pos += 1
+        return b
+
+    def bytes(self, n):
+        if self.pos + n > len(self.data):
+            raise TruncatedStream("truncated stream")
+        b = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return b
+
+    def u32(self):
+        return int.from_bytes(self.bytes(4), "little")
+
+    def varint(self):
+        x = 0
+        shift = 0
+        while True:
+            b = self.byte()
+            x |= (b & 0x7F) << shift
+            if b < 0x80:
+                return x
+            shift += 7
+
+
+def parse(data):
+    """Decodes a stream, returns the header, the threads names and the
+    list of (pc, thread) samples."""
+    rd = Reader(data)
+    if rd.bytes(4) != b"CHPF":
+        raise StreamError("not a profiler stream")
+    hdr = {}
+    hdr["version"] = rd.byte()
+    if hdr["version"] != 1:
+        raise StreamError("unsupported version %d" % hdr["version"])
+    hdr["ptr_size"] = rd.byte()
+    hdr["frequency"] = rd.u32()
+    hdr["anchor"] = rd.varint()
+    hdr["lost"] = 0
+
+    threads = {}
+    samples = []
+    while not rd.eof():
+        pos = rd.pos
+        try:
+            rtype = rd.byte()
+            if rtype == REC_SAMPLE:
+                pc = rd.varint()
+                tp = rd.varint()
+                samples.append((pc, tp))
+            elif rtype == REC_THREAD:
+                tp = rd.varint()
+                threads[tp] = rd.bytes(rd.varint()).decode("ascii",
+                                                           "replace")
+            elif rtype == REC_LOST:
+                hdr["lost"] += rd.varint()
+            else:
+                raise StreamError("unknown record type %d at offset %d" %
+                                  (rtype, pos))
+        except TruncatedStream:
+            # Captures usually end in the middle of a record.
+            break
+    return hdr, threads, samples
+
+
+class Symbols:
+    """Functions table built from the nm output."""
+
+    def __init__(self, nm, elf):
+        try:
+            out = subprocess.run([nm, "-n", "-C", "--defined-only", elf],
+                                 check=True, capture_output=True,
+                                 text=True).stdout
+        except (OSError, subprocess.CalledProcessError) as e:
+            raise StreamError("cannot read symbols: %s" % e)
+        self.addrs = []
+        self.names = []
+        self.anchor = None
+        for line in out.splitlines():
+            fields = line.split(None, 2)
+            if len(fields) != 3 or fields[1] not in "tTwW":
+                continue
+            addr = int(fields[0], 16)
+            if fields[2] == ANCHOR_SYMBOL:
+                self.anchor = addr
+            self.addrs.append(addr)
+            self.names.append(fields[2])
+
+    def offset(self, anchor):
+        """Load offset of the image, zero if not relocated."""
+        if self.anchor is None or anchor == 0:
+            return 0
+        return anchor - self.anchor
+
+    def lookup(self, addr):
+        i = bisect.bisect_right(self.addrs, addr) - 1
+        if i < 0:
+            return "0x%x" % addr
+        return self.names[i]
+
+
+def thread_name(threads, tp):
+    if tp in threads and threads[tp]:
+        return threads[tp]
+    return "0x%x" % tp
+
+
+def report(title, counts, total, top, out):
+    out.write("%s\n" % title)
+    out.write("%8s %7s  %s\n" % ("samples", "%", "function"))
+    ranked = sorted(counts.items(), key=lambda kv: (-kv[1], kv[0]))
+    for name, n in ranked[:top]:
+        out.write("%8d %6.2f%%  %s\n" % (n, 100.0 * n / total, name))
+    out.write("\n")
+
+
+def main():
+    ap = argparse.ArgumentParser(description="ChibiOS/RT profiler "
+                                             "symbolizer.")
+    ap.add_argument("elf", help="ELF file of the profiled image")
+    ap.add_argument("input", help="binary profiler stream")
+    ap.add_argument("--nm", default="nm",
+                    help="nm executable, for example arm-none-eabi-nm")
+    ap.add_argument("--top", type=int, default=20,
+                    help="number of functions in each profile")
+    ap.add_argument("--per-thread", action="store_true",
+                    help="also print a profile for each thread")
+    args = ap.parse_args()
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+    try:
+        hdr, threads, samples = parse(data)
+        syms = Symbols(args.nm, args.elf)
+    except StreamError as e:
+        sys.exit("chprof: %s" % e)
+
+    out = sys.stdout
+    out.write("# samples=%d lost=%d frequency=%d\n\n" %
+              (len(samples), hdr["lost"], hdr["frequency"]))
+    if not samples:
+        return
+
+    offset = syms.offset(hdr["anchor"])
+    flat = {}
+    per_thread = {}
+    for pc, tp in samples:
+        name = syms.lookup(pc - offset)
+        flat[name] = flat.get(name, 0) + 1
+        counts = per_thread.setdefault(tp, {})
+        counts[name] = counts.get(name, 0) + 1
+
+    report("Flat profile", flat, len(samples), args.top, out)
+
+    totals = {tp: sum(c.values()) for tp, c in per_thread.items()}
+    out.write("Threads\n")
+    out.write("%8s %7s  %s\n" % ("samples", "%", "thread"))
+    for tp, n in sorted(totals.items(), key=lambda kv: -kv[1]):
+        out.write("%8d %6.2f%%  %s\n" % (n, 100.0 * n / len(samples),
+                                         thread_name(threads, tp)))
+    out.write("\n")
+
+    if args.per_thread:
+        for tp, n in sorted(totals.items(), key=lambda kv: -kv[1]):
+            report("Thread %s" % thread_name(threads, tp), per_thread[tp],
+                   n, args.top, out)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,348 @@
+#!/usr/bin/env python3
+#
+#    ChibiOS - Copyright (C) 2006..2018 Giovanni Di Sirio
+#
+#    Licensed under the Apache License, Version 2.0 (the "License");
+#    you may not use this file except in compliance with the License.
+#    You may obtain a copy of the License at
+#
+#        http://www.apache.org/licenses/LICENSE-2.0
+#
+#    Unless required by applicable law or agreed to in writing, software
+#    distributed under the License is distributed on an "AS IS" BASIS,
+#    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#    See the License for the specific language governing permissions and
+#    limitations under the License.
+#
+
+"""Converts a ChibiOS/RT trace stream into a timeline.
+
+The input is the binary stream produced by the trace_stream module under
+os/various/trace_stream. The output is either a Chrome trace JSON file,
+which can be loaded by Perfetto (https://ui.perfetto.dev) or by the
+chrome://tracing page, or a plain text dump.
+
+Usage:
+    chtrace.py [-f json|text] [--rt-freq HZ] input [output]
+"""
+
+import argparse
+import json
+import sys
+
+TYPE_CTRL       = 0
+TYPE_READY      = 1
+TYPE_SWITCH     = 2
+TYPE_ISR_ENTER  = 3
+TYPE_ISR_LEAVE  = 4
+TYPE_HALT       = 5
+TYPE_USER       = 6
+
+CTRL_LOST       = 1
+CTRL_STRING     = 2
+CTRL_THREAD     = 3
+
+TYPE_NAMES = {
+    TYPE_READY:     "ready",
+    TYPE_SWITCH:    "switch",
+    TYPE_ISR_ENTER: "isr-enter",
+    TYPE_ISR_LEAVE: "isr-leave",
+    TYPE_HALT:      "halt",
+    TYPE_USER:      "user",
+}
+
+# Must match CH_STATE_NAMES in chschd.h.
+STATE_NAMES = [
+    "READY", "CURRENT", "WTSTART", "SUSPENDED", "QUEUED", "WTSEM", "WTMTX",
+    "WTCOND", "SLEEPING", "WTEXIT", "WTOREVT", "WTANDEVT", "SNDMSGQ",
+    "SNDMSG", "WTMSG", "FINAL",
+]
+
+
+class StreamError(Exception):
+    pass
+
+
+class TruncatedStream(StreamError):
+    pass
+
+
+class Reader:
+
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def eof(self):
+        return self.pos >= len(self.data)
+
+    def byte(self):
+        if self.pos >= len(self.data):
+            raise TruncatedStream("truncated stream")
+        b = self.data[self.pos]
+        self.pos += 1
+        return b
+
+    def bytes(self, n):
+        if self.pos + n > len(self.data):
+            raise TruncatedStream("truncated stream")
+        b = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return b
+
+    def u32(self):
+        return int.from_bytes(self.bytes(4), "little")
+
+    def varint(self):
+        x = 0
+        shift = 0
+        while True:
+            b = self.byte()
+            x |= (b & 0x7F) << shift
+            if b < 0x80:
+                return x
+            shift += 7
+
+
+def zigzag(x):
+    return (x >> 1) ^ -(x & 1)
+
+
+def parse(data, rt_freq):
+    """Decodes a stream, returns the header and the list of events.
+
+    Each event is a dictionary with absolute time in microseconds, the
+    type name and the decoded fields."""
+    rd = Reader(data)
+    if rd.bytes(4) != b"CHTR":
+        raise StreamError("not a trace stream")
+    hdr = {}
+    hdr["version"] = rd.byte()
+    if hdr["version"] != 1:
+        raise StreamError("unsupported version %d" % hdr["version"])
+    hdr["systime_bits"] = rd.byte()
+    hdr["st_freq"] = rd.u32()
+    hdr["rt_freq"] = rd.u32()
+    if rt_freq is not None:
+        hdr["rt_freq"] = rt_freq
+
+    strings = {}
+    threads = {}
+    events = []
+    st = 0
+    rt = 0
+    lost = 0
+
+    while not rd.eof():
+        try:
+            st, rt, lost = parse_record(rd, hdr, strings, threads, events,
+                                        st, rt, lost)
+        except TruncatedStream:
+            # Captures usually end in the middle of a record.
+            break
+
+    hdr["lost"] = lost
+    return hdr, strings, threads, events
+
+
+def parse_record(rd, hdr, strings, threads, events, st, rt, lost):
+    """Decodes a single record, returns the updated time and lost
+    records counters."""
+    st_freq = hdr["st_freq"]
+    rt_freq = hdr["rt_freq"]
+    b = rd.byte()
+    rtype = b & 7
+    state = b >> 3
+    if rtype == TYPE_CTRL:
+        if state == CTRL_LOST:
+            n = rd.varint()
+            lost += n
+            events.append({"type": "lost", "count": n,
+                           "ts": rt_time(st, rt, st_freq, rt_freq)})
+        elif state == CTRL_STRING:
+            p = rd.varint()
+            strings[p] = rd.bytes(rd.varint()).decode("ascii", "replace")
+        elif state == CTRL_THREAD:
+            tp = rd.varint()
+            prio = rd.varint()
+            name = rd.bytes(rd.varint()).decode("ascii", "replace")
+            threads[tp] = {"name": name, "prio": prio}
+        else:
+            raise StreamError("unknown control record %d" % state)
+        return st, rt, lost
+
+    dst = rd.varint()
+    drt = rd.varint()
+    st += dst
+    rt = advance_rt(rt, dst, drt, st_freq, rt_freq)
+    ev = {"type": TYPE_NAMES.get(rtype, "unknown"),
+          "state": STATE_NAMES[state] if state < len(STATE_NAMES)
+                   else str(state),
+          "ts": rt_time(st, rt, st_freq, rt_freq)}
+    if rtype == TYPE_READY:
+        ev["tp"] = rd.varint()
+        ev["msg"] = zigzag(rd.varint())
+    elif rtype == TYPE_SWITCH:
+        ev["ntp"] = rd.varint()
+        ev["wtobjp"] = rd.varint()
+    elif rtype in (TYPE_ISR_ENTER, TYPE_ISR_LEAVE):
+        ev["name"] = rd.varint()
+    elif rtype == TYPE_HALT:
+        ev["reason"] = rd.varint()
+    elif rtype == TYPE_USER:
+        ev["up1"] = rd.varint()
+        ev["up2"] = rd.varint()
+    else:
+        raise StreamError("unknown record type %d" % rtype)
+    events.append(ev)
+    return st, rt, lost
+
+
+def advance_rt(rt, dst, drt, st_freq, rt_freq):
+    """Accumulates the 24 bits realtime delta, wraps of the realtime
+    stamp are recovered using the system time delta when both
+    frequencies are known."""
+    if st_freq and rt_freq and dst > 0:
+        expected = dst * rt_freq // st_freq
+        wraps = max(0, (expected - drt + (1 << 23)) >> 24)
+        drt += wraps << 24
+    return rt + drt
+
+
+def rt_time(st, rt, st_freq, rt_freq):
+    """Returns the event time in microseconds."""
+    if rt_freq:
+        return rt * 1000000.0 / rt_freq
+    if st_freq:
+        return st * 1000000.0 / st_freq
+    return float(st)
+
+
+def thread_name(threads, tp):
+    if tp in threads and threads[tp]["name"]:
+        return threads[tp]["name"]
+    return "0x%x" % tp
+
+
+def to_json(hdr, strings, threads, events):
+    """Chrome trace format, each thread is a track with running slices,
+    ISRs have their own track. Wakeup latencies are attached to the
+    slices as arguments."""
+    out = []
+    pid = 1
+    isr_tid = 0
+    out.append({"ph": "M", "pid": pid, "name": "process_name",
+                "args": {"name": "ChibiOS/RT"}})
+    out.append({"ph": "M", "pid": pid, "tid": isr_tid, "name": "thread_name",
+                "args": {"name": "ISRs"}})
+    named = set()
+
+    def tid_of(tp):
+        if tp not in named:
+            named.add(tp)
+            out.append({"ph": "M", "pid": pid, "tid": tp,
+                        "name": "thread_name",
+                        "args": {"name": thread_name(threads, tp)}})
+        return tp
+
+    current = None
+    ready_at = {}
+    for ev in events:
+        ts = ev["ts"]
+        t = ev["type"]
+        if t == "switch":
+            if current is not None:
+                out.append({"ph": "E", "pid": pid, "tid": tid_of(current),
+                            "ts": ts, "args": {"state": ev["state"]}})
+            current = ev["ntp"]
+            args = {}
+            if current in ready_at:
+                args["wakeup_latency_us"] = round(ts - ready_at.pop(current),
+                                                  3)
+            out.append({"ph": "B", "pid": pid, "tid": tid_of(current),
+                        "ts": ts, "name": "running", "args": args})
+        elif t == "ready":
+            ready_at[ev["tp"]] = ts
+            out.append({"ph": "i", "pid": pid, "tid": tid_of(ev["tp"]),
+                        "ts": ts, "s": "t", "name": "ready",
+                        "args": {"msg": ev["msg"]}})
+        elif t == "isr-enter":
+            out.append({"ph": "B", "pid": pid, "tid": isr_tid, "ts": ts,
+                        "name": strings.get(ev["name"], "isr")})
+        elif t == "isr-leave":
+            out.append({"ph": "E", "pid": pid, "tid": isr_tid, "ts": ts})
+        elif t == "halt":
+            out.append({"ph": "i", "pid": pid, "ts": ts, "s": "g",
+                        "name": "halt: " + strings.get(ev["reason"], "")})
+        elif t == "user":
+            out.append({"ph": "i", "pid": pid,
+                        "tid": tid_of(current) if current is not None else 0,
+                        "ts": ts, "s": "t", "name": "user",
+                        "args": {"up1": "0x%x" % ev["up1"],
+                                 "up2": "0x%x" % ev["up2"]}})
+        elif t == "lost":
+            out.append({"ph": "i", "pid": pid, "ts": ts, "s": "g",
+                        "name": "lost %d records" % ev["count"]})
+    return json.dumps({"traceEvents": out, "displayTimeUnit": "ns"},
+                      indent=0)
+
+
+def to_text(hdr, strings, threads, events):
+    lines = ["# st_freq=%d rt_freq=%d lost=%d" %
+             (hdr["st_freq"], hdr["rt_freq"], hdr["lost"])]
+    for tp, t in sorted(threads.items()):
+        lines.append("# thread 0x%x prio %d \"%s\"" % (tp, t["prio"],
+                                                       t["name"]))
+    for ev in events:
+        t = ev["type"]
+        s = "%14.3f %-9s" % (ev["ts"], t)
+        if t == "switch":
+            s += " -> %s (out %s, obj 0x%x)" % (thread_name(threads,
+                                                            ev["ntp"]),
+                                                ev["state"], ev["wtobjp"])
+        elif t == "ready":
+            s += " %s msg %d" % (thread_name(threads, ev["tp"]), ev["msg"])
+        elif t in ("isr-enter", "isr-leave"):
+            s += " %s" % strings.get(ev["name"], "0x%x" % ev["name"])
+        elif t == "halt":
+            s += " %s" % strings.get(ev["reason"], "0x%x" % ev["reason"])
+        elif t == "user":
+            s += " 0x%x 0x%x" % (ev["up1"], ev["up2"])
+        elif t == "lost":
+            s += " %d" % ev["count"]
+        lines.append(s)
+    return "\n".join(lines) + "\n"
+
+
+def main():
+    ap = argparse.ArgumentParser(description="ChibiOS/RT trace converter.")
+    ap.add_argument("input", help="binary trace stream")
+    ap.add_argument("output", nargs="?", help="output file, default stdout")
+    ap.add_argument("-f", "--format", choices=["json", "text"],
+                    default="json", help="output format")
+    ap.add_argument("--rt-freq", type=int, default=None,
+                    help="realtime counter frequency in Hz, overrides the "
+                         "stream header")
+    args = ap.parse_args()
+
+    with open(args.input, "rb") as f:
+        data = f.read()
+    try:
+        hdr, strings, threads, events = parse(data, args.rt_freq)
+    except StreamError as e:
+        sys.exit("chtrace: %s" % e)
+
+    if args.format == "json":
+        result = to_json(hdr, strings, threads, events)
+    else:
+        result = to_text(hdr, strings, threads, events)
+
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(result)
+    else:
+        sys.stdout.write(result)
+
+
+if __name__ == "__main__":
+    main()